@@ -0,0 +1,568 @@
+#include "AsyncFileIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define MULTIAUDIO_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+namespace audio {
+
+namespace {
+
+#ifdef MULTIAUDIO_HAVE_IO_URING
+int uringSetup(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+// IORING_OP_READ/WRITE arrived in Linux 5.6, with the probe; older rings cannot run our requests
+bool uringSupportsReadWrite(int fd)
+{
+    const unsigned int ops = 256;
+    std::vector<uint64_t> storage((sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op)) / sizeof(uint64_t) + 1, 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, ops) < 0)
+    {
+        return false;
+    }
+    return probe->last_op >= IORING_OP_WRITE && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) &&
+           (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+}
+#endif
+
+#ifdef _WIN32
+// No pread/pwrite: serialise seek+transfer pairs across pool threads
+std::mutex seekMutex;
+#endif
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+AsyncFileIO::AsyncFileIO()
+    : backend(AsyncIOBackend::ThreadPool),
+      depth(0),
+      inFlight(0),
+      ringFd(-1),
+      sqRing(nullptr),
+      sqRingBytes(0),
+      cqRing(nullptr),
+      cqRingBytes(0),
+      sqeArray(nullptr),
+      sqeBytes(0),
+      sqHead(nullptr),
+      sqTail(nullptr),
+      sqMask(nullptr),
+      sqIndices(nullptr),
+      cqHead(nullptr),
+      cqTail(nullptr),
+      cqMask(nullptr),
+      cqes(nullptr),
+      stopping(false)
+{
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+    close();
+}
+
+bool AsyncFileIO::open(unsigned int queueDepth, AsyncIOBackend preferred, unsigned int poolThreads)
+{
+    close();
+    queueDepth = std::max(1u, queueDepth);
+
+    if (preferred != AsyncIOBackend::ThreadPool)
+    {
+        if (openUring(queueDepth))
+        {
+            backend = AsyncIOBackend::IoUring;
+            depth = queueDepth;
+            return true;
+        }
+        if (preferred == AsyncIOBackend::IoUring)
+        {
+            std::cerr << "[AsyncIO] ERROR: io_uring is not available" << std::endl;
+            return false;
+        }
+    }
+
+    backend = AsyncIOBackend::ThreadPool;
+    depth = queueDepth;
+    openPool(std::max(1u, std::min(poolThreads, queueDepth)));
+    return true;
+}
+
+void AsyncFileIO::close()
+{
+    if (depth == 0)
+    {
+        return;
+    }
+
+    // Never unmap or free buffers under the kernel/workers: drain first
+    AsyncIOCompletion discard[16];
+    while (inFlight > 0)
+    {
+        reap(discard, 16, true);
+    }
+
+    if (backend == AsyncIOBackend::IoUring)
+    {
+        closeUring();
+    }
+    else
+    {
+        closePool();
+    }
+    depth = 0;
+}
+
+const char* AsyncFileIO::getBackendName() const
+{
+    return backend == AsyncIOBackend::IoUring ? "io_uring" : "thread pool";
+}
+
+//--------------------------------------------------------------------------
+// Requests
+//--------------------------------------------------------------------------
+
+bool AsyncFileIO::submit(const AsyncIORequest& request)
+{
+    if (depth == 0 || inFlight >= depth)
+    {
+        return false;
+    }
+
+    if (backend == AsyncIOBackend::IoUring)
+    {
+        if (!submitUring(request))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            pending.push_back(request);
+        }
+        requestReady.notify_one();
+    }
+    inFlight++;
+    return true;
+}
+
+std::size_t AsyncFileIO::reap(AsyncIOCompletion* out, std::size_t maxCompletions, bool wait)
+{
+    if (depth == 0 || maxCompletions == 0 || inFlight == 0)
+    {
+        return 0;
+    }
+
+    std::size_t count = 0;
+    if (backend == AsyncIOBackend::IoUring)
+    {
+        count = reapUring(out, maxCompletions, wait);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        if (wait)
+        {
+            completionReady.wait(lock, [this]() { return !completed.empty(); });
+        }
+        while (count < maxCompletions && !completed.empty())
+        {
+            out[count++] = completed.front();
+            completed.pop_front();
+        }
+    }
+
+    inFlight -= static_cast<unsigned int>(count);
+    return count;
+}
+
+//--------------------------------------------------------------------------
+// io_uring Backend
+//--------------------------------------------------------------------------
+
+#ifdef MULTIAUDIO_HAVE_IO_URING
+
+bool AsyncFileIO::openUring(unsigned int queueDepth)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = uringSetup(queueDepth, &params);
+    if (fd < 0)
+    {
+        // ENOSYS (old kernel) or EPERM (seccomp/sysctl): use the pool instead
+        return false;
+    }
+    if (!uringSupportsReadWrite(fd))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap)
+    {
+        sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+    }
+
+    void* sq = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    void* cq = singleMap ? sq
+                         : mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                IORING_OFF_CQ_RING);
+    sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        if (sqes != MAP_FAILED) munmap(sqes, sqeBytes);
+        if (cq != MAP_FAILED && cq != sq) munmap(cq, cqRingBytes);
+        if (sq != MAP_FAILED) munmap(sq, sqRingBytes);
+        ::close(fd);
+        return false;
+    }
+
+    ringFd = fd;
+    sqRing = sq;
+    cqRing = cq;
+    sqeArray = sqes;
+
+    char* sqBase = static_cast<char*>(sqRing);
+    sqHead = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.ring_mask);
+    sqIndices = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.array);
+
+    char* cqBase = static_cast<char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned int*>(cqBase + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned int*>(cqBase + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned int*>(cqBase + params.cq_off.ring_mask);
+    cqes = cqBase + params.cq_off.cqes;
+    uringSlots.assign(queueDepth, UringSlot());
+    return true;
+}
+
+void AsyncFileIO::closeUring()
+{
+    if (ringFd < 0)
+    {
+        return;
+    }
+    munmap(sqeArray, sqeBytes);
+    if (cqRing != sqRing)
+    {
+        munmap(cqRing, cqRingBytes);
+    }
+    munmap(sqRing, sqRingBytes);
+    ::close(ringFd);
+    ringFd = -1;
+    sqRing = cqRing = sqeArray = cqes = nullptr;
+    uringSlots.clear();
+}
+
+bool AsyncFileIO::submitUring(const AsyncIORequest& request)
+{
+    // submit() keeps inFlight below depth, so a slot is free
+    unsigned int slot = 0;
+    while (uringSlots[slot].busy)
+    {
+        slot++;
+    }
+    uringSlots[slot].request = request;
+    uringSlots[slot].transferred = 0;
+    if (!queueUring(slot))
+    {
+        return false;
+    }
+    uringSlots[slot].busy = true;
+    return true;
+}
+
+bool AsyncFileIO::queueUring(unsigned int slot)
+{
+    // The part of the request not transferred yet
+    const UringSlot& pendingSlot = uringSlots[slot];
+    const AsyncIORequest& request = pendingSlot.request;
+
+    // Only this thread writes the SQ tail; the kernel only reads it
+    const unsigned int tail = *sqTail;
+    const unsigned int index = tail & *sqMask;
+
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqeArray) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = request.fd;
+    sqe->off = request.offset + pendingSlot.transferred;
+    sqe->addr = reinterpret_cast<uint64_t>(static_cast<char*>(request.buffer) + pendingSlot.transferred);
+    sqe->len = static_cast<uint32_t>(request.bytes - pendingSlot.transferred);
+    sqe->user_data = slot;
+    sqIndices[index] = index;
+
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    int submitted;
+    do
+    {
+        submitted = uringEnter(ringFd, 1, 0, 0);
+    } while (submitted < 0 && errno == EINTR);
+
+    if (submitted < 1)
+    {
+        // Nothing was consumed: withdraw the entry so the ring stays consistent
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+std::size_t AsyncFileIO::reapUring(AsyncIOCompletion* out, std::size_t maxCompletions, bool wait)
+{
+    std::size_t count = 0;
+    while (true)
+    {
+        unsigned int head = *cqHead;
+        const unsigned int tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail && count < maxCompletions)
+        {
+            // Copy the entry out before handing its place back to the kernel
+            const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(cqes) + (head & *cqMask);
+            const unsigned int index = static_cast<unsigned int>(cqe->user_data);
+            const long result = cqe->res;
+            __atomic_store_n(cqHead, ++head, __ATOMIC_RELEASE);
+            UringSlot& slot = uringSlots[index];
+
+            // Short but progressing (a pipe, a signal, a filesystem splitting the request): send the rest
+            if (result > 0 && slot.transferred + static_cast<std::size_t>(result) < slot.request.bytes)
+            {
+                slot.transferred += static_cast<std::size_t>(result);
+                if (queueUring(index))
+                {
+                    continue;
+                }
+                // The ring refused it: finish on this thread, the way transferNow() would have
+                AsyncIORequest rest = slot.request;
+                rest.buffer = static_cast<char*>(rest.buffer) + slot.transferred;
+                rest.bytes -= slot.transferred;
+                rest.offset += slot.transferred;
+                const long more = transferNow(rest);
+                out[count].result = static_cast<long>(slot.transferred) + std::max(0L, more);
+            }
+            else if (result < 0)
+            {
+                out[count].result = slot.transferred > 0 ? static_cast<long>(slot.transferred) : result;
+            }
+            else
+            {
+                out[count].result = static_cast<long>(slot.transferred) + result;
+            }
+            out[count].tag = slot.request.tag;
+            slot.busy = false;
+            count++;
+        }
+
+        if (count > 0 || !wait)
+        {
+            return count;
+        }
+        if (uringEnter(ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+            return count;
+        }
+    }
+}
+
+#else
+
+bool AsyncFileIO::openUring(unsigned int) { return false; }
+void AsyncFileIO::closeUring() {}
+bool AsyncFileIO::submitUring(const AsyncIORequest&) { return false; }
+bool AsyncFileIO::queueUring(unsigned int) { return false; }
+std::size_t AsyncFileIO::reapUring(AsyncIOCompletion*, std::size_t, bool) { return 0; }
+
+#endif
+
+//--------------------------------------------------------------------------
+// Thread Pool Backend
+//--------------------------------------------------------------------------
+
+void AsyncFileIO::openPool(unsigned int threads)
+{
+    stopping = false;
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(&AsyncFileIO::workerLoop, this);
+    }
+}
+
+void AsyncFileIO::closePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    requestReady.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    pending.clear();
+    completed.clear();
+}
+
+void AsyncFileIO::workerLoop()
+{
+    while (true)
+    {
+        AsyncIORequest request;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            requestReady.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty())
+            {
+                return;
+            }
+            request = pending.front();
+            pending.pop_front();
+        }
+
+        AsyncIOCompletion completion;
+        completion.tag = request.tag;
+        completion.result = transferNow(request);
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            completed.push_back(completion);
+        }
+        completionReady.notify_one();
+    }
+}
+
+//--------------------------------------------------------------------------
+// File Helpers
+//--------------------------------------------------------------------------
+
+int AsyncFileIO::openFile(const std::string& path, bool forWrite, bool tryDirect, bool* gotDirect)
+{
+    const int flags = (forWrite ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY) | O_BINARY;
+    int fd = -1;
+    if (gotDirect)
+    {
+        *gotDirect = false;
+    }
+
+#if defined(__linux__) && defined(O_DIRECT)
+    if (tryDirect)
+    {
+        // tmpfs and some network filesystems reject O_DIRECT; fall back below
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0 && gotDirect)
+        {
+            *gotDirect = true;
+        }
+    }
+#else
+    (void)tryDirect;
+#endif
+    if (fd < 0)
+    {
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    return fd;
+}
+
+void AsyncFileIO::closeFile(int fd)
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+bool AsyncFileIO::truncateFile(int fd, uint64_t length)
+{
+#ifdef _WIN32
+    (void)fd;
+    (void)length;
+    return false;
+#else
+    return ftruncate(fd, static_cast<off_t>(length)) == 0;
+#endif
+}
+
+long AsyncFileIO::transferNow(const AsyncIORequest& request)
+{
+    char* data = static_cast<char*>(request.buffer);
+    std::size_t remaining = request.bytes;
+    uint64_t offset = request.offset;
+    long total = 0;
+
+    while (remaining > 0)
+    {
+#ifdef _WIN32
+        long done;
+        {
+            std::lock_guard<std::mutex> lock(seekMutex);
+            if (lseek(request.fd, static_cast<off_t>(offset), SEEK_SET) < 0)
+            {
+                return -errno;
+            }
+            done = request.write ? ::write(request.fd, data, static_cast<unsigned int>(remaining))
+                                 : ::read(request.fd, data, static_cast<unsigned int>(remaining));
+        }
+#else
+        long done = request.write ? pwrite(request.fd, data, remaining, static_cast<off_t>(offset))
+                                  : pread(request.fd, data, remaining, static_cast<off_t>(offset));
+#endif
+        if (done < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return total > 0 ? total : -errno;
+        }
+        if (done == 0)
+        {
+            break; // end of file
+        }
+        data += done;
+        remaining -= static_cast<std::size_t>(done);
+        offset += static_cast<uint64_t>(done);
+        total += done;
+    }
+    return total;
+}
+
+} // namespace audio
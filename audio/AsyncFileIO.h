@@ -0,0 +1,251 @@
+#ifndef ASYNC_FILE_IO_H
+#define ASYNC_FILE_IO_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Alignment for buffers, offsets and lengths used with O_DIRECT files.
+ */
+const std::size_t ASYNC_IO_ALIGNMENT = 4096;
+
+/**
+ * How AsyncFileIO issues requests.
+ */
+enum class AsyncIOBackend
+{
+    Auto,       // io_uring if the kernel allows it, otherwise ThreadPool
+    IoUring,    // Linux io_uring with READ/WRITE (5.6+; raw syscalls, no liburing needed)
+    ThreadPool  // pread/pwrite on worker threads
+};
+
+/**
+ * One positioned read or write.
+ */
+struct AsyncIORequest
+{
+    int fd = -1;
+    void* buffer = nullptr;
+    std::size_t bytes = 0;
+    uint64_t offset = 0;
+    bool write = false;
+    uint64_t tag = 0;           // returned unchanged in the completion
+};
+
+/**
+ * Result of one request.
+ */
+struct AsyncIOCompletion
+{
+    uint64_t tag = 0;
+    long result = 0;            // bytes transferred, or -errno
+};
+
+/**
+ * Queue of asynchronous positioned reads and writes.
+ *
+ * Keeps up to a fixed number of requests in flight so a streaming reader
+ * or writer can overlap disk transfers with its own work. On Linux this
+ * talks to io_uring directly; where io_uring is missing, blocked or too
+ * old for plain reads and writes it falls back to a small pool of threads
+ * doing pread/pwrite. Completions may arrive in any order and are matched
+ * by tag. Like transferNow(), each request completes in full unless it
+ * hits the end of the file or an error: short transfers are resubmitted.
+ *
+ * Not thread-safe: one owner thread submits and reaps.
+ */
+class AsyncFileIO
+{
+private:
+    //--------------------------------------------------------------------------
+    // Common State
+    //--------------------------------------------------------------------------
+    AsyncIOBackend backend;
+    unsigned int depth;
+    unsigned int inFlight;
+
+    //--------------------------------------------------------------------------
+    // io_uring State
+    //--------------------------------------------------------------------------
+    /**
+     * A request in the ring; its index is the SQE's user data.
+     */
+    struct UringSlot
+    {
+        AsyncIORequest request;
+        std::size_t transferred = 0;    // bytes done by earlier, short completions
+        bool busy = false;
+    };
+
+    int ringFd;
+    void* sqRing;
+    std::size_t sqRingBytes;
+    void* cqRing;
+    std::size_t cqRingBytes;
+    void* sqeArray;
+    std::size_t sqeBytes;
+    unsigned int* sqHead;
+    unsigned int* sqTail;
+    unsigned int* sqMask;
+    unsigned int* sqIndices;
+    unsigned int* cqHead;
+    unsigned int* cqTail;
+    unsigned int* cqMask;
+    void* cqes;
+    std::vector<UringSlot> uringSlots;
+
+    //--------------------------------------------------------------------------
+    // Thread Pool State
+    //--------------------------------------------------------------------------
+    std::vector<std::thread> workers;
+    std::mutex poolMutex;
+    std::condition_variable requestReady;
+    std::condition_variable completionReady;
+    std::deque<AsyncIORequest> pending;
+    std::deque<AsyncIOCompletion> completed;
+    bool stopping;
+
+    bool openUring(unsigned int queueDepth);
+    void closeUring();
+    bool submitUring(const AsyncIORequest& request);
+    bool queueUring(unsigned int slot);
+    std::size_t reapUring(AsyncIOCompletion* out, std::size_t maxCompletions, bool wait);
+
+    void openPool(unsigned int threads);
+    void closePool();
+    void workerLoop();
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    AsyncFileIO();
+    ~AsyncFileIO();
+
+    /**
+     * Sets up the queue.
+     *
+     * @param queueDepth Requests that may be in flight at once
+     * @param preferred Backend to use; Auto tries io_uring first
+     * @param poolThreads Worker threads for the ThreadPool backend
+     * @return false if the requested backend is unavailable
+     */
+    bool open(unsigned int queueDepth = 8, AsyncIOBackend preferred = AsyncIOBackend::Auto,
+              unsigned int poolThreads = 2);
+
+    /**
+     * Waits for requests in flight and tears the queue down.
+     */
+    void close();
+
+    //--------------------------------------------------------------------------
+    // Requests
+    //--------------------------------------------------------------------------
+    /**
+     * Starts a read or write. The buffer must stay valid until it completes.
+     * @return false if the queue is full or the request could not be queued
+     */
+    bool submit(const AsyncIORequest& request);
+
+    /**
+     * Collects finished requests.
+     *
+     * @param out Completions are written here
+     * @param maxCompletions Capacity of out
+     * @param wait Block until at least one completes (if any are in flight)
+     * @return Number of completions written
+     */
+    std::size_t reap(AsyncIOCompletion* out, std::size_t maxCompletions, bool wait);
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    bool isOpen() const { return depth > 0; }
+    unsigned int getInFlight() const { return inFlight; }
+    unsigned int getDepth() const { return depth; }
+    AsyncIOBackend getBackend() const { return backend; }
+    const char* getBackendName() const;
+
+    //--------------------------------------------------------------------------
+    // File Helpers
+    //--------------------------------------------------------------------------
+    /**
+     * Opens a file for streaming I/O, trying O_DIRECT first when asked.
+     *
+     * @param path File to open
+     * @param forWrite Create/truncate for writing instead of reading
+     * @param tryDirect Bypass the page cache where the filesystem allows it
+     * @param gotDirect Set to true if O_DIRECT was used
+     * @return File descriptor, or -1 on error
+     */
+    static int openFile(const std::string& path, bool forWrite, bool tryDirect, bool* gotDirect);
+
+    /**
+     * Closes a descriptor from openFile().
+     */
+    static void closeFile(int fd);
+
+    /**
+     * Sets a file's length (to drop O_DIRECT padding after the last write).
+     * @return false on error or where unsupported
+     */
+    static bool truncateFile(int fd, uint64_t length);
+
+    /**
+     * Performs a blocking positioned read or write on the calling thread.
+     * @return Bytes transferred, or -errno
+     */
+    static long transferNow(const AsyncIORequest& request);
+
+    AsyncFileIO(const AsyncFileIO&) = delete;
+    AsyncFileIO& operator=(const AsyncFileIO&) = delete;
+};
+
+/**
+ * Heap buffer aligned for O_DIRECT transfers.
+ */
+class AlignedBuffer
+{
+private:
+    std::vector<char> storage;
+    char* aligned;
+    std::size_t bytes;
+
+public:
+    explicit AlignedBuffer(std::size_t size = 0) : aligned(nullptr), bytes(0) { resize(size); }
+
+    /**
+     * Reallocates to at least size bytes, rounded up to ASYNC_IO_ALIGNMENT.
+     */
+    void resize(std::size_t size)
+    {
+        bytes = (size + ASYNC_IO_ALIGNMENT - 1) / ASYNC_IO_ALIGNMENT * ASYNC_IO_ALIGNMENT;
+        // Over-allocate and align by hand; aligned_alloc is not portable to MinGW
+        storage.assign(bytes + ASYNC_IO_ALIGNMENT, 0);
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(storage.data());
+        std::uintptr_t offset = (ASYNC_IO_ALIGNMENT - base % ASYNC_IO_ALIGNMENT) % ASYNC_IO_ALIGNMENT;
+        aligned = storage.data() + offset;
+    }
+
+    char* data() { return aligned; }
+    const char* data() const { return aligned; }
+    std::size_t size() const { return bytes; }
+
+    // Moving keeps the heap block (and so the alignment); copying would not
+    AlignedBuffer(AlignedBuffer&&) = default;
+    AlignedBuffer& operator=(AlignedBuffer&&) = default;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+};
+
+} // namespace audio
+
+#endif // ASYNC_FILE_IO_H
@@ -0,0 +1,75 @@
+#ifndef BLOCK_HEADER_H
+#define BLOCK_HEADER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace audio {
+
+/**
+ * Points in a block's trip through the RtAudio pipeline, in order.
+ */
+enum class BlockStage : uint8_t
+{
+    Capture,        // input callback received it
+    Dequeue,        // processing thread popped it
+    Processed,      // effect chain finished
+    Enqueue,        // pushed to the output queue
+    Playout,        // output callback popped it
+    Count
+};
+
+constexpr std::size_t BLOCK_STAGE_COUNT = static_cast<std::size_t>(BlockStage::Count);
+
+/**
+ * Block flags carried in BlockHeader::flags.
+ */
+constexpr uint32_t BLOCK_FLAG_SILENT = 1u << 0;    // samples are all exact zeros
+constexpr uint32_t BLOCK_FLAG_SPEECH = 1u << 1;    // voice activity detection classified the block as speech
+
+/**
+ * Reads the monotonic clock used for block timestamps.
+ * @return Nanoseconds since an arbitrary epoch
+ */
+inline uint64_t blockClockNanos()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Identity and timing of one block, carried alongside its samples
+ * through BufferQueue so the output side knows which input it came from.
+ */
+struct BlockHeader
+{
+    uint64_t sequence = 0;                      // assigned at capture, one per callback
+    double streamTime = -1.0;                   // RtAudio streamTime at capture (seconds), -1 if unknown
+    uint64_t stageNanos[BLOCK_STAGE_COUNT] = {}; // blockClockNanos() per stage, 0 if not reached
+    uint32_t flags = 0;                         // BLOCK_FLAG_* bits
+
+    /**
+     * Records the current time for a stage.
+     */
+    void stamp(BlockStage stage) { stageNanos[static_cast<std::size_t>(stage)] = blockClockNanos(); }
+
+    /**
+     * Gets the time a stage was reached (0 if it was not).
+     */
+    uint64_t at(BlockStage stage) const { return stageNanos[static_cast<std::size_t>(stage)]; }
+
+    /**
+     * Checks whether the block is flagged as exact silence.
+     */
+    bool isSilent() const { return (flags & BLOCK_FLAG_SILENT) != 0; }
+
+    /**
+     * Checks whether the block is flagged as speech.
+     */
+    bool isSpeech() const { return (flags & BLOCK_FLAG_SPEECH) != 0; }
+};
+
+} // namespace audio
+
+#endif // BLOCK_HEADER_H
@@ -6,8 +6,8 @@ namespace audio {
 // Lifecycle
 //--------------------------------------------------------------------------
 
-BufferQueue::BufferQueue(size_t capacity)
-    : queueCapacity(capacity), done(false)
+BufferQueue::BufferQueue(size_t capacity, uint32_t queueId)
+    : queueCapacity(capacity), done(false), traceId(queueId), pushCount(0), depth(0)
 {
 }
 
@@ -16,6 +16,17 @@ BufferQueue::BufferQueue(size_t capacity)
 //--------------------------------------------------------------------------
 
 void BufferQueue::push(const std::vector<float>& buffer)
+{
+    // Headerless blocks are numbered in push order
+    BlockHeader header;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        header.sequence = pushCount;
+    }
+    push(buffer, header);
+}
+
+void BufferQueue::push(const std::vector<float>& buffer, const BlockHeader& header)
 {
     std::unique_lock<std::mutex> lock(mtx);
 
@@ -28,12 +39,21 @@ void BufferQueue::push(const std::vector<float>& buffer)
         return;
     }
 
-    bufferQueue.push(buffer);
+    bufferQueue.push(QueuedBlock{ header, buffer });
+    depth.store(bufferQueue.size(), std::memory_order_relaxed);
+    MULTIAUDIO_TRACE4(queue_push, traceId, header.sequence, buffer.size(), bufferQueue.size());
+    ++pushCount;
     lock.unlock();
     queueHasData.notify_one();
 }
 
 bool BufferQueue::pop(std::vector<float>& buffer)
+{
+    BlockHeader header;
+    return pop(buffer, header);
+}
+
+bool BufferQueue::pop(std::vector<float>& buffer, BlockHeader& header)
 {
     std::unique_lock<std::mutex> lock(mtx);
 
@@ -46,8 +66,12 @@ bool BufferQueue::pop(std::vector<float>& buffer)
         return false;
     }
 
-    buffer = bufferQueue.front();
+    // Swap rather than copy; the caller's old storage is released with the node
+    buffer.swap(bufferQueue.front().samples);
+    header = bufferQueue.front().header;
     bufferQueue.pop();
+    depth.store(bufferQueue.size(), std::memory_order_relaxed);
+    MULTIAUDIO_TRACE4(queue_pop, traceId, header.sequence, buffer.size(), bufferQueue.size());
 
     lock.unlock();
     queueHasSpace.notify_one();
@@ -66,4 +90,15 @@ void BufferQueue::setDone()
     queueHasSpace.notify_all();
 }
 
+void BufferQueue::reset()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::queue<QueuedBlock>().swap(bufferQueue);
+        depth.store(0, std::memory_order_relaxed);
+        done.store(false);
+    }
+    queueHasSpace.notify_all();
+}
+
 } // namespace audio
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define BUFFER_QUEUE_H
 
 #include "../common.h"
+#include "Tracepoints.h"
+#include "BlockHeader.h"
 
 #include <queue>
 #include <vector>
@@ -14,6 +16,7 @@ namespace audio {
 /**
  * Thread-safe queue for audio buffer management.
  * Facilitates thread communication through producer-consumer pattern.
+ * Each buffer travels with a BlockHeader identifying and timestamping it.
  */
 class BufferQueue
 {
@@ -21,12 +24,21 @@ private:
     //--------------------------------------------------------------------------
     // Internal State
     //--------------------------------------------------------------------------
-    std::queue<std::vector<float>> bufferQueue;
+    struct QueuedBlock
+    {
+        BlockHeader header;
+        std::vector<float> samples;
+    };
+
+    std::queue<QueuedBlock> bufferQueue;
     size_t queueCapacity;
     std::mutex mtx;
     std::condition_variable queueHasData;
     std::condition_variable queueHasSpace;
     std::atomic<bool> done;
+    uint32_t traceId;           // queue id for tracepoints
+    uint64_t pushCount;         // guarded by mtx
+    std::atomic<size_t> depth;  // mirror of bufferQueue.size() for lock-free readers
 
 public:
     //--------------------------------------------------------------------------
@@ -35,8 +47,9 @@ public:
     /**
      * Creates an empty queue with specified capacity.
      * @param capacity Maximum number of buffers that can be held (default: 10)
+     * @param queueId Id reported by the queue tracepoints (see Tracepoints.h)
      */
-    explicit BufferQueue(size_t capacity = 10);
+    explicit BufferQueue(size_t capacity = 10, uint32_t queueId = TRACE_QUEUE_NONE);
 
     //--------------------------------------------------------------------------
     // Queue Operations
@@ -48,6 +61,14 @@ public:
      */
     void push(const std::vector<float>& buffer);
 
+    /**
+     * Adds a new audio buffer together with its header.
+     * Blocks if queue is full until space becomes available.
+     * @param buffer Audio data to be added
+     * @param header Identity and timestamps of the block
+     */
+    void push(const std::vector<float>& buffer, const BlockHeader& header);
+
     /**
      * Removes the next audio buffer from the queue.
      * Blocks if queue is empty until data becomes available.
@@ -56,11 +77,38 @@ public:
      */
     bool pop(std::vector<float>& buffer);
 
+    /**
+     * Removes the next audio buffer and its header from the queue.
+     * Blocks if queue is empty until data becomes available.
+     * @param buffer Reference to store the retrieved data
+     * @param header Reference to store the block's header
+     * @return true if successful, false if queue is empty and shutdown signaled
+     */
+    bool pop(std::vector<float>& buffer, BlockHeader& header);
+
     /**
      * Signals shutdown to all waiting threads.
      * Wakes all blocked producers and consumers.
      */
     void setDone();
+
+    /**
+     * Discards every queued buffer and clears the shutdown signal so the
+     * queue can be used again (e.g. when a stalled pipeline is restarted).
+     * Call only once no consumer is waiting on the queue.
+     */
+    void reset();
+
+    /**
+     * Gets the number of queued buffers without taking the queue lock.
+     * @return Depth as of the last push or pop
+     */
+    size_t getDepth() const { return depth.load(std::memory_order_relaxed); }
+
+    /**
+     * Gets the maximum number of buffers the queue holds.
+     */
+    size_t getCapacity() const { return queueCapacity; }
 };
 
 } // namespace audio
@@ -0,0 +1,54 @@
+#include "ChainInstance.h"
+
+#include <algorithm>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+ChainInstance::ChainInstance(unsigned int rate, unsigned int frames)
+    : sampleRate(rate),
+      blockFrames(frames),
+      noiseGate(rate),
+      eq(rate, frames),
+      limiter(rate),
+      chain(noiseGate, eq, limiter, deesser, rate, static_cast<std::size_t>(frames) * 2)
+{
+    // The de-esser's FFT size is fixed, so its latency depends on the period
+    chain.prepare(static_cast<std::size_t>(frames) * 2, frames);
+}
+
+//--------------------------------------------------------------------------
+// Settings
+//--------------------------------------------------------------------------
+
+void ChainInstance::copySettings(const NoiseGate& ng, const ThreeBandEQ& threeBandEq, const Limiter& lim,
+                                 const DeEsserSettings& deesserSettings)
+{
+    noiseGate.setThreshold(ng.getThreshold());
+    noiseGate.setAttackTime(ng.getAttackTime());
+    noiseGate.setReleaseTime(ng.getReleaseTime());
+    noiseGate.setEnabled(ng.isEnabled());
+
+    // A cutoff at the old Nyquist frequency (the top band's edge) moves to the new one
+    const float nyquist = sampleRate / 2.0f;
+    const float previousNyquist = threeBandEq.getSampleRate() / 2.0f;
+    for (unsigned int band = 0; band < NUM_EQ_BANDS; ++band)
+    {
+        const float cutoff = threeBandEq.getBandCutoff(band);
+        eq.setBandCutoff(band, cutoff >= previousNyquist ? nyquist : std::min(cutoff, nyquist));
+        eq.setBandGain(band, threeBandEq.getBandGain(band));
+    }
+    eq.setEnabled(threeBandEq.isEnabled());
+
+    limiter.setThreshold(lim.getThreshold());
+    limiter.setAttackTime(lim.getAttackTime());
+    limiter.setReleaseTime(lim.getReleaseTime());
+    limiter.setEnabled(lim.isEnabled());
+
+    deesser = deesserSettings;
+}
+
+} // namespace audio
@@ -0,0 +1,62 @@
+#ifndef CHAIN_INSTANCE_H
+#define CHAIN_INSTANCE_H
+
+#include "EffectChain.h"
+#include "../effects/NoiseGate.h"
+#include "../effects/ThreeBandEQ.h"
+#include "../effects/Limiter.h"
+#include "../effects/DeEsser.h"
+
+namespace audio {
+
+/**
+ * A complete effect chain built for one stream format.
+ *
+ * Owns its effects (with their FFT plans and buffers sized for the given
+ * sample rate and block size) and the EffectChain running them. Building
+ * one allocates and plans FFTs, so it is done off the audio thread and
+ * then handed to a HotSwapChain.
+ */
+class ChainInstance
+{
+private:
+    unsigned int sampleRate;
+    unsigned int blockFrames;
+    NoiseGate noiseGate;
+    ThreeBandEQ eq;
+    Limiter limiter;
+    DeEsserSettings deesser;
+    EffectChain chain;
+
+public:
+    /**
+     * Builds the effects and chain for a stream format.
+     *
+     * @param rate Sample rate in Hz
+     * @param frames Block size the stream delivers
+     */
+    ChainInstance(unsigned int rate, unsigned int frames);
+
+    ChainInstance(const ChainInstance&) = delete;
+    ChainInstance& operator=(const ChainInstance&) = delete;
+
+    /**
+     * Copies every user-facing setting (enable states, thresholds, times,
+     * band gains and cutoffs, de-esser range) from a running chain's effects.
+     * Cutoffs are clamped to the new Nyquist frequency.
+     */
+    void copySettings(const NoiseGate& ng, const ThreeBandEQ& threeBandEq, const Limiter& lim,
+                      const DeEsserSettings& deesserSettings);
+
+    unsigned int getSampleRate() const { return sampleRate; }
+    unsigned int getBlockFrames() const { return blockFrames; }
+    NoiseGate& getNoiseGate() { return noiseGate; }
+    ThreeBandEQ& getEQ() { return eq; }
+    Limiter& getLimiter() { return limiter; }
+    DeEsserSettings& getDeEsser() { return deesser; }
+    EffectChain& getChain() { return chain; }
+};
+
+} // namespace audio
+
+#endif // CHAIN_INSTANCE_H
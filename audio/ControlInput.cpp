@@ -0,0 +1,463 @@
+#include "ControlInput.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// OSC Parsing
+//--------------------------------------------------------------------------
+
+namespace {
+
+uint32_t readBigEndian32(const uint8_t* bytes)
+{
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+void writeBigEndian32(uint8_t* bytes, uint32_t value)
+{
+    bytes[0] = static_cast<uint8_t>(value >> 24);
+    bytes[1] = static_cast<uint8_t>(value >> 16);
+    bytes[2] = static_cast<uint8_t>(value >> 8);
+    bytes[3] = static_cast<uint8_t>(value);
+}
+
+// Length of an OSC string field including its terminator and padding, 0 if it runs past the end
+std::size_t oscStringField(const uint8_t* field, std::size_t available)
+{
+    const void* terminator = std::memchr(field, '\0', available);
+    if (!terminator)
+    {
+        return 0;
+    }
+    const std::size_t length = static_cast<const uint8_t*>(terminator) - field + 1;
+    const std::size_t padded = (length + 3) & ~static_cast<std::size_t>(3);
+    return padded <= available ? padded : 0;
+}
+
+} // namespace
+
+bool parseOscMessage(const uint8_t* packet, std::size_t size, OscMessage& message)
+{
+    if (size < 8 || packet[0] != '/')
+    {
+        return false;
+    }
+    const std::size_t addressField = oscStringField(packet, size);
+    if (addressField == 0 || addressField >= size || packet[addressField] != ',')
+    {
+        return false;
+    }
+    const std::size_t typeField = oscStringField(packet + addressField, size - addressField);
+    if (typeField == 0)
+    {
+        return false;
+    }
+
+    const uint8_t* argument = packet + addressField + typeField;
+    const std::size_t available = size - addressField - typeField;
+    message.address = reinterpret_cast<const char*>(packet);
+    message.type = static_cast<char>(packet[addressField + 1]);
+    switch (message.type)
+    {
+        case 'f':
+        {
+            if (available < 4) return false;
+            const uint32_t bits = readBigEndian32(argument);
+            std::memcpy(&message.value, &bits, sizeof(bits));
+            return std::isfinite(message.value);
+        }
+        case 'i':
+        {
+            if (available < 4) return false;
+            message.value = static_cast<float>(static_cast<int32_t>(readBigEndian32(argument)));
+            return true;
+        }
+        case 'd':
+        {
+            if (available < 8) return false;
+            const uint64_t bits = (static_cast<uint64_t>(readBigEndian32(argument)) << 32) | readBigEndian32(argument + 4);
+            double value;
+            std::memcpy(&value, &bits, sizeof(bits));
+            message.value = static_cast<float>(value);
+            return std::isfinite(message.value);     // also doubles beyond float range
+        }
+        case 'T': message.value = 1.0f; return true;
+        case 'F': message.value = 0.0f; return true;
+        default: return false;
+    }
+}
+
+std::size_t buildOscMessage(uint8_t* packet, std::size_t capacity, const char* address, float value)
+{
+    const std::size_t addressField = (std::strlen(address) + 4) & ~static_cast<std::size_t>(3);
+    const std::size_t size = addressField + 4 + 4;
+    if (size > capacity)
+    {
+        return 0;
+    }
+    std::memset(packet, 0, size);
+    std::memcpy(packet, address, std::strlen(address));
+    packet[addressField] = ',';
+    packet[addressField + 1] = 'f';
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeBigEndian32(packet + addressField + 4, bits);
+    return size;
+}
+
+//--------------------------------------------------------------------------
+// Control Map
+//--------------------------------------------------------------------------
+
+ControlMap::ControlMap()
+{
+    for (std::size_t i = 0; i < PARAMETER_ID_COUNT; ++i)
+    {
+        const ParameterId id = static_cast<ParameterId>(i);
+        OscEntry& entry = oscTable[i];
+        entry.id = id;
+        entry.address[0] = '/';
+        std::strncpy(entry.address + 1, parameterName(id), OSC_MAX_ADDRESS - 2);
+        entry.address[OSC_MAX_ADDRESS - 1] = '\0';
+        std::replace(entry.address, entry.address + OSC_MAX_ADDRESS, '.', '/');
+
+        // Controllers span the GUI control's range
+        const ParameterRange range = parameterRange(id);
+        mapMidiController(static_cast<uint8_t>(MIDI_DEFAULT_FIRST_CC + i), id, range.minimum, range.maximum);
+    }
+    std::sort(oscTable, oscTable + PARAMETER_ID_COUNT, [](const OscEntry& a, const OscEntry& b) {
+        return std::strcmp(a.address, b.address) < 0;
+    });
+}
+
+bool ControlMap::lookupOsc(const char* address, ParameterId& id) const
+{
+    const OscEntry* end = oscTable + PARAMETER_ID_COUNT;
+    const OscEntry* entry = std::lower_bound(oscTable, end, address, [](const OscEntry& a, const char* key) {
+        return std::strcmp(a.address, key) < 0;
+    });
+    if (entry == end || std::strcmp(entry->address, address) != 0)
+    {
+        return false;
+    }
+    id = entry->id;
+    return true;
+}
+
+bool ControlMap::lookupMidi(uint8_t controller, uint8_t value, ParameterId& id, float& parameterValue) const
+{
+    if (controller >= 128 || midiTable[controller].id == ParameterId::Count)
+    {
+        return false;
+    }
+    const MidiEntry& entry = midiTable[controller];
+    id = entry.id;
+    const uint8_t clamped = std::min<uint8_t>(value, 127);
+    if (isRoutingParameter(id))
+    {
+        parameterValue = clamped >= 64 ? 1.0f : 0.0f;
+    }
+    else
+    {
+        parameterValue = entry.minimum + (entry.maximum - entry.minimum) * (clamped / 127.0f);
+    }
+    return true;
+}
+
+void ControlMap::mapMidiController(uint8_t controller, ParameterId id, float minimum, float maximum)
+{
+    if (controller < 128)
+    {
+        midiTable[controller].id = id;
+        midiTable[controller].minimum = minimum;
+        midiTable[controller].maximum = maximum;
+    }
+}
+
+#ifdef __linux__
+
+//--------------------------------------------------------------------------
+// Control Input
+//--------------------------------------------------------------------------
+
+namespace {
+
+const int IDLE_POLL_MS = 50;            // how often the thread observes stop()
+const int RETRY_POLL_MS = 1;            // while values wait for room in the queue
+const std::size_t OSC_BATCH = 256;      // datagrams drained per wake-up before posting
+const int MAX_MIDI_DESCRIPTORS = 4;
+
+} // namespace
+
+ControlInput::ControlInput(ParameterQueue& target)
+    : queue(target),
+      oscSocket(-1),
+      oscPort(0),
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+      sequencer(nullptr),
+      midiPort(-1),
+#endif
+      running(false),
+      oscMessages(0),
+      midiMessages(0),
+      unmappedMessages(0),
+      malformedPackets(0),
+      eventsPosted(0)
+{
+    std::fill_n(pendingValues, PARAMETER_ID_COUNT, 0.0f);
+    std::fill_n(pendingSet, PARAMETER_ID_COUNT, false);
+}
+
+ControlInput::~ControlInput()
+{
+    stop();
+}
+
+bool ControlInput::openOsc(uint16_t port, const std::string& address)
+{
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &local.sin_addr) != 1)
+    {
+        std::cerr << "[Control] ERROR: Invalid OSC bind address " << address << std::endl;
+        return false;
+    }
+
+    oscSocket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (oscSocket < 0)
+    {
+        std::cerr << "[Control] ERROR: Failed to create OSC socket." << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    int receiveBuffer = 1 << 20;        // absorbs bursts while the thread is descheduled
+    setsockopt(oscSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    setsockopt(oscSocket, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    if (::bind(oscSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+    {
+        std::cerr << "[Control] ERROR: Failed to bind OSC port " << address << ":" << port << std::endl;
+        ::close(oscSocket);
+        oscSocket = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(local);
+    ::getsockname(oscSocket, reinterpret_cast<sockaddr*>(&local), &length);
+    oscPort.store(ntohs(local.sin_port));
+    return true;
+}
+
+bool ControlInput::openMidi(const std::string& clientName)
+{
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    if (snd_seq_open(&sequencer, "default", SND_SEQ_OPEN_INPUT, SND_SEQ_NONBLOCK) < 0)
+    {
+        std::cerr << "[Control] ERROR: Failed to open the ALSA sequencer." << std::endl;
+        sequencer = nullptr;
+        return false;
+    }
+    snd_seq_set_client_name(sequencer, clientName.c_str());
+    midiPort = snd_seq_create_simple_port(sequencer, "control",
+                                          SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE,
+                                          SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION);
+    if (midiPort < 0)
+    {
+        std::cerr << "[Control] ERROR: Failed to create the MIDI input port." << std::endl;
+        snd_seq_close(sequencer);
+        sequencer = nullptr;
+        return false;
+    }
+    return true;
+#else
+    (void)clientName;
+    std::cerr << "[Control] ERROR: MIDI input needs a build with -DMULTIAUDIO_WITH_ALSA_MIDI." << std::endl;
+    return false;
+#endif
+}
+
+bool ControlInput::start()
+{
+    if (running.load())
+    {
+        return true;
+    }
+    bool open = oscSocket >= 0;
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    open = open || sequencer != nullptr;
+#endif
+    if (!open)
+    {
+        return false;
+    }
+    running.store(true);
+    controlThread = std::thread(&ControlInput::controlLoop, this);
+    return true;
+}
+
+void ControlInput::stop()
+{
+    running.store(false);
+    if (controlThread.joinable())
+    {
+        controlThread.join();
+    }
+    if (oscSocket >= 0)
+    {
+        ::close(oscSocket);
+        oscSocket = -1;
+    }
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    if (sequencer)
+    {
+        snd_seq_close(sequencer);
+        sequencer = nullptr;
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------
+// Control Thread
+//--------------------------------------------------------------------------
+
+void ControlInput::controlLoop()
+{
+    pollfd descriptors[1 + MAX_MIDI_DESCRIPTORS];
+    int count = 0;
+    if (oscSocket >= 0)
+    {
+        descriptors[count++] = { oscSocket, POLLIN, 0 };
+    }
+    const int midiFirst = count;
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    if (sequencer)
+    {
+        const int midiCount = std::min(snd_seq_poll_descriptors_count(sequencer, POLLIN), MAX_MIDI_DESCRIPTORS);
+        count += snd_seq_poll_descriptors(sequencer, descriptors + count, static_cast<unsigned int>(midiCount), POLLIN);
+    }
+#endif
+
+    bool waiting = false;
+    while (running.load())
+    {
+        const int ready = ::poll(descriptors, static_cast<nfds_t>(count), waiting ? RETRY_POLL_MS : IDLE_POLL_MS);
+        if (ready > 0)
+        {
+            if (oscSocket >= 0 && (descriptors[0].revents & POLLIN))
+            {
+                readOsc();
+            }
+            for (int i = midiFirst; i < count; ++i)
+            {
+                if (descriptors[i].revents & POLLIN)
+                {
+                    readMidi();
+                    break;
+                }
+            }
+        }
+        postPending();
+        waiting = std::find(pendingSet, pendingSet + PARAMETER_ID_COUNT, true) != pendingSet + PARAMETER_ID_COUNT;
+    }
+}
+
+void ControlInput::readOsc()
+{
+    for (std::size_t i = 0; i < OSC_BATCH; ++i)
+    {
+        const ssize_t received = ::recv(oscSocket, packet, sizeof(packet), MSG_DONTWAIT);
+        if (received <= 0)
+        {
+            return;
+        }
+        const std::size_t malformed = forEachOscMessage(packet, static_cast<std::size_t>(received),
+                                                        [this](const OscMessage& message)
+        {
+            oscMessages.store(oscMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            ParameterId id;
+            if (map.lookupOsc(message.address, id))
+            {
+                // Any sender can reach the port: keep values inside the controls' ranges
+                float value = message.value;
+                clampParameter(id, value);
+                setPending(id, value);
+            }
+            else
+            {
+                unmappedMessages.store(unmappedMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        });
+        if (malformed > 0)
+        {
+            malformedPackets.store(malformedPackets.load(std::memory_order_relaxed) + malformed, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ControlInput::readMidi()
+{
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    snd_seq_event_t* event = nullptr;
+    while (snd_seq_event_input(sequencer, &event) >= 0 && event)
+    {
+        if (event->type != SND_SEQ_EVENT_CONTROLLER)
+        {
+            continue;
+        }
+        midiMessages.store(midiMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        const int value = std::max(0, std::min(127, static_cast<int>(event->data.control.value)));
+        ParameterId id;
+        float parameterValue;
+        if (event->data.control.param < 128 &&
+            map.lookupMidi(static_cast<uint8_t>(event->data.control.param), static_cast<uint8_t>(value), id, parameterValue))
+        {
+            setPending(id, parameterValue);
+        }
+        else
+        {
+            unmappedMessages.store(unmappedMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+#endif
+}
+
+void ControlInput::setPending(ParameterId id, float value)
+{
+    const std::size_t index = static_cast<std::size_t>(id);
+    pendingValues[index] = value;
+    pendingSet[index] = true;
+}
+
+void ControlInput::postPending()
+{
+    for (std::size_t i = 0; i < PARAMETER_ID_COUNT; ++i)
+    {
+        // Only this thread fills the queue: a full queue keeps the value for the next wake-up
+        if (!pendingSet[i] || queue.pending() >= queue.capacity())
+        {
+            continue;
+        }
+        queue.post(static_cast<ParameterId>(i), pendingValues[i]);
+        pendingSet[i] = false;
+        eventsPosted.store(eventsPosted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+#endif // __linux__
+
+} // namespace audio
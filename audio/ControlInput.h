@@ -0,0 +1,274 @@
+#ifndef CONTROL_INPUT_H
+#define CONTROL_INPUT_H
+
+#include "ParameterQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+#include <alsa/asoundlib.h>
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// OSC Parsing
+//--------------------------------------------------------------------------
+
+constexpr std::size_t OSC_MAX_PACKET_SIZE = 1536;
+constexpr int OSC_MAX_BUNDLE_DEPTH = 4;
+
+/**
+ * One OSC message reduced to its address and first argument.
+ * Points into the packet it was parsed from; nothing is copied.
+ */
+struct OscMessage
+{
+    const char* address = nullptr;
+    char type = 0;          // type tag of the argument: 'f', 'i', 'd', 'T' or 'F'
+    float value = 0.0f;     // the argument as a float ('T' = 1, 'F' = 0)
+};
+
+/**
+ * Parses a single OSC message (not a bundle).
+ *
+ * @param packet Message bytes, 4-byte aligned fields as sent on the wire
+ * @param size Message size in bytes
+ * @param message Address and first numeric argument
+ * @return false if the message is malformed or has no finite numeric first argument
+ */
+bool parseOscMessage(const uint8_t* packet, std::size_t size, OscMessage& message);
+
+/**
+ * Walks a packet, which is either a message or a (nested) bundle, and
+ * hands every message in it to a handler. Bundle time tags are ignored:
+ * controls apply as they arrive.
+ *
+ * @param handler Called as handler(const OscMessage&) for each valid message
+ * @return Number of malformed elements skipped
+ */
+template <typename Handler>
+std::size_t forEachOscMessage(const uint8_t* packet, std::size_t size, Handler&& handler, int depth = 0)
+{
+    static const char BUNDLE[8] = { '#', 'b', 'u', 'n', 'd', 'l', 'e', '\0' };
+    if (size >= 16 && std::equal(BUNDLE, BUNDLE + 8, reinterpret_cast<const char*>(packet)))
+    {
+        if (depth >= OSC_MAX_BUNDLE_DEPTH)
+        {
+            return 1;
+        }
+        // "#bundle", 8-byte time tag, then (size, element) pairs
+        std::size_t malformed = 0;
+        std::size_t position = 16;
+        while (position + 4 <= size)
+        {
+            const std::size_t length = (static_cast<std::size_t>(packet[position]) << 24) |
+                                       (static_cast<std::size_t>(packet[position + 1]) << 16) |
+                                       (static_cast<std::size_t>(packet[position + 2]) << 8) | packet[position + 3];
+            position += 4;
+            if (length == 0 || length % 4 != 0 || length > size - position)
+            {
+                return malformed + 1;
+            }
+            malformed += forEachOscMessage(packet + position, length, handler, depth + 1);
+            position += length;
+        }
+        return malformed;
+    }
+
+    OscMessage message;
+    if (!parseOscMessage(packet, size, message))
+    {
+        return 1;
+    }
+    handler(message);
+    return 0;
+}
+
+/**
+ * Builds an OSC message with one float argument (for senders and tests).
+ *
+ * @param packet Destination
+ * @param capacity Room in packet
+ * @return Message size in bytes, 0 if it does not fit
+ */
+std::size_t buildOscMessage(uint8_t* packet, std::size_t capacity, const char* address, float value);
+
+//--------------------------------------------------------------------------
+// Control Map
+//--------------------------------------------------------------------------
+
+// First controller of the default MIDI map (CC 20-35 are undefined in General MIDI)
+constexpr uint8_t MIDI_DEFAULT_FIRST_CC = 20;
+constexpr std::size_t OSC_MAX_ADDRESS = 48;
+
+/**
+ * Lookup from OSC addresses and MIDI controllers to parameters, built
+ * once so the control thread maps each message without allocating.
+ *
+ * Every parameter answers at "/<effect>/<name>" (its saved name with
+ * '/' for '.', e.g. /eq/low_gain), with the value in parameter units.
+ * MIDI controllers scale 0-127 onto a range; by default CC 20 onwards
+ * follow ParameterId order over the ranges of the GUI controls, and
+ * enable toggles switch at 64.
+ */
+class ControlMap
+{
+private:
+    struct OscEntry
+    {
+        char address[OSC_MAX_ADDRESS];
+        ParameterId id;
+    };
+
+    struct MidiEntry
+    {
+        ParameterId id = ParameterId::Count;    // Count: unmapped
+        float minimum = 0.0f;
+        float maximum = 1.0f;
+    };
+
+    OscEntry oscTable[PARAMETER_ID_COUNT];      // sorted by address
+    MidiEntry midiTable[128];
+
+public:
+    ControlMap();
+
+    /**
+     * Finds the parameter an OSC address controls (binary search, no allocation).
+     * @return false if the address is not mapped
+     */
+    bool lookupOsc(const char* address, ParameterId& id) const;
+
+    /**
+     * Maps a MIDI control change onto a parameter value.
+     * @param controller Controller number (0-127)
+     * @param value Controller value (0-127)
+     * @param id Parameter the controller is mapped to
+     * @param parameterValue Value in parameter units
+     * @return false if the controller is not mapped
+     */
+    bool lookupMidi(uint8_t controller, uint8_t value, ParameterId& id, float& parameterValue) const;
+
+    /**
+     * Maps a MIDI controller onto a parameter range (replacing its mapping).
+     * Call before the control thread starts.
+     * @param id Parameter to control, or ParameterId::Count to unmap
+     */
+    void mapMidiController(uint8_t controller, ParameterId id, float minimum, float maximum);
+};
+
+#ifdef __linux__
+
+//--------------------------------------------------------------------------
+// Control Input
+//--------------------------------------------------------------------------
+
+/**
+ * Background thread taking control surface input: OSC over UDP and,
+ * when built with MULTIAUDIO_WITH_ALSA_MIDI, MIDI control changes from
+ * an ALSA sequencer port.
+ *
+ * Messages are parsed in place from a preallocated receive buffer and
+ * mapped through a ControlMap. Each wake-up drains everything pending
+ * and posts only the latest value per parameter, so a fader sending
+ * thousands of messages a second costs the audio thread a handful of
+ * events per block. The thread is the queue's only producer: give it
+ * its own queue (see EffectChain::setParameterQueue()).
+ */
+class ControlInput
+{
+private:
+    ParameterQueue& queue;
+    ControlMap map;
+
+    int oscSocket;
+    std::atomic<uint16_t> oscPort;
+    uint8_t packet[OSC_MAX_PACKET_SIZE];        // control thread only
+
+#ifdef MULTIAUDIO_WITH_ALSA_MIDI
+    snd_seq_t* sequencer;
+    int midiPort;
+#endif
+
+    std::thread controlThread;
+    std::atomic<bool> running;
+
+    // Latest value per parameter since the last post (control thread only)
+    float pendingValues[PARAMETER_ID_COUNT];
+    bool pendingSet[PARAMETER_ID_COUNT];
+
+    std::atomic<uint64_t> oscMessages;
+    std::atomic<uint64_t> midiMessages;
+    std::atomic<uint64_t> unmappedMessages;
+    std::atomic<uint64_t> malformedPackets;
+    std::atomic<uint64_t> eventsPosted;
+
+    void controlLoop();
+    void readOsc();
+    void readMidi();
+    void setPending(ParameterId id, float value);
+    void postPending();
+
+public:
+    /**
+     * @param target Queue the controls post to (this thread must be its only producer)
+     */
+    explicit ControlInput(ParameterQueue& target);
+
+    ~ControlInput();
+
+    /**
+     * Binds the OSC socket. Call before start().
+     * @param port UDP port, 0 for any free port (see getOscPort())
+     * @param address Interface to bind (default: loopback only)
+     * @return false if the socket cannot be bound
+     */
+    bool openOsc(uint16_t port, const std::string& address = "127.0.0.1");
+
+    /**
+     * Opens an ALSA sequencer port others can connect MIDI controllers to.
+     * Call before start().
+     * @param clientName Name shown to aconnect and patchbays
+     * @return false if the sequencer is unavailable or MIDI was not built in
+     */
+    bool openMidi(const std::string& clientName = "multiaudio");
+
+    /**
+     * Starts the control thread.
+     * @return false if neither OSC nor MIDI is open
+     */
+    bool start();
+
+    /**
+     * Stops the thread and closes the socket and sequencer.
+     */
+    void stop();
+
+    /**
+     * Gets the map, to change MIDI assignments before start().
+     */
+    ControlMap& getMap() { return map; }
+
+    bool isRunning() const { return running.load(); }
+    uint16_t getOscPort() const { return oscPort.load(); }
+    uint64_t getOscMessages() const { return oscMessages.load(std::memory_order_relaxed); }
+    uint64_t getMidiMessages() const { return midiMessages.load(std::memory_order_relaxed); }
+    uint64_t getUnmappedMessages() const { return unmappedMessages.load(std::memory_order_relaxed); }
+    uint64_t getMalformedPackets() const { return malformedPackets.load(std::memory_order_relaxed); }
+    uint64_t getEventsPosted() const { return eventsPosted.load(std::memory_order_relaxed); }
+
+    ControlInput(const ControlInput&) = delete;
+    ControlInput& operator=(const ControlInput&) = delete;
+};
+
+#endif // __linux__
+
+} // namespace audio
+
+#endif // CONTROL_INPUT_H
@@ -0,0 +1,115 @@
+#include "DriftCompensator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+DriftCompensator::DriftCompensator(unsigned int channels, std::size_t maxFrames, double maxPpm)
+    : numChannels(std::max(1u, channels)),
+      proportionalGain(1e-6),
+      integralGain(1e-8),
+      maxDeviation(std::max(0.0, maxPpm) * 1e-6),
+      depthSmoothing(0.9)
+{
+    // Worst case input need: ratio bound plus the carried frame and rounding
+    std::size_t maxInput = static_cast<std::size_t>(std::ceil(maxFrames * (1.0 + maxDeviation))) + 2;
+    inputFrames.resize(maxInput * numChannels);
+    reset();
+}
+
+//--------------------------------------------------------------------------
+// Processing
+//--------------------------------------------------------------------------
+
+void DriftCompensator::update(double depthFrames, double targetFrames)
+{
+    if (smoothedDepth < 0.0)
+    {
+        smoothedDepth = depthFrames;
+    }
+    smoothedDepth = depthSmoothing * smoothedDepth + (1.0 - depthSmoothing) * depthFrames;
+
+    // Positive error: buffer is filling, remote clock is faster than ours
+    double error = smoothedDepth - targetFrames;
+    integral += error;
+
+    // Anti-windup: keep the integral term inside the correction range
+    double integralLimit = (integralGain > 0.0) ? maxDeviation / integralGain : 0.0;
+    integral = std::max(-integralLimit, std::min(integralLimit, integral));
+
+    double deviation = proportionalGain * error + integralGain * integral;
+    deviation = std::max(-maxDeviation, std::min(maxDeviation, deviation));
+    ratio = 1.0 + deviation;
+}
+
+void DriftCompensator::process(JitterBuffer& source, float* interleaved, std::size_t numFrames)
+{
+    if (numFrames == 0)
+    {
+        return;
+    }
+
+    // inputFrames[0] holds the last frame of the previous call
+    double endPosition = phase + static_cast<double>(numFrames) * ratio;
+    std::size_t consumed = static_cast<std::size_t>(endPosition);
+    std::size_t capacity = inputFrames.size() / numChannels;
+    if (consumed + 1 > capacity)
+    {
+        consumed = capacity - 1;
+    }
+
+    source.read(inputFrames.data() + numChannels, consumed);
+
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        double position = phase + static_cast<double>(i) * ratio;
+        std::size_t index = std::min(static_cast<std::size_t>(position), consumed - (consumed > 0 ? 1 : 0));
+        float t = static_cast<float>(position - static_cast<double>(index));
+        std::size_t next = std::min(index + 1, consumed);
+
+        const float* a = inputFrames.data() + index * numChannels;
+        const float* b = inputFrames.data() + next * numChannels;
+        float* out = interleaved + i * numChannels;
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            out[ch] = a[ch] + (b[ch] - a[ch]) * t;
+        }
+    }
+
+    // Carry the last consumed frame and the fractional phase forward
+    std::copy(inputFrames.data() + consumed * numChannels,
+              inputFrames.data() + (consumed + 1) * numChannels,
+              inputFrames.data());
+    phase = std::max(0.0, endPosition - static_cast<double>(consumed));
+    phase = std::min(phase, 1.0);
+}
+
+void DriftCompensator::reset()
+{
+    ratio = 1.0;
+    integral = 0.0;
+    smoothedDepth = -1.0;
+    phase = 0.0;
+    std::fill(inputFrames.begin(), inputFrames.end(), 0.0f);
+}
+
+//--------------------------------------------------------------------------
+// Status
+//--------------------------------------------------------------------------
+
+double DriftCompensator::getPpm() const
+{
+    return (ratio - 1.0) * 1e6;
+}
+
+double DriftCompensator::getRatio() const
+{
+    return ratio;
+}
+
+} // namespace audio
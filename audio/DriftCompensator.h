@@ -0,0 +1,100 @@
+#ifndef DRIFT_COMPENSATOR_H
+#define DRIFT_COMPENSATOR_H
+
+#include "../common.h"
+#include "JitterBuffer.h"
+
+#include <vector>
+
+namespace audio {
+
+/**
+ * Adaptive resampler that locks the local processing clock to a remote
+ * sender's media clock.
+ *
+ * Clock recovery is PTP-agnostic: the only input is the jitter buffer's
+ * fill level. A PI controller turns the deviation from the target depth
+ * into a small resampling ratio (bounded to +-maxPpm), and a linear
+ * interpolator consumes input at that ratio. A sender running fast fills
+ * the buffer, so the ratio rises above 1.0 and input is consumed faster.
+ */
+class DriftCompensator
+{
+private:
+    //--------------------------------------------------------------------------
+    // Configuration
+    //--------------------------------------------------------------------------
+    unsigned int numChannels;
+    double proportionalGain;
+    double integralGain;
+    double maxDeviation;     // Ratio bound (maxPpm * 1e-6)
+    double depthSmoothing;   // One-pole coefficient for the depth estimate
+
+    //--------------------------------------------------------------------------
+    // Internal State
+    //--------------------------------------------------------------------------
+    double ratio;            // Input frames consumed per output frame
+    double integral;
+    double smoothedDepth;
+    double phase;            // Fractional read position within inputFrames
+    std::vector<float> inputFrames; // [previous frame, new frames...] interleaved
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a drift compensator.
+     *
+     * @param channels Interleaved channel count
+     * @param maxFrames Largest output block requested per call
+     * @param maxPpm Largest correction applied, in parts per million (default: 1000)
+     */
+    DriftCompensator(unsigned int channels, std::size_t maxFrames, double maxPpm = 1000.0);
+
+    //--------------------------------------------------------------------------
+    // Processing
+    //--------------------------------------------------------------------------
+    /**
+     * Updates the resampling ratio from the jitter buffer's fill level.
+     * Call once per block before process().
+     *
+     * @param depthFrames Current buffered frames
+     * @param targetFrames Desired buffered frames
+     */
+    void update(double depthFrames, double targetFrames);
+
+    /**
+     * Produces numFrames output frames, pulling input from the jitter buffer
+     * at the current ratio.
+     *
+     * @param source Jitter buffer to read from
+     * @param interleaved Destination (numFrames * channels)
+     * @param numFrames Frames to produce (at most maxFrames)
+     */
+    void process(JitterBuffer& source, float* interleaved, std::size_t numFrames);
+
+    /**
+     * Returns to unity ratio and clears interpolation history.
+     */
+    void reset();
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the current correction.
+     * @return Estimated remote/local clock offset in parts per million
+     */
+    double getPpm() const;
+
+    /**
+     * Gets the current resampling ratio.
+     * @return Input frames consumed per output frame
+     */
+    double getRatio() const;
+};
+
+} // namespace audio
+
+#endif // DRIFT_COMPENSATOR_H
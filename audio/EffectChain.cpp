@@ -0,0 +1,540 @@
+#include "EffectChain.h"
+#include "../effects/FusedChain.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+EffectChain::EffectChain(NoiseGate& ng, ThreeBandEQ& threeBandEq, Limiter& lim,
+                         DeEsserSettings& deesser, unsigned int rate, std::size_t maxFrames)
+    : noiseGate(ng),
+      eq(threeBandEq),
+      limiter(lim),
+      deesserConfig(deesser),
+      sampleRate(rate),
+      deesserEffect(rate),
+      sideChain(rate, maxFrames),
+      sideChainDetection(false),
+      voiceActivity(rate),
+      voiceActivityDetection(false),
+      skipNonSpeech(false),
+      echoCanceller(rate),
+      echoCancellation(false),
+      preTap(nullptr),
+      postTap(nullptr),
+      parameterRecorder(nullptr),
+      blockEvents(MAX_BLOCK_EVENTS),
+      profile(nullptr),
+      streamId(TRACE_STREAM_NONE),
+      blockSequence(0),
+      framesProcessed(0),
+      processingNanos(0),
+      gateOpenBlocks(0),
+      limiterGain(1.0f),
+      speechBlocks(0),
+      speechActive(false),
+      echoERLE(0.0f),
+      doubleTalkBlocks(0),
+      outputSilent(false),
+      timeDomainPath(false),
+      speech(false)
+{
+    std::fill_n(parameterQueues, MAX_PARAMETER_QUEUES, nullptr);
+    for (std::atomic<float>& level : bandLevels)
+    {
+        level.store(0.0f, std::memory_order_relaxed);
+    }
+    prepare(maxFrames);
+}
+
+//--------------------------------------------------------------------------
+// Processing
+//--------------------------------------------------------------------------
+
+void EffectChain::prepare(std::size_t maxFrames)
+{
+    gateOutput.resize(maxFrames);
+    eqOutput.resize(maxFrames);
+    deessedData.resize(maxFrames);
+    echoOutput.resize(maxFrames);
+    sideChain.prepare(maxFrames);
+
+    // Each block's output must be pushed before the canceller needs it; growing keeps the learnt echo path
+    echoCanceller.growReferenceDelay(maxFrames);
+}
+
+void EffectChain::prepare(std::size_t maxFrames, std::size_t periodFrames)
+{
+    prepare(maxFrames);
+    eq.prepare(periodFrames);
+    deesserEffect.prepare(periodFrames);
+}
+
+void EffectChain::process(const float* input, float* output, std::size_t numFrames)
+{
+    const std::size_t maxFrames = gateOutput.size();
+    if (numFrames > maxFrames && maxFrames == 0)
+    {
+        // Never prepared: nothing to split into
+        prepare(numFrames);
+    }
+    else if (numFrames > maxFrames)
+    {
+        // Oversized block: run it in prepared-size pieces rather than allocate here (backends should prepare())
+        for (std::size_t offset = 0; offset < numFrames; offset += maxFrames)
+        {
+            process(input + offset, output + offset, std::min(maxFrames, numFrames - offset));
+        }
+        return;
+    }
+
+    const uint64_t startNanos = blockClockNanos();
+
+    // Attaching is a thread-local store, so whichever thread the backend runs us on is timed
+    if (profile)
+    {
+        Profiler::attach(profile);
+    }
+    MULTIAUDIO_PROFILE_SCOPE(ProfileStage::Chain);
+    const uint64_t sequence = blockSequence.load(std::memory_order_relaxed);
+    MULTIAUDIO_TRACE3(process_start, streamId, sequence, numFrames);
+
+    // Taps only copy into their rings; input may alias output, so tap first
+    if (preTap)
+    {
+        preTap->write(input, numFrames);
+    }
+
+    // Enable toggles first: they decide which path the block takes
+    const BlockEvents events = takeEvents(numFrames);
+
+    // Echo first: every detector and stage works on the cancelled input
+    const float* source = input;
+    if (echoCancellation)
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EchoCanceller);
+        echoCanceller.process(input, echoOutput.data(), numFrames);
+        source = echoOutput.data();
+        echoERLE.store(echoCanceller.getERLEDB(), std::memory_order_relaxed);
+        if (echoCanceller.isDoubleTalk())
+        {
+            doubleTalkBlocks.store(doubleTalkBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // The detectors' input, analysed once before the gate reads it
+    if (sideChainDetection)
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::SideChain);
+        sideChain.analyze(source, numFrames);
+        for (unsigned int band = 0; band < SIDECHAIN_BANDS; ++band)
+        {
+            bandLevels[band].store(static_cast<float>(sideChain.getBandPower(band)), std::memory_order_relaxed);
+        }
+    }
+
+    // Voice features before any stage overwrites the input; the gate hands over its frames
+    if (voiceActivityDetection)
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::VoiceActivity);
+        voiceActivity.measure(source, numFrames, noiseGate.isEnabled() && !sideChainDetection);
+    }
+
+    if (timeDomainPath)
+    {
+        // Per-sample stages only: split the fused pass at each event
+        bool silent = numFrames > 0;
+        events.split(numFrames, [this](const ParameterEvent& event) { applyParameter(event); },
+                     [&](std::size_t from, std::size_t to)
+        {
+            processTimeDomain(source + from, output + from, to - from, sequence);
+            silent = silent && outputSilent;
+        });
+        outputSilent = silent;
+        if (noiseGate.isOpen())
+        {
+            gateOpenBlocks.store(gateOpenBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        decideVoiceActivity();
+    }
+    else
+    {
+        processStages(source, output, numFrames, sequence, events);
+    }
+
+    // What plays is the reference for the echo in later blocks
+    if (echoCancellation)
+    {
+        echoCanceller.pushReference(output, numFrames);
+    }
+
+    if (postTap && (!voiceActivityDetection || !skipNonSpeech || speech))
+    {
+        postTap->write(output, numFrames);
+    }
+
+    MULTIAUDIO_TRACE3(process_end, streamId, sequence, numFrames);
+    blockSequence.store(sequence + 1, std::memory_order_relaxed);
+
+    // Single writer: plain load/store pairs instead of read-modify-write
+    framesProcessed.store(framesProcessed.load(std::memory_order_relaxed) + numFrames, std::memory_order_relaxed);
+    processingNanos.store(processingNanos.load(std::memory_order_relaxed) + (blockClockNanos() - startNanos),
+                          std::memory_order_relaxed);
+}
+
+BlockEvents EffectChain::takeEvents(std::size_t numFrames)
+{
+    BlockEvents events;
+    events.blockStart = framesProcessed.load(std::memory_order_relaxed);
+
+    std::size_t taken = 0;
+    for (ParameterQueue* queue : parameterQueues)
+    {
+        if (!queue)
+        {
+            continue;
+        }
+        const std::size_t first = taken;
+        taken += queue->take(events.blockStart + numFrames, blockEvents.data() + taken, blockEvents.size() - taken);
+
+        // Each queue is in stream order: insert its run into the events so far, keeping ties in queue order
+        for (std::size_t i = first; i < taken; ++i)
+        {
+            const ParameterEvent event = blockEvents[i];
+            std::size_t j = i;
+            for (; j > 0 && blockEvents[j - 1].frame > event.frame; --j)
+            {
+                blockEvents[j] = blockEvents[j - 1];
+            }
+            blockEvents[j] = event;
+        }
+    }
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < taken; ++i)
+    {
+        ParameterEvent event = blockEvents[i];
+        const bool routing = isRoutingParameter(event.id);
+        if (routing)
+        {
+            applyParameter(event);
+        }
+        else
+        {
+            blockEvents[kept++] = event;
+        }
+        if (parameterRecorder)
+        {
+            // Late events (and every toggle) take effect at the block start
+            event.frame = routing ? events.blockStart : std::max(event.frame, events.blockStart);
+            parameterRecorder->capture(event);
+        }
+    }
+    events.events = blockEvents.data();
+    events.count = kept;
+
+    // Bypassed stages start clean when re-enabled: reset them once, as the path switches
+    const bool timeDomain = noiseGate.isEnabled() && !eq.isEnabled() && !deesserConfig.enabled;
+    if (timeDomain && !timeDomainPath)
+    {
+        eq.reset();
+        deesserEffect.reset();
+    }
+    timeDomainPath = timeDomain;
+    return events;
+}
+
+void EffectChain::applyParameter(const ParameterEvent& event)
+{
+    if (!noiseGate.applyParameter(event) && !eq.applyParameter(event) && !limiter.applyParameter(event))
+    {
+        audio::applyParameter(deesserConfig, event);
+    }
+}
+
+void EffectChain::processStages(const float* input, float* output, std::size_t numFrames, uint64_t sequence,
+                                const BlockEvents& events)
+{
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::NoiseGate);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::NoiseGate), numFrames);
+        noiseGate.process(input, gateOutput.data(), numFrames, events);
+        outputSilent = noiseGate.isEnabled() && noiseGate.isOutputSilent();
+        if (!noiseGate.isEnabled() || noiseGate.isOpen())
+        {
+            gateOpenBlocks.store(gateOpenBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::NoiseGate), numFrames);
+    }
+    decideVoiceActivity();
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQ);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::EQ), numFrames);
+        if (outputSilent)
+        {
+            outputSilent = eq.processSilence(eqOutput.data(), numFrames, events);
+        }
+        else
+        {
+            eq.process(gateOutput.data(), eqOutput.data(), numFrames, events);
+        }
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::EQ), numFrames);
+    }
+
+    const float* deesserOutput = eqOutput.data();
+    if (deesserConfig.enabled)
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::DeEsser);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::DeEsser), numFrames);
+        if (outputSilent)
+        {
+            outputSilent = deesserEffect.processSilence(deessedData.data(), numFrames, deesserConfig, events);
+        }
+        else
+        {
+            deesserEffect.process(eqOutput.data(), deessedData.data(), numFrames, deesserConfig, events);
+        }
+        deesserOutput = deessedData.data();
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::DeEsser), numFrames);
+    }
+    else
+    {
+        deesserEffect.reset(); // Start clean when re-enabled, like the effects' own bypass
+        events.applyBefore(0, static_cast<std::size_t>(-1),
+                           [this](const ParameterEvent& event) { audio::applyParameter(deesserConfig, event); });
+    }
+
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::Limiter);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::Limiter), numFrames);
+        if (outputSilent)
+        {
+            limiter.processSilence(output, numFrames, events);
+        }
+        else
+        {
+            limiter.process(deesserOutput, output, numFrames, events);
+        }
+        limiterGain.store(limiter.isEnabled() ? limiter.getCurrentGain() : 1.0f, std::memory_order_relaxed);
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::Limiter), numFrames);
+    }
+}
+
+void EffectChain::processTimeDomain(const float* input, float* output, std::size_t numFrames, uint64_t sequence)
+{
+    GateRamp gateRamp;
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::NoiseGate);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::NoiseGate), numFrames);
+        gateRamp = noiseGate.beginRamp(input, numFrames);
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::NoiseGate), numFrames);
+    }
+
+    // One pass from input to output: the gate's ramp and the limiter per sample
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::Limiter);
+        MULTIAUDIO_TRACE4(effect_enter, streamId, sequence, static_cast<uint32_t>(ProfileStage::Limiter), numFrames);
+        if (noiseGate.isOutputSilent())
+        {
+            limiter.processSilence(output, numFrames);
+        }
+        else if (limiter.isEnabled())
+        {
+            LimiterRamp limiterRamp = limiter.beginRamp();
+            FusedChain<GateRamp, LimiterRamp>::run(input, output, numFrames, gateRamp, limiterRamp);
+            limiter.endRamp(limiterRamp);
+        }
+        else
+        {
+            FusedChain<GateRamp>::run(input, output, numFrames, gateRamp);
+        }
+        noiseGate.endRamp(gateRamp);
+        outputSilent = noiseGate.isOutputSilent();
+        limiterGain.store(limiter.isEnabled() ? limiter.getCurrentGain() : 1.0f, std::memory_order_relaxed);
+        MULTIAUDIO_TRACE4(effect_exit, streamId, sequence, static_cast<uint32_t>(ProfileStage::Limiter), numFrames);
+    }
+}
+
+void EffectChain::decideVoiceActivity()
+{
+    if (!voiceActivityDetection)
+    {
+        return;
+    }
+    speech = voiceActivity.decide();
+    if (speech)
+    {
+        speechBlocks.store(speechBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    speechActive.store(speech, std::memory_order_relaxed);
+
+    const bool skip = skipNonSpeech && !speech;
+    eq.setPassThrough(skip);
+    deesserEffect.setPassThrough(skip);
+}
+
+std::size_t EffectChain::getMaxFrames() const
+{
+    return gateOutput.size();
+}
+
+void EffectChain::setTaps(RecordingTap* pre, RecordingTap* post)
+{
+    preTap = pre;
+    postTap = post;
+}
+
+void EffectChain::setProfile(ThreadProfile* threadProfile)
+{
+    profile = threadProfile;
+}
+
+void EffectChain::setParameterQueue(ParameterQueue* queue, std::size_t slot)
+{
+    if (slot < MAX_PARAMETER_QUEUES)
+    {
+        parameterQueues[slot] = queue;
+    }
+}
+
+void EffectChain::setParameterRecorder(ParameterRecorder* recorder)
+{
+    parameterRecorder = recorder;
+}
+
+void EffectChain::setSideChainDetection(bool enabled)
+{
+    if (enabled && !sideChainDetection)
+    {
+        sideChain.reset();
+    }
+    sideChainDetection = enabled;
+    noiseGate.setSideChain(enabled ? &sideChain : nullptr);
+}
+
+void EffectChain::setVoiceActivityDetection(bool enabled)
+{
+    if (enabled && !voiceActivityDetection)
+    {
+        voiceActivity.reset();
+    }
+    voiceActivityDetection = enabled;
+    noiseGate.setVoiceActivity(enabled ? &voiceActivity : nullptr);
+    if (!enabled)
+    {
+        speech = false;
+        speechActive.store(false, std::memory_order_relaxed);
+        eq.setPassThrough(false);
+        deesserEffect.setPassThrough(false);
+    }
+}
+
+void EffectChain::setSkipNonSpeech(bool enabled)
+{
+    skipNonSpeech = enabled;
+    if (!enabled)
+    {
+        eq.setPassThrough(false);
+        deesserEffect.setPassThrough(false);
+    }
+}
+
+void EffectChain::setEchoCancellation(bool enabled)
+{
+    if (enabled && !echoCancellation)
+    {
+        echoCanceller.reset();
+    }
+    echoCancellation = enabled;
+    if (!enabled)
+    {
+        echoERLE.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+void EffectChain::setStreamId(uint32_t id)
+{
+    streamId = id;
+}
+
+void EffectChain::inheritFrom(const EffectChain& previous)
+{
+    profile = previous.profile;
+    streamId = previous.streamId;
+    blockSequence.store(previous.blockSequence.load());
+    framesProcessed.store(previous.framesProcessed.load());
+    processingNanos.store(previous.processingNanos.load());
+    gateOpenBlocks.store(previous.gateOpenBlocks.load());
+    limiterGain.store(previous.limiterGain.load());
+    speechBlocks.store(previous.speechBlocks.load());
+    doubleTalkBlocks.store(previous.doubleTalkBlocks.load());
+}
+
+uint64_t EffectChain::getBlockSequence() const
+{
+    return blockSequence.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------
+// Statistics
+//--------------------------------------------------------------------------
+
+uint64_t EffectChain::getFramesProcessed() const
+{
+    return framesProcessed.load(std::memory_order_relaxed);
+}
+
+double EffectChain::getProcessingSeconds() const
+{
+    return processingNanos.load(std::memory_order_relaxed) * 1e-9;
+}
+
+uint64_t EffectChain::getGateOpenBlocks() const
+{
+    return gateOpenBlocks.load(std::memory_order_relaxed);
+}
+
+double EffectChain::getLimiterGainReductionDB() const
+{
+    const float gain = limiterGain.load(std::memory_order_relaxed);
+    return gain > 0.0f && gain < 1.0f ? -20.0 * std::log10(gain) : 0.0;
+}
+
+double EffectChain::getBandLevelDB(unsigned int band) const
+{
+    const float power = band < SIDECHAIN_BANDS ? bandLevels[band].load(std::memory_order_relaxed) : 0.0f;
+    return power > 1e-12f ? 10.0 * std::log10(power) : -120.0;
+}
+
+uint64_t EffectChain::getSpeechBlocks() const
+{
+    return speechBlocks.load(std::memory_order_relaxed);
+}
+
+bool EffectChain::isSpeechActive() const
+{
+    return speechActive.load(std::memory_order_relaxed);
+}
+
+double EffectChain::getEchoReturnLossEnhancementDB() const
+{
+    return echoERLE.load(std::memory_order_relaxed);
+}
+
+uint64_t EffectChain::getDoubleTalkBlocks() const
+{
+    return doubleTalkBlocks.load(std::memory_order_relaxed);
+}
+
+double EffectChain::getRealTimeFactor() const
+{
+    const uint64_t frames = getFramesProcessed();
+    return frames > 0 ? getProcessingSeconds() * sampleRate / static_cast<double>(frames) : 0.0;
+}
+
+} // namespace audio
@@ -0,0 +1,439 @@
+#ifndef EFFECT_CHAIN_H
+#define EFFECT_CHAIN_H
+
+#include "../common.h"
+#include "../effects/NoiseGate.h"
+#include "../effects/ThreeBandEQ.h"
+#include "../effects/Limiter.h"
+#include "../effects/DeEsser.h"
+#include "../effects/SideChain.h"
+#include "../effects/VoiceActivity.h"
+#include "../effects/EchoCanceller.h"
+#include "RecordingTap.h"
+#include "ParameterQueue.h"
+#include "Profiler.h"
+#include "Tracepoints.h"
+#include "BlockHeader.h"
+
+#include <atomic>
+
+#include <vector>
+
+namespace audio {
+
+// Parameter events one block can take from its queues (the rest wait a block)
+constexpr std::size_t MAX_BLOCK_EVENTS = 256;
+
+// Parameter queues a chain takes events from, one per producer thread
+constexpr std::size_t MAX_PARAMETER_QUEUES = 4;
+
+/**
+ * The mono processing chain shared by every audio backend.
+ *
+ * Runs NoiseGate -> ThreeBandEQ -> De-Esser -> Limiter on a single
+ * channel. Effects are owned externally (the GUI edits them directly);
+ * the chain owns the intermediate buffers between stages, so that
+ * backends can call process() from a real-time thread without allocating,
+ * and the de-esser's STFT state (its settings stay external).
+ *
+ * When the gate closes fully its blocks are flagged silent, and the flag
+ * propagates: each later stage only advances its state (flushing any
+ * tail of earlier signal) and reports whether its own output is silent.
+ *
+ * While the EQ and de-esser are bypassed, the gate and limiter are
+ * adjacent per-sample stages. Their gain envelopes then run fused in one
+ * FusedChain pass from input to output, with no intermediate buffers.
+ *
+ * Parameter changes can arrive through ParameterQueues (one per control
+ * thread, e.g. the GUI and a control surface), timestamped in stream frames. Enable toggles take effect at the start of their block;
+ * other changes reach each effect at their offset in the block (per
+ * sample for the gate and limiter, per STFT frame for the EQ and
+ * de-esser).
+ *
+ * With side-chain detection on, a decimated SideChain analyses each input
+ * block once; the gate decides from its power instead of its own FFT, and
+ * its octave band levels are published for meters.
+ *
+ * With voice activity detection on, each block is classified as speech or
+ * not (isSpeech()), from the gate's own frames when it analyses the block.
+ * With skipping on as well, non-speech blocks run the EQ and de-esser
+ * delay-only and are not written to the post tap; the pre tap keeps the
+ * complete input.
+ *
+ * With echo cancellation on, an EchoCanceller removes the echo of the
+ * chain's own output from the input before any other stage: each block's
+ * output is fed back as the canceller's reference, taken to play at least
+ * one block (getMaxFrames()) before its echo reaches the input.
+ */
+class EffectChain
+{
+private:
+    //--------------------------------------------------------------------------
+    // Effect References (external ownership)
+    //--------------------------------------------------------------------------
+    NoiseGate& noiseGate;
+    ThreeBandEQ& eq;
+    Limiter& limiter;
+    DeEsserSettings& deesserConfig;
+    unsigned int sampleRate;
+
+    //--------------------------------------------------------------------------
+    // Intermediate Buffers
+    //--------------------------------------------------------------------------
+    std::vector<float> gateOutput;
+    std::vector<float> eqOutput;
+    std::vector<float> deessedData;
+    std::vector<float> echoOutput;
+
+    //--------------------------------------------------------------------------
+    // Owned Stages
+    //--------------------------------------------------------------------------
+    DeEsser deesserEffect;      // STFT state for deesserConfig
+    SideChain sideChain;        // shared detector input, run while sideChainDetection is set
+    bool sideChainDetection;
+    VoiceActivityDetector voiceActivity;    // run while voiceActivityDetection is set
+    bool voiceActivityDetection;
+    bool skipNonSpeech;         // non-speech blocks skip the spectral stages and the post tap
+    EchoCanceller echoCanceller;    // run while echoCancellation is set, referenced to the chain's output
+    bool echoCancellation;
+
+    //--------------------------------------------------------------------------
+    // Archive Taps (optional, externally owned)
+    //--------------------------------------------------------------------------
+    RecordingTap* preTap;
+    RecordingTap* postTap;
+
+    //--------------------------------------------------------------------------
+    // Automation (optional, externally owned)
+    //--------------------------------------------------------------------------
+    ParameterQueue* parameterQueues[MAX_PARAMETER_QUEUES];
+    ParameterRecorder* parameterRecorder;
+    std::vector<ParameterEvent> blockEvents;    // events taken for the current block
+
+    //--------------------------------------------------------------------------
+    // Profiling (optional, externally owned)
+    //--------------------------------------------------------------------------
+    ThreadProfile* profile;
+
+    //--------------------------------------------------------------------------
+    // Tracing
+    //--------------------------------------------------------------------------
+    uint32_t streamId;                      // backend id for tracepoints
+    std::atomic<uint64_t> blockSequence;    // blocks processed, written by the audio thread only
+
+    //--------------------------------------------------------------------------
+    // Statistics (written by the audio thread, read from any thread)
+    //--------------------------------------------------------------------------
+    std::atomic<uint64_t> framesProcessed;
+    std::atomic<uint64_t> processingNanos;  // wall time inside process()
+    std::atomic<uint64_t> gateOpenBlocks;   // blocks the gate passed (or was bypassed)
+    std::atomic<float> limiterGain;         // limiter gain at the end of the last block
+    std::atomic<float> bandLevels[SIDECHAIN_BANDS]; // side-chain band powers of the last block
+    std::atomic<uint64_t> speechBlocks;     // blocks the voice activity detector classified as speech
+    std::atomic<bool> speechActive;         // the last block was speech
+    std::atomic<float> echoERLE;            // echo canceller's ERLE at the end of the last block (dB)
+    std::atomic<uint64_t> doubleTalkBlocks; // blocks ending in double-talk
+
+    //--------------------------------------------------------------------------
+    // Silence (audio thread only)
+    //--------------------------------------------------------------------------
+    bool outputSilent;                      // the last block's output was exact silence
+    bool timeDomainPath;                    // the block runs processTimeDomain() (set by takeEvents())
+    bool speech;                            // the last block was speech (false while detection is off)
+
+    //--------------------------------------------------------------------------
+    // Private Methods
+    //--------------------------------------------------------------------------
+    /**
+     * Takes the block's events from the queues, merged in stream order,
+     * applies the enable toggles (resetting the bypassed spectral stages
+     * when they switch the block onto the fused path)
+     * and records each event at the frame it takes effect.
+     * @return The remaining events, for the stages to apply at their offsets
+     */
+    BlockEvents takeEvents(std::size_t numFrames);
+
+    /**
+     * Applies an event to whichever effect it belongs to.
+     */
+    void applyParameter(const ParameterEvent& event);
+
+    /**
+     * Runs each enabled stage over the block in turn, through the intermediate buffers.
+     */
+    void processStages(const float* input, float* output, std::size_t numFrames, uint64_t sequence,
+                       const BlockEvents& events);
+
+    /**
+     * Runs the gate and limiter fused in one pass (EQ and de-esser bypassed, gate enabled).
+     */
+    void processTimeDomain(const float* input, float* output, std::size_t numFrames, uint64_t sequence);
+
+    /**
+     * Decides whether the block measured last is speech (once the gate has
+     * handed over its frames) and sets the spectral stages' pass-through.
+     */
+    void decideVoiceActivity();
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a chain over the given effects.
+     *
+     * @param ng Noise gate stage
+     * @param threeBandEq Equalizer stage
+     * @param lim Limiter stage
+     * @param deesser De-esser settings
+     * @param rate Sample rate in Hz (default: SAMPLE_RATE)
+     * @param maxFrames Largest block the chain must handle without allocating
+     */
+    EffectChain(NoiseGate& ng, ThreeBandEQ& threeBandEq, Limiter& lim,
+                DeEsserSettings& deesser,
+                unsigned int rate = SAMPLE_RATE,
+                std::size_t maxFrames = FRAMES_PER_BUFFER * 2);
+
+    //--------------------------------------------------------------------------
+    // Processing
+    //--------------------------------------------------------------------------
+    /**
+     * Resizes intermediate buffers for a new maximum block size. A larger
+     * size lengthens the echo canceller's reference delay without losing
+     * its converged filter; a smaller one leaves the delay as it is.
+     * Allocates; must not be called from the audio thread.
+     * @param maxFrames Largest block size that process() will receive
+     */
+    void prepare(std::size_t maxFrames);
+
+    /**
+     * prepare() for a backend that declares its period, which also chooses
+     * the latency of the EQ and de-esser (see StftEngine::prepare()).
+     * Changing the latency clears their STFTs; call before the stream starts.
+     * @param maxFrames Largest block size that process() will receive
+     * @param periodFrames Frames in every block, or 0 if blocks vary in size
+     */
+    void prepare(std::size_t maxFrames, std::size_t periodFrames);
+
+    /**
+     * Runs one mono block through the full chain.
+     * Input and output may point at the same memory. A block larger than
+     * getMaxFrames() runs as several blocks of at most that size.
+     *
+     * @param input Source samples (numFrames)
+     * @param output Destination for processed samples (numFrames)
+     * @param numFrames Number of samples to process
+     */
+    void process(const float* input, float* output, std::size_t numFrames);
+
+    /**
+     * Gets the largest block size process() can handle without allocating.
+     * @return Capacity of the intermediate buffers in frames
+     */
+    std::size_t getMaxFrames() const;
+
+    /**
+     * Archives the chain's input and/or output through recording taps.
+     * Call before the backend starts; pass nullptr to leave a point untapped.
+     *
+     * @param pre Tap fed with the unprocessed mono input
+     * @param post Tap fed with the processed mono output
+     */
+    void setTaps(RecordingTap* pre, RecordingTap* post);
+
+    /**
+     * Times each stage into a profile on whichever thread runs process().
+     * Call before the backend starts; pass nullptr to stop profiling.
+     * @param threadProfile Profile from Profiler::createProfile()
+     */
+    void setProfile(ThreadProfile* threadProfile);
+
+    /**
+     * Takes parameter changes from a queue at the start of each block.
+     * Each queue has a single producer, so every control thread posts to
+     * its own slot. Call before the backend starts; pass nullptr to stop.
+     * @param queue Queue the control thread posts to
+     * @param slot Slot below MAX_PARAMETER_QUEUES (0: the GUI)
+     */
+    void setParameterQueue(ParameterQueue* queue, std::size_t slot = 0);
+
+    /**
+     * Captures every event taken from the queue, at the frame it took effect.
+     * Call before the backend starts; pass nullptr to stop recording.
+     * @param recorder Recorder a control thread collects from
+     */
+    void setParameterRecorder(ParameterRecorder* recorder);
+
+    ParameterQueue* getParameterQueue(std::size_t slot = 0) const
+    {
+        return slot < MAX_PARAMETER_QUEUES ? parameterQueues[slot] : nullptr;
+    }
+    ParameterRecorder* getParameterRecorder() const { return parameterRecorder; }
+
+    /**
+     * Runs the decimated side-chain on each block and makes the noise
+     * gate detect from it (see NoiseGate::setSideChain()). Call before the
+     * backend starts, or between blocks on the audio thread.
+     * @param enabled true for side-chain detection, false for the gate's own FFT
+     */
+    void setSideChainDetection(bool enabled);
+
+    bool isSideChainDetection() const { return sideChainDetection; }
+
+    /**
+     * Gets the chain's side-chain, for its band edges.
+     */
+    const SideChain& getSideChain() const { return sideChain; }
+
+    /**
+     * Classifies each block as speech or not (see VoiceActivityDetector),
+     * taking the gate's frames while it analyses the block. Call before the
+     * backend starts, or between blocks on the audio thread.
+     * @param enabled true to run the detector
+     */
+    void setVoiceActivityDetection(bool enabled);
+
+    bool isVoiceActivityDetection() const { return voiceActivityDetection; }
+
+    /**
+     * Skips work on non-speech blocks while voice activity detection is
+     * on: the EQ and de-esser run delay-only (their latency and the
+     * crossfades stay exact) and the post tap is not written.
+     * Call before the backend starts, or between blocks on the audio thread.
+     * @param enabled true to skip
+     */
+    void setSkipNonSpeech(bool enabled);
+
+    bool isSkipNonSpeech() const { return skipNonSpeech; }
+
+    /**
+     * Gets the chain's voice activity detector, for its settings and features.
+     * Call on the thread running process().
+     */
+    VoiceActivityDetector& getVoiceActivity() { return voiceActivity; }
+
+    /**
+     * Cancels the echo of the chain's output from its input (see
+     * EchoCanceller), adding the canceller's latency. Call before the
+     * backend starts, or between blocks on the audio thread.
+     * @param enabled true to cancel
+     */
+    void setEchoCancellation(bool enabled);
+
+    bool isEchoCancellation() const { return echoCancellation; }
+
+    /**
+     * Gets the chain's echo canceller, for its settings and state.
+     * Call on the thread running process().
+     */
+    EchoCanceller& getEchoCanceller() { return echoCanceller; }
+    const EchoCanceller& getEchoCanceller() const { return echoCanceller; }
+
+    /**
+     * Sets the stream id reported by the chain's tracepoints.
+     * @param id One of TraceStream (see Tracepoints.h)
+     */
+    void setStreamId(uint32_t id);
+
+    /**
+     * Continues another chain's identity when this chain replaces it:
+     * takes over its profile, stream id, block sequence and statistics, so
+     * counters stay monotonic across a swap. Taps and the parameter queue
+     * are not taken over (the swap moves them once the old chain stops
+     * running).
+     * Call before this chain starts processing.
+     * @param previous Chain being replaced
+     */
+    void inheritFrom(const EffectChain& previous);
+
+    /**
+     * Checks whether the last block's output was exact silence, as
+     * propagated through the stages. Call on the thread running process().
+     */
+    bool isOutputSilent() const { return outputSilent; }
+
+    /**
+     * Checks whether the last block was classified as speech (always false
+     * while voice activity detection is off). Call on the thread running process().
+     */
+    bool isSpeech() const { return speech; }
+
+    RecordingTap* getPreTap() const { return preTap; }
+    RecordingTap* getPostTap() const { return postTap; }
+
+    /**
+     * Gets the sample rate the chain was built for.
+     * @return Sample rate in Hz
+     */
+    unsigned int getSampleRate() const { return sampleRate; }
+
+    /**
+     * Gets the sequence number of the next block (blocks processed so far).
+     * Safe to call from any thread.
+     */
+    uint64_t getBlockSequence() const;
+
+    //--------------------------------------------------------------------------
+    // Statistics (any thread)
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the frames processed since construction.
+     */
+    uint64_t getFramesProcessed() const;
+
+    /**
+     * Gets the total wall time spent in process().
+     * @return Seconds
+     */
+    double getProcessingSeconds() const;
+
+    /**
+     * Gets the blocks in which the noise gate was open.
+     */
+    uint64_t getGateOpenBlocks() const;
+
+    /**
+     * Gets the limiter's gain reduction at the end of the last block.
+     * @return Reduction in dB (0 when not limiting)
+     */
+    double getLimiterGainReductionDB() const;
+
+    /**
+     * Gets a side-chain band's level over the last block (while side-chain
+     * detection is on).
+     * @param band Band index, 0 (lowest) .. SIDECHAIN_BANDS-1
+     * @return Level in dB relative to full scale (-120 for silence)
+     */
+    double getBandLevelDB(unsigned int band) const;
+
+    /**
+     * Gets the blocks classified as speech while voice activity detection was on.
+     */
+    uint64_t getSpeechBlocks() const;
+
+    /**
+     * Checks whether the last block was speech, from any thread.
+     */
+    bool isSpeechActive() const;
+
+    /**
+     * Gets the echo canceller's echo return loss enhancement at the end of the last block.
+     * @return Enhancement in dB (0 while cancellation is off)
+     */
+    double getEchoReturnLossEnhancementDB() const;
+
+    /**
+     * Gets the blocks that ended in double-talk while echo cancellation was on.
+     */
+    uint64_t getDoubleTalkBlocks() const;
+
+    /**
+     * Gets processing time divided by the duration of the audio processed.
+     * @return Real-time factor (below 1 keeps up; 0 before the first block)
+     */
+    double getRealTimeFactor() const;
+};
+
+} // namespace audio
+
+#endif // EFFECT_CHAIN_H
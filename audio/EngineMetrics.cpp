@@ -0,0 +1,185 @@
+#include "EngineMetrics.h"
+
+#include <vector>
+
+namespace audio {
+
+namespace {
+
+// Exported bucket bounds: 1 us doubling up to ~1 s
+const std::size_t EXPORT_BUCKETS = 21;
+
+double exportBound(std::size_t index)
+{
+    return 1e-6 * static_cast<double>(1ull << index);
+}
+
+/**
+ * Rebins log2 buckets (bucket b holds [2^b, 2^(b+1)) units) onto the fixed
+ * export bounds, so every histogram uses the same, stable bucket set.
+ */
+void rebinLog2(const uint64_t* counts, std::size_t bucketCount, double unitSeconds,
+               std::vector<HistogramBucket>& out, uint64_t& total)
+{
+    out.assign(EXPORT_BUCKETS, HistogramBucket());
+    for (std::size_t i = 0; i < EXPORT_BUCKETS; ++i)
+    {
+        out[i].upperBound = exportBound(i);
+    }
+    total = 0;
+    for (std::size_t b = 0; b < bucketCount; ++b)
+    {
+        total += counts[b];
+        const double upper = unitSeconds * static_cast<double>(2ull << b);
+        for (std::size_t i = 0; i < EXPORT_BUCKETS; ++i)
+        {
+            if (upper <= out[i].upperBound)
+            {
+                out[i].count += counts[b];
+                break;
+            }
+        }
+        // Beyond the last bound: counted in total only (+Inf)
+    }
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Registration
+//--------------------------------------------------------------------------
+
+void registerChainMetrics(MetricsRegistry& registry, const EffectChain& chain)
+{
+    const EffectChain* source = &chain;
+    registry.addCounter("multiaudio_blocks_total", "Blocks processed by the effect chain.", "",
+                        [source] { return static_cast<double>(source->getBlockSequence()); });
+    registry.addCounter("multiaudio_audio_seconds_total", "Duration of the audio processed.", "",
+                        [source] { return source->getFramesProcessed() / static_cast<double>(source->getSampleRate()); });
+    registry.addCounter("multiaudio_processing_seconds_total", "Wall time spent in the effect chain.", "",
+                        [source] { return source->getProcessingSeconds(); });
+    registry.addGauge("multiaudio_realtime_factor",
+                      "Processing time over audio time since start (below 1 keeps up).", "",
+                      [source] { return source->getRealTimeFactor(); });
+    registry.addGauge("multiaudio_gate_open_ratio", "Fraction of blocks the noise gate passed since start.", "",
+                      [source]
+                      {
+                          const uint64_t blocks = source->getBlockSequence();
+                          return blocks ? static_cast<double>(source->getGateOpenBlocks()) / blocks : 0.0;
+                      });
+    registry.addGauge("multiaudio_limiter_gain_reduction_db", "Limiter gain reduction at the end of the last block.",
+                      "", [source] { return source->getLimiterGainReductionDB(); });
+    if (chain.isSideChainDetection())
+    {
+        const SideChain& sideChain = chain.getSideChain();
+        for (unsigned int band = 0; band < SIDECHAIN_BANDS; ++band)
+        {
+            const std::string labels = "band=\"" + std::to_string(static_cast<int>(sideChain.getBandLowHz(band))) + "-" +
+                                       std::to_string(static_cast<int>(sideChain.getBandHighHz(band))) + "\"";
+            registry.addGauge("multiaudio_band_level_db", "Side-chain octave band level over the last block (dBFS).",
+                              labels, [source, band] { return source->getBandLevelDB(band); });
+        }
+    }
+    if (chain.isVoiceActivityDetection())
+    {
+        registry.addCounter("multiaudio_speech_blocks_total", "Blocks voice activity detection classified as speech.",
+                            "", [source] { return static_cast<double>(source->getSpeechBlocks()); });
+        registry.addGauge("multiaudio_speech_ratio", "Fraction of blocks classified as speech since start.", "",
+                          [source]
+                          {
+                              const uint64_t blocks = source->getBlockSequence();
+                              return blocks ? static_cast<double>(source->getSpeechBlocks()) / blocks : 0.0;
+                          });
+        registry.addGauge("multiaudio_speech_active", "1 while the last block was speech.", "",
+                          [source] { return source->isSpeechActive() ? 1.0 : 0.0; });
+    }
+    if (chain.isEchoCancellation())
+    {
+        registry.addGauge("multiaudio_aec_erle_db", "Echo canceller's echo return loss enhancement (dB).", "",
+                          [source] { return source->getEchoReturnLossEnhancementDB(); });
+        registry.addCounter("multiaudio_aec_double_talk_blocks_total", "Blocks the echo canceller froze for double-talk.",
+                            "", [source] { return static_cast<double>(source->getDoubleTalkBlocks()); });
+    }
+}
+
+void registerXrunMetric(MetricsRegistry& registry, const std::string& backend, MetricsRegistry::ValueReader readXruns)
+{
+    registry.addCounter("multiaudio_xruns_total", "Overruns/underruns reported by the audio backend.",
+                        "backend=\"" + backend + "\"", std::move(readXruns));
+}
+
+void registerQueueMetrics(MetricsRegistry& registry, const BufferQueue& queue, const std::string& name)
+{
+    const BufferQueue* source = &queue;
+    const std::string labels = "queue=\"" + name + "\"";
+    registry.addGauge("multiaudio_queue_depth", "Buffers waiting in a pipeline queue.", labels,
+                      [source] { return static_cast<double>(source->getDepth()); });
+    registry.addGauge("multiaudio_queue_capacity", "Maximum buffers a pipeline queue holds.", labels,
+                      [source] { return static_cast<double>(source->getCapacity()); });
+}
+
+void registerLatencyMetrics(MetricsRegistry& registry, const LatencyTracker& tracker)
+{
+    const LatencyTracker* source = &tracker;
+    registry.addHistogram("multiaudio_block_latency_seconds", "Capture-to-playout latency of played blocks.", "",
+                          [source](std::vector<HistogramBucket>& buckets, double& sum, uint64_t& count)
+                          {
+                              uint64_t counts[LATENCY_HISTOGRAM_BUCKETS];
+                              for (std::size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; ++b)
+                              {
+                                  counts[b] = source->getHistogramCount(b);
+                              }
+                              rebinLog2(counts, LATENCY_HISTOGRAM_BUCKETS, 1e-6, buckets, count);
+                              sum = source->getMeanLatencyMs() * 1e-3 * static_cast<double>(count);
+                          });
+    registry.addCounter("multiaudio_blocks_dropped_total", "Block sequence numbers that never played.", "",
+                        [source] { return static_cast<double>(source->getDropped()); });
+    registry.addCounter("multiaudio_blocks_reordered_total", "Blocks played after a later block.", "",
+                        [source] { return static_cast<double>(source->getReordered()); });
+}
+
+void registerProfileMetrics(MetricsRegistry& registry, const ThreadProfile& profile)
+{
+    const ThreadProfile* source = &profile;
+    for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s)
+    {
+        const ProfileStage stage = static_cast<ProfileStage>(s);
+        const std::string labels = std::string("thread=\"") + profile.getName() + "\",stage=\"" +
+                                   profileStageName(stage) + "\"";
+        registry.addCounter("multiaudio_stage_cpu_seconds_total", "Time spent in each processing stage.", labels,
+                            [source, stage]
+                            {
+                                return source->getStage(stage).totalTicks.load(std::memory_order_relaxed) /
+                                       Profiler::ticksPerMicrosecond() * 1e-6;
+                            });
+        registry.addHistogram("multiaudio_stage_duration_seconds", "Duration of each call to a processing stage.",
+                              labels,
+                              [source, stage](std::vector<HistogramBucket>& buckets, double& sum, uint64_t& count)
+                              {
+                                  const ThreadProfile::StageCounters& counters = source->getStage(stage);
+                                  uint64_t counts[PROFILE_HISTOGRAM_BUCKETS];
+                                  for (std::size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; ++b)
+                                  {
+                                      counts[b] = counters.histogram[b].load(std::memory_order_relaxed);
+                                  }
+                                  const double secondsPerTick = 1e-6 / Profiler::ticksPerMicrosecond();
+                                  rebinLog2(counts, PROFILE_HISTOGRAM_BUCKETS, secondsPerTick, buckets, count);
+                                  sum = counters.totalTicks.load(std::memory_order_relaxed) * secondsPerTick;
+                              });
+    }
+}
+
+void registerWatchdogMetrics(MetricsRegistry& registry, const Watchdog& watchdog)
+{
+    const Watchdog* source = &watchdog;
+    for (std::size_t c = 0; c < watchdog.getComponentCount(); ++c)
+    {
+        const std::string labels = "component=\"" + watchdog.getComponentName(c) + "\"";
+        registry.addCounter("multiaudio_recoveries_total", "Watchdog recoveries that restarted a component.", labels,
+                            [source, c] { return static_cast<double>(source->getRecoveries(c)); });
+        registry.addCounter("multiaudio_recovery_failures_total", "Watchdog recovery attempts that failed.", labels,
+                            [source, c] { return static_cast<double>(source->getFailures(c)); });
+    }
+}
+
+} // namespace audio
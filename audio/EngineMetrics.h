@@ -0,0 +1,64 @@
+#ifndef ENGINE_METRICS_H
+#define ENGINE_METRICS_H
+
+#include "MetricsRegistry.h"
+#include "EffectChain.h"
+#include "BufferQueue.h"
+#include "LatencyTracker.h"
+#include "Profiler.h"
+#include "Watchdog.h"
+
+#include <string>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Engine Metrics
+//--------------------------------------------------------------------------
+//
+// Registers the engine's lock-free statistics with a MetricsRegistry.
+// Every reader only loads relaxed atomics, so scraping never waits on or
+// blocks an audio thread. The registered objects must outlive the
+// registry's use (clear() the registry before destroying them).
+
+/**
+ * Registers chain throughput and effect state: blocks, audio and processing
+ * seconds, real-time factor, gate open ratio and limiter gain reduction,
+ * plus the side-chain band levels if the chain runs side-chain detection,
+ * the speech blocks, ratio and state if it runs voice activity detection,
+ * and the echo return loss enhancement and double-talk blocks if it cancels
+ * echo.
+ */
+void registerChainMetrics(MetricsRegistry& registry, const EffectChain& chain);
+
+/**
+ * Registers a backend's xrun total under multiaudio_xruns_total{backend="..."}.
+ * @param readXruns Returns the xruns so far (must be safe from any thread)
+ */
+void registerXrunMetric(MetricsRegistry& registry, const std::string& backend,
+                        MetricsRegistry::ValueReader readXruns);
+
+/**
+ * Registers the depth and capacity of a buffer queue.
+ * @param name Label value, e.g. "input"
+ */
+void registerQueueMetrics(MetricsRegistry& registry, const BufferQueue& queue, const std::string& name);
+
+/**
+ * Registers capture-to-playout latency, drops and reorders.
+ */
+void registerLatencyMetrics(MetricsRegistry& registry, const LatencyTracker& tracker);
+
+/**
+ * Registers per-stage CPU time and duration histograms from a thread profile.
+ */
+void registerProfileMetrics(MetricsRegistry& registry, const ThreadProfile& profile);
+
+/**
+ * Registers successful and failed recoveries per supervised component.
+ */
+void registerWatchdogMetrics(MetricsRegistry& registry, const Watchdog& watchdog);
+
+} // namespace audio
+
+#endif // ENGINE_METRICS_H
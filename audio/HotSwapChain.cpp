@@ -0,0 +1,151 @@
+#include "HotSwapChain.h"
+
+#include <algorithm>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+HotSwapChain::HotSwapChain(EffectChain& initial, std::size_t maxFrames)
+    : active(&initial),
+      incoming(nullptr),
+      retired(nullptr),
+      swapping(false),
+      crossfadeFrames(0),
+      fading(nullptr),
+      fadePosition(0),
+      fadeOutput(maxFrames),
+      outputSilent(false),
+      outputSpeech(false)
+{
+}
+
+void HotSwapChain::prepare(std::size_t maxFrames)
+{
+    if (fadeOutput.size() < maxFrames)
+    {
+        fadeOutput.resize(maxFrames);
+    }
+    EffectChain* chains[] = { active.load(), incoming.load(), fading };
+    for (EffectChain* chain : chains)
+    {
+        if (chain && chain->getMaxFrames() < maxFrames)
+        {
+            chain->prepare(maxFrames);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// Processing
+//--------------------------------------------------------------------------
+
+void HotSwapChain::process(const float* input, float* output, std::size_t numFrames)
+{
+    EffectChain* next = incoming.exchange(nullptr, std::memory_order_acquire);
+    if (next)
+    {
+        // Begin the swap
+        fading = active.load(std::memory_order_relaxed);
+        handOver(*fading, *next);
+        active.store(next, std::memory_order_release);
+        fadePosition = 0;
+    }
+
+    EffectChain* current = active.load(std::memory_order_relaxed);
+    if (!fading)
+    {
+        current->process(input, output, numFrames);
+        outputSilent = current->isOutputSilent();
+        outputSpeech = current->isSpeech();
+        return;
+    }
+
+    if (fadeOutput.size() < numFrames)
+    {
+        fadeOutput.resize(numFrames); // Oversized block: grow rather than overrun (prepare() avoids this)
+    }
+    // The old chain writes to its own buffer first, so the input is intact for the new one
+    fading->process(input, fadeOutput.data(), numFrames);
+    current->process(input, output, numFrames);
+    outputSilent = fading->isOutputSilent() && current->isOutputSilent();
+    outputSpeech = fading->isSpeech() || current->isSpeech();
+
+    const std::size_t fadeLength = std::max<std::size_t>(crossfadeFrames.load(std::memory_order_relaxed), 1);
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        const float mix = std::min(1.0f, static_cast<float>(fadePosition + i + 1) / fadeLength);
+        output[i] = fadeOutput[i] + mix * (output[i] - fadeOutput[i]);
+    }
+
+    fadePosition += numFrames;
+    if (fadePosition >= fadeLength)
+    {
+        retired.store(fading, std::memory_order_release);
+        fading = nullptr;
+    }
+}
+
+//--------------------------------------------------------------------------
+// Swapping
+//--------------------------------------------------------------------------
+
+void HotSwapChain::handOver(EffectChain& from, EffectChain& to)
+{
+    // Archive taps, automation and the detector follow the chain that produces the output
+    to.setTaps(from.getPreTap(), from.getPostTap());
+    from.setTaps(nullptr, nullptr);
+    for (std::size_t slot = 0; slot < MAX_PARAMETER_QUEUES; ++slot)
+    {
+        to.setParameterQueue(from.getParameterQueue(slot), slot);
+        from.setParameterQueue(nullptr, slot);
+    }
+    to.setParameterRecorder(from.getParameterRecorder());
+    from.setParameterRecorder(nullptr);
+    to.setSideChainDetection(from.isSideChainDetection());
+    to.setVoiceActivityDetection(from.isVoiceActivityDetection());
+    to.setSkipNonSpeech(from.isSkipNonSpeech());
+    to.setEchoCancellation(from.isEchoCancellation());
+}
+
+bool HotSwapChain::stage(EffectChain& next, std::size_t fadeFrames)
+{
+    bool idle = false;
+    if (!swapping.compare_exchange_strong(idle, true))
+    {
+        return false;
+    }
+    crossfadeFrames.store(fadeFrames, std::memory_order_relaxed);
+    incoming.store(&next, std::memory_order_release);
+    return true;
+}
+
+bool HotSwapChain::replace(EffectChain& next)
+{
+    if (swapping.load())
+    {
+        return false;
+    }
+    EffectChain* current = active.load();
+    if (current != &next)
+    {
+        next.inheritFrom(*current);
+        handOver(*current, next);
+        active.store(&next);
+    }
+    return true;
+}
+
+EffectChain* HotSwapChain::takeRetired()
+{
+    EffectChain* old = retired.exchange(nullptr, std::memory_order_acquire);
+    if (old)
+    {
+        swapping.store(false);
+    }
+    return old;
+}
+
+} // namespace audio
@@ -0,0 +1,127 @@
+#ifndef HOT_SWAP_CHAIN_H
+#define HOT_SWAP_CHAIN_H
+
+#include "EffectChain.h"
+
+#include <atomic>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Runs one EffectChain and replaces it with another without a gap.
+ *
+ * A control thread stages a fully built chain (buffers sized, FFTs
+ * planned); the processing thread picks it up at the start of its next
+ * block and, for the length of the crossfade, runs both chains on the
+ * same input and fades linearly from the old output to the new one. The
+ * crossfade hides the new chain's cold start (empty overlap buffers, a
+ * closed gate) and costs nothing but the doubled work while it lasts.
+ * Once the fade is done the old chain is handed back through
+ * takeRetired() so the control thread can free it.
+ *
+ * The old chain runs the new stream's blocks while it fades. If it was
+ * prepared for whole hops of its spectral effects and the new blocks are
+ * not, their StftEngines switch once to any-block latency and drop up to
+ * one hop of output early in the fade.
+ *
+ * Chains are not owned. One swap is in flight at a time.
+ */
+class HotSwapChain
+{
+private:
+    std::atomic<EffectChain*> active;
+    std::atomic<EffectChain*> incoming;     // staged by the control thread
+    std::atomic<EffectChain*> retired;      // faded out, waiting for takeRetired()
+    std::atomic<bool> swapping;             // stage() until takeRetired()
+    std::atomic<std::size_t> crossfadeFrames;
+
+    // Processing thread only
+    EffectChain* fading;                    // old chain while the crossfade runs
+    std::size_t fadePosition;
+    std::vector<float> fadeOutput;          // old chain's output during the crossfade
+    bool outputSilent;                      // last block silent in every chain that produced it
+    bool outputSpeech;                      // last block speech in either chain that produced it
+
+    /**
+     * Moves archive taps, automation and the detector settings from the
+     * chain being replaced to its replacement.
+     */
+    static void handOver(EffectChain& from, EffectChain& to);
+
+public:
+    /**
+     * @param initial Chain to run until the first swap
+     * @param maxFrames Largest block process() must handle without allocating
+     */
+    explicit HotSwapChain(EffectChain& initial, std::size_t maxFrames = FRAMES_PER_BUFFER * 2);
+
+    HotSwapChain(const HotSwapChain&) = delete;
+    HotSwapChain& operator=(const HotSwapChain&) = delete;
+
+    /**
+     * Sizes the crossfade buffer and the running chains for a new maximum block.
+     * Allocates; call from the processing thread or while it is stopped.
+     */
+    void prepare(std::size_t maxFrames);
+
+    /**
+     * Runs one block through the active chain, crossfading from the previous
+     * chain while a swap is in progress. Input and output may alias.
+     */
+    void process(const float* input, float* output, std::size_t numFrames);
+
+    /**
+     * Stages a chain to replace the active one at the processing thread's next block.
+     * The chain must be ready to process (see EffectChain::inheritFrom()).
+     *
+     * @param next Replacement chain (must outlive its time as the active chain)
+     * @param fadeFrames Crossfade length in frames (0 swaps at the block boundary)
+     * @return false if a previous swap has not been taken back with takeRetired()
+     */
+    bool stage(EffectChain& next, std::size_t fadeFrames);
+
+    /**
+     * Makes a chain active at once, handing over to it as a swap does and
+     * continuing its counters (see EffectChain::inheritFrom()), for a chain
+     * rebuilt before processing starts (e.g. for the rate a backend turned
+     * out to run at). The processing thread must not be running; the
+     * replaced chain is not handed back.
+     *
+     * @param next Replacement chain (must outlive its time as the active chain)
+     * @return false while a swap is in flight
+     */
+    bool replace(EffectChain& next);
+
+    /**
+     * Takes back the chain a finished swap replaced.
+     * @return The old chain, now unused, or nullptr while none is ready
+     */
+    EffectChain* takeRetired();
+
+    /**
+     * True from stage() until the replaced chain has been taken back.
+     */
+    bool isSwapping() const { return swapping.load(); }
+
+    /**
+     * Checks whether the last block's output was exact silence (both chains
+     * silent while crossfading). Processing thread only.
+     */
+    bool isOutputSilent() const { return outputSilent; }
+
+    /**
+     * Checks whether the last block was classified as speech (by either
+     * chain while crossfading). Processing thread only.
+     */
+    bool isSpeech() const { return outputSpeech; }
+
+    /**
+     * Gets the chain the processing thread runs (the new one once a swap has begun).
+     */
+    EffectChain& getActive() const { return *active.load(); }
+};
+
+} // namespace audio
+
+#endif // HOT_SWAP_CHAIN_H
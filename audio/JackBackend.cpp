@@ -0,0 +1,275 @@
+#include "JackBackend.h"
+
+#ifdef MULTIAUDIO_WITH_JACK
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+JackBackend::JackBackend(EffectChain& effectChain, unsigned int channels)
+    : client(nullptr),
+      chain(&effectChain),
+      numChannels(std::max(1u, channels)),
+      expectedFrames(0),
+      serverRate(0),
+      xrunCount(0),
+      serverShutdown(false)
+{
+    chain->setStreamId(TRACE_STREAM_JACK);
+}
+
+JackBackend::~JackBackend()
+{
+    stop();
+}
+
+//--------------------------------------------------------------------------
+// JACK Callbacks
+//--------------------------------------------------------------------------
+
+int JackBackend::processCallback(jack_nframes_t nframes, void* arg)
+{
+    return static_cast<JackBackend*>(arg)->processPeriod(nframes);
+}
+
+int JackBackend::bufferSizeCallback(jack_nframes_t nframes, void* arg)
+{
+    JackBackend* self = static_cast<JackBackend*>(arg);
+
+    // JACK allows allocation here; the process callback is not running, and every
+    // period has nframes frames until the next call
+    self->chain->prepare(nframes, nframes);
+    self->expectedFrames.store(nframes);
+    return 0;
+}
+
+int JackBackend::sampleRateCallback(jack_nframes_t nframes, void* arg)
+{
+    // Effects are built for one rate: a change stops processing rather than run them at the wrong one
+    static_cast<JackBackend*>(arg)->serverRate.store(nframes);
+    return 0;
+}
+
+int JackBackend::xrunCallback(void* arg)
+{
+    JackBackend* self = static_cast<JackBackend*>(arg);
+    self->xrunCount.fetch_add(1);
+    MULTIAUDIO_TRACE2(xrun, TRACE_STREAM_JACK, self->chain->getBlockSequence());
+    return 0;
+}
+
+void JackBackend::shutdownCallback(void* arg)
+{
+    // Server is gone; ports and client are no longer valid for processing
+    static_cast<JackBackend*>(arg)->serverShutdown.store(true);
+}
+
+int JackBackend::processPeriod(jack_nframes_t nframes)
+{
+    const float* input = static_cast<const float*>(jack_port_get_buffer(inputPorts[0], nframes));
+    float* output = static_cast<float*>(jack_port_get_buffer(outputPorts[0], nframes));
+    const uint64_t sequence = chain->getBlockSequence();
+    int status = 0;
+    MULTIAUDIO_TRACE3(callback_entry, TRACE_STREAM_JACK, sequence, nframes);
+
+    if (nframes > chain->getMaxFrames())
+    {
+        // Never allocate on the server thread; wait for the buffer size callback
+        std::fill_n(output, nframes, 0.0f);
+        status = 1;
+    }
+    else if (serverRate.load(std::memory_order_relaxed) != chain->getSampleRate())
+    {
+        // Server switched rate under the chain; the control thread sees isRunning() turn false
+        std::fill_n(output, nframes, 0.0f);
+        status = 1;
+    }
+    else
+    {
+        // Chain reads and writes the port buffers directly (zero-copy)
+        chain->process(input, output, nframes);
+    }
+
+    // Remaining outputs carry the processed mono channel
+    for (std::size_t ch = 1; ch < outputPorts.size(); ++ch)
+    {
+        float* channelOut = static_cast<float*>(jack_port_get_buffer(outputPorts[ch], nframes));
+        std::memcpy(channelOut, output, nframes * sizeof(float));
+    }
+
+    MULTIAUDIO_TRACE4(callback_exit, TRACE_STREAM_JACK, sequence, nframes, status);
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// Private Methods
+//--------------------------------------------------------------------------
+
+void JackBackend::connectPhysicalPorts()
+{
+    const char** capture = jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                                          JackPortIsPhysical | JackPortIsOutput);
+    if (capture)
+    {
+        for (std::size_t ch = 0; ch < inputPorts.size() && capture[ch]; ++ch)
+        {
+            jack_connect(client, capture[ch], jack_port_name(inputPorts[ch]));
+        }
+        jack_free(capture);
+    }
+
+    const char** playback = jack_get_ports(client, nullptr, JACK_DEFAULT_AUDIO_TYPE,
+                                           JackPortIsPhysical | JackPortIsInput);
+    if (playback)
+    {
+        for (std::size_t ch = 0; ch < outputPorts.size() && playback[ch]; ++ch)
+        {
+            jack_connect(client, jack_port_name(outputPorts[ch]), playback[ch]);
+        }
+        jack_free(playback);
+    }
+}
+
+void JackBackend::closeClient()
+{
+    if (client)
+    {
+        jack_client_close(client);
+        client = nullptr;
+    }
+    inputPorts.clear();
+    outputPorts.clear();
+}
+
+//--------------------------------------------------------------------------
+// Stream Control
+//--------------------------------------------------------------------------
+
+bool JackBackend::open(const std::string& clientName)
+{
+    if (client)
+    {
+        return true;
+    }
+
+    jack_status_t status;
+    client = jack_client_open(clientName.c_str(), JackNoStartServer, &status);
+    if (!client)
+    {
+        std::cerr << "[JACK] ERROR: Could not connect to server (status " << status << ")." << std::endl;
+        return false;
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        std::string inName = "in_" + std::to_string(ch + 1);
+        std::string outName = "out_" + std::to_string(ch + 1);
+        jack_port_t* in = jack_port_register(client, inName.c_str(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+        jack_port_t* out = jack_port_register(client, outName.c_str(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+        if (!in || !out)
+        {
+            std::cerr << "[JACK] ERROR: Failed to register ports." << std::endl;
+            closeClient();
+            return false;
+        }
+        inputPorts.push_back(in);
+        outputPorts.push_back(out);
+    }
+
+    serverRate.store(jack_get_sample_rate(client));
+
+    // Size chain buffers for the current period before the first callback
+    bufferSizeCallback(jack_get_buffer_size(client), this);
+
+    jack_set_process_callback(client, &JackBackend::processCallback, this);
+    jack_set_buffer_size_callback(client, &JackBackend::bufferSizeCallback, this);
+    jack_set_sample_rate_callback(client, &JackBackend::sampleRateCallback, this);
+    jack_set_xrun_callback(client, &JackBackend::xrunCallback, this);
+    jack_on_shutdown(client, &JackBackend::shutdownCallback, this);
+
+    xrunCount.store(0);
+    serverShutdown.store(false);
+    return true;
+}
+
+void JackBackend::setChain(EffectChain& effectChain)
+{
+    chain = &effectChain;
+    chain->setStreamId(TRACE_STREAM_JACK);
+    if (expectedFrames.load() > 0)
+    {
+        chain->prepare(expectedFrames.load(), expectedFrames.load());
+    }
+}
+
+bool JackBackend::start()
+{
+    if (!client && !open())
+    {
+        return false;
+    }
+
+    if (serverRate.load() != chain->getSampleRate())
+    {
+        std::cerr << "[JACK] ERROR: Server runs at " << serverRate.load() << " Hz; the effect chain is built for "
+                  << chain->getSampleRate() << " Hz." << std::endl;
+        return false;
+    }
+
+    if (jack_activate(client) != 0)
+    {
+        std::cerr << "[JACK] ERROR: Failed to activate client." << std::endl;
+        return false;
+    }
+
+    connectPhysicalPorts();
+    return true;
+}
+
+void JackBackend::stop()
+{
+    if (!client)
+    {
+        return;
+    }
+
+    if (!serverShutdown.load())
+    {
+        jack_deactivate(client);
+    }
+    closeClient();
+}
+
+bool JackBackend::isRunning() const
+{
+    return client != nullptr && !serverShutdown.load() && serverRate.load() == chain->getSampleRate();
+}
+
+//--------------------------------------------------------------------------
+// Status
+//--------------------------------------------------------------------------
+
+unsigned int JackBackend::getSampleRate() const
+{
+    return client ? serverRate.load() : 0;
+}
+
+unsigned int JackBackend::getBufferSize() const
+{
+    return expectedFrames.load();
+}
+
+unsigned long JackBackend::getXrunCount() const
+{
+    return xrunCount.load();
+}
+
+} // namespace audio
+
+#endif // MULTIAUDIO_WITH_JACK
@@ -0,0 +1,170 @@
+#ifndef JACK_BACKEND_H
+#define JACK_BACKEND_H
+
+#include "../common.h"
+#include "EffectChain.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifdef MULTIAUDIO_WITH_JACK
+#include <jack/jack.h>
+#endif
+
+namespace audio {
+
+#ifdef MULTIAUDIO_WITH_JACK
+
+/**
+ * Native JACK client that runs the effect chain inside the server's
+ * process callback.
+ *
+ * JACK hands out one planar float buffer per port, which is exactly
+ * what the mono chain consumes, so the first input port is processed
+ * straight into the first output port with no interleaving, no extra
+ * callback thread and no BufferQueue hop. Remaining output ports receive
+ * a copy of the processed channel (dual mono, as with RtAudio).
+ *
+ * PipeWire is covered by the same code path through its JACK API
+ * (pipewire-jack / pw-jack), which serves the graph's port buffers directly.
+ *
+ * The server chooses the sample rate. The chain must be built for it
+ * (see setChain()) before start(); if the server later switches rate,
+ * the outputs fall silent and isRunning() turns false.
+ */
+class JackBackend
+{
+private:
+    //--------------------------------------------------------------------------
+    // JACK Resources
+    //--------------------------------------------------------------------------
+    jack_client_t* client;
+    std::vector<jack_port_t*> inputPorts;
+    std::vector<jack_port_t*> outputPorts;
+
+    //--------------------------------------------------------------------------
+    // Internal State
+    //--------------------------------------------------------------------------
+    EffectChain* chain;
+    unsigned int numChannels;
+    std::atomic<jack_nframes_t> expectedFrames;
+    std::atomic<jack_nframes_t> serverRate;
+    std::atomic<unsigned long> xrunCount;
+    std::atomic<bool> serverShutdown;
+
+    //--------------------------------------------------------------------------
+    // JACK Callbacks
+    //--------------------------------------------------------------------------
+    static int processCallback(jack_nframes_t nframes, void* arg);
+    static int bufferSizeCallback(jack_nframes_t nframes, void* arg);
+    static int sampleRateCallback(jack_nframes_t nframes, void* arg);
+    static int xrunCallback(void* arg);
+    static void shutdownCallback(void* arg);
+
+    /**
+     * Processes one period on the server's real-time thread.
+     * @param nframes Number of frames in each port buffer
+     */
+    int processPeriod(jack_nframes_t nframes);
+
+    /**
+     * Connects our ports to the system's physical capture/playback ports.
+     */
+    void connectPhysicalPorts();
+
+    /**
+     * Releases the client and clears port handles.
+     */
+    void closeClient();
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a JACK backend driving the given chain.
+     * @param effectChain Chain run in the process callback
+     * @param channels Number of input/output ports (default: NUM_CHANNELS)
+     */
+    explicit JackBackend(EffectChain& effectChain, unsigned int channels = NUM_CHANNELS);
+
+    /**
+     * Deactivates and closes the client if still open.
+     */
+    ~JackBackend();
+
+    //--------------------------------------------------------------------------
+    // Stream Control
+    //--------------------------------------------------------------------------
+    /**
+     * Opens a client and registers ports. Does not start processing.
+     * @param clientName Name shown in the JACK/PipeWire graph
+     * @return true if the client was opened and ports registered
+     */
+    bool open(const std::string& clientName = "multiaudio");
+
+    /**
+     * Replaces the chain run in the process callback, e.g. with one built
+     * for the server's rate after open(). Must not be called while running.
+     * @param effectChain Chain to run from start() on
+     */
+    void setChain(EffectChain& effectChain);
+
+    /**
+     * Activates the client and connects to physical ports.
+     * @return false if the chain is not built for the server's sample rate,
+     *         or the client could not be activated
+     */
+    bool start();
+
+    /**
+     * Deactivates and closes the client.
+     */
+    void stop();
+
+    /**
+     * Checks whether the server is still serving this client.
+     * @return false after stop(), if the server shut down or if it left
+     *         the chain's sample rate
+     */
+    bool isRunning() const;
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the sample rate chosen by the server, following any change.
+     * @return Sample rate in Hz, or 0 if not open
+     */
+    unsigned int getSampleRate() const;
+
+    /**
+     * Gets the chain run in the process callback.
+     */
+    const EffectChain& getChain() const { return *chain; }
+
+    /**
+     * Gets the current period size.
+     * @return Frames per process callback
+     */
+    unsigned int getBufferSize() const;
+
+    /**
+     * Gets the number of xruns reported by the server since open().
+     * @return Xrun count
+     */
+    unsigned long getXrunCount() const;
+
+    //--------------------------------------------------------------------------
+    // Object Semantics
+    //--------------------------------------------------------------------------
+    JackBackend(const JackBackend&) = delete;
+    JackBackend& operator=(const JackBackend&) = delete;
+};
+
+#endif // MULTIAUDIO_WITH_JACK
+
+} // namespace audio
+
+#endif // JACK_BACKEND_H
@@ -0,0 +1,207 @@
+#include "JitterBuffer.h"
+
+#include <algorithm>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+JitterBuffer::JitterBuffer(unsigned int channels, unsigned int packetFrames,
+                           std::size_t capacityPackets, unsigned int targetDepthPackets)
+    : numChannels(std::max(1u, channels)),
+      framesPerPacket(std::max(1u, packetFrames)),
+      readSequence(0),
+      highestSequence(0),
+      primed(false),
+      readOffset(0),
+      packetsReceived(0),
+      packetsLate(0),
+      packetsDropped(0),
+      packetsLost(0),
+      underruns(0)
+{
+    // Power-of-two slot count so sequence -> slot is a mask
+    std::size_t capacity = 1;
+    while (capacity < std::max<std::size_t>(capacityPackets, 2))
+    {
+        capacity <<= 1;
+    }
+
+    slots = std::vector<Slot>(capacity);
+    slotMask = capacity - 1;
+    targetPackets = std::min<unsigned int>(std::max(1u, targetDepthPackets),
+                                           static_cast<unsigned int>(capacity / 2));
+
+    for (Slot& slot : slots)
+    {
+        slot.stamp.store(0);
+        slot.rtpTimestamp = 0;
+        slot.numFrames = 0;
+        slot.samples.assign(static_cast<std::size_t>(framesPerPacket) * numChannels, 0.0f);
+    }
+}
+
+//--------------------------------------------------------------------------
+// Producer Interface
+//--------------------------------------------------------------------------
+
+bool JitterBuffer::write(uint64_t sequence, uint32_t rtpTimestamp, const float* interleaved, std::size_t numFrames)
+{
+    uint64_t highest = highestSequence.load(std::memory_order_relaxed);
+    if (highest == 0)
+    {
+        // First packet defines where playout starts
+        readSequence.store(sequence, std::memory_order_release);
+    }
+
+    uint64_t reader = readSequence.load(std::memory_order_acquire);
+    if (sequence < reader)
+    {
+        packetsLate.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (sequence >= reader + slots.size())
+    {
+        // Producer is a full buffer ahead of playout
+        packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = slots[sequence & slotMask];
+    if (slot.stamp.load(std::memory_order_acquire) == sequence + 1)
+    {
+        // Duplicate
+        packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::size_t frames = std::min<std::size_t>(numFrames, framesPerPacket);
+    std::copy(interleaved, interleaved + frames * numChannels, slot.samples.begin());
+    slot.numFrames = static_cast<uint32_t>(frames);
+    slot.rtpTimestamp = rtpTimestamp;
+    slot.stamp.store(sequence + 1, std::memory_order_release);
+
+    if (sequence + 1 > highest)
+    {
+        highestSequence.store(sequence + 1, std::memory_order_release);
+    }
+    packetsReceived.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// Consumer Interface
+//--------------------------------------------------------------------------
+
+std::size_t JitterBuffer::read(float* interleaved, std::size_t numFrames)
+{
+    uint64_t sequence = readSequence.load(std::memory_order_acquire);
+
+    if (!primed.load(std::memory_order_relaxed))
+    {
+        uint64_t highest = highestSequence.load(std::memory_order_acquire);
+        sequence = readSequence.load(std::memory_order_acquire);
+        if (highest < sequence + targetPackets)
+        {
+            std::fill_n(interleaved, numFrames * numChannels, 0.0f);
+            return 0;
+        }
+        if (highest > sequence + targetPackets)
+        {
+            // Start playout at the target depth rather than wherever priming overshot
+            sequence = highest - targetPackets;
+            readSequence.store(sequence, std::memory_order_release);
+        }
+        primed.store(true, std::memory_order_relaxed);
+        readOffset = 0;
+    }
+
+    std::size_t produced = 0;
+    std::size_t received = 0;
+
+    while (produced < numFrames)
+    {
+        Slot& slot = slots[sequence & slotMask];
+        std::size_t remaining = numFrames - produced;
+        float* dest = interleaved + produced * numChannels;
+
+        if (slot.stamp.load(std::memory_order_acquire) == sequence + 1)
+        {
+            std::size_t n = std::min<std::size_t>(slot.numFrames - readOffset, remaining);
+            const float* src = slot.samples.data() + readOffset * numChannels;
+            std::copy(src, src + n * numChannels, dest);
+            produced += n;
+            received += n;
+            readOffset += n;
+
+            if (readOffset >= slot.numFrames)
+            {
+                slot.stamp.store(0, std::memory_order_release);
+                readOffset = 0;
+                readSequence.store(++sequence, std::memory_order_release);
+            }
+        }
+        else if (highestSequence.load(std::memory_order_acquire) > sequence + 1)
+        {
+            // A later packet arrived, so this one is lost: conceal a nominal packet
+            std::size_t n = std::min<std::size_t>(framesPerPacket - readOffset, remaining);
+            std::fill_n(dest, n * numChannels, 0.0f);
+            produced += n;
+            readOffset += n;
+
+            if (readOffset >= framesPerPacket)
+            {
+                packetsLost.fetch_add(1, std::memory_order_relaxed);
+                readOffset = 0;
+                readSequence.store(++sequence, std::memory_order_release);
+            }
+        }
+        else
+        {
+            // Starved: output silence and rebuild the playout depth
+            std::fill_n(dest, remaining * numChannels, 0.0f);
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            primed.store(false, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    return received;
+}
+
+void JitterBuffer::reset()
+{
+    for (Slot& slot : slots)
+    {
+        slot.stamp.store(0, std::memory_order_relaxed);
+    }
+    readOffset = 0;
+    primed.store(false);
+    readSequence.store(0);
+    highestSequence.store(0);
+}
+
+//--------------------------------------------------------------------------
+// Status
+//--------------------------------------------------------------------------
+
+double JitterBuffer::getDepthFrames() const
+{
+    uint64_t highest = highestSequence.load(std::memory_order_acquire);
+    uint64_t reader = readSequence.load(std::memory_order_acquire);
+    if (highest <= reader)
+    {
+        return 0.0;
+    }
+    double frames = static_cast<double>(highest - reader) * framesPerPacket;
+    return std::max(0.0, frames - static_cast<double>(readOffset));
+}
+
+double JitterBuffer::getTargetDepthFrames() const
+{
+    return static_cast<double>(targetPackets) * framesPerPacket;
+}
+
+} // namespace audio
@@ -0,0 +1,147 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include "../common.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Lock-free single-producer/single-consumer jitter buffer for packetised audio.
+ *
+ * The network thread writes packets into slots indexed by their extended
+ * sequence number; the processing thread reads samples back in sequence
+ * order. Reordered packets land in their slot and are consumed in order,
+ * late packets are dropped, and gaps are concealed with silence once a
+ * later packet proves the missing one is lost.
+ */
+class JitterBuffer
+{
+private:
+    //--------------------------------------------------------------------------
+    // Slot Storage
+    //--------------------------------------------------------------------------
+    struct Slot
+    {
+        std::atomic<uint64_t> stamp;   // extended sequence + 1, 0 when empty
+        uint32_t rtpTimestamp;
+        uint32_t numFrames;
+        std::vector<float> samples;    // interleaved, framesPerPacket * channels
+    };
+
+    std::vector<Slot> slots;
+    std::size_t slotMask;
+    unsigned int numChannels;
+    unsigned int framesPerPacket;
+    unsigned int targetPackets;
+
+    //--------------------------------------------------------------------------
+    // Shared Positions
+    //--------------------------------------------------------------------------
+    std::atomic<uint64_t> readSequence;    // next sequence the reader will consume
+    std::atomic<uint64_t> highestSequence; // highest sequence written + 1
+    std::atomic<bool> primed;              // reader has seen targetPackets buffered
+
+    //--------------------------------------------------------------------------
+    // Reader State
+    //--------------------------------------------------------------------------
+    std::size_t readOffset;                // frames already consumed from current slot
+
+    //--------------------------------------------------------------------------
+    // Statistics
+    //--------------------------------------------------------------------------
+    std::atomic<uint64_t> packetsReceived;
+    std::atomic<uint64_t> packetsLate;
+    std::atomic<uint64_t> packetsDropped;
+    std::atomic<uint64_t> packetsLost;
+    std::atomic<uint64_t> underruns;
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a jitter buffer.
+     *
+     * @param channels Interleaved channels per packet
+     * @param packetFrames Nominal frames per packet
+     * @param capacityPackets Slot count, rounded up to a power of two
+     * @param targetDepthPackets Packets to buffer before playout starts
+     */
+    JitterBuffer(unsigned int channels, unsigned int packetFrames,
+                 std::size_t capacityPackets = 64, unsigned int targetDepthPackets = 8);
+
+    //--------------------------------------------------------------------------
+    // Producer Interface (network thread)
+    //--------------------------------------------------------------------------
+    /**
+     * Stores one packet of interleaved samples.
+     *
+     * @param sequence Extended (monotonic, wrap-free) sequence number
+     * @param rtpTimestamp Media timestamp of the first frame
+     * @param interleaved Decoded samples
+     * @param numFrames Frames in the packet (at most the nominal packet size)
+     * @return false if the packet was late or too far ahead to store
+     */
+    bool write(uint64_t sequence, uint32_t rtpTimestamp, const float* interleaved, std::size_t numFrames);
+
+    //--------------------------------------------------------------------------
+    // Consumer Interface (processing thread)
+    //--------------------------------------------------------------------------
+    /**
+     * Reads interleaved frames in sequence order.
+     * Outputs silence while priming or when the producer has fallen behind.
+     *
+     * @param interleaved Destination (numFrames * channels)
+     * @param numFrames Frames to read
+     * @return Frames that carried received audio (the rest is concealment)
+     */
+    std::size_t read(float* interleaved, std::size_t numFrames);
+
+    /**
+     * Drops all buffered packets and restarts priming.
+     * Only call from the consumer while the producer is stopped.
+     */
+    void reset();
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the approximate number of buffered frames ahead of the reader.
+     * @return Buffered frames
+     */
+    double getDepthFrames() const;
+
+    /**
+     * Gets the playout depth the buffer primes to.
+     * @return Target depth in frames
+     */
+    double getTargetDepthFrames() const;
+
+    /**
+     * Checks whether playout has started (target depth was reached).
+     * @return false while priming or after an underrun
+     */
+    bool isPrimed() const { return primed.load(std::memory_order_relaxed); }
+
+    unsigned int getChannels() const { return numChannels; }
+    uint64_t getPacketsReceived() const { return packetsReceived.load(); }
+    uint64_t getPacketsLate() const { return packetsLate.load(); }
+    uint64_t getPacketsDropped() const { return packetsDropped.load(); }
+    uint64_t getPacketsLost() const { return packetsLost.load(); }
+    uint64_t getUnderruns() const { return underruns.load(); }
+
+    //--------------------------------------------------------------------------
+    // Object Semantics
+    //--------------------------------------------------------------------------
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator=(const JitterBuffer&) = delete;
+};
+
+} // namespace audio
+
+#endif // JITTER_BUFFER_H
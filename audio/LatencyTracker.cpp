@@ -0,0 +1,161 @@
+#include "LatencyTracker.h"
+
+namespace audio {
+
+namespace {
+
+// Single writer: plain load/store pairs instead of read-modify-write
+inline void addRelaxed(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+LatencyTracker::LatencyTracker()
+    : started(false),
+      nextSequence(0),
+      blocks(0),
+      timedBlocks(0),
+      dropped(0),
+      reordered(0),
+      lastLatencyNanos(0),
+      minLatencyNanos(UINT64_MAX),
+      maxLatencyNanos(0),
+      totalLatencyNanos(0)
+{
+    for (auto& total : stageTotalNanos)
+    {
+        total.store(0, std::memory_order_relaxed);
+    }
+    for (auto& count : histogram)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyTracker::reset()
+{
+    started = false;
+    nextSequence = 0;
+    blocks.store(0, std::memory_order_relaxed);
+    timedBlocks.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    reordered.store(0, std::memory_order_relaxed);
+    lastLatencyNanos.store(0, std::memory_order_relaxed);
+    minLatencyNanos.store(UINT64_MAX, std::memory_order_relaxed);
+    maxLatencyNanos.store(0, std::memory_order_relaxed);
+    totalLatencyNanos.store(0, std::memory_order_relaxed);
+    for (auto& total : stageTotalNanos)
+    {
+        total.store(0, std::memory_order_relaxed);
+    }
+    for (auto& count : histogram)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+//--------------------------------------------------------------------------
+// Recording
+//--------------------------------------------------------------------------
+
+void LatencyTracker::record(const BlockHeader& header)
+{
+    // Sequence integrity: a jump forward means blocks were lost, a step back means reordering
+    if (!started || header.sequence == nextSequence)
+    {
+        started = true;
+        nextSequence = header.sequence + 1;
+    }
+    else if (header.sequence > nextSequence)
+    {
+        addRelaxed(dropped, header.sequence - nextSequence);
+        nextSequence = header.sequence + 1;
+    }
+    else
+    {
+        // Counted as dropped when it was skipped; it arrived after all
+        addRelaxed(reordered, 1);
+        if (dropped.load(std::memory_order_relaxed) > 0)
+        {
+            dropped.store(dropped.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        }
+    }
+    addRelaxed(blocks, 1);
+
+    const uint64_t capture = header.at(BlockStage::Capture);
+    const uint64_t playout = header.at(BlockStage::Playout);
+    if (capture == 0 || playout < capture)
+    {
+        return;
+    }
+
+    const uint64_t latency = playout - capture;
+    addRelaxed(timedBlocks, 1);
+    lastLatencyNanos.store(latency, std::memory_order_relaxed);
+    addRelaxed(totalLatencyNanos, latency);
+    if (latency < minLatencyNanos.load(std::memory_order_relaxed))
+    {
+        minLatencyNanos.store(latency, std::memory_order_relaxed);
+    }
+    if (latency > maxLatencyNanos.load(std::memory_order_relaxed))
+    {
+        maxLatencyNanos.store(latency, std::memory_order_relaxed);
+    }
+
+    std::size_t bucket = 0;
+    for (uint64_t micros = (latency / 1000) >> 1; micros != 0 && bucket + 1 < LATENCY_HISTOGRAM_BUCKETS; micros >>= 1)
+    {
+        ++bucket;
+    }
+    addRelaxed(histogram[bucket], 1);
+
+    for (std::size_t s = 1; s < BLOCK_STAGE_COUNT; ++s)
+    {
+        const uint64_t previous = header.stageNanos[s - 1];
+        const uint64_t current = header.stageNanos[s];
+        if (previous != 0 && current >= previous)
+        {
+            addRelaxed(stageTotalNanos[s], current - previous);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// Statistics
+//--------------------------------------------------------------------------
+
+double LatencyTracker::getMinLatencyMs() const
+{
+    const uint64_t minimum = minLatencyNanos.load(std::memory_order_relaxed);
+    return minimum == UINT64_MAX ? 0.0 : minimum * 1e-6;
+}
+
+double LatencyTracker::getMeanLatencyMs() const
+{
+    const uint64_t count = timedBlocks.load(std::memory_order_relaxed);
+    return count ? totalLatencyNanos.load(std::memory_order_relaxed) * 1e-6 / count : 0.0;
+}
+
+double LatencyTracker::getMeanStageMs(BlockStage stage) const
+{
+    const uint64_t count = timedBlocks.load(std::memory_order_relaxed);
+    const std::size_t index = static_cast<std::size_t>(stage);
+    if (count == 0 || index >= BLOCK_STAGE_COUNT)
+    {
+        return 0.0;
+    }
+    return stageTotalNanos[index].load(std::memory_order_relaxed) * 1e-6 / count;
+}
+
+uint64_t LatencyTracker::getHistogramCount(std::size_t bucket) const
+{
+    return bucket < LATENCY_HISTOGRAM_BUCKETS ? histogram[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+} // namespace audio
@@ -0,0 +1,104 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include "BlockHeader.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace audio {
+
+constexpr std::size_t LATENCY_HISTOGRAM_BUCKETS = 32;  // bucket b: [2^b, 2^(b+1)) microseconds
+
+/**
+ * Measures end-to-end latency and sequence integrity at the output.
+ *
+ * The output callback hands every block header it plays to record();
+ * capture-to-playout latency, the time spent in each stage and any gaps
+ * (drops) or out-of-order blocks are accumulated in relaxed atomics, so
+ * the GUI or a metrics exporter can read them from any thread without
+ * touching the audio thread.
+ */
+class LatencyTracker
+{
+private:
+    //--------------------------------------------------------------------------
+    // Writer State (output callback only)
+    //--------------------------------------------------------------------------
+    bool started;
+    uint64_t nextSequence;
+
+    //--------------------------------------------------------------------------
+    // Statistics
+    //--------------------------------------------------------------------------
+    std::atomic<uint64_t> blocks;
+    std::atomic<uint64_t> timedBlocks;         // blocks with capture and playout stamps
+    std::atomic<uint64_t> dropped;             // sequence numbers never played
+    std::atomic<uint64_t> reordered;           // blocks older than one already played
+    std::atomic<uint64_t> lastLatencyNanos;
+    std::atomic<uint64_t> minLatencyNanos;
+    std::atomic<uint64_t> maxLatencyNanos;
+    std::atomic<uint64_t> totalLatencyNanos;
+    std::atomic<uint64_t> stageTotalNanos[BLOCK_STAGE_COUNT];  // time from the previous stage
+    std::atomic<uint64_t> histogram[LATENCY_HISTOGRAM_BUCKETS];
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    LatencyTracker();
+
+    /**
+     * Clears all statistics and the expected sequence.
+     * Call only while no block is being recorded.
+     */
+    void reset();
+
+    //--------------------------------------------------------------------------
+    // Recording (output callback)
+    //--------------------------------------------------------------------------
+    /**
+     * Accounts for one played block. Never blocks or allocates.
+     * @param header Header popped with the block; its Playout stage should be stamped
+     */
+    void record(const BlockHeader& header);
+
+    //--------------------------------------------------------------------------
+    // Statistics (any thread)
+    //--------------------------------------------------------------------------
+    uint64_t getBlocks() const { return blocks.load(std::memory_order_relaxed); }
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t getReordered() const { return reordered.load(std::memory_order_relaxed); }
+    double getLastLatencyMs() const { return lastLatencyNanos.load(std::memory_order_relaxed) * 1e-6; }
+    double getMaxLatencyMs() const { return maxLatencyNanos.load(std::memory_order_relaxed) * 1e-6; }
+
+    /**
+     * Gets the lowest latency seen (0 before the first block).
+     */
+    double getMinLatencyMs() const;
+
+    /**
+     * Gets the mean capture-to-playout latency.
+     */
+    double getMeanLatencyMs() const;
+
+    /**
+     * Gets the mean time from the previous stage to this one (0 for Capture).
+     * @param stage Pipeline stage
+     */
+    double getMeanStageMs(BlockStage stage) const;
+
+    /**
+     * Gets the blocks whose latency fell in a log2 microsecond bucket.
+     * @param bucket Index below LATENCY_HISTOGRAM_BUCKETS
+     */
+    uint64_t getHistogramCount(std::size_t bucket) const;
+
+    LatencyTracker(const LatencyTracker&) = delete;
+    LatencyTracker& operator=(const LatencyTracker&) = delete;
+};
+
+} // namespace audio
+
+#endif // LATENCY_TRACKER_H
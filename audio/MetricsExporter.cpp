@@ -0,0 +1,196 @@
+#include "MetricsExporter.h"
+
+#ifdef __linux__
+
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace audio {
+
+namespace {
+
+const int POLL_INTERVAL_MS = 100;          // how often the serving thread observes stop()
+const std::size_t MAX_REQUEST_BYTES = 4096;
+
+// Sends the whole buffer; false if the peer went away
+bool sendAll(int fd, const char* data, std::size_t bytes)
+{
+    while (bytes > 0)
+    {
+        ssize_t sent = ::send(fd, data, bytes, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data += sent;
+        bytes -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+void sendResponse(int fd, const char* status, const char* contentType, const std::string& body)
+{
+    std::string response = std::string("HTTP/1.1 ") + status + "\r\n" +
+                           "Content-Type: " + contentType + "\r\n" +
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           "Connection: close\r\n\r\n" + body;
+    sendAll(fd, response.data(), response.size());
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& metrics, uint16_t port, const std::string& address)
+    : registry(metrics),
+      bindAddress(address),
+      requestedPort(port),
+      boundPort(0),
+      listenFd(-1),
+      serving(false),
+      scrapes(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+bool MetricsExporter::start()
+{
+    if (serving.load())
+    {
+        return true;
+    }
+
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(requestedPort);
+    if (::inet_pton(AF_INET, bindAddress.c_str(), &local.sin_addr) != 1)
+    {
+        std::cerr << "[Exporter] ERROR: Invalid bind address " << bindAddress << std::endl;
+        return false;
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        std::cerr << "[Exporter] ERROR: Failed to create socket." << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || ::listen(listenFd, 8) != 0)
+    {
+        std::cerr << "[Exporter] ERROR: Failed to listen on " << bindAddress << ":" << requestedPort << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(local);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&local), &length);
+    boundPort.store(ntohs(local.sin_port));
+
+    serving.store(true);
+    serveThread = std::thread(&MetricsExporter::serveLoop, this);
+    return true;
+}
+
+void MetricsExporter::stop()
+{
+    serving.store(false);
+    if (serveThread.joinable())
+    {
+        serveThread.join();
+    }
+    if (listenFd >= 0)
+    {
+        ::close(listenFd);
+        listenFd = -1;
+    }
+}
+
+//--------------------------------------------------------------------------
+// Serving
+//--------------------------------------------------------------------------
+
+void MetricsExporter::serveLoop()
+{
+    while (serving.load())
+    {
+        pollfd listener = { listenFd, POLLIN, 0 };
+        if (::poll(&listener, 1, POLL_INTERVAL_MS) <= 0)
+        {
+            continue;
+        }
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0)
+        {
+            continue;
+        }
+
+        // A stalled client must not hold the exporter forever
+        timeval timeout = {1, 0};
+        setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handleConnection(clientFd);
+        ::close(clientFd);
+    }
+}
+
+void MetricsExporter::handleConnection(int clientFd)
+{
+    // Only the request line matters; read until it is complete
+    std::string request;
+    char chunk[512];
+    while (request.find("\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES)
+    {
+        ssize_t received = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+        {
+            return;
+        }
+        request.append(chunk, static_cast<std::size_t>(received));
+    }
+
+    const std::size_t methodEnd = request.find(' ');
+    const std::size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : request.find(' ', methodEnd + 1);
+    if (pathEnd == std::string::npos)
+    {
+        sendResponse(clientFd, "400 Bad Request", "text/plain", "bad request\n");
+        return;
+    }
+    const std::string method = request.substr(0, methodEnd);
+    std::string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+
+    if (method != "GET")
+    {
+        sendResponse(clientFd, "405 Method Not Allowed", "text/plain", "only GET is supported\n");
+    }
+    else if (path == "/metrics")
+    {
+        scrapes.fetch_add(1, std::memory_order_relaxed);
+        sendResponse(clientFd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", registry.renderPrometheus());
+    }
+    else
+    {
+        sendResponse(clientFd, "404 Not Found", "text/plain", "see /metrics\n");
+    }
+}
+
+} // namespace audio
+
+#endif // __linux__
@@ -0,0 +1,70 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include "MetricsRegistry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace audio {
+
+/**
+ * Serves a MetricsRegistry over HTTP for Prometheus-style scrapers.
+ *
+ * One background thread accepts connections and answers GET /metrics
+ * with the registry in text exposition format; any other path gets 404.
+ * Requests are handled one at a time, which is plenty for a scraper and
+ * keeps the exporter to a single thread that never touches audio state
+ * except through the registry's readers. Linux only.
+ */
+class MetricsExporter
+{
+private:
+    const MetricsRegistry& registry;
+    std::string bindAddress;
+    uint16_t requestedPort;
+    std::atomic<uint16_t> boundPort;
+    int listenFd;
+    std::atomic<bool> serving;
+    std::atomic<uint64_t> scrapes;
+    std::thread serveThread;
+
+    void serveLoop();
+    void handleConnection(int clientFd);
+
+public:
+    /**
+     * Creates an exporter; nothing is opened until start().
+     *
+     * @param metrics Registry to serve (must outlive the exporter)
+     * @param port TCP port, 0 for any free port (see getPort())
+     * @param address Interface to bind (default: loopback only)
+     */
+    MetricsExporter(const MetricsRegistry& metrics, uint16_t port, const std::string& address = "127.0.0.1");
+
+    ~MetricsExporter();
+
+    /**
+     * Binds the port and starts the serving thread.
+     * @return false if the socket cannot be bound
+     */
+    bool start();
+
+    /**
+     * Stops serving and closes the socket.
+     */
+    void stop();
+
+    bool isServing() const { return serving.load(); }
+    uint16_t getPort() const { return boundPort.load(); }
+    uint64_t getScrapes() const { return scrapes.load(std::memory_order_relaxed); }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+};
+
+} // namespace audio
+
+#endif // METRICS_EXPORTER_H
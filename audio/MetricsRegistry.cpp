@@ -0,0 +1,153 @@
+#include "MetricsRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace audio {
+
+namespace {
+
+const char* kindName(MetricKind kind)
+{
+    switch (kind)
+    {
+        case MetricKind::Counter: return "counter";
+        case MetricKind::Gauge: return "gauge";
+        case MetricKind::Histogram: return "histogram";
+    }
+    return "untyped";
+}
+
+void appendValue(std::string& out, double value)
+{
+    char text[32];
+    if (std::isnan(value))
+    {
+        out += "NaN";
+    }
+    else if (std::isinf(value))
+    {
+        out += value > 0 ? "+Inf" : "-Inf";
+    }
+    else
+    {
+        std::snprintf(text, sizeof(text), "%.17g", value);
+        out += text;
+    }
+}
+
+// name{labels,extra} value
+void appendSample(std::string& out, const std::string& name, const std::string& labels,
+                  const std::string& extraLabel, double value)
+{
+    out += name;
+    if (!labels.empty() || !extraLabel.empty())
+    {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extraLabel.empty())
+        {
+            out += ',';
+        }
+        out += extraLabel;
+        out += '}';
+    }
+    out += ' ';
+    appendValue(out, value);
+    out += '\n';
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Registration
+//--------------------------------------------------------------------------
+
+void MetricsRegistry::addCounter(const std::string& name, const std::string& help, const std::string& labels,
+                                 ValueReader reader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.push_back({ name, help, labels, MetricKind::Counter, std::move(reader), nullptr });
+}
+
+void MetricsRegistry::addGauge(const std::string& name, const std::string& help, const std::string& labels,
+                               ValueReader reader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.push_back({ name, help, labels, MetricKind::Gauge, std::move(reader), nullptr });
+}
+
+void MetricsRegistry::addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                                   HistogramReader reader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.push_back({ name, help, labels, MetricKind::Histogram, nullptr, std::move(reader) });
+}
+
+void MetricsRegistry::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.clear();
+}
+
+//--------------------------------------------------------------------------
+// Rendering
+//--------------------------------------------------------------------------
+
+std::string MetricsRegistry::renderPrometheus() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    std::vector<bool> written(metrics.size(), false);
+    std::vector<HistogramBucket> buckets;
+
+    for (std::size_t first = 0; first < metrics.size(); ++first)
+    {
+        if (written[first])
+        {
+            continue;
+        }
+        const Metric& head = metrics[first];
+        out += "# HELP " + head.name + " " + head.help + "\n";
+        out += "# TYPE " + head.name + " " + kindName(head.kind) + "\n";
+
+        // Every metric with this name, in registration order
+        for (std::size_t i = first; i < metrics.size(); ++i)
+        {
+            const Metric& metric = metrics[i];
+            if (written[i] || metric.name != head.name)
+            {
+                continue;
+            }
+            written[i] = true;
+
+            if (metric.kind != MetricKind::Histogram)
+            {
+                appendSample(out, metric.name, metric.labels, "", metric.value());
+                continue;
+            }
+
+            buckets.clear();
+            double sum = 0.0;
+            uint64_t count = 0;
+            metric.histogram(buckets, sum, count);
+            uint64_t cumulative = 0;
+            for (const HistogramBucket& bucket : buckets)
+            {
+                cumulative += bucket.count;
+                std::string bound = "le=\"";
+                appendValue(bound, bucket.upperBound);
+                bound += '"';
+                appendSample(out, metric.name + "_bucket", metric.labels, bound, static_cast<double>(cumulative));
+            }
+            count = std::max(count, cumulative);
+            appendSample(out, metric.name + "_bucket", metric.labels, "le=\"+Inf\"", static_cast<double>(count));
+            appendSample(out, metric.name + "_sum", metric.labels, "", sum);
+            appendSample(out, metric.name + "_count", metric.labels, "", static_cast<double>(count));
+        }
+    }
+    return out;
+}
+
+} // namespace audio
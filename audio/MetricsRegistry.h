@@ -0,0 +1,100 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Kind of an exported metric (Prometheus semantics).
+ */
+enum class MetricKind
+{
+    Counter,        // monotonically increasing total
+    Gauge,          // current value
+    Histogram       // bucketed distribution with sum and count
+};
+
+/**
+ * One histogram bucket: inclusive upper bound and the count in it alone
+ * (not cumulative; the registry accumulates when rendering).
+ */
+struct HistogramBucket
+{
+    double upperBound = 0.0;
+    uint64_t count = 0;
+};
+
+/**
+ * Live engine metrics, read on demand.
+ *
+ * Each metric is a reader function registered once at startup; readers
+ * load the relaxed atomics the audio threads already maintain, so
+ * rendering never takes a lock the audio thread uses. Only the metric
+ * list itself is guarded, and the audio thread never touches it.
+ */
+class MetricsRegistry
+{
+public:
+    using ValueReader = std::function<double()>;
+    using HistogramReader = std::function<void(std::vector<HistogramBucket>& buckets, double& sum, uint64_t& count)>;
+
+private:
+    struct Metric
+    {
+        std::string name;
+        std::string help;
+        std::string labels;         // e.g. stage="EQ", empty for none
+        MetricKind kind;
+        ValueReader value;
+        HistogramReader histogram;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Metric> metrics;
+
+public:
+    /**
+     * Registers a monotonically increasing total.
+     *
+     * @param name Metric name, e.g. multiaudio_xruns_total
+     * @param help One-line description
+     * @param labels Label set without braces (e.g. backend="jack"), or empty
+     * @param reader Returns the current total
+     */
+    void addCounter(const std::string& name, const std::string& help, const std::string& labels, ValueReader reader);
+
+    /**
+     * Registers a value that can go up and down.
+     * Parameters as for addCounter().
+     */
+    void addGauge(const std::string& name, const std::string& help, const std::string& labels, ValueReader reader);
+
+    /**
+     * Registers a distribution.
+     * Parameters as for addCounter(); the reader fills finite buckets in ascending order,
+     * the sum and the total count (observations above the last bucket only reach +Inf).
+     */
+    void addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                      HistogramReader reader);
+
+    /**
+     * Removes every metric (e.g. before the objects they read are destroyed).
+     */
+    void clear();
+
+    /**
+     * Reads every metric and formats it in the Prometheus text exposition format (0.0.4).
+     * Metrics sharing a name are grouped under one HELP/TYPE header.
+     */
+    std::string renderPrometheus() const;
+};
+
+} // namespace audio
+
+#endif // METRICS_REGISTRY_H
@@ -0,0 +1,178 @@
+#ifndef PARAMETER_EVENT_H
+#define PARAMETER_EVENT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Parameter Events
+//--------------------------------------------------------------------------
+
+/**
+ * Every automatable setting of the effect chain.
+ */
+enum class ParameterId : uint16_t
+{
+    GateEnabled,
+    GateThreshold,
+    GateAttack,             // ms
+    GateRelease,            // ms
+    EQEnabled,
+    EQLowGain,
+    EQMidGain,
+    EQHighGain,
+    LimiterEnabled,
+    LimiterThreshold,
+    LimiterAttack,          // ms
+    LimiterRelease,         // ms
+    DeEsserEnabled,
+    DeEsserReduction,       // dB
+    DeEsserStartFreq,       // Hz
+    DeEsserEndFreq,         // Hz
+    Count
+};
+
+constexpr std::size_t PARAMETER_ID_COUNT = static_cast<std::size_t>(ParameterId::Count);
+
+/**
+ * Checks whether a parameter switches a stage in or out. These change the
+ * chain's routing and latency, so they take effect at the start of the
+ * block they fall in rather than mid-block.
+ */
+constexpr bool isRoutingParameter(ParameterId id)
+{
+    return id == ParameterId::GateEnabled || id == ParameterId::EQEnabled ||
+           id == ParameterId::LimiterEnabled || id == ParameterId::DeEsserEnabled;
+}
+
+/**
+ * The values a parameter accepts (the range of its GUI control).
+ */
+struct ParameterRange
+{
+    float minimum;
+    float maximum;
+};
+
+/**
+ * Gets the range of a parameter's values.
+ */
+constexpr ParameterRange parameterRange(ParameterId id)
+{
+    switch (id)
+    {
+        case ParameterId::GateAttack:
+        case ParameterId::LimiterAttack: return { 0.1f, 50.0f };
+        case ParameterId::GateRelease:
+        case ParameterId::LimiterRelease: return { 1.0f, 500.0f };
+        case ParameterId::EQLowGain:
+        case ParameterId::EQMidGain:
+        case ParameterId::EQHighGain: return { 0.0f, 6.0f };
+        case ParameterId::DeEsserReduction: return { 0.0f, 30.0f };
+        case ParameterId::DeEsserStartFreq: return { 2000.0f, 10000.0f };
+        case ParameterId::DeEsserEndFreq: return { 3000.0f, 12000.0f };
+        default: return { 0.0f, 1.0f };     // toggles and thresholds
+    }
+}
+
+/**
+ * Clamps a value into its parameter's range. Values from control surfaces
+ * and recordings are untrusted, so every effect clamps what it applies.
+ * @return false if the value is NaN or infinite and must be dropped
+ */
+inline bool clampParameter(ParameterId id, float& value)
+{
+    if (!std::isfinite(value))
+    {
+        return false;
+    }
+    const ParameterRange range = parameterRange(id);
+    value = std::max(range.minimum, std::min(range.maximum, value));
+    return true;
+}
+
+/**
+ * A parameter change at a point in the stream.
+ */
+struct ParameterEvent
+{
+    uint64_t frame = 0;             // stream position it takes effect at (earlier: as soon as possible)
+    ParameterId id = ParameterId::Count;
+    float value = 0.0f;             // booleans as 0 / 1
+};
+
+//--------------------------------------------------------------------------
+// Block Events
+//--------------------------------------------------------------------------
+
+/**
+ * The events that fall inside one block, in stream order.
+ *
+ * Effects take one with their block and apply each event at its offset:
+ * per-sample effects split the block there (split()); STFT effects apply
+ * the events before each frame that ends after them (applyBefore()), since
+ * a frame is the finest step their settings have.
+ */
+struct BlockEvents
+{
+    const ParameterEvent* events = nullptr;
+    std::size_t count = 0;
+    uint64_t blockStart = 0;        // stream position of the block's first frame
+
+    /**
+     * Gets an event's offset into the block (0 for events already due).
+     */
+    std::size_t offsetOf(std::size_t index) const
+    {
+        const uint64_t frame = events[index].frame;
+        return frame > blockStart ? static_cast<std::size_t>(frame - blockStart) : 0;
+    }
+
+    /**
+     * Applies the events from next on whose offset is below end.
+     * @param next Index of the first event not yet applied
+     * @param end Block offset to apply up to (exclusive)
+     * @param apply Called as apply(event)
+     * @return Index of the first event not applied
+     */
+    template <typename Apply>
+    std::size_t applyBefore(std::size_t next, std::size_t end, Apply&& apply) const
+    {
+        while (next < count && offsetOf(next) < end)
+        {
+            apply(events[next]);
+            ++next;
+        }
+        return next;
+    }
+
+    /**
+     * Runs a block in segments split at the event offsets, applying each
+     * event before the segment it starts.
+     * @param numFrames Block length
+     * @param apply Called as apply(event)
+     * @param process Called as process(from, to) for each segment
+     */
+    template <typename Apply, typename Process>
+    void split(std::size_t numFrames, Apply&& apply, Process&& process) const
+    {
+        std::size_t next = 0;
+        std::size_t from = 0;
+        while (from < numFrames)
+        {
+            next = applyBefore(next, from + 1, apply);
+            const std::size_t to = (next < count) ? std::min(numFrames, offsetOf(next)) : numFrames;
+            process(from, to);
+            from = to;
+        }
+        applyBefore(next, static_cast<std::size_t>(-1), apply);
+    }
+};
+
+} // namespace audio
+
+#endif // PARAMETER_EVENT_H
@@ -0,0 +1,212 @@
+#include "ParameterQueue.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Parameter Names
+//--------------------------------------------------------------------------
+
+namespace {
+
+const char* const PARAMETER_NAMES[PARAMETER_ID_COUNT] = {
+    "gate.enabled",
+    "gate.threshold",
+    "gate.attack_ms",
+    "gate.release_ms",
+    "eq.enabled",
+    "eq.low_gain",
+    "eq.mid_gain",
+    "eq.high_gain",
+    "limiter.enabled",
+    "limiter.threshold",
+    "limiter.attack_ms",
+    "limiter.release_ms",
+    "deesser.enabled",
+    "deesser.reduction_db",
+    "deesser.start_hz",
+    "deesser.end_hz"
+};
+
+} // namespace
+
+const char* parameterName(ParameterId id)
+{
+    const std::size_t index = static_cast<std::size_t>(id);
+    return index < PARAMETER_ID_COUNT ? PARAMETER_NAMES[index] : "unknown";
+}
+
+bool parameterFromName(const std::string& name, ParameterId& id)
+{
+    for (std::size_t i = 0; i < PARAMETER_ID_COUNT; ++i)
+    {
+        if (name == PARAMETER_NAMES[i])
+        {
+            id = static_cast<ParameterId>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+//--------------------------------------------------------------------------
+// Parameter Queue
+//--------------------------------------------------------------------------
+
+ParameterQueue::ParameterQueue(std::size_t capacity)
+    : ring(capacity),
+      dropped(0)
+{
+}
+
+bool ParameterQueue::post(ParameterId id, float value, uint64_t frame)
+{
+    ParameterEvent event;
+    event.frame = frame;
+    event.id = id;
+    event.value = value;
+    return post(event);
+}
+
+bool ParameterQueue::post(const ParameterEvent& event)
+{
+    if (!ring.push(event))
+    {
+        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+std::size_t ParameterQueue::take(uint64_t endFrame, ParameterEvent* events, std::size_t capacity)
+{
+    std::size_t count = 0;
+    while (count < capacity)
+    {
+        const ParameterEvent* event = ring.front();
+        if (!event || event->frame >= endFrame)
+        {
+            break;
+        }
+        events[count++] = *event;
+        ring.pop();
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------
+// Parameter Recorder
+//--------------------------------------------------------------------------
+
+ParameterRecorder::ParameterRecorder(std::size_t capacity)
+    : ring(capacity),
+      dropped(0)
+{
+}
+
+void ParameterRecorder::capture(const ParameterEvent& event)
+{
+    if (!ring.push(event))
+    {
+        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void ParameterRecorder::collect()
+{
+    ParameterEvent event;
+    while (ring.pop(event))
+    {
+        events.push_back(event);
+    }
+}
+
+bool ParameterRecorder::save(const std::string& path)
+{
+    collect();
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "ParameterRecorder: cannot write " << path << std::endl;
+        return false;
+    }
+    file << "# multiaudio automation: frame parameter value\n";
+    file.precision(9);
+    for (const ParameterEvent& event : events)
+    {
+        file << event.frame << ' ' << parameterName(event.id) << ' ' << event.value << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+//--------------------------------------------------------------------------
+// Parameter Player
+//--------------------------------------------------------------------------
+
+ParameterPlayer::ParameterPlayer()
+    : next(0)
+{
+}
+
+bool ParameterPlayer::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "ParameterPlayer: cannot read " << path << std::endl;
+        return false;
+    }
+
+    std::vector<ParameterEvent> loaded;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        ParameterEvent event;
+        std::string name;
+        if (!(fields >> event.frame >> name >> event.value) || !parameterFromName(name, event.id))
+        {
+            std::cerr << "ParameterPlayer: bad event on line " << lineNumber << " of " << path << std::endl;
+            return false;
+        }
+        loaded.push_back(event);
+    }
+    setEvents(loaded);
+    return true;
+}
+
+void ParameterPlayer::setEvents(const std::vector<ParameterEvent>& recorded)
+{
+    events = recorded;
+    std::stable_sort(events.begin(), events.end(), [](const ParameterEvent& a, const ParameterEvent& b) {
+        return a.frame < b.frame;
+    });
+    next = 0;
+}
+
+bool ParameterPlayer::feed(ParameterQueue& queue, uint64_t endFrame)
+{
+    while (next < events.size() && events[next].frame < endFrame)
+    {
+        // Only this side fills the queue, so room seen here is still there to post into
+        if (queue.pending() >= queue.capacity())
+        {
+            return false;
+        }
+        queue.post(events[next]);
+        ++next;
+    }
+    return true;
+}
+
+} // namespace audio
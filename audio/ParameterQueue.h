@@ -0,0 +1,196 @@
+#ifndef PARAMETER_QUEUE_H
+#define PARAMETER_QUEUE_H
+
+#include "ParameterEvent.h"
+#include "SpscRingBuffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Parameter Names
+//--------------------------------------------------------------------------
+
+/**
+ * Gets the name a parameter is saved under (e.g. "eq.low_gain").
+ */
+const char* parameterName(ParameterId id);
+
+/**
+ * Looks a parameter up by its saved name.
+ * @return false if no parameter has that name
+ */
+bool parameterFromName(const std::string& name, ParameterId& id);
+
+//--------------------------------------------------------------------------
+// Parameter Queue
+//--------------------------------------------------------------------------
+
+/**
+ * Timestamped parameter changes from a control thread to one stream.
+ *
+ * Lock-free single producer (the GUI, or a ParameterPlayer) and single
+ * consumer (the thread running the stream's EffectChain). Events must be
+ * posted in stream order; the chain takes the ones due in each block and
+ * its effects apply them at their offsets.
+ */
+class ParameterQueue
+{
+private:
+    SpscRingBuffer<ParameterEvent> ring;
+    std::atomic<uint64_t> dropped;
+
+public:
+    /**
+     * @param capacity Events that can be pending at once
+     */
+    explicit ParameterQueue(std::size_t capacity = 256);
+
+    //--------------------------------------------------------------------------
+    // Producer Interface
+    //--------------------------------------------------------------------------
+    /**
+     * Posts a change.
+     * @param id Parameter to change
+     * @param value New value
+     * @param frame Stream position to apply it at (0: at the next block)
+     * @return false if the queue is full (the event is dropped and counted)
+     */
+    bool post(ParameterId id, float value, uint64_t frame = 0);
+
+    /**
+     * Posts an event.
+     * @return false if the queue is full
+     */
+    bool post(const ParameterEvent& event);
+
+    //--------------------------------------------------------------------------
+    // Consumer Interface
+    //--------------------------------------------------------------------------
+    /**
+     * Takes the events due before a stream position, oldest first.
+     * @param endFrame Stream position just past the block
+     * @param events Receives the events
+     * @param capacity Room in events; further due events wait for the next call
+     * @return Number of events taken
+     */
+    std::size_t take(uint64_t endFrame, ParameterEvent* events, std::size_t capacity);
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    std::size_t pending() const { return ring.size(); }
+    std::size_t capacity() const { return ring.capacity(); }
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    ParameterQueue(const ParameterQueue&) = delete;
+    ParameterQueue& operator=(const ParameterQueue&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// Recording and Playback
+//--------------------------------------------------------------------------
+
+/**
+ * Captures the parameter events a chain applies, at the stream position
+ * each one actually took effect, so a render can be reproduced later.
+ *
+ * The chain hands events over through a lock-free ring (capture() is
+ * real-time safe); a control thread moves them into the recording with
+ * collect() and saves it.
+ */
+class ParameterRecorder
+{
+private:
+    SpscRingBuffer<ParameterEvent> ring;
+    std::vector<ParameterEvent> events;
+    std::atomic<uint64_t> dropped;
+
+public:
+    /**
+     * @param capacity Events the ring holds between collect() calls
+     */
+    explicit ParameterRecorder(std::size_t capacity = 1024);
+
+    /**
+     * Hands one applied event over. Audio thread; never blocks or allocates.
+     */
+    void capture(const ParameterEvent& event);
+
+    /**
+     * Moves captured events into the recording. Control thread; allocates.
+     */
+    void collect();
+
+    /**
+     * Writes the recording as text, one "frame name value" line per event.
+     * Collects first.
+     * @return false if the file could not be written
+     */
+    bool save(const std::string& path);
+
+    /**
+     * Gets the events collected so far.
+     */
+    const std::vector<ParameterEvent>& getEvents() const { return events; }
+
+    /**
+     * Gets the events lost because the ring was full.
+     */
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    ParameterRecorder(const ParameterRecorder&) = delete;
+    ParameterRecorder& operator=(const ParameterRecorder&) = delete;
+};
+
+/**
+ * Replays recorded parameter events into a queue, ahead of the blocks they
+ * fall in, so an offline render applies them at the same stream positions
+ * as the run that was recorded.
+ */
+class ParameterPlayer
+{
+private:
+    std::vector<ParameterEvent> events;
+    std::size_t next;
+
+public:
+    ParameterPlayer();
+
+    /**
+     * Reads a recording written by ParameterRecorder::save().
+     * @return false if the file could not be read or a line is malformed
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Replaces the events to play (sorted into stream order) and rewinds.
+     */
+    void setEvents(const std::vector<ParameterEvent>& recorded);
+
+    /**
+     * Posts every event before a stream position not posted yet.
+     * Call before the block ending at endFrame is processed.
+     * @param queue Queue of the chain rendering the stream
+     * @param endFrame Stream position just past the next block
+     * @return false if the queue filled up (the rest is posted next call)
+     */
+    bool feed(ParameterQueue& queue, uint64_t endFrame);
+
+    /**
+     * Starts playback from the first event again.
+     */
+    void rewind() { next = 0; }
+
+    bool isFinished() const { return next >= events.size(); }
+    const std::vector<ParameterEvent>& getEvents() const { return events; }
+};
+
+} // namespace audio
+
+#endif // PARAMETER_QUEUE_H
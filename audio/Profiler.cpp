@@ -0,0 +1,302 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace audio {
+
+namespace {
+
+const char* const STAGE_NAMES[PROFILE_STAGE_COUNT] = {
+    "Chain", "NoiseGate", "GateFFT", "GateRamp",
+    "EQ", "EQWindow", "EQForwardFFT", "EQGain", "EQInverseFFT", "EQOverlapAdd",
+    "DeEsser", "Limiter", "SideChain", "VoiceActivity", "EchoCanceller"
+};
+
+const ProfileStage STAGE_PARENTS[PROFILE_STAGE_COUNT] = {
+    ProfileStage::Chain, ProfileStage::Chain, ProfileStage::NoiseGate, ProfileStage::NoiseGate,
+    ProfileStage::Chain, ProfileStage::EQ, ProfileStage::EQ, ProfileStage::EQ, ProfileStage::EQ, ProfileStage::EQ,
+    ProfileStage::Chain, ProfileStage::Chain, ProfileStage::Chain, ProfileStage::Chain, ProfileStage::Chain
+};
+
+std::size_t roundUpPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Tick value at which the given fraction of calls has completed
+double histogramPercentile(const ThreadProfile::StageCounters& counters, uint64_t calls, double fraction)
+{
+    const uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(calls));
+    uint64_t seen = 0;
+    for (std::size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; ++b)
+    {
+        seen += counters.histogram[b].load(std::memory_order_relaxed);
+        if (seen > target)
+        {
+            // Geometric midpoint of [2^b, 2^(b+1))
+            return b == 0 ? 1.0 : static_cast<double>(1ull << b) * 1.41421356;
+        }
+    }
+    return 0.0;
+}
+
+// Stage path from Chain down, e.g. "Chain;EQ;EQGain"
+std::string stagePath(ProfileStage stage)
+{
+    std::string path = profileStageName(stage);
+    while (stage != ProfileStage::Chain)
+    {
+        stage = profileStageParent(stage);
+        path = std::string(profileStageName(stage)) + ";" + path;
+    }
+    return path;
+}
+
+} // namespace
+
+const char* profileStageName(ProfileStage stage)
+{
+    const std::size_t index = static_cast<std::size_t>(stage);
+    return index < PROFILE_STAGE_COUNT ? STAGE_NAMES[index] : "?";
+}
+
+ProfileStage profileStageParent(ProfileStage stage)
+{
+    const std::size_t index = static_cast<std::size_t>(stage);
+    return index < PROFILE_STAGE_COUNT ? STAGE_PARENTS[index] : ProfileStage::Chain;
+}
+
+//--------------------------------------------------------------------------
+// ThreadProfile
+//--------------------------------------------------------------------------
+
+ThreadProfile::ThreadProfile(const std::string& threadName, std::size_t eventCapacity)
+    : name(threadName),
+      enabled(true),
+      events(new Event[roundUpPowerOfTwo(std::max<std::size_t>(eventCapacity, 1))]),
+      eventMask(roundUpPowerOfTwo(std::max<std::size_t>(eventCapacity, 1)) - 1),
+      eventHead(0)
+{
+}
+
+void ThreadProfile::reset()
+{
+    for (StageCounters& counters : stages)
+    {
+        counters.calls.store(0, std::memory_order_relaxed);
+        counters.totalTicks.store(0, std::memory_order_relaxed);
+        counters.maxTicks.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& slot : counters.histogram)
+        {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+    eventHead.store(0, std::memory_order_release);
+}
+
+//--------------------------------------------------------------------------
+// Profiler
+//--------------------------------------------------------------------------
+
+ThreadProfile* Profiler::createProfile(const std::string& threadName, std::size_t eventCapacity)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    profiles.push_back(std::unique_ptr<ThreadProfile>(new ThreadProfile(threadName, eventCapacity)));
+    return profiles.back().get();
+}
+
+void Profiler::setEnabled(bool isEnabled)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& profile : profiles)
+    {
+        profile->setEnabled(isEnabled);
+    }
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& profile : profiles)
+    {
+        profile->reset();
+    }
+}
+
+std::vector<ThreadProfile*> Profiler::getProfiles() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ThreadProfile*> result;
+    for (const auto& profile : profiles)
+    {
+        result.push_back(profile.get());
+    }
+    return result;
+}
+
+std::vector<ProfileSummary> Profiler::summarize(const ThreadProfile& profile) const
+{
+    const double ticksPerMicro = ticksPerMicrosecond();
+    std::vector<ProfileSummary> result(PROFILE_STAGE_COUNT);
+
+    for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s)
+    {
+        const ThreadProfile::StageCounters& counters = profile.getStage(static_cast<ProfileStage>(s));
+        ProfileSummary& summary = result[s];
+        summary.calls = counters.calls.load(std::memory_order_relaxed);
+        summary.totalMicros = counters.totalTicks.load(std::memory_order_relaxed) / ticksPerMicro;
+        summary.maxMicros = counters.maxTicks.load(std::memory_order_relaxed) / ticksPerMicro;
+        if (summary.calls > 0)
+        {
+            summary.meanMicros = summary.totalMicros / static_cast<double>(summary.calls);
+            summary.p50Micros = histogramPercentile(counters, summary.calls, 0.50) / ticksPerMicro;
+            summary.p99Micros = histogramPercentile(counters, summary.calls, 0.99) / ticksPerMicro;
+        }
+        summary.selfMicros = summary.totalMicros;
+    }
+
+    // Self time: subtract each stage's total from its parent
+    for (std::size_t s = 1; s < PROFILE_STAGE_COUNT; ++s)
+    {
+        ProfileSummary& parent = result[static_cast<std::size_t>(profileStageParent(static_cast<ProfileStage>(s)))];
+        parent.selfMicros = std::max(0.0, parent.selfMicros - result[s].totalMicros);
+    }
+    return result;
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cerr << "[Profiler] ERROR: Cannot create " << path << std::endl;
+        return false;
+    }
+
+    const double ticksPerMicro = ticksPerMicrosecond();
+    const std::vector<ThreadProfile*> threads = getProfiles();
+
+    // Copy each ring, then drop anything the writer lapped while we copied
+    struct TraceEvent { uint64_t start; uint64_t duration; std::size_t stage; };
+    std::vector<std::vector<TraceEvent>> threadEvents(threads.size());
+    uint64_t origin = UINT64_MAX;
+    for (std::size_t t = 0; t < threads.size(); ++t)
+    {
+        const ThreadProfile& profile = *threads[t];
+        const uint64_t capacity = profile.getEventCapacity();
+        const uint64_t head = profile.getEventHead();
+        const uint64_t first = head > capacity ? head - capacity : 0;
+        std::vector<TraceEvent>& copied = threadEvents[t];
+        copied.reserve(static_cast<std::size_t>(head - first));
+        for (uint64_t i = first; i < head; ++i)
+        {
+            const ThreadProfile::Event& event = profile.getEvent(i);
+            const uint64_t packed = event.packed.load(std::memory_order_relaxed);
+            copied.push_back({ event.start.load(std::memory_order_relaxed), packed >> 8,
+                               static_cast<std::size_t>(packed & 0xFF) });
+        }
+        const uint64_t headAfter = profile.getEventHead();
+        const uint64_t validFrom = headAfter > capacity ? headAfter - capacity : 0;
+        if (validFrom > first)
+        {
+            copied.erase(copied.begin(), copied.begin() +
+                         static_cast<std::ptrdiff_t>(std::min<uint64_t>(validFrom - first, copied.size())));
+        }
+        for (const TraceEvent& event : copied)
+        {
+            origin = std::min(origin, event.start);
+        }
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    for (std::size_t t = 0; t < threads.size(); ++t)
+    {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                     first ? "" : ",\n", t + 1, threads[t]->getName().c_str());
+        first = false;
+        for (const TraceEvent& event : threadEvents[t])
+        {
+            if (event.stage >= PROFILE_STAGE_COUNT)
+            {
+                continue;
+            }
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"audio\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,"
+                         "\"ts\":%.3f,\"dur\":%.3f}",
+                         STAGE_NAMES[event.stage], t + 1, (event.start - origin) / ticksPerMicro,
+                         event.duration / ticksPerMicro);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    const bool ok = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !ok)
+    {
+        std::cerr << "[Profiler] ERROR: Failed writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Profiler::exportFoldedStacks(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cerr << "[Profiler] ERROR: Cannot create " << path << std::endl;
+        return false;
+    }
+
+    for (ThreadProfile* profile : getProfiles())
+    {
+        const std::vector<ProfileSummary> summary = summarize(*profile);
+        for (std::size_t s = 0; s < PROFILE_STAGE_COUNT; ++s)
+        {
+            const uint64_t selfNanos = static_cast<uint64_t>(summary[s].selfMicros * 1000.0 + 0.5);
+            if (selfNanos > 0)
+            {
+                std::fprintf(file, "%s;%s %llu\n", profile->getName().c_str(),
+                             stagePath(static_cast<ProfileStage>(s)).c_str(),
+                             static_cast<unsigned long long>(selfNanos));
+            }
+        }
+    }
+
+    const bool ok = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !ok)
+    {
+        std::cerr << "[Profiler] ERROR: Failed writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double Profiler::ticksPerMicrosecond()
+{
+#ifdef MULTIAUDIO_PROFILE_RDTSC
+    // Measure the TSC against the steady clock once, over ~20 ms
+    static const double rate = []
+    {
+        const auto wallStart = std::chrono::steady_clock::now();
+        const uint64_t tickStart = profileTicks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const uint64_t tickEnd = profileTicks();
+        const double micros = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - wallStart).count();
+        return micros > 0.0 ? static_cast<double>(tickEnd - tickStart) / micros : 1000.0;
+    }();
+    return rate;
+#else
+    return 1000.0;  // nanosecond ticks
+#endif
+}
+
+} // namespace audio
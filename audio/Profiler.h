@@ -0,0 +1,316 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MULTIAUDIO_PROFILE_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define MULTIAUDIO_PROFILE_RDTSC 1
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Stages
+//--------------------------------------------------------------------------
+
+/**
+ * Timed regions of the processing chain. Sub-stages nest inside their
+ * effect, which nests inside Chain (see profileStageParent()).
+ */
+enum class ProfileStage : uint8_t
+{
+    Chain,
+    NoiseGate,
+    GateFFT,        // forward FFT and band energies
+    GateRamp,       // attack/release gain ramp
+    EQ,
+    EQWindow,       // gather from the input ring with the analysis window
+    EQForwardFFT,
+    EQGain,
+    EQInverseFFT,
+    EQOverlapAdd,
+    DeEsser,
+    Limiter,        // with EQ and de-esser bypassed: the fused gate ramp and limiter pass
+    SideChain,      // decimated detector analysis shared by the gate and meters
+    VoiceActivity,  // voice activity features (and their own STFT when the gate has none)
+    EchoCanceller,  // partitioned-block adaptive filter against the fed-back output
+    Count
+};
+
+constexpr std::size_t PROFILE_STAGE_COUNT = static_cast<std::size_t>(ProfileStage::Count);
+constexpr std::size_t PROFILE_HISTOGRAM_BUCKETS = 48;  // bucket b: [2^b, 2^(b+1)) ticks
+
+/**
+ * Gets the display name of a stage.
+ */
+const char* profileStageName(ProfileStage stage);
+
+/**
+ * Gets the stage a stage nests inside; Chain is its own parent.
+ */
+ProfileStage profileStageParent(ProfileStage stage);
+
+/**
+ * Reads the profiling clock: the TSC on x86, the monotonic clock elsewhere.
+ * Convert with Profiler::ticksPerMicrosecond().
+ */
+inline uint64_t profileTicks()
+{
+#ifdef MULTIAUDIO_PROFILE_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+//--------------------------------------------------------------------------
+// ThreadProfile
+//--------------------------------------------------------------------------
+
+/**
+ * Timings recorded by one thread.
+ *
+ * Only the owning thread writes; readers (GUI, exporters) load the same
+ * relaxed atomics concurrently, so nothing ever locks. Each stage keeps a
+ * call count, total, maximum and a log2 histogram; a ring of the most
+ * recent events feeds the trace export.
+ */
+class ThreadProfile
+{
+public:
+    struct StageCounters
+    {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> totalTicks{0};
+        std::atomic<uint64_t> maxTicks{0};
+        std::atomic<uint64_t> histogram[PROFILE_HISTOGRAM_BUCKETS] = {};
+    };
+
+    struct Event
+    {
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> packed{0};   // duration << 8 | stage
+    };
+
+private:
+    std::string name;
+    std::atomic<bool> enabled;
+    StageCounters stages[PROFILE_STAGE_COUNT];
+    std::unique_ptr<Event[]> events;
+    std::size_t eventMask;
+    std::atomic<uint64_t> eventHead;
+
+public:
+    /**
+     * Creates a profile; allocates, so create it before the audio starts.
+     * @param threadName Label used in the GUI and exports
+     * @param eventCapacity Recent events kept for trace export (rounded to a power of two)
+     */
+    ThreadProfile(const std::string& threadName, std::size_t eventCapacity);
+
+    /**
+     * Records one timed region. Never blocks or allocates.
+     */
+    void record(ProfileStage stage, uint64_t startTicks, uint64_t endTicks)
+    {
+        const uint64_t duration = endTicks - startTicks;
+        StageCounters& counters = stages[static_cast<std::size_t>(stage)];
+
+        // Single writer: plain load/store pairs instead of read-modify-write
+        counters.calls.store(counters.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.totalTicks.store(counters.totalTicks.load(std::memory_order_relaxed) + duration,
+                                  std::memory_order_relaxed);
+        if (duration > counters.maxTicks.load(std::memory_order_relaxed))
+        {
+            counters.maxTicks.store(duration, std::memory_order_relaxed);
+        }
+        std::size_t bucket = 0;
+        for (uint64_t d = duration >> 1; d != 0 && bucket + 1 < PROFILE_HISTOGRAM_BUCKETS; d >>= 1)
+        {
+            ++bucket;
+        }
+        std::atomic<uint64_t>& slot = counters.histogram[bucket];
+        slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        const uint64_t head = eventHead.load(std::memory_order_relaxed);
+        Event& event = events[head & eventMask];
+        event.start.store(startTicks, std::memory_order_relaxed);
+        event.packed.store((duration << 8) | static_cast<uint64_t>(stage), std::memory_order_relaxed);
+        eventHead.store(head + 1, std::memory_order_release);
+    }
+
+    const std::string& getName() const { return name; }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool isEnabled) { enabled.store(isEnabled, std::memory_order_relaxed); }
+    const StageCounters& getStage(ProfileStage stage) const { return stages[static_cast<std::size_t>(stage)]; }
+    const Event& getEvent(uint64_t index) const { return events[index & eventMask]; }
+    std::size_t getEventCapacity() const { return eventMask + 1; }
+    uint64_t getEventHead() const { return eventHead.load(std::memory_order_acquire); }
+
+    /**
+     * Clears counters and events. Values recorded concurrently may survive.
+     */
+    void reset();
+
+    ThreadProfile(const ThreadProfile&) = delete;
+    ThreadProfile& operator=(const ThreadProfile&) = delete;
+};
+
+/**
+ * Profile the calling thread records into; nullptr means timers are off.
+ */
+inline thread_local ThreadProfile* currentThreadProfile = nullptr;
+
+//--------------------------------------------------------------------------
+// ScopedTimer
+//--------------------------------------------------------------------------
+
+/**
+ * Times the enclosing scope into the calling thread's profile.
+ * Costs one thread-local load when the thread has no profile.
+ */
+class ScopedTimer
+{
+private:
+    ThreadProfile* profile;
+    uint64_t startTicks;
+    ProfileStage stage;
+
+public:
+    explicit ScopedTimer(ProfileStage timedStage)
+        : profile(currentThreadProfile),
+          startTicks(0),
+          stage(timedStage)
+    {
+        if (profile && !profile->isEnabled())
+        {
+            profile = nullptr;
+        }
+        if (profile)
+        {
+            startTicks = profileTicks();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        if (profile)
+        {
+            profile->record(stage, startTicks, profileTicks());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Times the rest of the enclosing scope; compiled out with -DMULTIAUDIO_NO_PROFILING
+#define MULTIAUDIO_PROFILE_CONCAT2(a, b) a##b
+#define MULTIAUDIO_PROFILE_CONCAT(a, b) MULTIAUDIO_PROFILE_CONCAT2(a, b)
+#ifdef MULTIAUDIO_NO_PROFILING
+#define MULTIAUDIO_PROFILE_SCOPE(stage) ((void)0)
+#else
+#define MULTIAUDIO_PROFILE_SCOPE(stage) \
+    ::audio::ScopedTimer MULTIAUDIO_PROFILE_CONCAT(profileScope, __LINE__)(stage)
+#endif
+
+//--------------------------------------------------------------------------
+// Profiler
+//--------------------------------------------------------------------------
+
+/**
+ * Summary of one stage on one thread, in microseconds.
+ */
+struct ProfileSummary
+{
+    uint64_t calls = 0;
+    double totalMicros = 0.0;
+    double selfMicros = 0.0;        // total minus nested stages
+    double meanMicros = 0.0;
+    double p50Micros = 0.0;         // from the log2 histogram (bucket midpoint)
+    double p99Micros = 0.0;
+    double maxMicros = 0.0;
+};
+
+/**
+ * Owns the per-thread profiles and turns them into summaries and exports.
+ *
+ * Create a profile per timed thread up front, then have that thread
+ * attach() it (EffectChain::setProfile does this for every backend).
+ */
+class Profiler
+{
+private:
+    mutable std::mutex mutex;       // guards the profile list, never taken by timed threads
+    std::vector<std::unique_ptr<ThreadProfile>> profiles;
+
+public:
+    /**
+     * Creates a profile for a thread. Allocates; call before the audio starts.
+     * @param threadName Label used in the GUI and exports
+     * @param eventCapacity Recent events kept for trace export (default: 65536)
+     */
+    ThreadProfile* createProfile(const std::string& threadName, std::size_t eventCapacity = 1 << 16);
+
+    /**
+     * Makes the calling thread record into a profile (nullptr stops recording).
+     */
+    static void attach(ThreadProfile* profile) { currentThreadProfile = profile; }
+
+    /**
+     * Pauses or resumes recording on every profile.
+     */
+    void setEnabled(bool isEnabled);
+
+    /**
+     * Clears every profile.
+     */
+    void reset();
+
+    /**
+     * Summarises every stage of one profile.
+     * @param profile Profile from createProfile()
+     * @return One entry per ProfileStage
+     */
+    std::vector<ProfileSummary> summarize(const ThreadProfile& profile) const;
+
+    /**
+     * Gets the profiles created so far (stable pointers).
+     */
+    std::vector<ThreadProfile*> getProfiles() const;
+
+    /**
+     * Writes the recent events of every profile in Chrome trace format
+     * (chrome://tracing, Perfetto, speedscope).
+     * @return false if the file cannot be written
+     */
+    bool exportChromeTrace(const std::string& path) const;
+
+    /**
+     * Writes self time per stage as folded stacks ("Chain;EQ;EQGain 1234",
+     * nanoseconds), the input format of flamegraph.pl and speedscope.
+     * @return false if the file cannot be written
+     */
+    bool exportFoldedStacks(const std::string& path) const;
+
+    /**
+     * Gets the profiling clock rate, calibrated once against the steady clock.
+     */
+    static double ticksPerMicrosecond();
+};
+
+} // namespace audio
+
+#endif // PROFILER_H
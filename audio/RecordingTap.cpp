@@ -0,0 +1,219 @@
+#include "RecordingTap.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace audio {
+
+namespace {
+
+std::size_t roundUpPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// RecordingTap: Lifecycle
+//--------------------------------------------------------------------------
+
+RecordingTap::RecordingTap(const std::string& filePath, unsigned int channels, unsigned int rate,
+                           const TapConfig& config)
+    : ring(roundUpPowerOfTwo(std::max<std::size_t>(
+          ASYNC_IO_ALIGNMENT, static_cast<std::size_t>(config.ringSeconds * rate) * std::max(1u, channels)))),
+      ringMask(ring.size() - 1),
+      numChannels(std::max(1u, channels)),
+      writeIndex(0),
+      readIndex(0),
+      path(filePath),
+      sampleRate(rate),
+      overflows(0),
+      droppedFrames(0),
+      framesWritten(0),
+      writeErrors(0),
+      highWater(0),
+      direct(false)
+{
+    streamConfig.bufferBytes = config.writeBytes;
+    streamConfig.buffersInFlight = config.writesInFlight;
+    streamConfig.directIO = config.directIO;
+    streamConfig.backend = config.backend;
+}
+
+RecordingTap::~RecordingTap()
+{
+    closeFile();
+}
+
+//--------------------------------------------------------------------------
+// RecordingTap: Producer Interface
+//--------------------------------------------------------------------------
+
+bool RecordingTap::write(const float* interleaved, std::size_t numFrames)
+{
+    const std::size_t count = numFrames * numChannels;
+    const uint64_t write = writeIndex.load(std::memory_order_relaxed);
+    const uint64_t fill = write - readIndex.load(std::memory_order_acquire);
+
+    if (fill + count > ring.size())
+    {
+        overflows.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames.fetch_add(numFrames, std::memory_order_relaxed);
+        return false;
+    }
+
+    const std::size_t start = static_cast<std::size_t>(write) & ringMask;
+    const std::size_t first = std::min(count, ring.size() - start);
+    std::copy(interleaved, interleaved + first, ring.begin() + start);
+    std::copy(interleaved + first, interleaved + count, ring.begin());
+    writeIndex.store(write + count, std::memory_order_release);
+
+    if (fill + count > highWater.load(std::memory_order_relaxed))
+    {
+        highWater.store(fill + count, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// RecordingTap: Writer Interface
+//--------------------------------------------------------------------------
+
+bool RecordingTap::openFile()
+{
+    if (!writer.open(path, numChannels, sampleRate, WavEncoding::Float32, streamConfig))
+    {
+        return false;
+    }
+    direct.store(writer.isDirect());
+    return true;
+}
+
+std::size_t RecordingTap::drain()
+{
+    if (!writer.isOpen())
+    {
+        return 0;
+    }
+
+    const uint64_t read = readIndex.load(std::memory_order_relaxed);
+    const uint64_t available = writeIndex.load(std::memory_order_acquire) - read;
+    uint64_t consumed = 0;
+
+    // At most two contiguous pieces; the writer copies them into its aligned buffers
+    while (consumed < available)
+    {
+        const std::size_t start = static_cast<std::size_t>(read + consumed) & ringMask;
+        const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(available - consumed, ring.size() - start));
+        writer.writeSamples(&ring[start], count);
+        consumed += count;
+    }
+
+    // Free ring space as soon as the samples are queued, not once they hit the disk
+    readIndex.store(read + consumed, std::memory_order_release);
+    framesWritten.store(writer.getFramesWritten(), std::memory_order_relaxed);
+    writeErrors.store(writer.getWriteErrors(), std::memory_order_relaxed);
+    return static_cast<std::size_t>(consumed * sizeof(float));
+}
+
+void RecordingTap::closeFile()
+{
+    if (!writer.isOpen())
+    {
+        return;
+    }
+
+    drain();
+    writer.close();
+    framesWritten.store(writer.getFramesWritten());
+    writeErrors.store(writer.getWriteErrors());
+}
+
+//--------------------------------------------------------------------------
+// TapRecorder
+//--------------------------------------------------------------------------
+
+TapRecorder::TapRecorder(const TapConfig& tapConfig)
+    : config(tapConfig),
+      running(false)
+{
+}
+
+TapRecorder::~TapRecorder()
+{
+    stop();
+}
+
+RecordingTap* TapRecorder::addTap(const std::string& filePath, unsigned int channels, unsigned int sampleRate)
+{
+    if (running.load())
+    {
+        return nullptr;
+    }
+    taps.push_back(std::unique_ptr<RecordingTap>(new RecordingTap(filePath, channels, sampleRate, config)));
+    return taps.back().get();
+}
+
+bool TapRecorder::start()
+{
+    if (running.load())
+    {
+        return true;
+    }
+    for (std::unique_ptr<RecordingTap>& tap : taps)
+    {
+        if (!tap->openFile())
+        {
+            for (std::unique_ptr<RecordingTap>& opened : taps)
+            {
+                opened->closeFile();
+            }
+            return false;
+        }
+    }
+
+    running.store(true);
+    writerThread = std::thread(&TapRecorder::writerLoop, this);
+    return true;
+}
+
+void TapRecorder::writerLoop()
+{
+    while (running.load())
+    {
+        std::size_t moved = 0;
+        for (std::unique_ptr<RecordingTap>& tap : taps)
+        {
+            moved += tap->drain();
+        }
+        if (moved == 0)
+        {
+            // Rings hold seconds of audio; polling every few ms is plenty
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+void TapRecorder::stop()
+{
+    if (!running.exchange(false))
+    {
+        return;
+    }
+    if (writerThread.joinable())
+    {
+        writerThread.join();
+    }
+    for (std::unique_ptr<RecordingTap>& tap : taps)
+    {
+        tap->closeFile();
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,197 @@
+#ifndef RECORDING_TAP_H
+#define RECORDING_TAP_H
+
+#include "../common.h"
+#include "WavStream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Settings shared by every tap of a TapRecorder.
+ */
+struct TapConfig
+{
+    double ringSeconds = 10.0;          // audio the ring absorbs while the disk stalls
+    std::size_t writeBytes = 1 << 20;   // bytes per disk write, multiple of 4096
+    unsigned int writesInFlight = 4;    // disk writes queued at once per tap
+    bool directIO = true;               // O_DIRECT where the filesystem allows it (Linux)
+    AsyncIOBackend backend = AsyncIOBackend::Auto;
+};
+
+//--------------------------------------------------------------------------
+// RecordingTap
+//--------------------------------------------------------------------------
+
+/**
+ * One archived stream (e.g. the chain input or the chain output).
+ *
+ * The audio side calls write() with interleaved float blocks; samples are
+ * copied into a large preallocated lock-free ring and nothing else happens
+ * on that thread. TapRecorder's writer thread drains the ring into a
+ * WavStreamWriter, which keeps several large aligned writes of a 32-bit
+ * float WAV file in flight (io_uring where available). If the ring is full
+ * the block is dropped and counted, so a slow disk never stalls the audio
+ * thread.
+ */
+class RecordingTap
+{
+private:
+    //--------------------------------------------------------------------------
+    // Sample Ring (audio thread -> writer thread)
+    //--------------------------------------------------------------------------
+    std::vector<float> ring;
+    std::size_t ringMask;
+    unsigned int numChannels;
+    alignas(64) std::atomic<uint64_t> writeIndex;   // samples, monotonic
+    alignas(64) std::atomic<uint64_t> readIndex;    // samples, monotonic
+
+    //--------------------------------------------------------------------------
+    // File State (writer thread only)
+    //--------------------------------------------------------------------------
+    std::string path;
+    unsigned int sampleRate;
+    WavStreamConfig streamConfig;
+    WavStreamWriter writer;
+
+    //--------------------------------------------------------------------------
+    // Statistics
+    //--------------------------------------------------------------------------
+    std::atomic<uint64_t> overflows;        // write() calls dropped
+    std::atomic<uint64_t> droppedFrames;
+    std::atomic<uint64_t> framesWritten;    // frames written to disk
+    std::atomic<uint64_t> writeErrors;
+    std::atomic<uint64_t> highWater;        // largest ring fill seen, in samples
+    std::atomic<bool> direct;
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a tap; the file is opened by TapRecorder::start().
+     *
+     * @param filePath Output WAV file
+     * @param channels Interleaved channels per frame
+     * @param rate Sample rate written to the header
+     * @param config Ring size and write size
+     */
+    RecordingTap(const std::string& filePath, unsigned int channels, unsigned int rate, const TapConfig& config);
+
+    ~RecordingTap();
+
+    //--------------------------------------------------------------------------
+    // Producer Interface (audio thread)
+    //--------------------------------------------------------------------------
+    /**
+     * Queues one block for archiving. Never blocks or allocates.
+     *
+     * @param interleaved Samples (numFrames * channels)
+     * @param numFrames Frames in the block
+     * @return false if the ring was full and the block was dropped
+     */
+    bool write(const float* interleaved, std::size_t numFrames);
+
+    //--------------------------------------------------------------------------
+    // Writer Interface (TapRecorder thread)
+    //--------------------------------------------------------------------------
+    /**
+     * Creates the file and starts its I/O queue.
+     * @return false if the file cannot be created
+     */
+    bool openFile();
+
+    /**
+     * Moves queued samples into the file writer, which submits each full buffer.
+     * @return Bytes moved out of the ring
+     */
+    std::size_t drain();
+
+    /**
+     * Drains the ring, writes the tail, fixes up the header and closes the file.
+     */
+    void closeFile();
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    const std::string& getPath() const { return path; }
+    bool isDirect() const { return direct.load(); }
+    uint64_t getOverflows() const { return overflows.load(); }
+    uint64_t getDroppedFrames() const { return droppedFrames.load(); }
+    uint64_t getFramesWritten() const { return framesWritten.load(); }
+    uint64_t getWriteErrors() const { return writeErrors.load(); }
+
+    /**
+     * Gets the fullest the ring has been, as a fraction of its capacity.
+     * Values near 1.0 mean the disk nearly fell behind.
+     */
+    double getHighWaterRatio() const { return static_cast<double>(highWater.load()) / ring.size(); }
+
+    RecordingTap(const RecordingTap&) = delete;
+    RecordingTap& operator=(const RecordingTap&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// TapRecorder
+//--------------------------------------------------------------------------
+
+/**
+ * Owns a set of taps and the single writer thread that drains them.
+ *
+ * Add every tap before start(); the pointers returned by addTap() stay
+ * valid until the recorder is destroyed and may be handed to the audio
+ * side (see EffectChain::setTaps).
+ */
+class TapRecorder
+{
+private:
+    TapConfig config;
+    std::vector<std::unique_ptr<RecordingTap>> taps;
+    std::thread writerThread;
+    std::atomic<bool> running;
+
+    void writerLoop();
+
+public:
+    explicit TapRecorder(const TapConfig& tapConfig = TapConfig());
+    ~TapRecorder();
+
+    /**
+     * Adds a stream to archive.
+     *
+     * @param filePath Output WAV file
+     * @param channels Interleaved channels per frame
+     * @param sampleRate Sample rate in Hz (default: SAMPLE_RATE)
+     * @return Tap to feed from the audio side, or nullptr once started
+     */
+    RecordingTap* addTap(const std::string& filePath, unsigned int channels, unsigned int sampleRate = SAMPLE_RATE);
+
+    /**
+     * Opens every tap's file and starts the writer thread.
+     * @return false if any file could not be created
+     */
+    bool start();
+
+    /**
+     * Drains all taps, finalises the files and stops the writer thread.
+     * Stop the audio side first so nothing is written after the final drain.
+     */
+    void stop();
+
+    bool isRunning() const { return running.load(); }
+    const std::vector<std::unique_ptr<RecordingTap>>& getTaps() const { return taps; }
+
+    TapRecorder(const TapRecorder&) = delete;
+    TapRecorder& operator=(const TapRecorder&) = delete;
+};
+
+} // namespace audio
+
+#endif // RECORDING_TAP_H
@@ -0,0 +1,528 @@
+#include "RtpBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// RTP Payload Helpers
+//--------------------------------------------------------------------------
+
+std::size_t buildRtpPacket(uint8_t* packet, const RtpPacketInfo& info, RtpEncoding encoding,
+                           const float* interleaved, std::size_t numSamples)
+{
+    packet[0] = 0x80; // Version 2, no padding, no extension, no CSRC
+    packet[1] = static_cast<uint8_t>(info.payloadType & 0x7F);
+    packet[2] = static_cast<uint8_t>(info.sequence >> 8);
+    packet[3] = static_cast<uint8_t>(info.sequence);
+    packet[4] = static_cast<uint8_t>(info.timestamp >> 24);
+    packet[5] = static_cast<uint8_t>(info.timestamp >> 16);
+    packet[6] = static_cast<uint8_t>(info.timestamp >> 8);
+    packet[7] = static_cast<uint8_t>(info.timestamp);
+    packet[8] = static_cast<uint8_t>(info.ssrc >> 24);
+    packet[9] = static_cast<uint8_t>(info.ssrc >> 16);
+    packet[10] = static_cast<uint8_t>(info.ssrc >> 8);
+    packet[11] = static_cast<uint8_t>(info.ssrc);
+
+    uint8_t* payload = packet + RTP_HEADER_SIZE;
+    for (std::size_t i = 0; i < numSamples; ++i)
+    {
+        float x = std::max(-1.0f, std::min(1.0f, interleaved[i]));
+        if (encoding == RtpEncoding::L24)
+        {
+            int32_t v = static_cast<int32_t>(std::lrint(x * 8388607.0f));
+            payload[0] = static_cast<uint8_t>(v >> 16);
+            payload[1] = static_cast<uint8_t>(v >> 8);
+            payload[2] = static_cast<uint8_t>(v);
+            payload += 3;
+        }
+        else
+        {
+            int32_t v = static_cast<int32_t>(std::lrint(x * 32767.0f));
+            payload[0] = static_cast<uint8_t>(v >> 8);
+            payload[1] = static_cast<uint8_t>(v);
+            payload += 2;
+        }
+    }
+
+    return RTP_HEADER_SIZE + numSamples * rtpBytesPerSample(encoding);
+}
+
+bool parseRtpPacket(const uint8_t* packet, std::size_t size, RtpPacketInfo& info)
+{
+    if (size < RTP_HEADER_SIZE || (packet[0] >> 6) != 2)
+    {
+        return false;
+    }
+
+    std::size_t offset = RTP_HEADER_SIZE + 4 * static_cast<std::size_t>(packet[0] & 0x0F);
+    if (packet[0] & 0x10)
+    {
+        // Header extension: 16-bit profile, 16-bit length in 32-bit words
+        if (offset + 4 > size)
+        {
+            return false;
+        }
+        std::size_t words = (static_cast<std::size_t>(packet[offset + 2]) << 8) | packet[offset + 3];
+        offset += 4 + 4 * words;
+    }
+
+    std::size_t padding = (packet[0] & 0x20) ? packet[size - 1] : 0;
+    if (offset + padding > size)
+    {
+        return false;
+    }
+
+    info.payloadType = packet[1] & 0x7F;
+    info.sequence = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    info.timestamp = (static_cast<uint32_t>(packet[4]) << 24) | (static_cast<uint32_t>(packet[5]) << 16) |
+                     (static_cast<uint32_t>(packet[6]) << 8) | packet[7];
+    info.ssrc = (static_cast<uint32_t>(packet[8]) << 24) | (static_cast<uint32_t>(packet[9]) << 16) |
+                (static_cast<uint32_t>(packet[10]) << 8) | packet[11];
+    info.payload = packet + offset;
+    info.payloadSize = size - offset - padding;
+    return true;
+}
+
+void decodeRtpPayload(const uint8_t* payload, std::size_t numSamples, RtpEncoding encoding, float* interleaved)
+{
+    if (encoding == RtpEncoding::L24)
+    {
+        for (std::size_t i = 0; i < numSamples; ++i, payload += 3)
+        {
+            // Assemble in the top 24 bits so the arithmetic shift sign-extends
+            int32_t v = static_cast<int32_t>((static_cast<uint32_t>(payload[0]) << 24) |
+                                             (static_cast<uint32_t>(payload[1]) << 16) |
+                                             (static_cast<uint32_t>(payload[2]) << 8)) >> 8;
+            interleaved[i] = static_cast<float>(v) / 8388608.0f;
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < numSamples; ++i, payload += 2)
+        {
+            int16_t v = static_cast<int16_t>((payload[0] << 8) | payload[1]);
+            interleaved[i] = static_cast<float>(v) / 32768.0f;
+        }
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+bool makeAddress(const std::string& address, uint16_t port, sockaddr_in& out)
+{
+    std::memset(&out, 0, sizeof(out));
+    out.sin_family = AF_INET;
+    out.sin_port = htons(port);
+    return inet_pton(AF_INET, address.c_str(), &out.sin_addr) == 1;
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// RtpReceiver
+//--------------------------------------------------------------------------
+
+RtpReceiver::RtpReceiver(JitterBuffer& buffer, RtpEncoding format, uint8_t pt)
+    : socketFd(-1),
+      encoding(format),
+      payloadType(pt),
+      jitterBuffer(buffer),
+      receiving(false),
+      haveSequence(false),
+      extendedSequence(0),
+      packetStorage(BATCH_SIZE * RTP_MAX_PACKET_SIZE),
+      decodeScratch(RTP_MAX_PACKET_SIZE / 2),
+      packetsInvalid(0),
+      batchesReceived(0)
+{
+}
+
+RtpReceiver::~RtpReceiver()
+{
+    stop();
+}
+
+uint64_t RtpReceiver::extendSequence(uint16_t sequence)
+{
+    if (!haveSequence)
+    {
+        // Start one wrap in so small backward steps never underflow
+        haveSequence = true;
+        extendedSequence = 0x10000u + sequence;
+        return extendedSequence;
+    }
+
+    int16_t delta = static_cast<int16_t>(sequence - static_cast<uint16_t>(extendedSequence));
+    extendedSequence = static_cast<uint64_t>(static_cast<int64_t>(extendedSequence) + delta);
+    return extendedSequence;
+}
+
+bool RtpReceiver::start(const std::string& address, uint16_t port)
+{
+    if (receiving.load())
+    {
+        return true;
+    }
+
+    sockaddr_in local;
+    if (!makeAddress(address, port, local))
+    {
+        std::cerr << "[RTP] ERROR: Invalid bind address " << address << std::endl;
+        return false;
+    }
+
+    socketFd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0)
+    {
+        std::cerr << "[RTP] ERROR: Failed to create receive socket." << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    int receiveBuffer = 1 << 20;
+    timeval timeout = {0, 50000}; // Wake periodically to observe stop()
+    setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (::bind(socketFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+    {
+        std::cerr << "[RTP] ERROR: Failed to bind " << address << ":" << port << std::endl;
+        ::close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+
+    haveSequence = false;
+    receiving.store(true);
+    receiveThread = std::thread(&RtpReceiver::receiveLoop, this);
+    return true;
+}
+
+void RtpReceiver::stop()
+{
+    receiving.store(false);
+    if (receiveThread.joinable())
+    {
+        receiveThread.join();
+    }
+    if (socketFd >= 0)
+    {
+        ::close(socketFd);
+        socketFd = -1;
+    }
+}
+
+void RtpReceiver::receiveLoop()
+{
+    mmsghdr messages[BATCH_SIZE];
+    iovec vectors[BATCH_SIZE];
+    unsigned int channels = jitterBuffer.getChannels();
+    std::size_t bytesPerSample = rtpBytesPerSample(encoding);
+
+    while (receiving.load())
+    {
+        for (unsigned int i = 0; i < BATCH_SIZE; ++i)
+        {
+            vectors[i].iov_base = packetStorage.data() + i * RTP_MAX_PACKET_SIZE;
+            vectors[i].iov_len = RTP_MAX_PACKET_SIZE;
+            std::memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Block for the first datagram, then drain whatever else is queued
+        int count = ::recvmmsg(socketFd, messages, BATCH_SIZE, MSG_WAITFORONE, nullptr);
+        if (count <= 0)
+        {
+            continue;
+        }
+        batchesReceived.fetch_add(1, std::memory_order_relaxed);
+
+        for (int i = 0; i < count; ++i)
+        {
+            const uint8_t* data = static_cast<const uint8_t*>(vectors[i].iov_base);
+            RtpPacketInfo info;
+            if (!parseRtpPacket(data, messages[i].msg_len, info) || info.payloadType != payloadType)
+            {
+                packetsInvalid.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::size_t numSamples = std::min(info.payloadSize / bytesPerSample, decodeScratch.size());
+            std::size_t numFrames = numSamples / channels;
+            decodeRtpPayload(info.payload, numFrames * channels, encoding, decodeScratch.data());
+            jitterBuffer.write(extendSequence(info.sequence), info.timestamp, decodeScratch.data(), numFrames);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// RtpSender
+//--------------------------------------------------------------------------
+
+RtpSender::RtpSender(RtpEncoding format, uint8_t pt, unsigned int channels,
+                     unsigned int packetFrames, std::size_t maxBlockFrames)
+    : socketFd(-1),
+      encoding(format),
+      payloadType(pt),
+      numChannels(std::max(1u, channels)),
+      sequence(0),
+      timestamp(0),
+      packetsSent(0),
+      sendErrors(0)
+{
+    // Keep every packet inside one Ethernet MTU
+    std::size_t maxFrames = (RTP_MAX_PACKET_SIZE - RTP_HEADER_SIZE) / (numChannels * rtpBytesPerSample(encoding));
+    framesPerPacket = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(packetFrames, maxFrames)));
+
+    maxPackets = (maxBlockFrames + framesPerPacket - 1) / framesPerPacket;
+    packetStorage.resize(std::max<std::size_t>(1, maxPackets) * RTP_MAX_PACKET_SIZE);
+    messages.resize(std::max<std::size_t>(1, maxPackets));
+    vectors.resize(std::max<std::size_t>(1, maxPackets));
+
+    std::random_device rd;
+    ssrc = rd();
+    sequence = static_cast<uint16_t>(rd());
+    timestamp = rd();
+}
+
+RtpSender::~RtpSender()
+{
+    close();
+}
+
+bool RtpSender::open(const std::string& address, uint16_t port)
+{
+    sockaddr_in remote;
+    if (!makeAddress(address, port, remote))
+    {
+        std::cerr << "[RTP] ERROR: Invalid destination address " << address << std::endl;
+        return false;
+    }
+
+    socketFd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socketFd < 0)
+    {
+        std::cerr << "[RTP] ERROR: Failed to create send socket." << std::endl;
+        return false;
+    }
+
+    if (::connect(socketFd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0)
+    {
+        std::cerr << "[RTP] ERROR: Failed to connect to " << address << ":" << port << std::endl;
+        ::close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void RtpSender::close()
+{
+    if (socketFd >= 0)
+    {
+        ::close(socketFd);
+        socketFd = -1;
+    }
+}
+
+std::size_t RtpSender::send(const float* interleaved, std::size_t numFrames)
+{
+    if (socketFd < 0 || numFrames == 0)
+    {
+        return 0;
+    }
+
+    std::size_t numPackets = std::min(maxPackets, (numFrames + framesPerPacket - 1) / framesPerPacket);
+
+    RtpPacketInfo info;
+    info.payloadType = payloadType;
+    info.ssrc = ssrc;
+
+    for (std::size_t p = 0; p < numPackets; ++p)
+    {
+        std::size_t firstFrame = p * framesPerPacket;
+        std::size_t frames = std::min<std::size_t>(framesPerPacket, numFrames - firstFrame);
+        uint8_t* packet = packetStorage.data() + p * RTP_MAX_PACKET_SIZE;
+
+        info.sequence = sequence++;
+        info.timestamp = timestamp;
+        timestamp += static_cast<uint32_t>(frames);
+
+        vectors[p].iov_base = packet;
+        vectors[p].iov_len = buildRtpPacket(packet, info, encoding,
+                                            interleaved + firstFrame * numChannels, frames * numChannels);
+        std::memset(&messages[p], 0, sizeof(mmsghdr));
+        messages[p].msg_hdr.msg_iov = &vectors[p];
+        messages[p].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg may send a prefix of the batch; resubmit the remainder
+    std::size_t sent = 0;
+    while (sent < numPackets)
+    {
+        int result = ::sendmmsg(socketFd, messages.data() + sent, static_cast<unsigned int>(numPackets - sent), 0);
+        if (result <= 0)
+        {
+            sendErrors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        sent += static_cast<std::size_t>(result);
+    }
+
+    packetsSent.fetch_add(sent, std::memory_order_relaxed);
+    return sent;
+}
+
+//--------------------------------------------------------------------------
+// RtpBackend
+//--------------------------------------------------------------------------
+
+RtpBackend::RtpBackend(EffectChain& effectChain, const RtpConfig& rtpConfig)
+    : config(rtpConfig),
+      chain(effectChain),
+      // Playout depth covers one processing block plus the configured jitter margin
+      jitterBuffer(rtpConfig.channels, rtpConfig.framesPerPacket, rtpConfig.jitterCapacityPackets,
+                   rtpConfig.jitterDepthPackets +
+                   (rtpConfig.blockFrames + rtpConfig.framesPerPacket - 1) / std::max(1u, rtpConfig.framesPerPacket)),
+      driftCompensator(rtpConfig.channels, rtpConfig.blockFrames),
+      receiver(jitterBuffer, rtpConfig.encoding, rtpConfig.payloadType),
+      sender(rtpConfig.encoding, rtpConfig.payloadType, rtpConfig.channels,
+             rtpConfig.framesPerPacket, rtpConfig.blockFrames),
+      processing(false),
+      blocksProcessed(0),
+      deadlineMisses(0),
+      driftPpm(0.0)
+{
+    chain.setStreamId(TRACE_STREAM_RTP);
+}
+
+RtpBackend::~RtpBackend()
+{
+    stop();
+}
+
+bool RtpBackend::start()
+{
+    if (processing.load())
+    {
+        return true;
+    }
+
+    if (!sender.open(config.destAddress, config.destPort))
+    {
+        return false;
+    }
+    if (!receiver.start(config.bindAddress, config.listenPort))
+    {
+        sender.close();
+        return false;
+    }
+
+    chain.prepare(config.blockFrames, config.blockFrames);
+    driftCompensator.reset();
+    processing.store(true);
+    processThread = std::thread(&RtpBackend::processLoop, this);
+    return true;
+}
+
+void RtpBackend::stop()
+{
+    processing.store(false);
+    if (processThread.joinable())
+    {
+        processThread.join();
+    }
+    receiver.stop();
+    sender.close();
+    jitterBuffer.reset();
+}
+
+void RtpBackend::processLoop()
+{
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_RR);
+    if (pthread_setschedparam(pthread_self(), SCHED_RR, &param) != 0)
+    {
+        std::cerr << "[RTP] Warning: Failed to set real-time thread priority (requires permissions?)." << std::endl;
+    }
+
+    const std::size_t blockFrames = config.blockFrames;
+    const unsigned int channels = std::max(1u, config.channels);
+    std::vector<float> interleavedInput(blockFrames * channels);
+    std::vector<float> interleavedOutput(blockFrames * channels);
+    std::vector<float> monoChannel(blockFrames);
+    std::vector<float> processed(blockFrames);
+
+    // The local clock paces the stream; the compensator follows the sender
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(blockFrames) / config.sampleRate));
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (processing.load())
+    {
+        const uint64_t sequence = chain.getBlockSequence();
+        const int status = jitterBuffer.isPrimed() ? 0 : 1;
+        MULTIAUDIO_TRACE3(callback_entry, TRACE_STREAM_RTP, sequence, blockFrames);
+
+        if (jitterBuffer.isPrimed())
+        {
+            // Only track the fill level during playout; priming would wind up the integrator
+            driftCompensator.update(jitterBuffer.getDepthFrames(), jitterBuffer.getTargetDepthFrames());
+        }
+        driftCompensator.process(jitterBuffer, interleavedInput.data(), blockFrames);
+
+        for (std::size_t i = 0; i < blockFrames; ++i)
+        {
+            monoChannel[i] = interleavedInput[i * channels];
+        }
+
+        chain.process(monoChannel.data(), processed.data(), blockFrames);
+
+        for (std::size_t i = 0; i < blockFrames; ++i)
+        {
+            for (unsigned int ch = 0; ch < channels; ++ch)
+            {
+                interleavedOutput[i * channels + ch] = processed[i];
+            }
+        }
+
+        sender.send(interleavedOutput.data(), blockFrames);
+        blocksProcessed.fetch_add(1, std::memory_order_relaxed);
+        driftPpm.store(driftCompensator.getPpm(), std::memory_order_relaxed);
+        MULTIAUDIO_TRACE4(callback_exit, TRACE_STREAM_RTP, sequence, blockFrames, status);
+
+        deadline += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > deadline + period)
+        {
+            // More than a block late: count it and re-anchor instead of bursting
+            deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+            MULTIAUDIO_TRACE2(xrun, TRACE_STREAM_RTP, sequence);
+            deadline = now;
+        }
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+#endif // __linux__
+
+} // namespace audio
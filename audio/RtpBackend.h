@@ -0,0 +1,328 @@
+#ifndef RTP_BACKEND_H
+#define RTP_BACKEND_H
+
+#include "../common.h"
+#include "EffectChain.h"
+#include "JitterBuffer.h"
+#include "DriftCompensator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// RTP Payload Helpers
+//--------------------------------------------------------------------------
+
+/**
+ * Linear PCM payload formats (RFC 3551 L16, RFC 3190 L24; AES67 uses L24).
+ */
+enum class RtpEncoding
+{
+    L16,
+    L24
+};
+
+constexpr std::size_t RTP_HEADER_SIZE = 12;
+constexpr std::size_t RTP_MAX_PACKET_SIZE = 1500;
+
+/**
+ * Header fields of a parsed RTP packet.
+ */
+struct RtpPacketInfo
+{
+    uint16_t sequence = 0;
+    uint32_t timestamp = 0;
+    uint32_t ssrc = 0;
+    uint8_t payloadType = 0;
+    const uint8_t* payload = nullptr;
+    std::size_t payloadSize = 0;
+};
+
+/**
+ * Gets the payload size of one sample.
+ * @param encoding Payload format
+ * @return Bytes per sample (2 or 3)
+ */
+inline std::size_t rtpBytesPerSample(RtpEncoding encoding)
+{
+    return encoding == RtpEncoding::L24 ? 3 : 2;
+}
+
+/**
+ * Builds an RTP packet from interleaved float samples.
+ *
+ * @param packet Destination (at least RTP_HEADER_SIZE + payload bytes)
+ * @param info Header fields (payload pointer/size are ignored)
+ * @param encoding Payload format
+ * @param interleaved Source samples (numFrames * channels)
+ * @param numSamples Total samples to encode
+ * @return Packet size in bytes
+ */
+std::size_t buildRtpPacket(uint8_t* packet, const RtpPacketInfo& info, RtpEncoding encoding,
+                           const float* interleaved, std::size_t numSamples);
+
+/**
+ * Parses an RTP header, skipping CSRCs, extensions and padding.
+ *
+ * @param packet Raw datagram
+ * @param size Datagram size in bytes
+ * @param info Parsed header fields and payload location
+ * @return false if the datagram is not a valid RTP version 2 packet
+ */
+bool parseRtpPacket(const uint8_t* packet, std::size_t size, RtpPacketInfo& info);
+
+/**
+ * Decodes big-endian PCM payload into floats in [-1, 1).
+ *
+ * @param payload Payload bytes
+ * @param numSamples Samples to decode
+ * @param encoding Payload format
+ * @param interleaved Destination
+ */
+void decodeRtpPayload(const uint8_t* payload, std::size_t numSamples, RtpEncoding encoding, float* interleaved);
+
+#ifdef __linux__
+
+//--------------------------------------------------------------------------
+// Configuration
+//--------------------------------------------------------------------------
+
+/**
+ * Addresses and stream format for the RTP backend.
+ */
+struct RtpConfig
+{
+    std::string bindAddress = "0.0.0.0";
+    uint16_t listenPort = 5004;
+    std::string destAddress = "127.0.0.1";
+    uint16_t destPort = 5006;
+    RtpEncoding encoding = RtpEncoding::L24;
+    uint8_t payloadType = 96;
+    unsigned int channels = NUM_CHANNELS;
+    unsigned int sampleRate = SAMPLE_RATE;
+    unsigned int framesPerPacket = 48;        // 1 ms at 48 kHz (AES67 default)
+    unsigned int blockFrames = FRAMES_PER_BUFFER;
+    unsigned int jitterDepthPackets = 8;
+    std::size_t jitterCapacityPackets = 256;
+};
+
+//--------------------------------------------------------------------------
+// RtpReceiver
+//--------------------------------------------------------------------------
+
+/**
+ * Network ingest thread: batched recvmmsg into a jitter buffer.
+ */
+class RtpReceiver
+{
+private:
+    static constexpr unsigned int BATCH_SIZE = 32;
+
+    int socketFd;
+    RtpEncoding encoding;
+    uint8_t payloadType;
+    JitterBuffer& jitterBuffer;
+    std::thread receiveThread;
+    std::atomic<bool> receiving;
+
+    // Extended sequence tracking (receive thread only)
+    bool haveSequence;
+    uint64_t extendedSequence;
+
+    // Preallocated batch storage
+    std::vector<uint8_t> packetStorage;
+    std::vector<float> decodeScratch;
+
+    std::atomic<uint64_t> packetsInvalid;
+    std::atomic<uint64_t> batchesReceived;
+
+    /**
+     * Receive loop run on receiveThread.
+     */
+    void receiveLoop();
+
+    /**
+     * Maps a 16-bit RTP sequence number onto a wrap-free 64-bit counter.
+     */
+    uint64_t extendSequence(uint16_t sequence);
+
+public:
+    /**
+     * Creates a receiver feeding the given jitter buffer.
+     * @param buffer Destination jitter buffer (producer side)
+     * @param format Payload format
+     * @param pt Expected payload type
+     */
+    RtpReceiver(JitterBuffer& buffer, RtpEncoding format, uint8_t pt);
+
+    ~RtpReceiver();
+
+    /**
+     * Binds the UDP socket and starts the receive thread.
+     * @param address Local address to bind
+     * @param port Local UDP port
+     * @return true if the socket was bound
+     */
+    bool start(const std::string& address, uint16_t port);
+
+    /**
+     * Stops the receive thread and closes the socket.
+     */
+    void stop();
+
+    uint64_t getPacketsInvalid() const { return packetsInvalid.load(); }
+    uint64_t getBatchesReceived() const { return batchesReceived.load(); }
+
+    RtpReceiver(const RtpReceiver&) = delete;
+    RtpReceiver& operator=(const RtpReceiver&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// RtpSender
+//--------------------------------------------------------------------------
+
+/**
+ * Network egress: packetises blocks and sends them with one sendmmsg.
+ */
+class RtpSender
+{
+private:
+    int socketFd;
+    RtpEncoding encoding;
+    uint8_t payloadType;
+    unsigned int numChannels;
+    unsigned int framesPerPacket;
+    uint16_t sequence;
+    uint32_t timestamp;
+    uint32_t ssrc;
+
+    std::vector<uint8_t> packetStorage;
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+    std::size_t maxPackets;
+
+    std::atomic<uint64_t> packetsSent;
+    std::atomic<uint64_t> sendErrors;
+
+public:
+    /**
+     * Creates a sender.
+     * @param format Payload format
+     * @param pt Payload type
+     * @param channels Interleaved channels
+     * @param packetFrames Frames per packet
+     * @param maxBlockFrames Largest block passed to send()
+     */
+    RtpSender(RtpEncoding format, uint8_t pt, unsigned int channels,
+              unsigned int packetFrames, std::size_t maxBlockFrames);
+
+    ~RtpSender();
+
+    /**
+     * Opens the socket and sets the destination.
+     * @param address Destination IPv4 address
+     * @param port Destination UDP port
+     * @return true if the socket was connected
+     */
+    bool open(const std::string& address, uint16_t port);
+
+    /**
+     * Closes the socket.
+     */
+    void close();
+
+    /**
+     * Packetises and sends a block of interleaved samples.
+     * @param interleaved Samples (numFrames * channels)
+     * @param numFrames Frames in the block
+     * @return Packets sent
+     */
+    std::size_t send(const float* interleaved, std::size_t numFrames);
+
+    uint64_t getPacketsSent() const { return packetsSent.load(); }
+    uint64_t getSendErrors() const { return sendErrors.load(); }
+
+    RtpSender(const RtpSender&) = delete;
+    RtpSender& operator=(const RtpSender&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// RtpBackend
+//--------------------------------------------------------------------------
+
+/**
+ * Engine backend that takes audio from an RTP stream, runs the effect
+ * chain and sends the result as another RTP stream.
+ *
+ * The processing thread runs on the local clock, one block per block
+ * period; the drift compensator resamples the jitter buffer's output so
+ * the remote sender's clock is tracked without PTP.
+ */
+class RtpBackend
+{
+private:
+    RtpConfig config;
+    EffectChain& chain;
+    JitterBuffer jitterBuffer;
+    DriftCompensator driftCompensator;
+    RtpReceiver receiver;
+    RtpSender sender;
+
+    std::thread processThread;
+    std::atomic<bool> processing;
+    std::atomic<uint64_t> blocksProcessed;
+    std::atomic<uint64_t> deadlineMisses;
+    std::atomic<double> driftPpm;
+
+    /**
+     * Block loop run on processThread.
+     */
+    void processLoop();
+
+public:
+    /**
+     * Creates an RTP backend.
+     * @param effectChain Chain run on the first channel
+     * @param rtpConfig Addresses and stream format
+     */
+    RtpBackend(EffectChain& effectChain, const RtpConfig& rtpConfig);
+
+    ~RtpBackend();
+
+    /**
+     * Opens sockets and starts the receive and processing threads.
+     * @return true if both directions are running
+     */
+    bool start();
+
+    /**
+     * Stops all threads and closes sockets.
+     */
+    void stop();
+
+    bool isRunning() const { return processing.load(); }
+
+    const JitterBuffer& getJitterBuffer() const { return jitterBuffer; }
+    double getDriftPpm() const { return driftPpm.load(); }
+    uint64_t getBlocksProcessed() const { return blocksProcessed.load(); }
+    uint64_t getDeadlineMisses() const { return deadlineMisses.load(); }
+    uint64_t getPacketsSent() const { return sender.getPacketsSent(); }
+
+    RtpBackend(const RtpBackend&) = delete;
+    RtpBackend& operator=(const RtpBackend&) = delete;
+};
+
+#endif // __linux__
+
+} // namespace audio
+
+#endif // RTP_BACKEND_H
@@ -0,0 +1,175 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Bounded lock-free single-producer/single-consumer ring.
+ *
+ * Slots are preallocated from a prototype so that payloads such as
+ * sample vectors are sized once and reused; producers fill a slot in
+ * place (beginWrite/commitWrite) and consumers read it in place
+ * (front/pop), so no element is ever copied or allocated in steady state.
+ * Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscRingBuffer
+{
+private:
+    std::vector<T> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> writeIndex;
+    alignas(64) std::atomic<std::size_t> readIndex;
+
+    static std::size_t roundUpPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Creates a ring with every slot copied from a prototype.
+     * @param capacity Minimum number of slots
+     * @param prototype Initial value of every slot
+     */
+    explicit SpscRingBuffer(std::size_t capacity, const T& prototype = T())
+        : slots(roundUpPowerOfTwo(capacity < 2 ? 2 : capacity), prototype),
+          mask(slots.size() - 1),
+          writeIndex(0),
+          readIndex(0)
+    {
+    }
+
+    /**
+     * Empties the ring and resets every slot to a prototype.
+     * Use to size payloads up front; only call while neither side is active.
+     * @param prototype New value of every slot
+     */
+    void fill(const T& prototype)
+    {
+        for (T& slot : slots)
+        {
+            slot = prototype;
+        }
+        writeIndex.store(0);
+        readIndex.store(0);
+    }
+
+    //--------------------------------------------------------------------------
+    // Producer Interface
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the next free slot for in-place writing.
+     * @return Slot to fill, or nullptr if the ring is full
+     */
+    T* beginWrite()
+    {
+        std::size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) >= slots.size())
+        {
+            return nullptr;
+        }
+        return &slots[write & mask];
+    }
+
+    /**
+     * Publishes the slot returned by beginWrite().
+     */
+    void commitWrite()
+    {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Copies a value into the ring.
+     * @return false if the ring is full
+     */
+    bool push(const T& value)
+    {
+        T* slot = beginWrite();
+        if (!slot)
+        {
+            return false;
+        }
+        *slot = value;
+        commitWrite();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    // Consumer Interface
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the oldest published slot for in-place reading.
+     * @return Slot to read, or nullptr if the ring is empty
+     */
+    T* front()
+    {
+        std::size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &slots[read & mask];
+    }
+
+    /**
+     * Releases the slot returned by front() back to the producer.
+     */
+    void pop()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Copies the oldest value out of the ring.
+     * @return false if the ring is empty
+     */
+    bool pop(T& value)
+    {
+        T* slot = front();
+        if (!slot)
+        {
+            return false;
+        }
+        value = *slot;
+        pop();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    // Status
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the number of published, unread slots (approximate across threads).
+     */
+    std::size_t size() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return slots.size(); }
+    bool empty() const { return size() == 0; }
+
+    //--------------------------------------------------------------------------
+    // Object Semantics
+    //--------------------------------------------------------------------------
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+};
+
+} // namespace audio
+
+#endif // SPSC_RING_BUFFER_H
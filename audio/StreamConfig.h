@@ -0,0 +1,36 @@
+#ifndef STREAM_CONFIG_H
+#define STREAM_CONFIG_H
+
+#include "../common.h"
+
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Device and format of the duplex RtAudio stream.
+ * Changed at runtime through hot reconfiguration.
+ */
+struct StreamConfig
+{
+    unsigned int inputDevice = 0;
+    unsigned int outputDevice = 0;
+    unsigned int sampleRate = SAMPLE_RATE;
+    unsigned int bufferFrames = FRAMES_PER_BUFFER;  // requested; the driver may adjust it
+};
+
+/**
+ * One selectable audio device.
+ */
+struct DeviceOption
+{
+    unsigned int id = 0;
+    std::string name;
+    unsigned int inputChannels = 0;
+    unsigned int outputChannels = 0;
+};
+
+} // namespace audio
+
+#endif // STREAM_CONFIG_H
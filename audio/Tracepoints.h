@@ -0,0 +1,66 @@
+#ifndef TRACEPOINTS_H
+#define TRACEPOINTS_H
+
+#include <cstdint>
+
+//--------------------------------------------------------------------------
+// Static Tracepoints
+//--------------------------------------------------------------------------
+//
+// USDT probes under the provider "multiaudio", for attaching bpftrace,
+// perf or SystemTap to a running process. Build with -DMULTIAUDIO_WITH_USDT
+// on Linux (needs <sys/sdt.h>, e.g. systemtap-sdt-dev); otherwise every
+// probe compiles to nothing. When built in, an unattached probe is a single
+// nop; its arguments are values the caller already has in registers.
+//
+//   callback_entry  (stream, seq, frames)          backend period begins
+//   callback_exit   (stream, seq, frames, status)  status: 0 ok, 1 underrun/silence
+//   xrun            (stream, seq)                  reported by the backend
+//   queue_push      (queue, seq, samples, depth)   depth after the push
+//   queue_pop       (queue, seq, samples, depth)   depth after the pop
+//   process_start   (stream, seq, frames)          EffectChain::process
+//   process_end     (stream, seq, frames)
+//   effect_enter    (stream, seq, stage, frames)   stage: audio::ProfileStage
+//   effect_exit     (stream, seq, stage, frames)
+//
+// seq is the chain's block number for stream probes and the block header's
+// sequence number (see BlockHeader.h) for queue probes.
+
+#if defined(MULTIAUDIO_WITH_USDT) && defined(__linux__)
+#include <sys/sdt.h>
+#define MULTIAUDIO_TRACE2(name, a, b) DTRACE_PROBE2(multiaudio, name, a, b)
+#define MULTIAUDIO_TRACE3(name, a, b, c) DTRACE_PROBE3(multiaudio, name, a, b, c)
+#define MULTIAUDIO_TRACE4(name, a, b, c, d) DTRACE_PROBE4(multiaudio, name, a, b, c, d)
+#else
+// Unevaluated, so arguments count as used but cost nothing
+#define MULTIAUDIO_TRACE2(name, a, b) ((void)sizeof((a), (b)))
+#define MULTIAUDIO_TRACE3(name, a, b, c) ((void)sizeof((a), (b), (c)))
+#define MULTIAUDIO_TRACE4(name, a, b, c, d) ((void)sizeof((a), (b), (c), (d)))
+#endif
+
+namespace audio {
+
+/**
+ * Stream ids carried by stream probes (one per backend).
+ */
+enum TraceStream : uint32_t
+{
+    TRACE_STREAM_NONE = 0,
+    TRACE_STREAM_RTAUDIO = 1,
+    TRACE_STREAM_JACK = 2,
+    TRACE_STREAM_RTP = 3
+};
+
+/**
+ * Queue ids carried by queue probes.
+ */
+enum TraceQueue : uint32_t
+{
+    TRACE_QUEUE_NONE = 0,
+    TRACE_QUEUE_INPUT = 1,      // callback -> processing thread
+    TRACE_QUEUE_OUTPUT = 2      // processing thread -> callback
+};
+
+} // namespace audio
+
+#endif // TRACEPOINTS_H
@@ -0,0 +1,209 @@
+#include "Watchdog.h"
+#include "BlockHeader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace audio {
+
+namespace {
+
+const uint64_t NANOS_PER_MS = 1000000;
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+Watchdog::Watchdog(const WatchdogConfig& watchdogConfig)
+    : config(watchdogConfig),
+      watching(false)
+{
+}
+
+Watchdog::~Watchdog()
+{
+    stop();
+}
+
+std::size_t Watchdog::addComponent(const std::string& name, const Heartbeat& heartbeat, uint32_t stallMs,
+                                   RecoveryAction recover, const Heartbeat* input)
+{
+    std::unique_ptr<Component> component(new Component());
+    component->name = name;
+    component->heartbeat = &heartbeat;
+    component->input = input;
+    component->stallNanos = stallMs * NANOS_PER_MS;
+    component->recover = std::move(recover);
+    component->pendingFault.store(nullptr);
+    component->recoveries.store(0);
+    component->failures.store(0);
+    components.push_back(std::move(component));
+    return components.size() - 1;
+}
+
+bool Watchdog::start()
+{
+    if (watching.load())
+    {
+        return true;
+    }
+
+    // Every component starts with a full stall period of grace
+    const uint64_t now = blockClockNanos();
+    for (auto& component : components)
+    {
+        component->lastBeats = component->heartbeat->getBeats();
+        component->lastInputBeats = component->input ? component->input->getBeats() : 0;
+        component->lastInputNanos = now;
+        component->lastProgressNanos = now;
+        component->nextAttemptNanos = 0;
+        component->backoffNanos = config.initialBackoffMs * NANOS_PER_MS;
+        component->attempts = 0;
+    }
+
+    watching.store(true);
+    watchThread = std::thread(&Watchdog::watchLoop, this);
+    return true;
+}
+
+void Watchdog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        watching.store(false);
+    }
+    wake.notify_all();
+    if (watchThread.joinable())
+    {
+        watchThread.join();
+    }
+}
+
+//--------------------------------------------------------------------------
+// Faults and Events
+//--------------------------------------------------------------------------
+
+void Watchdog::reportFault(std::size_t component, const char* reason)
+{
+    if (component < components.size())
+    {
+        components[component]->pendingFault.store(reason ? reason : "fault reported");
+    }
+}
+
+std::vector<RecoveryEvent> Watchdog::getEvents() const
+{
+    std::lock_guard<std::mutex> lock(eventMutex);
+    return events;
+}
+
+//--------------------------------------------------------------------------
+// Supervision
+//--------------------------------------------------------------------------
+
+void Watchdog::watchLoop()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (watching.load())
+    {
+        wake.wait_for(lock, std::chrono::milliseconds(config.pollMs));
+        if (!watching.load())
+        {
+            break;
+        }
+
+        // Recovery actions may block for a while; stop() must not wait on the lock meanwhile
+        lock.unlock();
+        for (auto& component : components)
+        {
+            check(*component, blockClockNanos());
+        }
+        lock.lock();
+    }
+}
+
+void Watchdog::check(Component& component, uint64_t now)
+{
+    const uint64_t beats = component.heartbeat->getBeats();
+    if (beats != component.lastBeats)
+    {
+        component.lastBeats = beats;
+        component.lastProgressNanos = now;
+        // Healthy for a full stall period since the last recovery: start backoff over
+        if (component.attempts > 0 && now - component.lastRecoveryNanos >= component.stallNanos)
+        {
+            component.attempts = 0;
+            component.backoffNanos = config.initialBackoffMs * NANOS_PER_MS;
+        }
+    }
+    if (component.input)
+    {
+        const uint64_t inputBeats = component.input->getBeats();
+        if (inputBeats != component.lastInputBeats)
+        {
+            component.lastInputBeats = inputBeats;
+            component.lastInputNanos = now;
+        }
+        // Input idle for half a stall period (longer than any block gap): waiting is not a stall
+        if (now - component.lastInputNanos >= component.stallNanos / 2)
+        {
+            component.lastProgressNanos = now;
+        }
+    }
+
+    const bool stalled = now - component.lastProgressNanos >= component.stallNanos;
+    const char* fault = component.pendingFault.load();
+    if (!stalled && !fault)
+    {
+        return;
+    }
+    if (now < component.nextAttemptNanos)
+    {
+        return; // Still backing off; a pending fault waits for the next attempt
+    }
+    component.pendingFault.store(nullptr);
+
+    RecoveryEvent event;
+    event.component = component.name;
+    event.reason = fault ? fault : "heartbeat stalled";
+    event.attempt = ++component.attempts;
+    event.stalledMs = (now - component.lastProgressNanos) / 1e6;
+
+    std::cerr << "[Watchdog] " << component.name << ": " << event.reason << " (" << event.stalledMs
+              << " ms since last heartbeat), recovery attempt " << event.attempt << std::endl;
+    event.recovered = component.recover();
+    event.timeNanos = blockClockNanos();
+    if (event.recovered)
+    {
+        component.recoveries.fetch_add(1);
+        std::cerr << "[Watchdog] " << component.name << ": recovered." << std::endl;
+    }
+    else
+    {
+        component.failures.fetch_add(1);
+        std::cerr << "[Watchdog] ERROR: " << component.name << ": recovery failed, retrying in "
+                  << component.backoffNanos / NANOS_PER_MS << " ms." << std::endl;
+    }
+
+    // A restarted component gets a fresh stall period; either way the next attempt waits out the backoff
+    if (event.recovered)
+    {
+        component.lastBeats = component.heartbeat->getBeats();
+        component.lastProgressNanos = event.timeNanos;
+    }
+    component.lastRecoveryNanos = event.timeNanos;
+    component.nextAttemptNanos = event.timeNanos + component.backoffNanos;
+    component.backoffNanos = std::min(component.backoffNanos * 2, config.maxBackoffMs * NANOS_PER_MS);
+
+    std::lock_guard<std::mutex> lock(eventMutex);
+    events.push_back(event);
+    if (events.size() > config.maxEvents)
+    {
+        events.erase(events.begin());
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,163 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Progress counter a supervised thread bumps once per unit of work.
+ * Beating is a single relaxed increment, safe on the audio thread.
+ */
+class Heartbeat
+{
+private:
+    std::atomic<uint64_t> beats;
+
+public:
+    Heartbeat() : beats(0) {}
+
+    void beat() { beats.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t getBeats() const { return beats.load(std::memory_order_relaxed); }
+};
+
+/**
+ * One recovery attempt made by the watchdog.
+ */
+struct RecoveryEvent
+{
+    uint64_t timeNanos = 0;     // blockClockNanos() when the attempt finished
+    std::string component;
+    std::string reason;         // "heartbeat stalled" or the reported fault
+    uint32_t attempt = 0;       // 1 for the first attempt since the component was last healthy
+    double stalledMs = 0.0;     // time since the last heartbeat when recovery began
+    bool recovered = false;     // what the recovery action returned
+};
+
+/**
+ * Watchdog timing.
+ */
+struct WatchdogConfig
+{
+    uint32_t pollMs = 50;               // how often heartbeats are checked
+    uint32_t initialBackoffMs = 200;    // wait after a recovery before the next one
+    uint32_t maxBackoffMs = 10000;      // backoff doubles up to this
+    std::size_t maxEvents = 256;        // oldest events are dropped beyond this
+};
+
+/**
+ * Supervises engine components through their heartbeats.
+ *
+ * Each component names a heartbeat, how long it may go without a beat,
+ * and a recovery action. A background thread polls the heartbeats; when
+ * one stalls (or a fault is reported for it) the action runs on the
+ * watchdog thread. Repeated recoveries back off exponentially until the
+ * component has been healthy for a full stall period again. Every attempt
+ * is recorded as a RecoveryEvent.
+ *
+ * Components are checked in registration order, so register cheap,
+ * local recoveries (restart a thread) before expensive ones (reopen a
+ * device) and give the latter a longer stall timeout: a wedged pipeline
+ * then gets restarted before the device is blamed.
+ *
+ * A component that only works when fed (a consumer of the device's
+ * blocks) can name its input's heartbeat too: once the input has been
+ * idle for half a stall period, the component is waiting, not stalled,
+ * and its stall clock stays at zero until input arrives again. A dead device then gets recovered as a device, instead of the
+ * consumer being restarted over and over behind it.
+ */
+class Watchdog
+{
+public:
+    using RecoveryAction = std::function<bool()>;
+
+private:
+    struct Component
+    {
+        std::string name;
+        const Heartbeat* heartbeat;
+        const Heartbeat* input;     // optional: the work feeding the component
+        uint64_t stallNanos;
+        RecoveryAction recover;
+        std::atomic<const char*> pendingFault;  // set from any thread, taken by the watchdog
+        std::atomic<uint64_t> recoveries;
+        std::atomic<uint64_t> failures;
+
+        // Watchdog thread only
+        uint64_t lastBeats = 0;
+        uint64_t lastInputBeats = 0;
+        uint64_t lastInputNanos = 0;
+        uint64_t lastProgressNanos = 0;
+        uint64_t lastRecoveryNanos = 0;
+        uint64_t nextAttemptNanos = 0;
+        uint64_t backoffNanos = 0;
+        uint32_t attempts = 0;
+    };
+
+    WatchdogConfig config;
+    std::vector<std::unique_ptr<Component>> components;
+    std::thread watchThread;
+    std::atomic<bool> watching;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    mutable std::mutex eventMutex;
+    std::vector<RecoveryEvent> events;
+
+    void watchLoop();
+    void check(Component& component, uint64_t now);
+
+public:
+    explicit Watchdog(const WatchdogConfig& config = WatchdogConfig());
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * Adds a supervised component. Call before start().
+     *
+     * @param name Component name used in events and logs
+     * @param heartbeat Beaten by the component while it makes progress (must outlive the watchdog)
+     * @param stallMs Time without a beat after which the component is recovered
+     * @param recover Runs on the watchdog thread; returns true if the component was restarted
+     * @param input Beaten as work arrives for the component; a stall only counts while it beats (nullptr: always)
+     * @return Index for reportFault() and the per-component getters
+     */
+    std::size_t addComponent(const std::string& name, const Heartbeat& heartbeat, uint32_t stallMs,
+                             RecoveryAction recover, const Heartbeat* input = nullptr);
+
+    /**
+     * Requests recovery of a component without waiting for its heartbeat to stall
+     * (e.g. from a device error callback). Lock-free; safe from any thread.
+     *
+     * @param reason String literal describing the fault
+     */
+    void reportFault(std::size_t component, const char* reason);
+
+    bool start();
+    void stop();
+    bool isWatching() const { return watching.load(); }
+
+    std::size_t getComponentCount() const { return components.size(); }
+    const std::string& getComponentName(std::size_t component) const { return components[component]->name; }
+    uint64_t getRecoveries(std::size_t component) const { return components[component]->recoveries.load(); }
+    uint64_t getFailures(std::size_t component) const { return components[component]->failures.load(); }
+
+    /**
+     * Copies the recorded recovery events, oldest first.
+     */
+    std::vector<RecoveryEvent> getEvents() const;
+};
+
+} // namespace audio
+
+#endif // WATCHDOG_H
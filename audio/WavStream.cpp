@@ -0,0 +1,751 @@
+#include "WavStream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <sys/stat.h>
+
+namespace audio {
+
+namespace {
+
+// Audio data starts one aligned block into files we write; a JUNK chunk
+// pads the header out to it so every data write stays aligned.
+const std::size_t HEADER_BYTES = ASYNC_IO_ALIGNMENT;
+
+uint64_t alignDown(uint64_t value)
+{
+    return value / ASYNC_IO_ALIGNMENT * ASYNC_IO_ALIGNMENT;
+}
+
+uint64_t alignUp(uint64_t value)
+{
+    return alignDown(value + ASYNC_IO_ALIGNMENT - 1);
+}
+
+void putU16(unsigned char* at, uint16_t value)
+{
+    at[0] = static_cast<unsigned char>(value & 0xFF);
+    at[1] = static_cast<unsigned char>(value >> 8);
+}
+
+void putU32(unsigned char* at, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        at[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint16_t getU16(const unsigned char* at)
+{
+    return static_cast<uint16_t>(at[0] | (at[1] << 8));
+}
+
+uint32_t getU32(const unsigned char* at)
+{
+    return static_cast<uint32_t>(at[0]) | (static_cast<uint32_t>(at[1]) << 8) |
+           (static_cast<uint32_t>(at[2]) << 16) | (static_cast<uint32_t>(at[3]) << 24);
+}
+
+void encodeSample(float sample, WavEncoding encoding, unsigned char* out)
+{
+    if (encoding == WavEncoding::Float32)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &sample, sizeof(bits));
+        putU32(out, bits);
+        return;
+    }
+
+    double clamped = std::max(-1.0, std::min(1.0, static_cast<double>(sample)));
+    switch (encoding)
+    {
+        case WavEncoding::Pcm16:
+            putU16(out, static_cast<uint16_t>(static_cast<int16_t>(std::lrint(clamped * 32767.0))));
+            break;
+        case WavEncoding::Pcm24:
+        {
+            int32_t value = static_cast<int32_t>(std::lrint(clamped * 8388607.0));
+            out[0] = static_cast<unsigned char>(value & 0xFF);
+            out[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+            out[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+            break;
+        }
+        case WavEncoding::Pcm32:
+            putU32(out, static_cast<uint32_t>(static_cast<int32_t>(std::llrint(clamped * 2147483647.0))));
+            break;
+        case WavEncoding::Float32:
+            break;
+    }
+}
+
+float decodeSample(const unsigned char* in, WavEncoding encoding)
+{
+    switch (encoding)
+    {
+        case WavEncoding::Pcm16:
+            return static_cast<int16_t>(getU16(in)) / 32768.0f;
+        case WavEncoding::Pcm24:
+        {
+            int32_t value = static_cast<int32_t>(static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                                                 (static_cast<uint32_t>(in[2]) << 16) | (in[2] & 0x80 ? 0xFF000000u : 0u));
+            return value / 8388608.0f;
+        }
+        case WavEncoding::Pcm32:
+            return static_cast<float>(static_cast<int32_t>(getU32(in)) / 2147483648.0);
+        case WavEncoding::Float32:
+        {
+            uint32_t bits = getU32(in);
+            float sample;
+            std::memcpy(&sample, &bits, sizeof(sample));
+            return sample;
+        }
+    }
+    return 0.0f;
+}
+
+// Completes a transfer that came back short (done bytes of wanted) on the calling thread
+long finishTransfer(const AsyncIORequest& request, std::size_t wanted, long done)
+{
+    if (done < 0 || static_cast<std::size_t>(done) >= wanted)
+    {
+        return done;
+    }
+    AsyncIORequest rest = request;
+    rest.buffer = static_cast<char*>(request.buffer) + done;
+    rest.bytes = wanted - static_cast<std::size_t>(done);
+    rest.offset = request.offset + static_cast<uint64_t>(done);
+    const long more = AsyncFileIO::transferNow(rest);
+    return more > 0 ? done + more : done;
+}
+
+} // namespace
+
+unsigned int wavBytesPerSample(WavEncoding encoding)
+{
+    switch (encoding)
+    {
+        case WavEncoding::Pcm16:   return 2;
+        case WavEncoding::Pcm24:   return 3;
+        case WavEncoding::Pcm32:   return 4;
+        case WavEncoding::Float32: return 4;
+    }
+    return 4;
+}
+
+//--------------------------------------------------------------------------
+// WavStreamWriter
+//--------------------------------------------------------------------------
+
+WavStreamWriter::WavStreamWriter()
+    : fd(-1),
+      direct(false),
+      encoding(WavEncoding::Float32),
+      numChannels(1),
+      sampleRate(0),
+      bytesPerSample(4),
+      header(HEADER_BYTES),
+      current(0),
+      fill(0),
+      fileOffset(0),
+      dataBytes(0),
+      bytesCompleted(0),
+      writeErrors(0)
+{
+}
+
+WavStreamWriter::~WavStreamWriter()
+{
+    close();
+}
+
+bool WavStreamWriter::open(const std::string& path, unsigned int channels, unsigned int rate,
+                           WavEncoding wavEncoding, const WavStreamConfig& streamConfig)
+{
+    close();
+
+    config = streamConfig;
+    encoding = wavEncoding;
+    numChannels = std::max(1u, channels);
+    sampleRate = rate;
+    bytesPerSample = wavBytesPerSample(encoding);
+
+    fd = AsyncFileIO::openFile(path, true, config.directIO, &direct);
+    if (fd < 0)
+    {
+        std::cerr << "[WavStream] ERROR: Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const unsigned int depth = std::max(1u, config.buffersInFlight);
+    if (!io.open(depth, config.backend))
+    {
+        AsyncFileIO::closeFile(fd);
+        fd = -1;
+        return false;
+    }
+
+    // Buffers are sized once here; write() never allocates
+    const std::size_t bufferBytes = static_cast<std::size_t>(alignUp(std::max<std::size_t>(ASYNC_IO_ALIGNMENT, config.bufferBytes)));
+    slots.clear();
+    slots.resize(depth);
+    for (Slot& slot : slots)
+    {
+        slot.buffer.resize(bufferBytes);
+    }
+
+    current = 0;
+    fill = 0;
+    fileOffset = HEADER_BYTES;
+    dataBytes = 0;
+    bytesCompleted = 0;
+    writeErrors = 0;
+    return writeHeader();
+}
+
+bool WavStreamWriter::writeHeader()
+{
+    unsigned char* at = reinterpret_cast<unsigned char*>(header.data());
+    std::memset(at, 0, HEADER_BYTES);
+
+    const bool isFloat = (encoding == WavEncoding::Float32);
+    const uint32_t fmtBytes = isFloat ? 18 : 16;    // float carries cbSize
+    const uint32_t junkBytes = static_cast<uint32_t>(HEADER_BYTES - 12 - 8 - (8 + fmtBytes) - 8);
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes, 0xFFFFFFFFu - HEADER_BYTES));
+    const uint16_t blockAlign = static_cast<uint16_t>(numChannels * bytesPerSample);
+
+    std::memcpy(at, "RIFF", 4);
+    putU32(at + 4, static_cast<uint32_t>(HEADER_BYTES - 8) + dataSize);
+    std::memcpy(at + 8, "WAVE", 4);
+    at += 12;
+
+    std::memcpy(at, "JUNK", 4);
+    putU32(at + 4, junkBytes);
+    at += 8 + junkBytes;
+
+    std::memcpy(at, "fmt ", 4);
+    putU32(at + 4, fmtBytes);
+    putU16(at + 8, isFloat ? 3 : 1);
+    putU16(at + 10, static_cast<uint16_t>(numChannels));
+    putU32(at + 12, sampleRate);
+    putU32(at + 16, sampleRate * blockAlign);
+    putU16(at + 20, blockAlign);
+    putU16(at + 22, static_cast<uint16_t>(bytesPerSample * 8));
+    at += 8 + fmtBytes;
+
+    std::memcpy(at, "data", 4);
+    putU32(at + 4, dataSize);
+
+    AsyncIORequest request;
+    request.fd = fd;
+    request.buffer = header.data();
+    request.bytes = HEADER_BYTES;
+    request.offset = 0;
+    request.write = true;
+    if (AsyncFileIO::transferNow(request) != static_cast<long>(HEADER_BYTES))
+    {
+        writeErrors++;
+        return false;
+    }
+    return true;
+}
+
+void WavStreamWriter::collect(bool wait)
+{
+    AsyncIOCompletion done[16];
+    std::size_t count = io.reap(done, 16, wait);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Slot& slot = slots[done[i].tag];
+        AsyncIORequest request;
+        request.fd = fd;
+        request.buffer = slot.buffer.data();
+        request.offset = slot.fileOffset;
+        request.write = true;
+        // A short write keeps the rest of the block: finish it here before calling it an error
+        if (finishTransfer(request, slot.requested, done[i].result) != static_cast<long>(slot.requested))
+        {
+            writeErrors++;
+        }
+        else
+        {
+            bytesCompleted += slot.audioBytes;
+        }
+        slot.busy = false;
+    }
+}
+
+bool WavStreamWriter::submitCurrent(std::size_t bytes, std::size_t audioBytes)
+{
+    Slot& slot = slots[current];
+    slot.fileOffset = fileOffset;
+    slot.requested = bytes;
+    slot.audioBytes = audioBytes;
+    slot.busy = true;
+
+    AsyncIORequest request;
+    request.fd = fd;
+    request.buffer = slot.buffer.data();
+    request.bytes = bytes;
+    request.offset = fileOffset;
+    request.write = true;
+    request.tag = current;
+
+    if (!io.submit(request))
+    {
+        // Queue refused it: write synchronously rather than lose audio
+        long result = AsyncFileIO::transferNow(request);
+        if (result != static_cast<long>(bytes))
+        {
+            writeErrors++;
+        }
+        else
+        {
+            bytesCompleted += audioBytes;
+        }
+        slot.busy = false;
+    }
+
+    fileOffset += bytes;
+    dataBytes += audioBytes;
+    fill = 0;
+    current = (current + 1) % slots.size();
+
+    // Only blocks when every buffer is still queued: the disk is the bottleneck
+    while (slots[current].busy)
+    {
+        collect(true);
+    }
+    return writeErrors == 0;
+}
+
+bool WavStreamWriter::write(const float* interleaved, std::size_t numFrames)
+{
+    return writeSamples(interleaved, numFrames * numChannels);
+}
+
+bool WavStreamWriter::writeSamples(const float* samples, std::size_t count)
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    const std::size_t bufferBytes = slots[current].buffer.size();
+    std::size_t i = 0;
+    while (i < count)
+    {
+        unsigned char* buffer = reinterpret_cast<unsigned char*>(slots[current].buffer.data());
+
+        if (encoding == WavEncoding::Float32)
+        {
+            // Same layout on little-endian hosts: copy straight in
+            std::size_t n = std::min(count - i, (bufferBytes - fill) / sizeof(float));
+            std::memcpy(buffer + fill, samples + i, n * sizeof(float));
+            fill += n * sizeof(float);
+            i += n;
+        }
+        else
+        {
+            while (i < count && fill + bytesPerSample <= bufferBytes)
+            {
+                encodeSample(samples[i++], encoding, buffer + fill);
+                fill += bytesPerSample;
+            }
+            if (i < count && fill < bufferBytes)
+            {
+                // 24-bit samples can straddle two buffers
+                unsigned char bytes[4];
+                encodeSample(samples[i++], encoding, bytes);
+                std::size_t head = bufferBytes - fill;
+                std::memcpy(buffer + fill, bytes, head);
+                fill = bufferBytes;
+                submitCurrent(bufferBytes, bufferBytes);
+                std::memcpy(slots[current].buffer.data(), bytes + head, bytesPerSample - head);
+                fill = bytesPerSample - head;
+                continue;
+            }
+        }
+
+        if (fill == bufferBytes)
+        {
+            submitCurrent(bufferBytes, bufferBytes);
+        }
+    }
+    return writeErrors == 0;
+}
+
+bool WavStreamWriter::close()
+{
+    if (fd < 0)
+    {
+        return writeErrors == 0;
+    }
+
+    if (fill > 0)
+    {
+        // O_DIRECT writes whole aligned blocks; the zero tail is truncated away below
+        const std::size_t audioBytes = fill;
+        const std::size_t bytes = direct ? static_cast<std::size_t>(alignUp(fill)) : fill;
+        std::memset(slots[current].buffer.data() + fill, 0, bytes - fill);
+        submitCurrent(bytes, audioBytes);
+    }
+    while (io.getInFlight() > 0)
+    {
+        collect(true);
+    }
+    io.close();
+
+    if (direct && !AsyncFileIO::truncateFile(fd, HEADER_BYTES + dataBytes))
+    {
+        writeErrors++;
+    }
+    writeHeader();
+
+    AsyncFileIO::closeFile(fd);
+    fd = -1;
+    return writeErrors == 0;
+}
+
+//--------------------------------------------------------------------------
+// WavStreamReader
+//--------------------------------------------------------------------------
+
+WavStreamReader::WavStreamReader()
+    : fd(-1),
+      direct(false),
+      bytesPerSample(4),
+      nextIssueOffset(0),
+      readEnd(0),
+      issueIndex(0),
+      consumeIndex(0),
+      consumePos(0),
+      carry(),
+      carryBytes(0),
+      framesRead(0),
+      failed(false)
+{
+}
+
+WavStreamReader::~WavStreamReader()
+{
+    close();
+}
+
+bool WavStreamReader::parseHeader(const std::string& path)
+{
+    // Header parsing uses small unaligned reads, so it gets its own buffered descriptor
+    int headerFd = AsyncFileIO::openFile(path, false, false, nullptr);
+    if (headerFd < 0)
+    {
+        return false;
+    }
+
+    auto readAt = [headerFd](unsigned char* out, std::size_t bytes, uint64_t offset) {
+        AsyncIORequest request;
+        request.fd = headerFd;
+        request.buffer = out;
+        request.bytes = bytes;
+        request.offset = offset;
+        return AsyncFileIO::transferNow(request) == static_cast<long>(bytes);
+    };
+
+    unsigned char riff[12];
+    bool ok = readAt(riff, 12, 0) && std::memcmp(riff, "RIFF", 4) == 0 && std::memcmp(riff + 8, "WAVE", 4) == 0;
+    bool haveFormat = false;
+    bool haveData = false;
+    uint16_t formatTag = 0;
+    uint16_t bitsPerSample = 0;
+
+    uint64_t offset = 12;
+    while (ok && !haveData)
+    {
+        unsigned char chunk[8];
+        if (!readAt(chunk, 8, offset))
+        {
+            break;
+        }
+        const uint32_t size = getU32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            unsigned char fmt[40] = {};
+            if (size < 16 || !readAt(fmt, std::min<uint32_t>(size, sizeof(fmt)), offset + 8))
+            {
+                ok = false;
+                break;
+            }
+            formatTag = getU16(fmt);
+            info.channels = getU16(fmt + 2);
+            info.sampleRate = getU32(fmt + 4);
+            bitsPerSample = getU16(fmt + 14);
+            if (formatTag == 0xFFFE && size >= 26)
+            {
+                formatTag = getU16(fmt + 24);   // first bytes of the SubFormat GUID
+            }
+            haveFormat = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            info.dataOffset = offset + 8;
+            info.dataBytes = size;
+            haveData = true;
+        }
+        offset += 8 + size + (size & 1);
+    }
+
+    // Streamed/unfinished files leave the data size at 0 or 0xFFFFFFFF: use the file length
+    struct stat fileStat;
+    if (ok && haveData && fstat(headerFd, &fileStat) == 0)
+    {
+        const uint64_t available = static_cast<uint64_t>(fileStat.st_size) > info.dataOffset
+                                       ? static_cast<uint64_t>(fileStat.st_size) - info.dataOffset : 0;
+        if (info.dataBytes == 0 || info.dataBytes == 0xFFFFFFFFu || info.dataBytes > available)
+        {
+            info.dataBytes = available;
+        }
+    }
+    AsyncFileIO::closeFile(headerFd);
+
+    if (!ok || !haveFormat || !haveData || info.channels == 0)
+    {
+        return false;
+    }
+
+    if (formatTag == 1 && bitsPerSample == 16)
+    {
+        info.encoding = WavEncoding::Pcm16;
+    }
+    else if (formatTag == 1 && bitsPerSample == 24)
+    {
+        info.encoding = WavEncoding::Pcm24;
+    }
+    else if (formatTag == 1 && bitsPerSample == 32)
+    {
+        info.encoding = WavEncoding::Pcm32;
+    }
+    else if (formatTag == 3 && bitsPerSample == 32)
+    {
+        info.encoding = WavEncoding::Float32;
+    }
+    else
+    {
+        return false;
+    }
+
+    bytesPerSample = wavBytesPerSample(info.encoding);
+    info.frames = info.dataBytes / (static_cast<uint64_t>(bytesPerSample) * info.channels);
+    info.dataBytes = info.frames * bytesPerSample * info.channels;
+    return true;
+}
+
+bool WavStreamReader::open(const std::string& path, const WavStreamConfig& streamConfig, uint64_t startFrame)
+{
+    close();
+    config = streamConfig;
+    info = WavInfo();
+
+    if (!parseHeader(path))
+    {
+        return false;
+    }
+
+    fd = AsyncFileIO::openFile(path, false, config.directIO, &direct);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    const unsigned int depth = std::max(1u, config.buffersInFlight);
+    if (!io.open(depth, config.backend))
+    {
+        AsyncFileIO::closeFile(fd);
+        fd = -1;
+        return false;
+    }
+
+    const std::size_t bufferBytes = static_cast<std::size_t>(alignUp(std::max<std::size_t>(ASYNC_IO_ALIGNMENT, config.bufferBytes)));
+    slots.clear();
+    slots.resize(depth);
+    for (Slot& slot : slots)
+    {
+        slot.buffer.resize(bufferBytes);
+    }
+
+    // Reads start on the aligned block holding the first requested sample
+    const uint64_t frameBytes = static_cast<uint64_t>(bytesPerSample) * info.channels;
+    const uint64_t firstByte = info.dataOffset + std::min(startFrame, info.frames) * frameBytes;
+    nextIssueOffset = alignDown(firstByte);
+    readEnd = info.dataOffset + info.dataBytes;
+    issueIndex = 0;
+    consumeIndex = 0;
+    consumePos = static_cast<std::size_t>(firstByte - nextIssueOffset);
+    carryBytes = 0;
+    framesRead = 0;
+    failed = false;
+
+    issueReads();
+    return true;
+}
+
+void WavStreamReader::issueReads()
+{
+    while (issueIndex - consumeIndex < slots.size() && nextIssueOffset < readEnd)
+    {
+        const std::size_t index = issueIndex % slots.size();
+        Slot& slot = slots[index];
+        slot.fileOffset = nextIssueOffset;
+        slot.ready = false;
+        slot.pending = true;
+
+        AsyncIORequest request;
+        request.fd = fd;
+        request.buffer = slot.buffer.data();
+        request.bytes = slot.buffer.size();
+        request.offset = nextIssueOffset;
+        request.tag = index;
+
+        if (!io.submit(request))
+        {
+            slot.result = AsyncFileIO::transferNow(request);
+            slot.pending = false;
+            slot.ready = true;
+        }
+
+        nextIssueOffset += slot.buffer.size();
+        issueIndex++;
+    }
+}
+
+WavStreamReader::Slot* WavStreamReader::currentSlot()
+{
+    if (consumeIndex == issueIndex)
+    {
+        return nullptr;
+    }
+
+    Slot& slot = slots[consumeIndex % slots.size()];
+    while (!slot.ready)
+    {
+        AsyncIOCompletion done[16];
+        std::size_t count = io.reap(done, 16, true);
+        if (count == 0)
+        {
+            failed = true;
+            return nullptr;
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Slot& completed = slots[done[i].tag];
+            // Short before the data end: read the rest here, so only a real end of file looks truncated
+            AsyncIORequest request;
+            request.fd = fd;
+            request.buffer = completed.buffer.data();
+            request.offset = completed.fileOffset;
+            const std::size_t wanted = static_cast<std::size_t>(
+                std::min<uint64_t>(completed.buffer.size(), readEnd - std::min(readEnd, completed.fileOffset)));
+            completed.result = finishTransfer(request, wanted, done[i].result);
+            completed.pending = false;
+            completed.ready = true;
+        }
+    }
+    return &slot;
+}
+
+std::size_t WavStreamReader::read(float* interleaved, std::size_t numFrames)
+{
+    if (fd < 0 || failed)
+    {
+        return 0;
+    }
+
+    const std::size_t wanted = numFrames * info.channels;
+    std::size_t produced = 0;
+
+    while (produced < wanted)
+    {
+        Slot* slot = currentSlot();
+        if (!slot)
+        {
+            break;
+        }
+        if (slot->result < 0)
+        {
+            failed = true;
+            break;
+        }
+
+        const uint64_t validEnd = std::min<uint64_t>(slot->fileOffset + static_cast<uint64_t>(slot->result), readEnd);
+        const std::size_t end = validEnd > slot->fileOffset ? static_cast<std::size_t>(validEnd - slot->fileOffset) : 0;
+        const unsigned char* buffer = reinterpret_cast<const unsigned char*>(slot->buffer.data());
+
+        if (carryBytes > 0 && consumePos < end)
+        {
+            // Finish the sample split across the previous slot
+            std::size_t n = std::min<std::size_t>(bytesPerSample - carryBytes, end - consumePos);
+            std::memcpy(carry + carryBytes, buffer + consumePos, n);
+            carryBytes += static_cast<unsigned int>(n);
+            consumePos += n;
+            if (carryBytes == bytesPerSample)
+            {
+                interleaved[produced++] = decodeSample(carry, info.encoding);
+                carryBytes = 0;
+            }
+        }
+
+        if (info.encoding == WavEncoding::Float32 && carryBytes == 0)
+        {
+            std::size_t n = std::min(wanted - produced, (end - std::min(end, consumePos)) / sizeof(float));
+            std::memcpy(interleaved + produced, buffer + consumePos, n * sizeof(float));
+            produced += n;
+            consumePos += n * sizeof(float);
+        }
+        while (produced < wanted && consumePos + bytesPerSample <= end)
+        {
+            interleaved[produced++] = decodeSample(buffer + consumePos, info.encoding);
+            consumePos += bytesPerSample;
+        }
+        if (produced < wanted && consumePos < end)
+        {
+            carryBytes = static_cast<unsigned int>(end - consumePos);
+            std::memcpy(carry, buffer + consumePos, carryBytes);
+            consumePos = end;
+        }
+
+        if (consumePos >= end)
+        {
+            // Still short before the data end once finished: the file was truncated
+            if (validEnd < std::min<uint64_t>(slot->fileOffset + slot->buffer.size(), readEnd))
+            {
+                readEnd = validEnd;
+                nextIssueOffset = readEnd;
+            }
+            slot->ready = false;
+            consumeIndex++;
+            consumePos = 0;
+            issueReads();
+        }
+    }
+
+    const std::size_t frames = produced / info.channels;
+    framesRead += frames;
+    return frames;
+}
+
+void WavStreamReader::close()
+{
+    if (fd < 0)
+    {
+        return;
+    }
+    io.close();
+    AsyncFileIO::closeFile(fd);
+    fd = -1;
+    slots.clear();
+}
+
+} // namespace audio
@@ -0,0 +1,230 @@
+#ifndef WAV_STREAM_H
+#define WAV_STREAM_H
+
+#include "AsyncFileIO.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Sample encodings handled by the streaming WAV reader and writer.
+ */
+enum class WavEncoding
+{
+    Pcm16,
+    Pcm24,
+    Pcm32,
+    Float32
+};
+
+/**
+ * I/O settings for WavStreamReader and WavStreamWriter.
+ */
+struct WavStreamConfig
+{
+    std::size_t bufferBytes = 1 << 20;  // bytes per request, rounded to 4096
+    unsigned int buffersInFlight = 4;   // requests kept queued at once
+    bool directIO = true;               // O_DIRECT where the filesystem allows it
+    AsyncIOBackend backend = AsyncIOBackend::Auto;
+};
+
+/**
+ * Format of an opened WAV file.
+ */
+struct WavInfo
+{
+    unsigned int channels = 0;
+    unsigned int sampleRate = 0;
+    WavEncoding encoding = WavEncoding::Float32;
+    uint64_t frames = 0;
+    uint64_t dataOffset = 0;    // file offset of the first sample byte
+    uint64_t dataBytes = 0;
+};
+
+/**
+ * Gets the stored size of one sample.
+ */
+unsigned int wavBytesPerSample(WavEncoding encoding);
+
+//--------------------------------------------------------------------------
+// WavStreamWriter
+//--------------------------------------------------------------------------
+
+/**
+ * WAV writer that keeps several large aligned writes in flight.
+ *
+ * Samples are converted into one of a set of aligned buffers; each full
+ * buffer is handed to AsyncFileIO and the writer moves on to the next, so
+ * conversion overlaps the disk. The header is padded with a JUNK chunk to
+ * one aligned block so all data writes stay aligned for O_DIRECT. write()
+ * only waits when every buffer is still in flight.
+ */
+class WavStreamWriter
+{
+private:
+    struct Slot
+    {
+        AlignedBuffer buffer;
+        uint64_t fileOffset = 0;
+        std::size_t requested = 0;  // bytes submitted (includes O_DIRECT padding)
+        std::size_t audioBytes = 0; // of which audio
+        bool busy = false;
+    };
+
+    AsyncFileIO io;
+    WavStreamConfig config;
+    int fd;
+    bool direct;
+    WavEncoding encoding;
+    unsigned int numChannels;
+    unsigned int sampleRate;
+    unsigned int bytesPerSample;
+
+    std::vector<Slot> slots;
+    AlignedBuffer header;
+    std::size_t current;            // buffer being filled
+    std::size_t fill;               // bytes in the current buffer
+    uint64_t fileOffset;            // where the current buffer lands
+    uint64_t dataBytes;             // audio bytes handed to the file
+    uint64_t bytesCompleted;        // audio bytes confirmed written
+    uint64_t writeErrors;
+
+    bool writeHeader();
+    bool submitCurrent(std::size_t bytes, std::size_t audioBytes);
+    void collect(bool wait);
+
+public:
+    WavStreamWriter();
+    ~WavStreamWriter();
+
+    /**
+     * Creates the file, writes a placeholder header and starts the I/O queue.
+     *
+     * @param path Output file
+     * @param channels Interleaved channels per frame
+     * @param rate Sample rate in Hz
+     * @param wavEncoding Stored sample format
+     * @param streamConfig Buffer size, queue depth and O_DIRECT preference
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path, unsigned int channels, unsigned int rate,
+              WavEncoding wavEncoding = WavEncoding::Float32,
+              const WavStreamConfig& streamConfig = WavStreamConfig());
+
+    /**
+     * Queues interleaved frames.
+     * @return false once a write has failed
+     */
+    bool write(const float* interleaved, std::size_t numFrames);
+
+    /**
+     * Queues interleaved samples; calls may split a frame as long as the
+     * total written is a whole number of frames.
+     * @return false once a write has failed
+     */
+    bool writeSamples(const float* samples, std::size_t count);
+
+    /**
+     * Writes the tail, fixes up the header and closes the file.
+     * @return false if any write failed
+     */
+    bool close();
+
+    bool isOpen() const { return fd >= 0; }
+    bool isDirect() const { return direct; }
+    const char* getBackendName() const { return io.getBackendName(); }
+    uint64_t getFramesWritten() const { return bytesCompleted / (static_cast<uint64_t>(bytesPerSample) * numChannels); }
+    uint64_t getWriteErrors() const { return writeErrors; }
+
+    WavStreamWriter(const WavStreamWriter&) = delete;
+    WavStreamWriter& operator=(const WavStreamWriter&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// WavStreamReader
+//--------------------------------------------------------------------------
+
+/**
+ * WAV reader that keeps several large aligned reads in flight.
+ *
+ * Reads run ahead of the caller through AsyncFileIO into a ring of
+ * aligned buffers and are converted to float on read(). Handles 16/24/32
+ * bit PCM and 32-bit float, including WAVE_FORMAT_EXTENSIBLE headers;
+ * anything else fails open() so callers can fall back to libsndfile.
+ */
+class WavStreamReader
+{
+private:
+    struct Slot
+    {
+        AlignedBuffer buffer;
+        uint64_t fileOffset = 0;
+        long result = 0;
+        bool pending = false;
+        bool ready = false;
+    };
+
+    AsyncFileIO io;
+    WavStreamConfig config;
+    int fd;
+    bool direct;
+    WavInfo info;
+    unsigned int bytesPerSample;
+
+    std::vector<Slot> slots;
+    uint64_t nextIssueOffset;       // aligned file offset of the next read
+    uint64_t readEnd;               // file offset past the last data byte
+    std::size_t issueIndex;         // slots issued so far
+    std::size_t consumeIndex;       // slots consumed so far
+    std::size_t consumePos;         // byte position within the consumed slot
+    unsigned char carry[4];         // sample split across two slots
+    unsigned int carryBytes;
+    uint64_t framesRead;
+    bool failed;
+
+    bool parseHeader(const std::string& path);
+    void issueReads();
+    Slot* currentSlot();
+
+public:
+    WavStreamReader();
+    ~WavStreamReader();
+
+    /**
+     * Opens a WAV file and starts reading ahead.
+     *
+     * @param path Input file
+     * @param streamConfig Buffer size, queue depth and O_DIRECT preference
+     * @param startFrame First frame to read (default: 0)
+     * @return false if the file is missing, not WAV, or in an unsupported encoding
+     */
+    bool open(const std::string& path, const WavStreamConfig& streamConfig = WavStreamConfig(),
+              uint64_t startFrame = 0);
+
+    /**
+     * Reads and converts interleaved frames.
+     * @return Frames read; fewer than requested only at end of file or on error
+     */
+    std::size_t read(float* interleaved, std::size_t numFrames);
+
+    /**
+     * Stops read-ahead and closes the file.
+     */
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    bool isDirect() const { return direct; }
+    bool hasFailed() const { return failed; }
+    const WavInfo& getInfo() const { return info; }
+    const char* getBackendName() const { return io.getBackendName(); }
+
+    WavStreamReader(const WavStreamReader&) = delete;
+    WavStreamReader& operator=(const WavStreamReader&) = delete;
+};
+
+} // namespace audio
+
+#endif // WAV_STREAM_H
@@ -18,9 +18,32 @@ C:\msys64\mingw64\bin\g++.exe ^
 -o multiaudio.exe ^
 main.cpp ^
 audio/BufferQueue.cpp ^
+audio/EffectChain.cpp ^
+audio/JackBackend.cpp ^
+audio/JitterBuffer.cpp ^
+audio/DriftCompensator.cpp ^
+audio/RtpBackend.cpp ^
+audio/RecordingTap.cpp ^
+audio/AsyncFileIO.cpp ^
+audio/WavStream.cpp ^
+audio/Profiler.cpp ^
+audio/ParameterQueue.cpp ^
+audio/ControlInput.cpp ^
+audio/LatencyTracker.cpp ^
+audio/MetricsRegistry.cpp ^
+audio/MetricsExporter.cpp ^
+audio/EngineMetrics.cpp ^
+audio/Watchdog.cpp ^
+audio/ChainInstance.cpp ^
+audio/HotSwapChain.cpp ^
 effects/DeEsser.cpp ^
 effects/Limiter.cpp ^
 effects/NoiseGate.cpp ^
+effects/SpectralKernels.cpp ^
+effects/SideChain.cpp ^
+effects/VoiceActivity.cpp ^
+effects/EchoCanceller.cpp ^
+effects/StftEngine.cpp ^
 effects/ThreeBandEQ.cpp ^
 gui/GUIManager.cpp ^
 lib/imgui/imgui.cpp ^
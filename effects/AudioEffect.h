@@ -76,6 +76,15 @@ public:
         return effectActive.load();
     }
 
+    /**
+     * Gets the sample rate the effect was built for.
+     * @return Sample rate in Hz
+     */
+    unsigned int getSampleRate() const
+    {
+        return sampleRate;
+    }
+
     /**
      * Resets the internal state of the effect.
      * Derived classes should override to clear buffers, reset filters, etc.
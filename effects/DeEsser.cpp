@@ -11,6 +11,176 @@ namespace audio {
 // De-Esser Processing
 //--------------------------------------------------------------------------
 
+bool applyParameter(DeEsserSettings& settings, const ParameterEvent& event)
+{
+    // Non-finite values are claimed but dropped; the clamp keeps the int conversions defined
+    float value = event.value;
+    const bool valid = clampParameter(event.id, value);
+    switch (event.id)
+    {
+        case ParameterId::DeEsserEnabled: if (valid) settings.enabled = (value != 0.0f); return true;
+        case ParameterId::DeEsserReduction: if (valid) settings.reductionDB = value; return true;
+        case ParameterId::DeEsserStartFreq: if (valid) settings.startFreq = static_cast<int>(value); return true;
+        case ParameterId::DeEsserEndFreq: if (valid) settings.endFreq = static_cast<int>(value); return true;
+        default: return false;
+    }
+}
+
+DeEsser::DeEsser(unsigned int rate, StftOverlap overlap, std::size_t periodFrames)
+    : stft(DEESSER_FRAME_SIZE, overlap),
+      sampleRate(rate),
+      primed(false),
+      passThrough(false)
+{
+    stft.prepare(periodFrames);
+}
+
+void DeEsser::reduceBand(fftw_complex* bins, const DeEsserSettings& settings) const
+{
+    // Convert dB reduction to linear gain multiplier
+    const double reduction = std::pow(10.0, -settings.reductionDB / 20.0);
+
+    unsigned int firstBin = 0;
+    unsigned int endBin = 0;
+    getBandBins(settings, firstBin, endBin);
+
+    // Apply frequency-selective gain reduction
+    for (unsigned int j = firstBin; j < endBin; ++j)
+    {
+        bins[j][0] *= reduction;
+        bins[j][1] *= reduction;
+    }
+}
+
+void DeEsser::getBandBins(const DeEsserSettings& settings, unsigned int& firstBin, unsigned int& endBin) const
+{
+    // Bins inside [startFreq, endFreq], below Nyquist
+    const double binsPerHz = static_cast<double>(DEESSER_FRAME_SIZE) / sampleRate;
+    firstBin = static_cast<unsigned int>(std::max(0.0, std::ceil(settings.startFreq * binsPerHz)));
+    const double lastBin = std::min(DEESSER_FRAME_SIZE / 2 - 1.0, std::floor(settings.endFreq * binsPerHz));
+    endBin = (lastBin < 0.0) ? 0 : static_cast<unsigned int>(lastBin) + 1;
+    endBin = std::max(endBin, firstBin);
+}
+
+bool DeEsser::isIdentity(const DeEsserSettings& settings) const
+{
+    unsigned int firstBin = 0;
+    unsigned int endBin = 0;
+    getBandBins(settings, firstBin, endBin);
+    return settings.reductionDB == 0.0 || firstBin == endBin;
+}
+
+void DeEsser::process(const float* input, float* output, std::size_t numFrames, const DeEsserSettings& settings)
+{
+    if (!stft.isValid())
+    {
+        std::copy(input, input + numFrames, output);
+        return;
+    }
+    primed = true;
+
+    stft.process(input, output, numFrames, [&](fftw_complex* bins, unsigned int)
+    {
+        reduceBand(bins, settings);
+    }, passThrough || isIdentity(settings));
+}
+
+bool DeEsser::processSilence(float* output, std::size_t numFrames, const DeEsserSettings& settings)
+{
+    if (!stft.isValid())
+    {
+        std::fill_n(output, numFrames, 0.0f);
+        return true;
+    }
+    primed = true;
+
+    return stft.processSilence(output, numFrames, [&](fftw_complex* bins, unsigned int)
+    {
+        reduceBand(bins, settings);
+    }, passThrough || isIdentity(settings));
+}
+
+void DeEsser::process(const float* input, float* output, std::size_t numFrames, DeEsserSettings& settings,
+                      const BlockEvents& events)
+{
+    auto apply = [&settings](const ParameterEvent& event) { applyParameter(settings, event); };
+    if (!stft.isValid())
+    {
+        events.applyBefore(0, static_cast<std::size_t>(-1), apply);
+        std::copy(input, input + numFrames, output);
+        return;
+    }
+    primed = true;
+
+    // As StftEngine::process(), with events up to a frame's last sample taking effect in that frame
+    std::size_t next = 0;
+    for (std::size_t offset = 0; offset < numFrames;)
+    {
+        const std::size_t chunk = std::min(numFrames - offset, stft.getHopRemaining());
+        if (stft.pushInput(input + offset, chunk))
+        {
+            next = events.applyBefore(next, offset + chunk, apply);
+            if (stft.beginFrame(passThrough || isIdentity(settings)))
+            {
+                stft.analyze();
+                reduceBand(stft.getSpectrum(), settings);
+                stft.synthesize();
+            }
+        }
+        stft.popOutput(output + offset, chunk);
+        offset += chunk;
+    }
+    events.applyBefore(next, static_cast<std::size_t>(-1), apply);
+}
+
+bool DeEsser::processSilence(float* output, std::size_t numFrames, DeEsserSettings& settings,
+                             const BlockEvents& events)
+{
+    auto apply = [&settings](const ParameterEvent& event) { applyParameter(settings, event); };
+    if (!stft.isValid())
+    {
+        events.applyBefore(0, static_cast<std::size_t>(-1), apply);
+        std::fill_n(output, numFrames, 0.0f);
+        return true;
+    }
+    primed = true;
+
+    const bool drained = stft.isDrained();
+    std::size_t next = 0;
+    for (std::size_t offset = 0; offset < numFrames;)
+    {
+        const std::size_t chunk = std::min(numFrames - offset, stft.getHopRemaining());
+        if (stft.pushSilence(chunk))
+        {
+            next = events.applyBefore(next, offset + chunk, apply);
+            if (stft.beginFrame(passThrough || isIdentity(settings)) && !stft.isFrameSilent())
+            {
+                stft.analyze();
+                reduceBand(stft.getSpectrum(), settings);
+                stft.synthesize();
+            }
+        }
+        stft.popOutput(output + offset, chunk);
+        offset += chunk;
+    }
+    events.applyBefore(next, static_cast<std::size_t>(-1), apply);
+    return drained;
+}
+
+void DeEsser::prepare(std::size_t periodFrames)
+{
+    stft.prepare(periodFrames);
+}
+
+void DeEsser::reset()
+{
+    if (primed)
+    {
+        stft.reset();
+        primed = false;
+    }
+}
+
 /**
  * Applies de-essing effect to reduce sibilance in audio samples.
  *
@@ -23,66 +193,122 @@ namespace audio {
 void applyDeEsser(std::vector<double>& samples, int sampleRate,
                   int startFreq, int endFreq, double reductionDB)
 {
-    constexpr int FRAME_SIZE = 2048;
-
     if (samples.empty())
     {
         return;
     }
 
-    // Convert dB reduction to linear gain multiplier
-    double reduction = std::pow(10.0, -reductionDB / 20.0);
+    // One block of any length: prepare for periods that vary
+    DeEsser deesser(static_cast<unsigned int>(sampleRate), StftOverlap::Half, 0);
+    DeEsserSettings settings;
+    settings.enabled = true;
+    settings.reductionDB = reductionDB;
+    settings.startFreq = startFreq;
+    settings.endFreq = endFreq;
+
+    // Run the signal plus enough silence to flush the latency, in one block
+    const std::size_t latency = deesser.getLatency();
+    const std::size_t total = samples.size() + latency;
+    std::vector<float> buffer(total, 0.0f);
+    std::copy(samples.begin(), samples.end(), buffer.begin());
+    deesser.process(buffer.data(), buffer.data(), total, settings);
+
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        samples[i] = buffer[i + latency];
+    }
+}
+
+//--------------------------------------------------------------------------
+// De-Esser Metering
+//--------------------------------------------------------------------------
+
+DeEsserMeter::DeEsserMeter()
+    : plan(nullptr),
+      timeData(fftw_alloc_real(DEESSER_FRAME_SIZE)),
+      frequencyData(fftw_alloc_complex(DEESSER_FRAME_SIZE / 2 + 1))
+{
+    if (timeData && frequencyData)
+    {
+        plan = fftw_plan_dft_r2c_1d(DEESSER_FRAME_SIZE, timeData, frequencyData, FFTW_ESTIMATE);
+    }
+}
 
-    // Allocate FFTW resources
-    fftw_complex* in = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * FRAME_SIZE));
-    fftw_complex* out = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * FRAME_SIZE));
-    fftw_plan planF = fftw_plan_dft_1d(FRAME_SIZE, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-    fftw_plan planI = fftw_plan_dft_1d(FRAME_SIZE, out, in, FFTW_BACKWARD, FFTW_ESTIMATE);
+DeEsserMeter::~DeEsserMeter()
+{
+    if (plan)
+    {
+        fftw_destroy_plan(plan);
+    }
+    if (timeData)
+    {
+        fftw_free(timeData);
+    }
+    if (frequencyData)
+    {
+        fftw_free(frequencyData);
+    }
+}
 
-    // Process audio frame-by-frame
-    for (std::size_t i = 0; i < samples.size(); i += FRAME_SIZE)
+double DeEsserMeter::measure(const float* samples, std::size_t count, int sampleRate,
+                             int startFreq, int endFreq, double reductionDB)
+{
+    if (!plan || count == 0)
     {
-        std::size_t frameLength = std::min(static_cast<std::size_t>(FRAME_SIZE), samples.size() - i);
+        return 0.0;
+    }
+
+    // Energy scale applied to the band by applyDeEsser()
+    double reduction = std::pow(10.0, -reductionDB / 20.0);
+    double bandScale = 1.0 - reduction * reduction;
 
-        // Load frame data and zero-pad if needed
-        for (std::size_t j = 0; j < FRAME_SIZE; j++)
+    double totalEnergy = 0.0;
+    double bandEnergy = 0.0;
+    for (std::size_t i = 0; i < count; i += DEESSER_FRAME_SIZE)
+    {
+        std::size_t frameLength = std::min(static_cast<std::size_t>(DEESSER_FRAME_SIZE), count - i);
+        for (std::size_t j = 0; j < DEESSER_FRAME_SIZE; j++)
         {
-            in[j][0] = (j < frameLength) ? samples[i + j] : 0.0;
-            in[j][1] = 0.0;
+            timeData[j] = (j < frameLength) ? samples[i + j] : 0.0;
         }
 
-        // Forward FFT (time → frequency domain)
-        fftw_execute(planF);
+        fftw_execute(plan);
 
-        // Apply frequency-selective gain reduction
-        for (int j = 0; j < FRAME_SIZE / 2; j++)
+        for (int j = 0; j <= DEESSER_FRAME_SIZE / 2; j++)
         {
-            double freq = static_cast<double>(j) * sampleRate / FRAME_SIZE;
-            if (freq >= startFreq && freq <= endFreq)
+            double energy = frequencyData[j][0] * frequencyData[j][0] + frequencyData[j][1] * frequencyData[j][1];
+            totalEnergy += energy;
+
+            double freq = static_cast<double>(j) * sampleRate / DEESSER_FRAME_SIZE;
+            if (j < DEESSER_FRAME_SIZE / 2 && freq >= startFreq && freq <= endFreq)
             {
-                // Apply to both positive and negative frequencies (complex conjugates)
-                out[j][0] *= reduction;
-                out[j][1] *= reduction;
-                out[FRAME_SIZE - j][0] *= reduction;
-                out[FRAME_SIZE - j][1] *= reduction;
+                bandEnergy += energy;
             }
         }
+    }
 
-        // Inverse FFT (frequency → time domain)
-        fftw_execute(planI);
-
-        // Normalize and store result
-        for (std::size_t j = 0; j < frameLength; j++)
-        {
-            samples[i + j] = in[j][0] / FRAME_SIZE;
-        }
+    double remaining = totalEnergy - bandEnergy * bandScale;
+    if (totalEnergy <= 0.0 || remaining <= 0.0)
+    {
+        return totalEnergy > 0.0 ? reductionDB : 0.0;
     }
+    return 10.0 * std::log10(totalEnergy / remaining);
+}
+
+double DeEsserMeter::estimate(const SideChain& sideChain, int startFreq, int endFreq, double reductionDB)
+{
+    double reduction = std::pow(10.0, -reductionDB / 20.0);
+    double bandScale = 1.0 - reduction * reduction;
 
-    // Clean up FFTW resources
-    fftw_destroy_plan(planF);
-    fftw_destroy_plan(planI);
-    fftw_free(in);
-    fftw_free(out);
+    double totalEnergy = sideChain.getPower();
+    double bandEnergy = sideChain.getPowerBetween(startFreq, endFreq);
+
+    double remaining = totalEnergy - bandEnergy * bandScale;
+    if (totalEnergy <= 0.0 || remaining <= 0.0)
+    {
+        return totalEnergy > 0.0 ? reductionDB : 0.0;
+    }
+    return 10.0 * std::log10(totalEnergy / remaining);
 }
 
 } // namespace audio
\ No newline at end of file
@@ -1,16 +1,159 @@
 #ifndef DEESSER_H
 #define DEESSER_H
 
+#include "SideChain.h"
+#include "StftEngine.h"
+#include "../audio/ParameterEvent.h"
+#include "../common.h"
+
+#include <cstddef>
 #include <vector>
+#include <fftw3.h>
 
 namespace audio {
 
+// Frame length of the de-esser's FFT
+constexpr int DEESSER_FRAME_SIZE = 2048;
+
+//--------------------------------------------------------------------------
+// De-Esser Settings
+//--------------------------------------------------------------------------
+
+/**
+ * Parameters for the de-esser stage of the effect chain.
+ * Edited by the GUI, directly or through parameter events (see
+ * applyParameter()), and read by the audio thread each block.
+ */
+struct DeEsserSettings
+{
+    bool enabled = false;
+    double reductionDB = 6.0;
+    int startFreq = 4000;
+    int endFreq = 10000;
+};
+
+/**
+ * Applies a parameter event to de-esser settings if it is one of the de-esser's,
+ * clamped to parameterRange(); a non-finite value is ignored.
+ * @return false if the event belongs to another effect
+ */
+bool applyParameter(DeEsserSettings& settings, const ParameterEvent& event);
+
 //--------------------------------------------------------------------------
 // De-Esser Processing
 //--------------------------------------------------------------------------
 
+/**
+ * Streaming de-esser used by the effect chain.
+ *
+ * Attenuates the configured band in every STFT frame (DEESSER_FRAME_SIZE,
+ * 50% overlap by default) and resynthesises, so frames overlap rather
+ * than being cut at block edges and any block size is accepted. Settings
+ * are passed to each process() call, since the GUI edits them live.
+ * At 0 dB reduction, or with an empty band, no frames run and the input
+ * is only delayed (see isIdentity()).
+ */
+class DeEsser
+{
+private:
+    StftEngine stft;
+    unsigned int sampleRate;
+    bool primed;    // buffers hold audio since the last reset()
+    bool passThrough;   // frames run delay-only whatever the settings (setPassThrough())
+
+    /**
+     * Scales the bins inside the settings' band (below Nyquist) by the reduction.
+     */
+    void reduceBand(fftw_complex* bins, const DeEsserSettings& settings) const;
+
+    /**
+     * Gets the range of bins the settings reduce.
+     * @param firstBin Set to the first bin in the band
+     * @param endBin Set to one past the last bin (equal to firstBin for an empty band)
+     */
+    void getBandBins(const DeEsserSettings& settings, unsigned int& firstBin, unsigned int& endBin) const;
+
+public:
+    /**
+     * @param rate Sample rate in Hz (default: SAMPLE_RATE)
+     * @param overlap Overlap between FFT frames (default: 50%)
+     * @param periodFrames Frames in every block, or 0 if blocks vary (see prepare())
+     */
+    explicit DeEsser(unsigned int rate = SAMPLE_RATE, StftOverlap overlap = StftOverlap::Half,
+                     std::size_t periodFrames = FRAMES_PER_BUFFER);
+
+    DeEsser(const DeEsser&) = delete;
+    DeEsser& operator=(const DeEsser&) = delete;
+
+    /**
+     * Processes a block through the de-esser.
+     * @param input Source samples
+     * @param output Destination, delayed by getLatency() (may alias input)
+     * @param numFrames Number of samples, any size
+     * @param settings Band and reduction (enabled is not checked here)
+     */
+    void process(const float* input, float* output, std::size_t numFrames, const DeEsserSettings& settings);
+
+    /**
+     * Advances the de-esser over a block of silent input, flushing any
+     * tail; no FFTs run once it has drained.
+     * @param output Destination samples
+     * @param numFrames Number of samples, any size
+     * @param settings Band and reduction
+     * @return true if the output block is silent
+     */
+    bool processSilence(float* output, std::size_t numFrames, const DeEsserSettings& settings);
+
+    /**
+     * Processes a block, applying the de-esser's parameter events to
+     * settings before the first STFT frame that ends after each one.
+     * @param settings Band and reduction, updated by the events
+     * @param events Events inside the block; other effects' events are skipped
+     */
+    void process(const float* input, float* output, std::size_t numFrames, DeEsserSettings& settings,
+                 const BlockEvents& events);
+
+    /**
+     * processSilence() with the de-esser's parameter events applied per frame.
+     */
+    bool processSilence(float* output, std::size_t numFrames, DeEsserSettings& settings, const BlockEvents& events);
+
+    /**
+     * Checks whether settings leave every bin unchanged, so the de-esser only delays its input.
+     */
+    bool isIdentity(const DeEsserSettings& settings) const;
+
+    /**
+     * Runs frames delay-only while set, as if the reduction were 0 dB
+     * (e.g. while no speech is detected). Switching crossfades exactly.
+     * Call between blocks on the audio thread.
+     */
+    void setPassThrough(bool enabled) { passThrough = enabled; }
+
+    bool isPassThrough() const { return passThrough; }
+
+    /**
+     * Chooses the STFT latency for the period the backend delivers (see
+     * StftEngine::prepare()). Clears the buffers if it changes.
+     * @param periodFrames Frames in every block, or 0 if blocks vary in size
+     */
+    void prepare(std::size_t periodFrames);
+
+    /**
+     * Clears the STFT buffers (cheap when nothing was processed since the last reset).
+     */
+    void reset();
+
+    /**
+     * Gets the delay from input to output in samples.
+     */
+    unsigned int getLatency() const { return stft.getLatency(); }
+};
+
 /**
  * Applies de-essing effect to reduce sibilance in audio samples.
+ * Runs a DeEsser over the whole buffer and removes its latency, so the
+ * output lines up with the input.
  *
  * @param samples Audio samples to process (modified in-place)
  * @param sampleRate Sample rate in Hz
@@ -21,6 +164,61 @@ namespace audio {
 void applyDeEsser(std::vector<double>& samples, int sampleRate,
                   int startFreq, int endFreq, double reductionDB);
 
+//--------------------------------------------------------------------------
+// De-Esser Metering
+//--------------------------------------------------------------------------
+
+/**
+ * Measures how much applyDeEsser() would attenuate a block.
+ *
+ * Uses the de-esser's frame size and band but only the forward real FFT
+ * over unwindowed, non-overlapping frames: no inverse transform and no
+ * output samples, so analysis passes can report de-esser activity at a
+ * fraction of the cost. FFTW resources are created once and reused across
+ * blocks.
+ */
+class DeEsserMeter
+{
+private:
+    fftw_plan plan;
+    double* timeData;
+    fftw_complex* frequencyData;
+
+public:
+    DeEsserMeter();
+    ~DeEsserMeter();
+
+    /**
+     * Measures the attenuation the de-esser would apply.
+     *
+     * @param samples Audio samples
+     * @param count Number of samples
+     * @param sampleRate Sample rate in Hz
+     * @param startFreq Lower frequency bound for reduction (Hz)
+     * @param endFreq Upper frequency bound for reduction (Hz)
+     * @param reductionDB Amount of gain reduction in decibels
+     * @return Energy removed from the block in dB (0.0 = inactive)
+     */
+    double measure(const float* samples, std::size_t count, int sampleRate,
+                   int startFreq, int endFreq, double reductionDB);
+
+    /**
+     * Estimates the same attenuation from a side-chain that has analysed
+     * the block, with no FFT at all. The band's share comes from the
+     * overlapped octave bands, so it is approximate near band edges.
+     *
+     * @param sideChain Side-chain run over the block
+     * @param startFreq Lower frequency bound for reduction (Hz)
+     * @param endFreq Upper frequency bound for reduction (Hz)
+     * @param reductionDB Amount of gain reduction in decibels
+     * @return Energy removed from the block in dB (0.0 = inactive)
+     */
+    static double estimate(const SideChain& sideChain, int startFreq, int endFreq, double reductionDB);
+
+    DeEsserMeter(const DeEsserMeter&) = delete;
+    DeEsserMeter& operator=(const DeEsserMeter&) = delete;
+};
+
 } // namespace audio
 
 #endif // DEESSER_H
@@ -0,0 +1,442 @@
+#include "EchoCanceller.h"
+#include "SpectralKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace audio {
+
+namespace {
+
+// Reference mean square below which nothing plays and no adaptation runs (about -70 dBFS)
+const float REFERENCE_ACTIVE_POWER = 1e-7f;
+
+// Smoothing of the ERLE over adapting blocks
+const float ERLE_SMOOTHING = 0.95f;
+
+// Error power this far above the mic power means the filter diverged
+const double DIVERGENCE_RATIO = 4.0;
+
+// Bins processed per SIMD operation; the stride pads each spectrum to a multiple
+const unsigned int SIMD_WIDTH = 4;
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+EchoCanceller::EchoCanceller(unsigned int rate, unsigned int numChannels, float tailMs, unsigned int partitionSize)
+    : sampleRate(rate),
+      channelCount(std::max(1u, numChannels)),
+      blockSize(partitionSize),
+      fftSize(partitionSize * 2),
+      numBins(partitionSize + 1),
+      binStride((partitionSize + 1 + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH),
+      partitions(std::max(1u, static_cast<unsigned int>(std::ceil(tailMs * rate / 1000.0f / partitionSize)))),
+      timeData(nullptr),
+      spectrum(nullptr),
+      forwardPlan(nullptr),
+      inversePlan(nullptr),
+      referenceWritten(0),
+      referenceDelay(0),
+      newestSpectrum(0),
+      fill(0),
+      blockIndex(0),
+      constrainCursor(0),
+      channels(std::max(1u, numChannels))
+{
+    if (partitionSize == 0 || (partitionSize & (partitionSize - 1)) != 0)
+    {
+        std::cerr << "EchoCanceller: partition size must be a power of two, got " << partitionSize << std::endl;
+        return;
+    }
+
+    timeData = fftw_alloc_real(fftSize);
+    spectrum = fftw_alloc_complex(numBins);
+    if (timeData && spectrum)
+    {
+        forwardPlan = fftw_plan_dft_r2c_1d(fftSize, timeData, spectrum, FFTW_ESTIMATE);
+        inversePlan = fftw_plan_dft_c2r_1d(fftSize, spectrum, timeData, FFTW_ESTIMATE);
+    }
+    if (!isValid())
+    {
+        std::cerr << "EchoCanceller: failed to create FFT plans; passing input through" << std::endl;
+    }
+
+    const std::size_t spectraSize = static_cast<std::size_t>(partitions) * binStride;
+    referenceRe.resize(spectraSize);
+    referenceIm.resize(spectraSize);
+    referenceLevels.resize(partitions);
+    referencePower.resize(binStride);
+    accumRe.resize(binStride);
+    accumIm.resize(binStride);
+    error.resize(blockSize);
+    for (Channel& channel : channels)
+    {
+        channel.weightRe.resize(spectraSize);
+        channel.weightIm.resize(spectraSize);
+        channel.mic.resize(blockSize);
+        channel.output.resize(blockSize);
+    }
+    setReferenceDelay(0);
+}
+
+EchoCanceller::~EchoCanceller()
+{
+    if (forwardPlan) fftw_destroy_plan(forwardPlan);
+    if (inversePlan) fftw_destroy_plan(inversePlan);
+    if (timeData) fftw_free(timeData);
+    if (spectrum) fftw_free(spectrum);
+}
+
+void EchoCanceller::setReferenceDelay(std::size_t frames)
+{
+    referenceDelay = frames;
+    referenceRing.assign(ringSizeFor(frames), 0.0f);
+    reset();
+}
+
+void EchoCanceller::growReferenceDelay(std::size_t frames)
+{
+    if (frames <= referenceDelay)
+    {
+        return;
+    }
+    if (blockIndex == 0)
+    {
+        // Nothing learnt yet
+        setReferenceDelay(frames);
+        return;
+    }
+
+    // Whole partitions, so the weights move exactly
+    const std::size_t shift = (frames - referenceDelay + blockSize - 1) / blockSize;
+    referenceDelay += shift * blockSize;
+
+    const std::size_t size = ringSizeFor(referenceDelay);
+    if (size > referenceRing.size())
+    {
+        // Same stream indexing, wider mask: the held frames keep their places
+        std::vector<float> ring(size, 0.0f);
+        const uint64_t held = std::min<uint64_t>(referenceWritten, referenceRing.size());
+        const std::size_t oldMask = referenceRing.size() - 1;
+        for (uint64_t index = referenceWritten - held; index < referenceWritten; ++index)
+        {
+            ring[static_cast<std::size_t>(index) & (size - 1)] = referenceRing[static_cast<std::size_t>(index) & oldMask];
+        }
+        referenceRing.swap(ring);
+    }
+
+    // Partition p + shift covered the lags partition p covers now; the spectra step back with the weights
+    const unsigned int kept = shift < partitions ? partitions - static_cast<unsigned int>(shift) : 0;
+    for (Channel& channel : channels)
+    {
+        const std::size_t from = static_cast<std::size_t>(partitions - kept) * binStride;
+        std::copy(channel.weightRe.begin() + from, channel.weightRe.end(), channel.weightRe.begin());
+        std::copy(channel.weightIm.begin() + from, channel.weightIm.end(), channel.weightIm.begin());
+        std::fill(channel.weightRe.begin() + static_cast<std::size_t>(kept) * binStride, channel.weightRe.end(), 0.0f);
+        std::fill(channel.weightIm.begin() + static_cast<std::size_t>(kept) * binStride, channel.weightIm.end(), 0.0f);
+        if (kept == 0)
+        {
+            channel.converged = false;
+            channel.erleDB = 0.0f;
+        }
+    }
+    newestSpectrum = static_cast<unsigned int>((newestSpectrum + partitions - shift % partitions) % partitions);
+    for (unsigned int p = kept; p < partitions; ++p)
+    {
+        const std::size_t slot = (newestSpectrum + partitions - p) % partitions;
+        std::fill_n(referenceRe.begin() + slot * binStride, binStride, 0.0f);
+        std::fill_n(referenceIm.begin() + slot * binStride, binStride, 0.0f);
+        referenceLevels[slot] = 0.0f;
+    }
+    std::fill(referencePower.begin(), referencePower.end(), 0.0);
+    for (std::size_t i = 0; i < referenceRe.size(); ++i)
+    {
+        referencePower[i % binStride] += static_cast<double>(referenceRe[i]) * referenceRe[i]
+                                       + static_cast<double>(referenceIm[i]) * referenceIm[i];
+    }
+}
+
+std::size_t EchoCanceller::ringSizeFor(std::size_t delay) const
+{
+    std::size_t size = 1;
+    while (size < delay + fftSize * 2 + FRAMES_PER_BUFFER * 4)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+void EchoCanceller::reset()
+{
+    std::fill(referenceRing.begin(), referenceRing.end(), 0.0f);
+    referenceWritten = 0;
+    std::fill(referenceRe.begin(), referenceRe.end(), 0.0f);
+    std::fill(referenceIm.begin(), referenceIm.end(), 0.0f);
+    std::fill(referenceLevels.begin(), referenceLevels.end(), 0.0f);
+    std::fill(referencePower.begin(), referencePower.end(), 0.0f);
+    newestSpectrum = 0;
+    fill = 0;
+    blockIndex = 0;
+    constrainCursor = 0;
+    for (Channel& channel : channels)
+    {
+        std::fill(channel.weightRe.begin(), channel.weightRe.end(), 0.0f);
+        std::fill(channel.weightIm.begin(), channel.weightIm.end(), 0.0f);
+        std::fill(channel.mic.begin(), channel.mic.end(), 0.0f);
+        std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+        channel.erleDB = 0.0f;
+        channel.echoShare = 0.0f;
+        channel.hangover = 0;
+        channel.frozenBlocks = 0;
+        channel.converged = false;
+        channel.doubleTalk = false;
+    }
+}
+
+//--------------------------------------------------------------------------
+// Processing
+//--------------------------------------------------------------------------
+
+void EchoCanceller::pushReference(const float* reference, std::size_t numFrames)
+{
+    const std::size_t mask = referenceRing.size() - 1;
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        referenceRing[(referenceWritten + i) & mask] = reference[i];
+    }
+    referenceWritten += numFrames;
+}
+
+void EchoCanceller::process(const float* input, float* output, std::size_t numFrames)
+{
+    if (!isValid())
+    {
+        std::copy(input, input + numFrames * channelCount, output);
+        return;
+    }
+
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        for (unsigned int c = 0; c < channelCount; ++c)
+        {
+            // Read before writing: output may alias input
+            const float sample = input[i * channelCount + c];
+            output[i * channelCount + c] = channels[c].output[fill];
+            channels[c].mic[fill] = sample;
+        }
+        if (++fill == blockSize)
+        {
+            processBlock();
+            fill = 0;
+        }
+    }
+}
+
+void EchoCanceller::processBlock()
+{
+    const float referenceMeanSquare = analyzeReference();
+    const float referenceLevel = *std::max_element(referenceLevels.begin(), referenceLevels.end());
+    for (Channel& channel : channels)
+    {
+        processChannel(channel, referenceMeanSquare, referenceLevel);
+    }
+    constrainCursor = (constrainCursor + 1) % partitions;
+    ++blockIndex;
+}
+
+float EchoCanceller::analyzeReference()
+{
+    // Frame of 2 * blockSize ending referenceDelay frames before the partition's end
+    const int64_t end = static_cast<int64_t>((blockIndex + 1) * blockSize) - static_cast<int64_t>(referenceDelay);
+    const int64_t start = end - fftSize;
+    const int64_t written = static_cast<int64_t>(referenceWritten);
+    const int64_t oldestHeld = written - static_cast<int64_t>(referenceRing.size());
+    const std::size_t mask = referenceRing.size() - 1;
+
+    double power = 0.0;
+    for (unsigned int i = 0; i < fftSize; ++i)
+    {
+        const int64_t index = start + i;
+        // Frames not pushed yet (or before the stream) count as silence
+        const float sample = (index >= 0 && index < written && index >= oldestHeld)
+                             ? referenceRing[static_cast<std::size_t>(index) & mask] : 0.0f;
+        timeData[i] = sample;
+        if (i >= blockSize)
+        {
+            power += static_cast<double>(sample) * sample;
+        }
+    }
+    fftw_execute(forwardPlan);
+
+    // The newest spectrum replaces the oldest, in the ring and in the power summed over partitions
+    newestSpectrum = (newestSpectrum + 1) % partitions;
+    float* re = referenceRe.data() + static_cast<std::size_t>(newestSpectrum) * binStride;
+    float* im = referenceIm.data() + static_cast<std::size_t>(newestSpectrum) * binStride;
+    for (unsigned int k = 0; k < numBins; ++k)
+    {
+        const double evicted = static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+        re[k] = static_cast<float>(spectrum[k][0]);
+        im[k] = static_cast<float>(spectrum[k][1]);
+        const double added = static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+        referencePower[k] = std::max(0.0, referencePower[k] + added - evicted);
+    }
+    referenceLevels[newestSpectrum] = static_cast<float>(power / blockSize);
+    return referenceLevels[newestSpectrum];
+}
+
+void EchoCanceller::loadSpectrum(const float* re, const float* im)
+{
+    for (unsigned int k = 0; k < numBins; ++k)
+    {
+        spectrum[k][0] = re[k];
+        spectrum[k][1] = im[k];
+    }
+}
+
+void EchoCanceller::processChannel(Channel& channel, float referenceMeanSquare, float referenceLevel)
+{
+    // Echo estimate: the sum over partitions of weights times the matching delayed reference spectrum
+    std::fill(accumRe.begin(), accumRe.end(), 0.0f);
+    std::fill(accumIm.begin(), accumIm.end(), 0.0f);
+    for (unsigned int p = 0; p < partitions; ++p)
+    {
+        const std::size_t slot = static_cast<std::size_t>((newestSpectrum + partitions - p) % partitions) * binStride;
+        const std::size_t weights = static_cast<std::size_t>(p) * binStride;
+        complexMultiplyAccumulate(accumRe.data(), accumIm.data(),
+                                  channel.weightRe.data() + weights, channel.weightIm.data() + weights,
+                                  referenceRe.data() + slot, referenceIm.data() + slot, binStride);
+    }
+    loadSpectrum(accumRe.data(), accumIm.data());
+    fftw_execute(inversePlan);
+
+    // Overlap-save: the newest half is the echo estimate for this partition
+    const double inverseScale = 1.0 / fftSize;
+    double micPower = 0.0, echoPower = 0.0, crossPower = 0.0, errorPower = 0.0;
+    for (unsigned int i = 0; i < blockSize; ++i)
+    {
+        const double mic = channel.mic[i];
+        const double echo = timeData[blockSize + i] * inverseScale;
+        error[i] = static_cast<float>(mic - echo);
+        channel.output[i] = error[i];
+        micPower += mic * mic;
+        echoPower += echo * echo;
+        crossPower += mic * echo;
+        errorPower += static_cast<double>(error[i]) * error[i];
+    }
+
+    //--------------------------------------------------------------------------
+    // Double-Talk Detection
+    //--------------------------------------------------------------------------
+    const bool referenceActive = referenceMeanSquare > REFERENCE_ACTIVE_POWER;
+    channel.echoShare = micPower > 1e-12 ? static_cast<float>(std::max(-1.0, std::min(1.0, crossPower / micPower))) : 0.0f;
+    const bool nearEnd = channel.converged ? channel.echoShare < settings.doubleTalkThreshold
+                                           : micPower > settings.levelThreshold * referenceLevel * blockSize;
+    if (referenceActive && nearEnd)
+    {
+        channel.hangover = static_cast<unsigned int>(std::ceil(settings.hangoverMs * sampleRate / 1000.0f / blockSize));
+    }
+    channel.doubleTalk = referenceActive && channel.hangover > 0;
+    if (channel.hangover > 0)
+    {
+        --channel.hangover;
+    }
+    if (channel.doubleTalk)
+    {
+        ++channel.doubleTalkBlocks;
+        // Frozen for too long while the reference plays: the echo path moved, start over from the level test
+        if (++channel.frozenBlocks > settings.maxFreezeMs * sampleRate / 1000.0f / blockSize && channel.converged)
+        {
+            channel.converged = false;
+            channel.frozenBlocks = 0;
+            channel.hangover = 0;
+        }
+    }
+    else
+    {
+        channel.frozenBlocks = 0;
+    }
+
+    if (!referenceActive || channel.doubleTalk)
+    {
+        return;
+    }
+
+    // A filter that adds echo has diverged: clear it rather than let it ring
+    if (errorPower > DIVERGENCE_RATIO * micPower && micPower > 1e-10 * blockSize)
+    {
+        std::fill(channel.weightRe.begin(), channel.weightRe.end(), 0.0f);
+        std::fill(channel.weightIm.begin(), channel.weightIm.end(), 0.0f);
+        channel.converged = false;
+        channel.erleDB = 0.0f;
+        ++channel.resets;
+        return;
+    }
+
+    const float erle = static_cast<float>(10.0 * std::log10((micPower + 1e-12) / (errorPower + 1e-12)));
+    channel.erleDB = ERLE_SMOOTHING * channel.erleDB + (1.0f - ERLE_SMOOTHING) * erle;
+    if (channel.erleDB > settings.convergedERLEDB)
+    {
+        channel.converged = true;
+    }
+    else if (channel.erleDB < settings.convergedERLEDB / 2.0f)
+    {
+        channel.converged = false;
+    }
+
+    //--------------------------------------------------------------------------
+    // NLMS Update
+    //--------------------------------------------------------------------------
+    std::fill_n(timeData, blockSize, 0.0);
+    for (unsigned int i = 0; i < blockSize; ++i)
+    {
+        timeData[blockSize + i] = error[i];
+    }
+    fftw_execute(forwardPlan);
+
+    // Step per bin, normalised by the reference power over all partitions (regularised at about -60 dBFS)
+    const double regularization = static_cast<double>(partitions) * fftSize * 1e-6;
+    for (unsigned int k = 0; k < numBins; ++k)
+    {
+        const float scale = static_cast<float>(settings.stepSize / (referencePower[k] + regularization));
+        accumRe[k] = static_cast<float>(spectrum[k][0]) * scale;
+        accumIm[k] = static_cast<float>(spectrum[k][1]) * scale;
+    }
+    std::fill(accumRe.begin() + numBins, accumRe.end(), 0.0f);
+    std::fill(accumIm.begin() + numBins, accumIm.end(), 0.0f);
+
+    for (unsigned int p = 0; p < partitions; ++p)
+    {
+        const std::size_t slot = static_cast<std::size_t>((newestSpectrum + partitions - p) % partitions) * binStride;
+        const std::size_t weights = static_cast<std::size_t>(p) * binStride;
+        conjugateMultiplyAccumulate(channel.weightRe.data() + weights, channel.weightIm.data() + weights,
+                                    referenceRe.data() + slot, referenceIm.data() + slot,
+                                    accumRe.data(), accumIm.data(), binStride);
+    }
+    constrainPartition(channel, constrainCursor);
+}
+
+void EchoCanceller::constrainPartition(Channel& channel, unsigned int partition)
+{
+    float* re = channel.weightRe.data() + static_cast<std::size_t>(partition) * binStride;
+    float* im = channel.weightIm.data() + static_cast<std::size_t>(partition) * binStride;
+    loadSpectrum(re, im);
+    fftw_execute(inversePlan);
+    const double inverseScale = 1.0 / fftSize;
+    for (unsigned int i = 0; i < blockSize; ++i)
+    {
+        timeData[i] *= inverseScale;
+    }
+    std::fill_n(timeData + blockSize, blockSize, 0.0);
+    fftw_execute(forwardPlan);
+    for (unsigned int k = 0; k < numBins; ++k)
+    {
+        re[k] = static_cast<float>(spectrum[k][0]);
+        im[k] = static_cast<float>(spectrum[k][1]);
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,244 @@
+#ifndef ECHO_CANCELLER_H
+#define ECHO_CANCELLER_H
+
+#include "../common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+#include <vector>
+
+namespace audio {
+
+// Samples per filter partition and per adaptation step (also the canceller's latency)
+constexpr unsigned int AEC_BLOCK_SIZE = 256;
+
+// Echo tail modelled by default
+constexpr float AEC_DEFAULT_TAIL_MS = 200.0f;
+
+/**
+ * Adaptation and double-talk settings of the echo canceller.
+ */
+struct EchoCancellerSettings
+{
+    float stepSize = 0.5f;              // NLMS step, as a share of the per-bin normalised correction
+    float doubleTalkThreshold = 0.6f;   // once converged: share of mic power the echo estimate must explain
+    float levelThreshold = 0.5f;        // before convergence: mic power over recent reference power that means near-end talk
+    float hangoverMs = 30.0f;           // adaptation stays frozen this long after double-talk ends
+    float maxFreezeMs = 1500.0f;        // frozen longer with the reference active: assume the echo path moved
+    float convergedERLEDB = 6.0f;       // echo return loss enhancement that counts as converged
+};
+
+/**
+ * Acoustic echo canceller: a partitioned-block frequency-domain adaptive
+ * filter (multidelay filter, MDF) with NLMS steps and double-talk
+ * detection.
+ *
+ * The echo tail is split into partitions of AEC_BLOCK_SIZE samples, each
+ * a 2 * AEC_BLOCK_SIZE point overlap-save filter over a delayed spectrum
+ * of the reference, so a 200 ms tail costs two complex multiply-adds per
+ * partition and bin (filter and update) plus four FFTs per block. The
+ * step is normalised per bin by the reference power; one partition per
+ * block is re-constrained to a causal filter, in turn. Filter weights and
+ * reference spectra are float, in split real/imaginary arrays for the
+ * SIMD complex kernels (see SpectralKernels.h). Several microphone
+ * channels share one reference and its spectra.
+ *
+ * Double-talk (near-end speech over the echo) freezes adaptation. Until
+ * the filter converges, a level test (Geigel's, on block power rather
+ * than peaks) flags mic blocks louder than the strongest recent reference
+ * block; once converged, a normalised cross-correlation test
+ * flags blocks where the echo estimate explains too little of the mic
+ * power. Freezing longer than maxFreezeMs while the reference plays is
+ * taken as an echo path change, and the filter re-converges.
+ *
+ * Reference samples are indexed in the same stream as the microphone:
+ * reference sample j is taken to have been played referenceDelay frames
+ * before mic sample j (see setReferenceDelay()), so the filter models
+ * echo arriving referenceDelay .. referenceDelay + tail frames later.
+ */
+class EchoCanceller
+{
+private:
+    /**
+     * Filter and detector state of one microphone channel.
+     */
+    struct Channel
+    {
+        std::vector<float> weightRe;        // partitions * binStride, partition 0 the most recent reference
+        std::vector<float> weightIm;
+        std::vector<float> mic;             // the partition being filled
+        std::vector<float> output;          // the last partition's error, played out while mic fills
+        float erleDB = 0.0f;                // smoothed over adapting blocks
+        float echoShare = 0.0f;             // last block's mic power explained by the echo estimate
+        unsigned int hangover = 0;          // blocks adaptation stays frozen
+        unsigned int frozenBlocks = 0;      // consecutive frozen blocks with the reference active
+        bool converged = false;
+        bool doubleTalk = false;
+        uint64_t doubleTalkBlocks = 0;
+        uint64_t resets = 0;                // divergences that cleared the filter
+    };
+
+    unsigned int sampleRate;
+    unsigned int channelCount;
+    unsigned int blockSize;
+    unsigned int fftSize;               // 2 * blockSize
+    unsigned int numBins;               // blockSize + 1
+    unsigned int binStride;             // numBins rounded up to the SIMD width
+    unsigned int partitions;
+    EchoCancellerSettings settings;
+
+    //--------------------------------------------------------------------------
+    // FFT
+    //--------------------------------------------------------------------------
+    double* timeData;
+    fftw_complex* spectrum;
+    fftw_plan forwardPlan;
+    fftw_plan inversePlan;
+
+    //--------------------------------------------------------------------------
+    // Reference
+    //--------------------------------------------------------------------------
+    std::vector<float> referenceRing;   // power-of-two ring indexed by stream frame
+    uint64_t referenceWritten;          // reference frames pushed
+    std::size_t referenceDelay;
+    std::vector<float> referenceRe;     // partitions * binStride, a ring of spectra
+    std::vector<float> referenceIm;
+    std::vector<float> referenceLevels; // mean square of each spectrum's newest half (for the level test)
+    std::vector<double> referencePower; // |X|^2 summed over the ring's spectra, per bin
+    unsigned int newestSpectrum;
+
+    //--------------------------------------------------------------------------
+    // Block State
+    //--------------------------------------------------------------------------
+    std::vector<float> accumRe;         // echo estimate and step spectra (binStride)
+    std::vector<float> accumIm;
+    std::vector<float> error;
+    unsigned int fill;                  // samples in the current partition
+    uint64_t blockIndex;                // partitions completed
+    unsigned int constrainCursor;       // partition re-constrained next
+    std::vector<Channel> channels;
+
+    //--------------------------------------------------------------------------
+    // Private Methods
+    //--------------------------------------------------------------------------
+    /**
+     * Gets the reference ring size for a delay: the oldest frame still
+     * needed plus pushes running a few blocks ahead, rounded up to a power of two.
+     */
+    std::size_t ringSizeFor(std::size_t delay) const;
+
+    /**
+     * Runs a full partition: reference spectrum, then filter, detector and update per channel.
+     */
+    void processBlock();
+
+    /**
+     * Transforms the reference frame ending referenceDelay before the partition's end.
+     * @return Mean square of the frame's newest half
+     */
+    float analyzeReference();
+
+    /**
+     * Filters, detects and adapts one channel over the current partition.
+     */
+    void processChannel(Channel& channel, float referenceMeanSquare, float referenceLevel);
+
+    /**
+     * Zeroes the non-causal half of a partition's impulse response.
+     */
+    void constrainPartition(Channel& channel, unsigned int partition);
+
+    /**
+     * Copies split float bins into the FFT spectrum.
+     */
+    void loadSpectrum(const float* re, const float* im);
+
+public:
+    /**
+     * @param rate Sample rate in Hz (default: SAMPLE_RATE)
+     * @param numChannels Microphone channels sharing the reference (interleaved in process())
+     * @param tailMs Echo tail to model
+     * @param partitionSize Samples per partition, a power of two (default: AEC_BLOCK_SIZE)
+     */
+    explicit EchoCanceller(unsigned int rate = SAMPLE_RATE, unsigned int numChannels = 1,
+                           float tailMs = AEC_DEFAULT_TAIL_MS, unsigned int partitionSize = AEC_BLOCK_SIZE);
+    ~EchoCanceller();
+
+    EchoCanceller(const EchoCanceller&) = delete;
+    EchoCanceller& operator=(const EchoCanceller&) = delete;
+
+    /**
+     * Sets how long before the microphone a reference sample is taken to
+     * play, and sizes the reference ring for it. A reference fed back from
+     * the processed output needs at least the largest block size, so each
+     * block's output is pushed before its echo is cancelled. Allocates;
+     * must not be called from the audio thread. Clears the reference.
+     * @param frames Delay in frames (0: reference and mic already aligned)
+     */
+    void setReferenceDelay(std::size_t frames);
+
+    /**
+     * Raises the reference delay to at least the given frames, keeping what
+     * the filter has learnt: once it has run, the delay grows by whole
+     * partitions and the weights move down with it, so each keeps modelling
+     * the same echo lag (lags now shorter than the delay are dropped). The
+     * ring grows with its samples. Allocates when the ring grows; must not
+     * be called from the audio thread. A delay already long enough is kept.
+     * @param frames Smallest delay in frames
+     */
+    void growReferenceDelay(std::size_t frames);
+
+    /**
+     * Appends played samples to the reference, in stream order. Pushes may
+     * run ahead of process() by up to the largest block size.
+     * @param reference Mono samples
+     * @param numFrames Number of samples
+     */
+    void pushReference(const float* reference, std::size_t numFrames);
+
+    /**
+     * Cancels echo from a block, delayed by getLatency().
+     * @param input Interleaved microphone frames (numChannels per frame)
+     * @param output Echo-cancelled frames (may alias input)
+     * @param numFrames Number of frames, any size
+     */
+    void process(const float* input, float* output, std::size_t numFrames);
+
+    /**
+     * Clears the filters, detectors, reference and buffered samples.
+     */
+    void reset();
+
+    bool isValid() const { return forwardPlan != nullptr && inversePlan != nullptr; }
+
+    EchoCancellerSettings& getSettings() { return settings; }
+    const EchoCancellerSettings& getSettings() const { return settings; }
+
+    unsigned int getLatency() const { return blockSize; }
+    unsigned int getChannels() const { return channelCount; }
+    unsigned int getPartitions() const { return partitions; }
+    std::size_t getReferenceDelay() const { return referenceDelay; }
+    uint64_t getReferenceFrames() const { return referenceWritten; }
+
+    /**
+     * Gets a channel's echo return loss enhancement: mic over error power,
+     * smoothed over blocks that adapted.
+     * @return Enhancement in dB
+     */
+    float getERLEDB(unsigned int channel = 0) const { return channel < channelCount ? channels[channel].erleDB : 0.0f; }
+
+    /**
+     * Gets the share of the last block's mic power explained by the echo estimate.
+     */
+    float getEchoShare(unsigned int channel = 0) const { return channel < channelCount ? channels[channel].echoShare : 0.0f; }
+
+    bool isDoubleTalk(unsigned int channel = 0) const { return channel < channelCount && channels[channel].doubleTalk; }
+    bool isConverged(unsigned int channel = 0) const { return channel < channelCount && channels[channel].converged; }
+    uint64_t getDoubleTalkBlocks(unsigned int channel = 0) const { return channel < channelCount ? channels[channel].doubleTalkBlocks : 0; }
+    uint64_t getResets(unsigned int channel = 0) const { return channel < channelCount ? channels[channel].resets : 0; }
+};
+
+} // namespace audio
+
+#endif // ECHO_CANCELLER_H
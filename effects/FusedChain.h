@@ -0,0 +1,62 @@
+#ifndef FUSED_CHAIN_H
+#define FUSED_CHAIN_H
+
+#include <cstddef>
+#include <tuple>
+
+namespace audio {
+
+/**
+ * A per-sample stage that leaves the signal unchanged.
+ */
+struct PassThrough
+{
+    float process(float sample) { return sample; }
+};
+
+/**
+ * Per-sample time-domain stages composed at compile time and fused into
+ * one loop.
+ *
+ * A stage is a small struct holding its state as plain members, with an
+ * inline float process(float) that advances it by one sample (GateRamp,
+ * LimiterRamp, PassThrough). FusedChain<A, B, ...>::run() feeds every
+ * sample through the stages in order, so the block is read once and
+ * written once, with no intermediate buffers and no virtual calls.
+ *
+ * The stages are copied into locals for the loop and copied back after
+ * it. Through a reference, every float written to the output could alias
+ * a stage's state, and the compiler would reload it each sample. As
+ * locals it stays in registers.
+ */
+template <typename... Stages>
+struct FusedChain
+{
+    /**
+     * Runs a block through every stage.
+     * @param input Source samples
+     * @param output Destination (may alias input)
+     * @param numFrames Number of samples
+     * @param stages Stage state, updated to the end of the block
+     */
+    static void run(const float* input, float* output, std::size_t numFrames, Stages&... stages)
+    {
+        std::tie(stages...) = runLocal(input, output, numFrames, stages...);
+    }
+
+private:
+    static std::tuple<Stages...> runLocal(const float* input, float* output, std::size_t numFrames, Stages... stages)
+    {
+        for (std::size_t i = 0; i < numFrames; ++i)
+        {
+            float sample = input[i];
+            ((sample = stages.process(sample)), ...);
+            output[i] = sample;
+        }
+        return std::tuple<Stages...>(stages...);
+    }
+};
+
+} // namespace audio
+
+#endif // FUSED_CHAIN_H
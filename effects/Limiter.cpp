@@ -1,13 +1,11 @@
 #include "Limiter.h"
+#include "FusedChain.h"
 
 #include <algorithm>
 #include <cmath>
 
 namespace audio {
 
-// Small constant to prevent division by zero
-constexpr float TIME_EPSILON = 1e-6f;
-
 //--------------------------------------------------------------------------
 // Lifecycle
 //--------------------------------------------------------------------------
@@ -28,8 +26,8 @@ Limiter::Limiter(unsigned int rate, float thresh, float attackMs, float releaseM
 
 void Limiter::calculateCoeffs()
 {
-    float attackSeconds = std::max(TIME_EPSILON, attackTimeMs / 1000.0f);
-    float releaseSeconds = std::max(TIME_EPSILON, releaseTimeMs / 1000.0f);
+    float attackSeconds = std::max(LIMITER_TIME_EPSILON, attackTimeMs / 1000.0f);
+    float releaseSeconds = std::max(LIMITER_TIME_EPSILON, releaseTimeMs / 1000.0f);
 
     // Calculate smoothing coefficients for exponential gain control
     attackCoeff = std::exp(-1.0f / (attackSeconds * sampleRate));
@@ -48,37 +46,86 @@ void Limiter::process(const float* inputBuffer, float* outputBuffer, std::size_t
         return;
     }
 
+    LimiterRamp ramp = beginRamp();
+    FusedChain<LimiterRamp>::run(inputBuffer, outputBuffer, bufferSize, ramp);
+    endRamp(ramp);
+}
+
+void Limiter::processSilence(float* outputBuffer, std::size_t bufferSize)
+{
+    std::fill_n(outputBuffer, bufferSize, 0.0f);
+    if (!limiterActive.load() || currentGain >= 1.0f)
+    {
+        return;
+    }
+
+    // Silence targets unity: each sample the distance to 1 shrinks by releaseCoeff
+    const float remaining = (1.0f - currentGain) * std::pow(releaseCoeff, static_cast<float>(bufferSize));
+    currentGain = std::min(1.0f - remaining, 1.0f);
+}
+
+void Limiter::process(const float* inputBuffer, float* outputBuffer, std::size_t bufferSize,
+                      const BlockEvents& events)
+{
+    events.split(bufferSize, [this](const ParameterEvent& event) { applyParameter(event); },
+                 [&](std::size_t from, std::size_t to)
+    {
+        process(inputBuffer + from, outputBuffer + from, to - from);
+    });
+}
+
+void Limiter::processSilence(float* outputBuffer, std::size_t bufferSize, const BlockEvents& events)
+{
+    events.split(bufferSize, [this](const ParameterEvent& event) { applyParameter(event); },
+                 [&](std::size_t from, std::size_t to)
+    {
+        processSilence(outputBuffer + from, to - from);
+    });
+}
+
+float Limiter::analyze(const float* inputBuffer, std::size_t bufferSize)
+{
+    LimiterRamp ramp = beginRamp();
+    float minGain = ramp.currentGain;
+
     for (std::size_t i = 0; i < bufferSize; ++i)
     {
-        float inputAbs = std::abs(inputBuffer[i]);
-
-        // Calculate target gain - unity if below threshold, otherwise reduce to threshold
-        float targetGain = (inputAbs <= threshold) ?
-                           1.0f :
-                           threshold / (inputAbs + TIME_EPSILON);
-
-        // Apply attack/release smoothing based on whether gain decreases or increases
-        if (targetGain < currentGain)
-        {
-            // Attack phase - gain reduction
-            currentGain = attackCoeff * currentGain + (1.0f - attackCoeff) * targetGain;
-            currentGain = std::max(currentGain, targetGain);
-        }
-        else
-        {
-            // Release phase - gain recovery
-            currentGain = releaseCoeff * currentGain + (1.0f - releaseCoeff) * targetGain;
-            currentGain = std::min(currentGain, 1.0f);
-        }
-
-        outputBuffer[i] = inputBuffer[i] * currentGain;
+        ramp.process(inputBuffer[i]);
+        minGain = std::min(minGain, ramp.currentGain);
     }
+    endRamp(ramp);
+    return minGain;
+}
+
+LimiterRamp Limiter::beginRamp() const
+{
+    return { threshold, attackCoeff, releaseCoeff, currentGain };
+}
+
+void Limiter::endRamp(const LimiterRamp& ramp)
+{
+    currentGain = ramp.currentGain;
 }
 
 //--------------------------------------------------------------------------
 // Limiter Controls
 //--------------------------------------------------------------------------
 
+bool Limiter::applyParameter(const ParameterEvent& event)
+{
+    // Non-finite values are claimed but dropped
+    float value = event.value;
+    const bool valid = clampParameter(event.id, value);
+    switch (event.id)
+    {
+        case ParameterId::LimiterEnabled: if (valid) setEnabled(value != 0.0f); return true;
+        case ParameterId::LimiterThreshold: if (valid) setThreshold(value); return true;
+        case ParameterId::LimiterAttack: if (valid) setAttackTime(value); return true;
+        case ParameterId::LimiterRelease: if (valid) setReleaseTime(value); return true;
+        default: return false;
+    }
+}
+
 void Limiter::setThreshold(float newThreshold)
 {
     threshold = std::max(0.0f, std::min(1.0f, newThreshold));
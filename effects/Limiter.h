@@ -1,12 +1,62 @@
 #ifndef LIMITER_H
 #define LIMITER_H
 
+#include "../audio/ParameterEvent.h"
 #include "../common.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 
 namespace audio {
 
+// Small constant to prevent division by zero
+constexpr float LIMITER_TIME_EPSILON = 1e-6f;
+
+/**
+ * The limiter's per-sample gain envelope, with its state in plain members
+ * so it can run inside a FusedChain.
+ * Get one from Limiter::beginRamp() and hand it back to endRamp().
+ */
+struct LimiterRamp
+{
+    float threshold;
+    float attackCoeff;
+    float releaseCoeff;
+    float currentGain;
+
+    /**
+     * Advances the envelope by one sample.
+     * @param sample Input sample
+     * @return Sample scaled by the new gain
+     */
+    float process(float sample)
+    {
+        float inputAbs = std::abs(sample);
+
+        // Calculate target gain - unity if below threshold, otherwise reduce to threshold
+        float targetGain = (inputAbs <= threshold) ?
+                           1.0f :
+                           threshold / (inputAbs + LIMITER_TIME_EPSILON);
+
+        // Apply attack/release smoothing based on whether gain decreases or increases
+        if (targetGain < currentGain)
+        {
+            // Attack phase - gain reduction
+            currentGain = attackCoeff * currentGain + (1.0f - attackCoeff) * targetGain;
+            currentGain = std::max(currentGain, targetGain);
+        }
+        else
+        {
+            // Release phase - gain recovery
+            currentGain = releaseCoeff * currentGain + (1.0f - releaseCoeff) * targetGain;
+            currentGain = std::min(currentGain, 1.0f);
+        }
+
+        return sample * currentGain;
+    }
+};
+
 /**
  * Audio limiter that prevents signals from exceeding a threshold.
  *
@@ -67,9 +117,65 @@ public:
      */
     void process(const float* inputBuffer, float* outputBuffer, std::size_t bufferSize);
 
+    /**
+     * Processes a block of silent input: writes zeros and lets the gain
+     * recover as process() would, in closed form rather than per sample.
+     *
+     * @param outputBuffer Destination for the (silent) output
+     * @param bufferSize Number of samples
+     */
+    void processSilence(float* outputBuffer, std::size_t bufferSize);
+
+    /**
+     * Processes a block, applying the limiter's parameter events at their
+     * offsets (the block is split there).
+     * @param events Events inside the block; other effects' events are skipped
+     */
+    void process(const float* inputBuffer, float* outputBuffer, std::size_t bufferSize, const BlockEvents& events);
+
+    /**
+     * processSilence() with the limiter's parameter events applied at their offsets.
+     */
+    void processSilence(float* outputBuffer, std::size_t bufferSize, const BlockEvents& events);
+
+    /**
+     * Advances the gain envelope exactly as process() would without producing output.
+     * Used by analysis passes that only need the gain reduction per block.
+     *
+     * @param inputBuffer Source audio samples
+     * @param bufferSize Number of samples to analyze
+     * @return Lowest gain reached within the block (1.0 = no reduction)
+     */
+    float analyze(const float* inputBuffer, std::size_t bufferSize);
+
+    /**
+     * Gets the current smoothed gain (1.0 = no reduction).
+     */
+    float getCurrentGain() const { return currentGain; }
+
+    /**
+     * Captures the envelope state for a block processed outside process(),
+     * e.g. fused with other stages in a FusedChain.
+     * @return Envelope ready to run from the current gain
+     */
+    LimiterRamp beginRamp() const;
+
+    /**
+     * Stores the envelope state after such a block.
+     * @param ramp Envelope returned by beginRamp() and run over the block
+     */
+    void endRamp(const LimiterRamp& ramp);
+
     //--------------------------------------------------------------------------
     // Limiter Controls
     //--------------------------------------------------------------------------
+    /**
+     * Applies a parameter event if it is one of the limiter's, clamped to
+     * parameterRange(); a non-finite value is ignored.
+     * @return false if the event belongs to another effect
+     */
+    bool applyParameter(const ParameterEvent& event);
+
     /**
      * Sets the amplitude threshold.
      * @param newThreshold Threshold value (0.0-1.0)
@@ -1,4 +1,6 @@
 #include "NoiseGate.h"
+#include "FusedChain.h"
+#include "../audio/Profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -11,19 +13,22 @@ namespace audio {
 
 NoiseGate::NoiseGate(unsigned int rate, unsigned int size, float thresh, float attackMs, float releaseMs)
     : AudioEffect(rate),
-      fftSize(size),
+      stft(size, StftOverlap::Half, false),
+      sideChain(nullptr),
+      voiceActivity(nullptr),
+      bandEnergies(NUM_BANDS, 0.0),
       currentGain(0.0f),
-      bandEnergies(NUM_BANDS, 0.0)
+      lastTargetGain(0.0f),
+      outputSilent(false)
 {
     setThreshold(thresh);
     setAttackTime(attackMs);
     setReleaseTime(releaseMs);
 
-    timeData = fftw_alloc_real(fftSize);
-    frequencyData = fftw_alloc_complex(fftSize / 2 + 1);
-    fftPlan = fftw_plan_dft_r2c_1d(fftSize, timeData, frequencyData, FFTW_ESTIMATE);
+    // Room for every decision in a block of up to twice the default size
+    hopTargets.reserve(FRAMES_PER_BUFFER * 2 / stft.getHopSize() + 1);
 
-    if (!timeData || !frequencyData || !fftPlan)
+    if (!stft.isValid())
     {
         effectActive.store(false);
     }
@@ -31,22 +36,6 @@ NoiseGate::NoiseGate(unsigned int rate, unsigned int size, float thresh, float a
     reset();
 }
 
-NoiseGate::~NoiseGate()
-{
-    if (fftPlan)
-    {
-        fftw_destroy_plan(fftPlan);
-    }
-    if (timeData)
-    {
-        fftw_free(timeData);
-    }
-    if (frequencyData)
-    {
-        fftw_free(frequencyData);
-    }
-}
-
 //--------------------------------------------------------------------------
 // Private Methods
 //--------------------------------------------------------------------------
@@ -63,60 +52,125 @@ void NoiseGate::calculateCoeffs()
 void NoiseGate::calculateBandEnergies()
 {
     std::fill(bandEnergies.begin(), bandEnergies.end(), 0.0);
+    stft.getKernels().accumulateGateBands(stft.getSpectrum(), bandEnergies.data(), stft.getFftSize());
+}
 
-    for (unsigned int i = 1; i < fftSize / 2; ++i)
+float NoiseGate::determineTargetGain()
+{
+    calculateBandEnergies();
+
+    double totalEnergy = 0.0;
+    for (double energy : bandEnergies)
     {
-        double real = frequencyData[i][0];
-        double imaginary = frequencyData[i][1];
-        double energy = real * real + imaginary * imaginary;
+        totalEnergy += energy;
+    }
 
-        if (i > 0)
-        {
-            unsigned int band = static_cast<unsigned int>(
-                (NUM_BANDS - 1) * std::log2(static_cast<double>(i)) /
-                std::log2(static_cast<double>(fftSize / 2 - 1))
-            );
-            band = std::min(band, static_cast<unsigned int>(NUM_BANDS - 1));
+    double avgEnergy = (NUM_BANDS > 0) ? (totalEnergy / NUM_BANDS) : 0.0;
+    double normalizationFactor = stft.getAnalysisPower();
+    double normalizedAvgEnergy = avgEnergy / normalizationFactor;
 
-            if (band < bandEnergies.size())
-            {
-                bandEnergies[band] += energy;
-            }
-        }
-    }
+    return (normalizedAvgEnergy > (threshold * threshold)) ? 1.0f : 0.0f;
+}
+
+float NoiseGate::determineSideChainGain() const
+{
+    // Parseval: a frame's bins 1 .. N/2-1 hold about N/2 * power * window energy
+    const double normalizedAvgEnergy = sideChain->getPower() * (stft.getFftSize() / 2) / NUM_BANDS;
+    return (normalizedAvgEnergy > (threshold * threshold)) ? 1.0f : 0.0f;
 }
 
-float NoiseGate::determineTargetGain(const float* inputBuffer, std::size_t numFrames)
+GateRamp NoiseGate::beginRamp(const float* inputBuffer, std::size_t numFrames)
 {
-    std::fill_n(timeData, fftSize, 0.0);
-    std::size_t copySize = std::min(numFrames, static_cast<std::size_t>(fftSize));
-    for (std::size_t i = 0; i < copySize; ++i)
+    // Analyse first (input and output may alias); a decision applies from
+    // the hop boundary where its frame completes
+    std::size_t firstBoundary = stft.getHopRemaining();
+    hopTargets.clear();
+    if (sideChain)
     {
-        timeData[i] = static_cast<double>(inputBuffer[i]);
+        // One decision for the whole block, from its first sample
+        hopTargets.push_back(determineSideChainGain());
+        firstBoundary = 0;
     }
-
-    if (fftPlan)
+    else if (!stft.isValid())
     {
-        fftw_execute(fftPlan);
+        // Nothing to analyse: pass the block unchanged, as process() does
+        currentGain = 1.0f;
+        lastTargetGain = 1.0f;
     }
     else
     {
-        return 1.0f;
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::GateFFT);
+        for (std::size_t pos = 0; pos < numFrames; )
+        {
+            const std::size_t chunk = std::min(numFrames - pos, stft.getHopRemaining());
+            if (stft.pushInput(inputBuffer + pos, chunk))
+            {
+                stft.analyze();
+                hopTargets.push_back(determineTargetGain());
+                if (voiceActivity)
+                {
+                    voiceActivity->analyzeFrame(stft.getSpectrum(), stft.getFftSize());
+                }
+            }
+            pos += chunk;
+        }
     }
 
-    calculateBandEnergies();
+    // Closed and no frame opens it: the whole block is exact silence
+    outputSilent = (currentGain == 0.0f && lastTargetGain == 0.0f &&
+                    std::all_of(hopTargets.begin(), hopTargets.end(), [](float target) { return target == 0.0f; }));
+
+    GateRamp ramp;
+    ramp.currentGain = currentGain;
+    ramp.targetGain = lastTargetGain;
+    ramp.attackCoeff = attackCoeff;
+    ramp.releaseCoeff = releaseCoeff;
+    ramp.decisions = hopTargets.data();
+    ramp.decisionsEnd = hopTargets.data() + hopTargets.size();
+    ramp.nextBoundary = hopTargets.empty() ? std::numeric_limits<std::size_t>::max() : firstBoundary;
+    ramp.hopSize = stft.getHopSize();
+    ramp.position = 0;
+    return ramp;
+}
 
-    double totalEnergy = 0.0;
-    for (double energy : bandEnergies)
+void NoiseGate::endRamp(const GateRamp& ramp)
+{
+    currentGain = ramp.currentGain;
+    // A frame completing on the last sample decides the next block
+    lastTargetGain = (ramp.decisions != ramp.decisionsEnd) ? ramp.decisionsEnd[-1] : ramp.targetGain;
+
+    if (lastTargetGain == 0.0f && currentGain < NG_SILENCE_FLOOR)
     {
-        totalEnergy += energy;
+        currentGain = 0.0f; // Inaudible from here: let the next blocks be flagged silent
     }
+}
 
-    double avgEnergy = (NUM_BANDS > 0) ? (totalEnergy / NUM_BANDS) : 0.0;
-    double normalizationFactor = static_cast<double>(fftSize);
-    double normalizedAvgEnergy = avgEnergy / normalizationFactor;
-
-    return (normalizedAvgEnergy > (threshold * threshold)) ? 1.0f : 0.0f;
+void NoiseGate::runGate(const float* inputBuffer, float* outputBuffer, std::size_t numFrames)
+{
+    GateRamp ramp = beginRamp(inputBuffer, numFrames);
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::GateRamp);
+        if (outputSilent)
+        {
+            // Gain stays at exactly zero: nothing to ramp
+            if (outputBuffer)
+            {
+                std::fill_n(outputBuffer, numFrames, 0.0f);
+            }
+        }
+        else if (outputBuffer)
+        {
+            FusedChain<GateRamp>::run(inputBuffer, outputBuffer, numFrames, ramp);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < numFrames; ++i)
+            {
+                ramp.process(inputBuffer[i]);
+            }
+        }
+    }
+    endRamp(ramp);
 }
 
 //--------------------------------------------------------------------------
@@ -125,9 +179,10 @@ float NoiseGate::determineTargetGain(const float* inputBuffer, std::size_t numFr
 
 void NoiseGate::process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames)
 {
-    if (!effectActive.load() || numFrames == 0)
+    if (!effectActive.load() || numFrames == 0 || !stft.isValid())
     {
         std::copy(inputBuffer, inputBuffer + numFrames, outputBuffer);
+        outputSilent = false;
         if (!effectActive.load())
         {
             currentGain = 0.0f;
@@ -135,35 +190,82 @@ void NoiseGate::process(const float* inputBuffer, float* outputBuffer, std::size
         return;
     }
 
-    float targetGain = determineTargetGain(inputBuffer, numFrames);
+    runGate(inputBuffer, outputBuffer, numFrames);
+}
 
-    for (std::size_t i = 0; i < numFrames; ++i)
+void NoiseGate::process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames,
+                        const BlockEvents& events)
+{
+    // The gate gives the same output whatever the block size, so splitting costs nothing but the calls
+    bool silent = numFrames > 0;
+    events.split(numFrames, [this](const ParameterEvent& event) { applyParameter(event); },
+                 [&](std::size_t from, std::size_t to)
     {
-        if (targetGain > currentGain)
-        {
-            currentGain = attackCoeff * currentGain + (1.0f - attackCoeff) * targetGain;
-            currentGain = std::min(currentGain, targetGain);
-        }
-        else
-        {
-            currentGain = releaseCoeff * currentGain + (1.0f - releaseCoeff) * targetGain;
-            currentGain = std::max(currentGain, targetGain);
-        }
+        process(inputBuffer + from, outputBuffer + from, to - from);
+        silent = silent && outputSilent;
+    });
+    outputSilent = silent;
+}
 
-        outputBuffer[i] = inputBuffer[i] * currentGain;
-    }
+void NoiseGate::setSideChain(const SideChain* source)
+{
+    sideChain = source;
+    stft.reset(); // Frames restart clean if the spectral detector comes back
 }
 
 void NoiseGate::reset()
 {
+    stft.reset();
     std::fill(bandEnergies.begin(), bandEnergies.end(), 0.0);
     currentGain = 0.0f;
+    lastTargetGain = 0.0f;
+    outputSilent = false;
+}
+
+//--------------------------------------------------------------------------
+// Analysis Interface
+//--------------------------------------------------------------------------
+
+float NoiseGate::analyze(const float* inputBuffer, std::size_t numFrames)
+{
+    if (numFrames == 0 || !stft.isValid())
+    {
+        return currentGain;
+    }
+
+    // Same analysis and envelope as process(), minus the multiply and the output write
+    runGate(inputBuffer, nullptr, numFrames);
+    return currentGain;
+}
+
+double NoiseGate::getBandEnergy(unsigned int band) const
+{
+    if (band >= bandEnergies.size())
+    {
+        return 0.0;
+    }
+    return bandEnergies[band] / stft.getAnalysisPower();
 }
 
 //--------------------------------------------------------------------------
 // Noise Gate Controls
 //--------------------------------------------------------------------------
 
+bool NoiseGate::applyParameter(const ParameterEvent& event)
+{
+    // Non-finite values are claimed but dropped
+    float value = event.value;
+    const bool valid = clampParameter(event.id, value);
+    switch (event.id)
+    {
+        case ParameterId::GateEnabled: if (valid) setEnabled(value != 0.0f); return true;
+        case ParameterId::GateThreshold: if (valid) setThreshold(value); return true;
+        case ParameterId::GateAttack: if (valid) setAttackTime(value); return true;
+        case ParameterId::GateRelease: if (valid) setReleaseTime(value); return true;
+        default: return false;
+    }
+}
+
 void NoiseGate::setThreshold(float newThreshold)
 {
     threshold = std::max(0.0f, std::min(1.0f, newThreshold));
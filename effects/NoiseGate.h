@@ -2,21 +2,84 @@
 #define NOISE_GATE_H
 
 #include "AudioEffect.h"
+#include "SideChain.h"
+#include "StftEngine.h"
+#include "VoiceActivity.h"
+#include "../audio/ParameterEvent.h"
 #include "../common.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <vector>
-#include <fftw3.h>
 
 namespace audio {
 
 // Small constant to prevent division by zero in coefficient calculation
 constexpr float NG_TIME_EPSILON = 1e-6f;
 
+// Closed-gate gain below which the gate snaps to exact silence (-120 dB)
+constexpr float NG_SILENCE_FLOOR = 1e-6f;
+
+/**
+ * The gate's per-sample gain ramp for one analysed block, with its state
+ * in plain members so it can run inside a FusedChain.
+ * Get one from NoiseGate::beginRamp() and hand it back to endRamp().
+ */
+struct GateRamp
+{
+    float currentGain;
+    float targetGain;
+    float attackCoeff;
+    float releaseCoeff;
+    const float* decisions;         // targets from each hop boundary in the block
+    const float* decisionsEnd;
+    std::size_t nextBoundary;       // sample at which the next decision applies
+    std::size_t hopSize;
+    std::size_t position;
+
+    /**
+     * Advances the ramp by one sample.
+     * @param sample Input sample
+     * @return Sample scaled by the new gain
+     */
+    float process(float sample)
+    {
+        if (position++ == nextBoundary)
+        {
+            targetGain = *decisions++;
+            nextBoundary = (decisions != decisionsEnd) ? nextBoundary + hopSize
+                                                       : std::numeric_limits<std::size_t>::max();
+        }
+
+        if (targetGain > currentGain)
+        {
+            currentGain = attackCoeff * currentGain + (1.0f - attackCoeff) * targetGain;
+            currentGain = std::min(currentGain, targetGain);
+        }
+        else
+        {
+            currentGain = releaseCoeff * currentGain + (1.0f - releaseCoeff) * targetGain;
+            currentGain = std::max(currentGain, targetGain);
+        }
+        return sample * currentGain;
+    }
+};
+
 /**
  * Spectral noise gate with attack/release smoothing.
  *
  * Analyzes audio in the frequency domain to detect signal presence
  * and applies smooth gain transitions based on configurable threshold.
+ * Frames come from an analysis-only StftEngine at 50% overlap; each
+ * frame's decision applies from the hop boundary where it completes, so
+ * the gate reacts at the same rate whatever the block size. Alternatively
+ * the gate can detect from a shared SideChain (setSideChain()): one
+ * decision per block from its power, with no FFT of the gate's own. The
+ * frames it does analyse can be handed to a VoiceActivityDetector
+ * (setVoiceActivity()), so voice detection needs no FFT of its own. Once closed
+ * below NG_SILENCE_FLOOR the gain snaps to zero, and blocks in which it
+ * stays closed are flagged silent (isOutputSilent()).
  */
 class NoiseGate : public AudioEffect
 {
@@ -24,7 +87,6 @@ private:
     //--------------------------------------------------------------------------
     // Configuration
     //--------------------------------------------------------------------------
-    unsigned int fftSize;
     float threshold;
     float attackTimeMs;
     float releaseTimeMs;
@@ -32,17 +94,20 @@ private:
     float releaseCoeff;
 
     //--------------------------------------------------------------------------
-    // FFTW Resources
+    // STFT Analysis
     //--------------------------------------------------------------------------
-    fftw_plan fftPlan;
-    double* timeData;
-    fftw_complex* frequencyData;
+    StftEngine stft;
+    const SideChain* sideChain;     // detector input when set (externally owned and run)
+    VoiceActivityDetector* voiceActivity;   // gets each analysed frame when set (externally owned)
 
     //--------------------------------------------------------------------------
     // Internal State
     //--------------------------------------------------------------------------
     std::vector<double> bandEnergies;
     float currentGain;
+    float lastTargetGain;   // 1.0f while the last analysed frame was above threshold
+    std::vector<float> hopTargets;  // decisions of the frames completed in the current block
+    bool outputSilent;      // the last block was gated to exact silence
 
     //--------------------------------------------------------------------------
     // Private Methods
@@ -53,17 +118,31 @@ private:
     void calculateCoeffs();
 
     /**
-     * Calculates energy distribution across frequency bands.
+     * Calculates energy distribution across frequency bands
+     * (log-spaced, see gateBandOf()).
      */
     void calculateBandEnergies();
 
     /**
-     * Determines if signal exceeds threshold.
-     * @param inputBuffer Audio data to analyze
-     * @param numFrames Number of samples to process
+     * Determines if the frame just analysed exceeds the threshold.
      * @return 1.0f if signal exceeds threshold, 0.0f otherwise
      */
-    float determineTargetGain(const float* inputBuffer, std::size_t numFrames);
+    float determineTargetGain();
+
+    /**
+     * Determines the block's target from the side-chain power, on the same
+     * scale as the spectral test (the mean band energy of an FFT frame).
+     * @return 1.0f if signal exceeds threshold, 0.0f otherwise
+     */
+    float determineSideChainGain() const;
+
+    /**
+     * Analyses a block, then ramps the gain through it toward each frame's decision.
+     * @param inputBuffer Audio data
+     * @param outputBuffer Gated output, or nullptr to advance the envelope only
+     * @param numFrames Number of samples
+     */
+    void runGate(const float* inputBuffer, float* outputBuffer, std::size_t numFrames);
 
 public:
     //--------------------------------------------------------------------------
@@ -73,7 +152,7 @@ public:
      * Creates a noise gate with specified parameters.
      *
      * @param rate Sample rate in Hz (default: SAMPLE_RATE)
-     * @param size FFT size for spectral analysis (default: FFT_SIZE)
+     * @param size FFT size for spectral analysis; the hop is half of it (default: FFT_SIZE)
      * @param thresh Amplitude threshold (0.0-1.0, default: 0.1)
      * @param attackMs Attack time in milliseconds (default: 5.0)
      * @param releaseMs Release time in milliseconds (default: 50.0)
@@ -84,11 +163,6 @@ public:
                        float attackMs = 5.0f,
                        float releaseMs = 50.0f);
 
-    /**
-     * Cleans up FFTW resources.
-     */
-    ~NoiseGate() override;
-
     //--------------------------------------------------------------------------
     // AudioEffect Interface
     //--------------------------------------------------------------------------
@@ -100,14 +174,108 @@ public:
      */
     void process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames) override;
 
+    /**
+     * Processes a block, applying the gate's parameter events at their
+     * offsets (the block is split there).
+     * @param inputBuffer Input audio data
+     * @param outputBuffer Output buffer for processed audio
+     * @param numFrames Number of samples to process
+     * @param events Events inside the block; other effects' events are skipped
+     */
+    void process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames, const BlockEvents& events);
+
     /**
      * Resets internal state to default values.
      */
     void reset() override;
 
+    /**
+     * Analyses a block and returns the gain ramp that gates it, for running
+     * outside process(), e.g. fused with other stages in a FusedChain.
+     * Call only while the gate is enabled. A gate whose FFT could not be
+     * set up returns a ramp at unity gain.
+     * @param inputBuffer Audio data (read before any output is written)
+     * @param numFrames Number of samples in the block
+     * @return Ramp to run over exactly numFrames samples
+     */
+    GateRamp beginRamp(const float* inputBuffer, std::size_t numFrames);
+
+    /**
+     * Stores the gate state after a ramp from beginRamp() has run.
+     * @param ramp The ramp, advanced over the whole block
+     */
+    void endRamp(const GateRamp& ramp);
+
+    //--------------------------------------------------------------------------
+    // Analysis Interface
+    //--------------------------------------------------------------------------
+    /**
+     * Advances the gate exactly as process() would without producing output.
+     * Used by analysis passes that only need the gate's state per block.
+     * @param inputBuffer Audio data to analyze
+     * @param numFrames Number of samples in the block
+     * @return Gate gain at the end of the block
+     */
+    float analyze(const float* inputBuffer, std::size_t numFrames);
+
+    /**
+     * Checks whether the last analysed frame was above the threshold.
+     * @return true if the gate is opening or open
+     */
+    bool isOpen() const { return lastTargetGain > 0.5f; }
+
+    /**
+     * Checks whether the last block (or the ramp from beginRamp()) is
+     * exact silence: fully closed, staying closed throughout. The output
+     * is then all zeros, and downstream stages may skip their work.
+     */
+    bool isOutputSilent() const { return outputSilent; }
+
+    /**
+     * Gets the current smoothed gate gain (0.0 closed .. 1.0 open).
+     */
+    float getCurrentGain() const { return currentGain; }
+
+    /**
+     * Gets the spectral energy per band of the last analysed frame,
+     * normalised by the window energy as in the threshold test.
+     * Not updated while detecting from a side-chain.
+     * @param band Band index (0 .. NUM_BANDS-1)
+     */
+    double getBandEnergy(unsigned int band) const;
+
+    /**
+     * Detects from a shared side-chain instead of the gate's own FFT.
+     * The owner runs source->analyze() over each block the gate gets,
+     * before the gate processes or analyses it. Call off the audio thread
+     * (or between blocks on it); pass nullptr for the spectral detector.
+     * @param source Side-chain analysing the gate's input
+     */
+    void setSideChain(const SideChain* source);
+
+    const SideChain* getSideChain() const { return sideChain; }
+
+    /**
+     * Hands each frame the spectral detector analyses to a voice activity
+     * detector (VoiceActivityDetector::analyzeFrame()). No frames are
+     * handed over while the gate is bypassed or detects from a side-chain.
+     * Call off the audio thread (or between blocks on it); pass nullptr to stop.
+     * @param detector Detector measuring the gate's input
+     */
+    void setVoiceActivity(VoiceActivityDetector* detector) { voiceActivity = detector; }
+
+    VoiceActivityDetector* getVoiceActivity() const { return voiceActivity; }
+
     //--------------------------------------------------------------------------
     // Noise Gate Controls
     //--------------------------------------------------------------------------
+    /**
+     * Applies a parameter event if it is one of the gate's, clamped to
+     * parameterRange(); a non-finite value is ignored.
+     * @return false if the event belongs to another effect
+     */
+    bool applyParameter(const ParameterEvent& event);
+
     /**
      * Sets the gate threshold.
      * @param newThreshold Threshold value (0.0-1.0)
@@ -0,0 +1,223 @@
+#include "SideChain.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+namespace {
+
+// Kaiser window shape: about 50 dB of stopband for the 23-tap half-band
+const double HALFBAND_KAISER_BETA = 4.5;
+
+// Zeroth-order modified Bessel function of the first kind (series)
+double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Side taps of the half-band lowpass (cutoff at a quarter of the rate),
+ * a Kaiser-windowed sinc. Entry k is the tap at offsets +-(2k + 1) from
+ * the centre; the sides sum to 0.25 so the DC gain is exactly one.
+ */
+struct HalfBandCoefficients
+{
+    float side[HALFBAND_SIDE_TAPS];
+
+    HalfBandCoefficients()
+    {
+        const double centre = (HALFBAND_TAPS - 1) / 2.0;
+        double taps[HALFBAND_SIDE_TAPS];
+        double sum = 0.0;
+        for (unsigned int k = 0; k < HALFBAND_SIDE_TAPS; ++k)
+        {
+            const double offset = 2.0 * k + 1.0;
+            const double sinc = std::sin(M_PI * offset / 2.0) / (M_PI * offset / 2.0);
+            const double ratio = offset / centre;
+            const double window = besselI0(HALFBAND_KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) /
+                                  besselI0(HALFBAND_KAISER_BETA);
+            taps[k] = 0.5 * sinc * window;
+            sum += taps[k];
+        }
+        for (unsigned int k = 0; k < HALFBAND_SIDE_TAPS; ++k)
+        {
+            side[k] = static_cast<float>(taps[k] * 0.25 / sum);
+        }
+    }
+};
+
+const HalfBandCoefficients& halfBandCoefficients()
+{
+    static const HalfBandCoefficients coefficients;
+    return coefficients;
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Half-Band Decimator
+//--------------------------------------------------------------------------
+
+HalfBandDecimator::HalfBandDecimator()
+{
+    reset();
+}
+
+std::size_t HalfBandDecimator::process(const float* input, std::size_t numFrames, float* low, double& highEnergy)
+{
+    const float* side = halfBandCoefficients().side;
+    const unsigned int centre = (HALFBAND_TAPS - 1) / 2;
+    std::size_t produced = 0;
+    double energy = 0.0;
+
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        // Read before writing: low may alias input, but never runs ahead of it
+        const float sample = input[i];
+        delayLine[position] = sample;
+        delayLine[position + HALFBAND_TAPS] = sample;
+        position = (position + 1 == HALFBAND_TAPS) ? 0 : position + 1;
+
+        if (!oddSample)
+        {
+            oddSample = true;
+            continue;
+        }
+        oddSample = false;
+
+        // Oldest sample first; only the odd offsets from the centre have taps
+        const float* window = delayLine + position;
+        float sum = 0.0f;
+        for (unsigned int k = 0; k < HALFBAND_SIDE_TAPS; ++k)
+        {
+            const unsigned int offset = 2 * k + 1;
+            sum += side[k] * (window[centre - offset] + window[centre + offset]);
+        }
+        const float middle = 0.5f * window[centre];
+        const float high = middle - sum;
+        low[produced++] = middle + sum;
+        energy += static_cast<double>(high) * high;
+    }
+
+    highEnergy = energy;
+    return produced;
+}
+
+void HalfBandDecimator::reset()
+{
+    std::fill_n(delayLine, HALFBAND_TAPS * 2, 0.0f);
+    position = 0;
+    oddSample = false;
+}
+
+//--------------------------------------------------------------------------
+// Side-Chain Analysis
+//--------------------------------------------------------------------------
+
+SideChain::SideChain(unsigned int rate, std::size_t maxFrames)
+    : sampleRate(rate)
+{
+    prepare(maxFrames);
+    reset();
+}
+
+void SideChain::prepare(std::size_t maxFrames)
+{
+    decimated.resize(maxFrames / 2 + 1);
+}
+
+void SideChain::analyze(const float* input, std::size_t numFrames)
+{
+    if (numFrames / 2 + 1 > decimated.size())
+    {
+        // Oversized block: grow rather than overrun (callers should prepare())
+        prepare(numFrames);
+    }
+
+    // Each stage decimates the previous one's lower band in place
+    const float* source = input;
+    std::size_t count = numFrames;
+    for (unsigned int s = 0; s < SIDECHAIN_STAGES; ++s)
+    {
+        double highEnergy = 0.0;
+        count = stages[s].process(source, count, decimated.data(), highEnergy);
+        source = decimated.data();
+        if (count > 0)
+        {
+            bandPower[SIDECHAIN_STAGES - s] = highEnergy / count;
+        }
+    }
+
+    if (count > 0)
+    {
+        double lowEnergy = 0.0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            lowEnergy += static_cast<double>(decimated[i]) * decimated[i];
+        }
+        bandPower[0] = lowEnergy / count;
+    }
+}
+
+void SideChain::reset()
+{
+    for (HalfBandDecimator& stage : stages)
+    {
+        stage.reset();
+    }
+    std::fill_n(bandPower, SIDECHAIN_BANDS, 0.0);
+}
+
+double SideChain::getPower() const
+{
+    double power = 0.0;
+    for (unsigned int band = 0; band < SIDECHAIN_BANDS; ++band)
+    {
+        power += bandPower[band];
+    }
+    return power;
+}
+
+double SideChain::getPowerBetween(double lowHz, double highHz) const
+{
+    double power = 0.0;
+    for (unsigned int band = 0; band < SIDECHAIN_BANDS; ++band)
+    {
+        const double bandLow = getBandLowHz(band);
+        const double bandHigh = getBandHighHz(band);
+        const double overlap = std::min(highHz, bandHigh) - std::max(lowHz, bandLow);
+        if (overlap > 0.0)
+        {
+            power += bandPower[band] * overlap / (bandHigh - bandLow);
+        }
+    }
+    return power;
+}
+
+double SideChain::getBandLowHz(unsigned int band) const
+{
+    if (band == 0 || band >= SIDECHAIN_BANDS)
+    {
+        return 0.0;
+    }
+    return sampleRate / static_cast<double>(1u << (SIDECHAIN_STAGES - band + 2));
+}
+
+double SideChain::getBandHighHz(unsigned int band) const
+{
+    if (band >= SIDECHAIN_BANDS)
+    {
+        return 0.0;
+    }
+    return sampleRate / static_cast<double>(1u << (SIDECHAIN_STAGES - band + 1));
+}
+
+} // namespace audio
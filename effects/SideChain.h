@@ -0,0 +1,148 @@
+#ifndef SIDE_CHAIN_H
+#define SIDE_CHAIN_H
+
+#include "../common.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace audio {
+
+// Half-band stages in the cascade; each splits off the upper octave of its input
+constexpr unsigned int SIDECHAIN_STAGES = 5;
+
+// Octave bands the side-chain reports: one per stage plus the residual low band
+constexpr unsigned int SIDECHAIN_BANDS = SIDECHAIN_STAGES + 1;
+
+// Taps of the half-band filter (4k + 3, so the centre tap sits on an odd offset)
+constexpr unsigned int HALFBAND_TAPS = 23;
+
+// Non-zero taps on each side of the centre (the odd offsets 1, 3, .. 11)
+constexpr unsigned int HALFBAND_SIDE_TAPS = (HALFBAND_TAPS + 1) / 4;
+
+//--------------------------------------------------------------------------
+// Half-Band Decimator
+//--------------------------------------------------------------------------
+
+/**
+ * Splits a signal into its lower and upper half-bands at half the rate.
+ *
+ * Polyphase form of a linear-phase half-band FIR: every other tap is zero
+ * and the centre tap is 0.5, so each output pair costs HALFBAND_SIDE_TAPS
+ * multiplies over symmetric sums. The upper band is the delayed input
+ * minus the lower band (its complement), decimated without band limiting:
+ * it folds over, which keeps its energy for envelope detection but not
+ * its waveform.
+ */
+class HalfBandDecimator
+{
+private:
+    float delayLine[HALFBAND_TAPS * 2];     // written twice, so the last HALFBAND_TAPS are contiguous
+    unsigned int position;
+    bool oddSample;                         // the next sample completes an output pair
+
+public:
+    HalfBandDecimator();
+
+    /**
+     * Decimates a block.
+     * @param input Samples at the stage's input rate
+     * @param numFrames Number of samples (any size; phase carries over)
+     * @param low Receives the lower band at half the rate (may alias input)
+     * @param highEnergy Sum of squares of the upper band samples produced
+     * @return Number of samples written to low
+     */
+    std::size_t process(const float* input, std::size_t numFrames, float* low, double& highEnergy);
+
+    void reset();
+};
+
+//--------------------------------------------------------------------------
+// Side-Chain Analysis
+//--------------------------------------------------------------------------
+
+/**
+ * Shared, decimated detector input: octave band powers once per block.
+ *
+ * A cascade of SIDECHAIN_STAGES half-band decimators splits off one
+ * octave per stage (12-24 kHz, 6-12 kHz, .. at 48 kHz) and leaves a low
+ * band below rate / 2^(SIDECHAIN_STAGES + 1). Each stage runs at half the
+ * rate of the one before, so the whole cascade costs about twice its
+ * first stage. Detectors (the gate, de-esser metering, level meters) read
+ * the band powers instead of running a full-rate FFT each.
+ *
+ * The lower bands lag the upper ones by the filters' group delay (about
+ * 7 ms for the low band at 48 kHz): fine for control signals. The
+ * splits are amplitude- rather than power-complementary, so signal at a
+ * crossover counts at half power: a tone inside a band reads its full
+ * power, white noise about 0.6 dB low.
+ */
+class SideChain
+{
+private:
+    unsigned int sampleRate;
+    HalfBandDecimator stages[SIDECHAIN_STAGES];
+    std::vector<float> decimated;           // each stage's lower band, decimated in place
+    double bandPower[SIDECHAIN_BANDS];      // mean square per band over the last block, low band first
+
+public:
+    /**
+     * @param rate Sample rate in Hz (default: SAMPLE_RATE)
+     * @param maxFrames Largest block analyze() must handle without allocating
+     */
+    explicit SideChain(unsigned int rate = SAMPLE_RATE, std::size_t maxFrames = FRAMES_PER_BUFFER * 2);
+
+    /**
+     * Resizes the decimation buffer for a new maximum block size.
+     * Allocates; must not be called from the audio thread.
+     */
+    void prepare(std::size_t maxFrames);
+
+    /**
+     * Runs the cascade over a block and updates the band powers.
+     * A band that produced no samples in a short block keeps its last power.
+     * @param input Samples at the full rate
+     * @param numFrames Number of samples, any size
+     */
+    void analyze(const float* input, std::size_t numFrames);
+
+    /**
+     * Clears the filters and band powers.
+     */
+    void reset();
+
+    /**
+     * Gets the mean square of a band over the last block.
+     * @param band Band index, 0 (lowest) .. SIDECHAIN_BANDS-1
+     */
+    double getBandPower(unsigned int band) const { return band < SIDECHAIN_BANDS ? bandPower[band] : 0.0; }
+
+    /**
+     * Gets the mean square of the whole signal over the last block (sum of the bands).
+     */
+    double getPower() const;
+
+    /**
+     * Gets the power between two frequencies, taking the overlapped share
+     * of each band (as if flat within the band).
+     * @param lowHz Lower edge in Hz
+     * @param highHz Upper edge in Hz
+     */
+    double getPowerBetween(double lowHz, double highHz) const;
+
+    /**
+     * Gets the lower edge of a band in Hz.
+     */
+    double getBandLowHz(unsigned int band) const;
+
+    /**
+     * Gets the upper edge of a band in Hz.
+     */
+    double getBandHighHz(unsigned int band) const;
+
+    unsigned int getSampleRate() const { return sampleRate; }
+};
+
+} // namespace audio
+
+#endif // SIDE_CHAIN_H
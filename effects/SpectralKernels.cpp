@@ -0,0 +1,256 @@
+#include "SpectralKernels.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MULTIAUDIO_SSE2 1
+#endif
+
+namespace audio {
+
+namespace {
+
+//--------------------------------------------------------------------------
+// Generic Kernels
+//--------------------------------------------------------------------------
+
+void genericLoadFrame(double* frame, const double* ring, unsigned int oldest,
+                      const double* analysis, unsigned int fftSize)
+{
+    const unsigned int firstRun = fftSize - oldest;
+    for (unsigned int i = 0; i < firstRun; ++i)
+    {
+        frame[i] = ring[oldest + i] * analysis[i];
+    }
+    for (unsigned int i = firstRun; i < fftSize; ++i)
+    {
+        frame[i] = ring[i - firstRun] * analysis[i];
+    }
+}
+
+void genericOverlapAdd(double* ring, const double* frame, unsigned int position,
+                       const double* synthesis, unsigned int fftSize)
+{
+    const unsigned int firstRun = std::min(fftSize, fftSize * 2 - position);
+    for (unsigned int i = 0; i < firstRun; ++i)
+    {
+        ring[position + i] += frame[i] * synthesis[i];
+    }
+    for (unsigned int i = firstRun; i < fftSize; ++i)
+    {
+        ring[i - firstRun] += frame[i] * synthesis[i];
+    }
+}
+
+void genericApplyBinGains(fftw_complex* bins, const double* gains, unsigned int numBins)
+{
+    for (unsigned int i = 0; i < numBins; ++i)
+    {
+        bins[i][0] *= gains[i];
+        bins[i][1] *= gains[i];
+    }
+}
+
+void genericAccumulateGateBands(const fftw_complex* bins, double* energies, unsigned int fftSize)
+{
+    for (unsigned int i = 1; i < fftSize / 2; ++i)
+    {
+        energies[gateBandOf(i, fftSize)] += bins[i][0] * bins[i][0] + bins[i][1] * bins[i][1];
+    }
+}
+
+//--------------------------------------------------------------------------
+// Fixed-Size Kernels
+//--------------------------------------------------------------------------
+
+template <unsigned int N, unsigned int Factor>
+void fixedLoadFrame(double* frame, const double* ring, unsigned int oldest, const double*, unsigned int)
+{
+    const std::array<double, N>& analysis = FixedStftWindow<N, Factor>::analysis;
+    const unsigned int firstRun = N - oldest;
+    for (unsigned int i = 0; i < firstRun; ++i)
+    {
+        frame[i] = ring[oldest + i] * analysis[i];
+    }
+    for (unsigned int i = firstRun; i < N; ++i)
+    {
+        frame[i] = ring[i - firstRun] * analysis[i];
+    }
+}
+
+template <unsigned int N, unsigned int Factor>
+void fixedOverlapAdd(double* ring, const double* frame, unsigned int position, const double*, unsigned int)
+{
+    const std::array<double, N>& synthesis = FixedStftWindow<N, Factor>::synthesis;
+    if (position <= N)
+    {
+        // Frame fits without wrapping: one loop of N
+        double* out = ring + position;
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            out[i] += frame[i] * synthesis[i];
+        }
+        return;
+    }
+    const unsigned int firstRun = N * 2 - position;
+    for (unsigned int i = 0; i < firstRun; ++i)
+    {
+        ring[position + i] += frame[i] * synthesis[i];
+    }
+    for (unsigned int i = firstRun; i < N; ++i)
+    {
+        ring[i - firstRun] += frame[i] * synthesis[i];
+    }
+}
+
+template <unsigned int N>
+void fixedApplyBinGains(fftw_complex* bins, const double* gains, unsigned int)
+{
+    for (unsigned int i = 0; i < N / 2 + 1; ++i)
+    {
+        bins[i][0] *= gains[i];
+        bins[i][1] *= gains[i];
+    }
+}
+
+template <unsigned int N>
+void fixedAccumulateGateBands(const fftw_complex* bins, double* energies, unsigned int)
+{
+    constexpr std::array<unsigned int, NUM_BANDS + 1> edges = FixedGateBands<N>::edges;
+    for (unsigned int b = 0; b < NUM_BANDS; ++b)
+    {
+        double energy = 0.0;
+        for (unsigned int i = edges[b]; i < edges[b + 1]; ++i)
+        {
+            energy += bins[i][0] * bins[i][0] + bins[i][1] * bins[i][1];
+        }
+        energies[b] += energy;
+    }
+}
+
+template <unsigned int N, unsigned int Factor>
+constexpr SpectralKernels makeFixedKernels()
+{
+    return { N, Factor,
+             FixedStftWindow<N, Factor>::analysis.data(),
+             FixedStftWindow<N, Factor>::synthesis.data(),
+             &fixedLoadFrame<N, Factor>,
+             &fixedOverlapAdd<N, Factor>,
+             &fixedApplyBinGains<N>,
+             &fixedAccumulateGateBands<N> };
+}
+
+template <unsigned int N>
+constexpr std::array<SpectralKernels, 3> makeFixedKernelsAllOverlaps()
+{
+    return { makeFixedKernels<N, 2>(), makeFixedKernels<N, 4>(), makeFixedKernels<N, 8>() };
+}
+
+//--------------------------------------------------------------------------
+// Dispatch Tables
+//--------------------------------------------------------------------------
+
+const SpectralKernels GENERIC_KERNELS = {
+    0, 0, nullptr, nullptr,
+    &genericLoadFrame, &genericOverlapAdd, &genericApplyBinGains, &genericAccumulateGateBands
+};
+
+// Indexed by log2(fftSize / 64), then overlap (2, 4, 8)
+const std::array<SpectralKernels, 3> FIXED_KERNELS[] = {
+    makeFixedKernelsAllOverlaps<64>(),
+    makeFixedKernelsAllOverlaps<128>(),
+    makeFixedKernelsAllOverlaps<256>(),
+    makeFixedKernelsAllOverlaps<512>(),
+    makeFixedKernelsAllOverlaps<1024>(),
+    makeFixedKernelsAllOverlaps<2048>()
+};
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Kernel Dispatch
+//--------------------------------------------------------------------------
+
+const SpectralKernels& getSpectralKernels(unsigned int fftSize, unsigned int overlapFactor)
+{
+    unsigned int sizeIndex = 0;
+    unsigned int size = 64;
+    const unsigned int numSizes = sizeof(FIXED_KERNELS) / sizeof(FIXED_KERNELS[0]);
+    while (size < fftSize && sizeIndex + 1 < numSizes)
+    {
+        size *= 2;
+        ++sizeIndex;
+    }
+    if (size != fftSize)
+    {
+        return GENERIC_KERNELS;
+    }
+
+    switch (overlapFactor)
+    {
+        case 2: return FIXED_KERNELS[sizeIndex][0];
+        case 4: return FIXED_KERNELS[sizeIndex][1];
+        case 8: return FIXED_KERNELS[sizeIndex][2];
+        default: return GENERIC_KERNELS;
+    }
+}
+
+const SpectralKernels& getGenericSpectralKernels()
+{
+    return GENERIC_KERNELS;
+}
+
+//--------------------------------------------------------------------------
+// Complex Vector Kernels
+//--------------------------------------------------------------------------
+
+void complexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm,
+                               const float* bRe, const float* bIm, std::size_t count)
+{
+    std::size_t i = 0;
+#ifdef MULTIAUDIO_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 ar = _mm_loadu_ps(aRe + i);
+        const __m128 ai = _mm_loadu_ps(aIm + i);
+        const __m128 br = _mm_loadu_ps(bRe + i);
+        const __m128 bi = _mm_loadu_ps(bIm + i);
+        const __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+        const __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+        _mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+        _mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void conjugateMultiplyAccumulate(float* wRe, float* wIm, const float* xRe, const float* xIm,
+                                 const float* gRe, const float* gIm, std::size_t count)
+{
+    std::size_t i = 0;
+#ifdef MULTIAUDIO_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 xr = _mm_loadu_ps(xRe + i);
+        const __m128 xi = _mm_loadu_ps(xIm + i);
+        const __m128 gr = _mm_loadu_ps(gRe + i);
+        const __m128 gi = _mm_loadu_ps(gIm + i);
+        const __m128 re = _mm_add_ps(_mm_mul_ps(xr, gr), _mm_mul_ps(xi, gi));
+        const __m128 im = _mm_sub_ps(_mm_mul_ps(xr, gi), _mm_mul_ps(xi, gr));
+        _mm_storeu_ps(wRe + i, _mm_add_ps(_mm_loadu_ps(wRe + i), re));
+        _mm_storeu_ps(wIm + i, _mm_add_ps(_mm_loadu_ps(wIm + i), im));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        wRe[i] += xRe[i] * gRe[i] + xIm[i] * gIm[i];
+        wIm[i] += xRe[i] * gIm[i] - xIm[i] * gRe[i];
+    }
+}
+
+} // namespace audio
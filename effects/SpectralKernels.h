@@ -0,0 +1,227 @@
+#ifndef SPECTRAL_KERNELS_H
+#define SPECTRAL_KERNELS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+
+#include "../common.h"
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Compile-Time Math
+//--------------------------------------------------------------------------
+
+/**
+ * Sine of x in [0, pi], usable in constant expressions.
+ * Folds into [0, pi/2] and sums the Taylor series to x^29, which is
+ * accurate to the last bit of a double there.
+ */
+constexpr double constexprSin(double x)
+{
+    constexpr double PI = 3.14159265358979323846;
+    if (x > PI / 2.0)
+    {
+        x = PI - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n <= 14; ++n)
+    {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Gets the noise gate band of an FFT bin.
+ *
+ * Bands split bins 1 .. fftSize/2 - 1 evenly on a log2 scale. The test
+ * bin^(NUM_BANDS-1) >= top^band is the integer form of
+ * (NUM_BANDS-1) * log2(bin) / log2(top) >= band, so the generic and
+ * compile-time maps agree exactly (exact for FFT sizes up to 2^21).
+ *
+ * @param bin Bin index (1 .. fftSize/2 - 1)
+ * @param fftSize FFT size
+ * @return Band index (0 .. NUM_BANDS-1)
+ */
+constexpr unsigned int gateBandOf(unsigned int bin, unsigned int fftSize)
+{
+    const std::uint64_t top = fftSize / 2 - 1;
+    std::uint64_t binPower = 1;
+    for (unsigned int i = 0; i + 1 < NUM_BANDS; ++i)
+    {
+        binPower *= bin;
+    }
+    unsigned int band = 0;
+    std::uint64_t topPower = 1;
+    for (unsigned int b = 1; b < NUM_BANDS; ++b)
+    {
+        topPower *= top;
+        if (binPower >= topPower)
+        {
+            band = b;
+        }
+    }
+    return band;
+}
+
+//--------------------------------------------------------------------------
+// Compile-Time Tables
+//--------------------------------------------------------------------------
+
+/**
+ * Square-root periodic Hann window, sqrt(0.5 * (1 - cos(2 pi i / N))),
+ * which is sin(pi i / N) on [0, N).
+ */
+template <unsigned int N>
+constexpr std::array<double, N> makeSqrtHann()
+{
+    constexpr double PI = 3.14159265358979323846;
+    std::array<double, N> table{};
+    for (unsigned int i = 0; i < N; ++i)
+    {
+        table[i] = constexprSin(PI * i / N);
+    }
+    return table;
+}
+
+/**
+ * STFT window tables for an FFT size and overlap factor, generated by the
+ * compiler. Same layout as StftWindow: the synthesis window carries the
+ * 1/N of the inverse FFT and the overlap gain.
+ */
+template <unsigned int N, unsigned int Factor>
+struct FixedStftWindow
+{
+    static constexpr std::array<double, N> analysis = makeSqrtHann<N>();
+
+    static constexpr std::array<double, N> makeSynthesis()
+    {
+        std::array<double, N> table{};
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            table[i] = analysis[i] * (2.0 / (static_cast<double>(N) * Factor));
+        }
+        return table;
+    }
+
+    static constexpr std::array<double, N> synthesis = makeSynthesis();
+};
+
+/**
+ * Noise gate band edges for an FFT size, generated by the compiler.
+ * Band b covers bins edges[b] .. edges[b+1] - 1.
+ */
+template <unsigned int N>
+struct FixedGateBands
+{
+    static constexpr std::array<unsigned int, NUM_BANDS + 1> makeEdges()
+    {
+        // Bands are contiguous: each starts at the first bin that maps to it or above
+        std::array<unsigned int, NUM_BANDS + 1> edges{};
+        edges[0] = 1;
+        for (unsigned int b = 1; b <= NUM_BANDS; ++b)
+        {
+            edges[b] = N / 2;
+            for (unsigned int bin = edges[b - 1]; bin < N / 2; ++bin)
+            {
+                if (gateBandOf(bin, N) >= b)
+                {
+                    edges[b] = bin;
+                    break;
+                }
+            }
+        }
+        return edges;
+    }
+
+    static constexpr std::array<unsigned int, NUM_BANDS + 1> edges = makeEdges();
+};
+
+//--------------------------------------------------------------------------
+// Kernel Dispatch
+//--------------------------------------------------------------------------
+
+/**
+ * The inner loops of the spectral effects for one FFT size and overlap.
+ *
+ * Supported sizes (64 .. 2048, powers of two, at every StftOverlap) get
+ * kernels instantiated for that size, with compile-time trip counts and
+ * compile-time window and band tables. Any other size gets the generic
+ * kernels, which take the size and windows at runtime. Both produce the
+ * same results.
+ */
+struct SpectralKernels
+{
+    unsigned int fftSize;               // 0 for the generic kernels
+    unsigned int overlapFactor;
+    const double* analysisWindow;       // compile-time tables, nullptr for the generic kernels
+    const double* synthesisWindow;
+
+    /**
+     * Gathers fftSize samples from a circular buffer, oldest first, applying
+     * the analysis window in the same pass.
+     */
+    void (*loadFrame)(double* frame, const double* ring, unsigned int oldest,
+                      const double* analysis, unsigned int fftSize);
+
+    /**
+     * Windows a frame and adds it into a 2 * fftSize overlap-add ring at position.
+     */
+    void (*overlapAdd)(double* ring, const double* frame, unsigned int position,
+                       const double* synthesis, unsigned int fftSize);
+
+    /**
+     * Scales each bin of a spectrum by a per-bin gain.
+     */
+    void (*applyBinGains)(fftw_complex* bins, const double* gains, unsigned int numBins);
+
+    /**
+     * Sums bin energies into the NUM_BANDS noise gate bands (adds to energies).
+     */
+    void (*accumulateGateBands)(const fftw_complex* bins, double* energies, unsigned int fftSize);
+
+    bool isSpecialized() const { return fftSize != 0; }
+};
+
+/**
+ * Selects the kernels for an FFT size and overlap.
+ * @param fftSize FFT size
+ * @param overlapFactor Frames covering each sample (fftSize / hop)
+ * @return Specialised kernels when the size has them, else the generic ones
+ */
+const SpectralKernels& getSpectralKernels(unsigned int fftSize, unsigned int overlapFactor);
+
+/**
+ * Gets the generic kernels, which handle any size.
+ */
+const SpectralKernels& getGenericSpectralKernels();
+
+//--------------------------------------------------------------------------
+// Complex Vector Kernels
+//--------------------------------------------------------------------------
+
+/**
+ * Adds the bin-wise products a * b to acc, on split real/imaginary arrays
+ * (the filtering step of a frequency-domain adaptive filter).
+ * Four bins per SSE operation on x86-64, where SSE2 is the baseline;
+ * scalar elsewhere. Arrays need no particular alignment.
+ */
+void complexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm,
+                               const float* bRe, const float* bIm, std::size_t count);
+
+/**
+ * Adds conj(x) * g to w bin-wise, on split real/imaginary arrays (the
+ * frequency-domain LMS weight update). Vectorised like
+ * complexMultiplyAccumulate().
+ */
+void conjugateMultiplyAccumulate(float* wRe, float* wIm, const float* xRe, const float* xIm,
+                                 const float* gRe, const float* gIm, std::size_t count);
+
+} // namespace audio
+
+#endif // SPECTRAL_KERNELS_H
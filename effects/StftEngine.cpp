@@ -0,0 +1,308 @@
+#include "StftEngine.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Window Tables
+//--------------------------------------------------------------------------
+
+std::shared_ptr<const StftWindow> getStftWindow(unsigned int fftSize, StftOverlap overlap)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::pair<unsigned int, unsigned int>, std::shared_ptr<const StftWindow>> cache;
+
+    const unsigned int factor = static_cast<unsigned int>(overlap);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::shared_ptr<const StftWindow>& entry = cache[std::make_pair(fftSize, factor)];
+    if (!entry)
+    {
+        std::shared_ptr<StftWindow> tables = std::make_shared<StftWindow>();
+        const SpectralKernels& kernels = getSpectralKernels(fftSize, factor);
+        if (kernels.isSpecialized())
+        {
+            // Generated by the compiler; the specialised kernels read the same tables
+            tables->analysis.assign(kernels.analysisWindow, kernels.analysisWindow + fftSize);
+            tables->synthesis.assign(kernels.synthesisWindow, kernels.synthesisWindow + fftSize);
+        }
+        else
+        {
+            // Periodic Hann overlapped at fftSize / factor sums to factor / 2
+            const double synthesisScale = 2.0 / (static_cast<double>(fftSize) * factor);
+            tables->analysis.resize(fftSize);
+            tables->synthesis.resize(fftSize);
+            for (unsigned int i = 0; i < fftSize; ++i)
+            {
+                const double hann = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / fftSize));
+                tables->analysis[i] = std::sqrt(hann);
+                tables->synthesis[i] = std::sqrt(hann) * synthesisScale;
+            }
+        }
+        for (double value : tables->analysis)
+        {
+            tables->analysisPower += value * value;
+        }
+
+        // An unmodified frame adds analysis * synthesis * fftSize of each sample;
+        // sample j of a frame is also covered by the frames j / hop hops later
+        const unsigned int hop = fftSize / factor;
+        tables->identityRamp.assign(fftSize, 0.0);
+        for (unsigned int j = 0; j < fftSize && hop > 0; ++j)
+        {
+            for (unsigned int i = j % hop; i <= j; i += hop)
+            {
+                tables->identityRamp[j] += tables->analysis[i] * tables->synthesis[i] * fftSize;
+            }
+        }
+        entry = tables;
+    }
+    return entry;
+}
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+StftEngine::StftEngine(unsigned int size, StftOverlap overlap, bool synthesis)
+    : fftSize(size),
+      hopSize(size / static_cast<unsigned int>(overlap)),
+      synthesisEnabled(synthesis),
+      kernels(&getSpectralKernels(size, static_cast<unsigned int>(overlap))),
+      forwardPlan(nullptr),
+      inversePlan(nullptr),
+      timeData(nullptr),
+      spectrum(nullptr),
+      hopAligned(false)
+{
+    if (hopSize == 0 || fftSize % static_cast<unsigned int>(overlap) != 0)
+    {
+        // Size does not divide into hops: leave the engine invalid
+        hopSize = std::max(hopSize, 1u);
+        reset();
+        return;
+    }
+
+    window = getStftWindow(fftSize, overlap);
+    inputRing.resize(fftSize);
+    if (synthesisEnabled)
+    {
+        outputRing.resize(static_cast<std::size_t>(fftSize) * 2);
+    }
+
+    timeData = fftw_alloc_real(fftSize);
+    spectrum = fftw_alloc_complex(fftSize / 2 + 1);
+    if (timeData && spectrum)
+    {
+        forwardPlan = fftw_plan_dft_r2c_1d(fftSize, timeData, spectrum, FFTW_ESTIMATE);
+        if (synthesisEnabled)
+        {
+            inversePlan = fftw_plan_dft_c2r_1d(fftSize, spectrum, timeData, FFTW_ESTIMATE);
+            if (!inversePlan && forwardPlan)
+            {
+                fftw_destroy_plan(forwardPlan);
+                forwardPlan = nullptr;
+            }
+        }
+    }
+    reset();
+}
+
+StftEngine::~StftEngine()
+{
+    if (forwardPlan) fftw_destroy_plan(forwardPlan);
+    if (inversePlan) fftw_destroy_plan(inversePlan);
+    if (timeData) fftw_free(timeData);
+    if (spectrum) fftw_free(spectrum);
+}
+
+void StftEngine::reset()
+{
+    std::fill(inputRing.begin(), inputRing.end(), 0.0);
+    std::fill(outputRing.begin(), outputRing.end(), 0.0);
+    inputPos = 0;
+    hopFill = 0;
+
+    // Ring indices are times modulo 2 * fftSize: the first frame ends at time
+    // hop and starts at hop - fftSize; output starts at -latency. A block that
+    // may end up to hop - 1 samples past the last frame needs those covered
+    latency = hopAligned ? fftSize - hopSize : fftSize - 1;
+    synthesisPos = fftSize;
+    outputPos = fftSize * 2 - latency;
+    delayOnly = false;
+
+    // Both rings are clear: as if silence had been running forever
+    silentRun = std::numeric_limits<std::size_t>::max() / 2;
+}
+
+void StftEngine::prepare(std::size_t periodFrames)
+{
+    const bool aligned = periodFrames > 0 && periodFrames % hopSize == 0;
+    if (aligned != hopAligned)
+    {
+        hopAligned = aligned;
+        reset();
+    }
+}
+
+//--------------------------------------------------------------------------
+// Streaming
+//--------------------------------------------------------------------------
+
+bool StftEngine::pushInput(const float* input, std::size_t numFrames)
+{
+    if (delayOnly)
+    {
+        // The output ring is indexed by input time, so input lands where it is read latency samples later
+        const std::size_t ringSize = outputRing.size();
+        const std::size_t start = (synthesisPos + fftSize + hopFill) % ringSize;
+        const std::size_t delayRun = std::min(numFrames, ringSize - start);
+        for (std::size_t i = 0; i < delayRun; ++i)
+        {
+            outputRing[start + i] = static_cast<double>(input[i]);
+        }
+        for (std::size_t i = delayRun; i < numFrames; ++i)
+        {
+            outputRing[i - delayRun] = static_cast<double>(input[i]);
+        }
+    }
+
+    const std::size_t firstRun = std::min<std::size_t>(numFrames, fftSize - inputPos);
+    for (std::size_t i = 0; i < firstRun; ++i)
+    {
+        inputRing[inputPos + i] = static_cast<double>(input[i]);
+    }
+    for (std::size_t i = firstRun; i < numFrames; ++i)
+    {
+        inputRing[i - firstRun] = static_cast<double>(input[i]);
+    }
+    silentRun = 0;
+    return advanceInput(numFrames);
+}
+
+bool StftEngine::pushSilence(std::size_t numFrames)
+{
+    if (!isFrameSilent())
+    {
+        // Ring still holds signal: overwrite the oldest samples with zeros
+        const std::size_t firstRun = std::min<std::size_t>(numFrames, fftSize - inputPos);
+        std::fill_n(inputRing.begin() + inputPos, firstRun, 0.0);
+        std::fill_n(inputRing.begin(), numFrames - firstRun, 0.0);
+    }
+    // Delay only: the output ring is already clear where silence would land
+    silentRun += numFrames;
+    return advanceInput(numFrames);
+}
+
+bool StftEngine::advanceInput(std::size_t numFrames)
+{
+    inputPos = static_cast<unsigned int>((inputPos + numFrames) % fftSize);
+
+    hopFill += static_cast<unsigned int>(numFrames);
+    if (hopFill < hopSize)
+    {
+        return false;
+    }
+    hopFill = 0;
+    synthesisPos = (synthesisPos + hopSize) % static_cast<unsigned int>(fftSize * 2);
+    return true;
+}
+
+bool StftEngine::beginFrame(bool identity)
+{
+    if (!synthesisEnabled || !isValid())
+    {
+        return true;
+    }
+    if (identity != delayOnly)
+    {
+        addIdentityFrames(identity ? 1.0 : -1.0);
+        delayOnly = identity;
+    }
+    return !delayOnly;
+}
+
+void StftEngine::addIdentityFrames(double sign)
+{
+    // At a hop boundary the frame just completed starts at synthesisPos in the
+    // output ring and at inputPos in the input ring
+    const double* ramp = window->identityRamp.data();
+    const unsigned int ringSize = fftSize * 2;
+    for (unsigned int j = 0; j < fftSize; ++j)
+    {
+        outputRing[(synthesisPos + j) % ringSize] += sign * ramp[j] * inputRing[(inputPos + j) % fftSize];
+    }
+}
+
+void StftEngine::popOutput(float* output, std::size_t numFrames)
+{
+    if (!synthesisEnabled)
+    {
+        return;
+    }
+    if (hopAligned && hopFill != 0)
+    {
+        // Block ended mid-hop despite prepare(): the last hop - 1 samples are not
+        // summed yet, so fall back to the latency that works for any block size
+        hopAligned = false;
+        latency = fftSize - 1;
+        outputPos = (outputPos + fftSize * 2 - (hopSize - 1)) % (fftSize * 2);
+    }
+
+    const std::size_t ringSize = outputRing.size();
+    if (silentRun >= numFrames + fftSize + latency)
+    {
+        // Every frame reaching these samples was silent: the ring is already clear there
+        std::fill_n(output, numFrames, 0.0f);
+        outputPos = static_cast<unsigned int>((outputPos + numFrames) % ringSize);
+        return;
+    }
+
+    const std::size_t firstRun = std::min<std::size_t>(numFrames, ringSize - outputPos);
+    double* ring = outputRing.data();
+    for (std::size_t i = 0; i < firstRun; ++i)
+    {
+        output[i] = static_cast<float>(ring[outputPos + i]);
+        ring[outputPos + i] = 0.0;
+    }
+    for (std::size_t i = firstRun; i < numFrames; ++i)
+    {
+        output[i] = static_cast<float>(ring[i - firstRun]);
+        ring[i - firstRun] = 0.0;
+    }
+    outputPos = static_cast<unsigned int>((outputPos + numFrames) % ringSize);
+}
+
+//--------------------------------------------------------------------------
+// Frame Steps
+//--------------------------------------------------------------------------
+
+void StftEngine::loadFrame()
+{
+    kernels->loadFrame(timeData, inputRing.data(), inputPos, window->analysis.data(), fftSize);
+}
+
+void StftEngine::forward()
+{
+    fftw_execute(forwardPlan);
+}
+
+void StftEngine::inverse()
+{
+    fftw_execute(inversePlan);
+}
+
+void StftEngine::overlapAdd()
+{
+    kernels->overlapAdd(outputRing.data(), timeData, synthesisPos, window->synthesis.data(), fftSize);
+}
+
+} // namespace audio
@@ -0,0 +1,358 @@
+#ifndef STFT_ENGINE_H
+#define STFT_ENGINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <fftw3.h>
+
+#include "SpectralKernels.h"
+
+namespace audio {
+
+/**
+ * Overlap between successive STFT frames.
+ * The value is the number of frames covering each sample (fftSize / hop).
+ */
+enum class StftOverlap : unsigned int
+{
+    Half = 2,           // 50%, hop = fftSize / 2
+    ThreeQuarters = 4,  // 75%, hop = fftSize / 4
+    SevenEighths = 8    // 87.5%, hop = fftSize / 8
+};
+
+//--------------------------------------------------------------------------
+// Window Tables
+//--------------------------------------------------------------------------
+
+/**
+ * Analysis and synthesis windows for one FFT size and overlap.
+ *
+ * Both are square-root periodic Hann windows, so their product overlaps
+ * to a constant. The synthesis window also carries the 1/fftSize of the
+ * unnormalised inverse FFT and the overlap gain, so overlap-add needs no
+ * separate scaling pass.
+ */
+struct StftWindow
+{
+    std::vector<double> analysis;
+    std::vector<double> synthesis;
+    double analysisPower = 0.0;     // sum of analysis[i]^2, to calibrate spectral energies
+    std::vector<double> identityRamp;   // share of an unmodified signal at each sample of a frame
+                                        // that comes from that frame and the ones after it
+};
+
+/**
+ * Gets the shared window tables for an FFT size and overlap.
+ * Tables are built on first use and shared by every engine with the same
+ * format; sizes with specialised kernels copy the compiler-generated
+ * tables. Locks; call off the audio thread.
+ */
+std::shared_ptr<const StftWindow> getStftWindow(unsigned int fftSize, StftOverlap overlap);
+
+//--------------------------------------------------------------------------
+// STFT Engine
+//--------------------------------------------------------------------------
+
+/**
+ * Streaming short-time Fourier transform analysis and resynthesis.
+ *
+ * Input is written into a circular buffer indexed by time, so no samples
+ * are ever shifted: each frame is gathered from the ring in two runs,
+ * windowed in the same pass, and written straight into the FFT input.
+ * Resynthesis windows the inverse FFT and adds it into a circular
+ * overlap-add accumulator in one pass, and output is read from it (and
+ * cleared) as input arrives.
+ *
+ * The hop is independent of the host block: process() accepts any number
+ * of frames and runs one STFT frame at every hop boundary in between.
+ * The latency is chosen once, in prepare(), from the period the host
+ * declares: fftSize - hop when every period is a whole number of hops,
+ * fftSize - 1 (covers a block ending anywhere in a hop) when periods vary
+ * or end mid-hop. A block that breaks a whole-hop declaration switches
+ * the engine for good to fftSize - 1, at the cost of hop - 1 samples of
+ * silence at the switch.
+ *
+ * Frame loops run through the SpectralKernels for the size and overlap,
+ * specialised at compile time for power-of-two sizes 64 .. 2048.
+ *
+ * While a frame's modification would leave the spectrum unchanged, the
+ * engine can skip the frame and copy input straight into the output ring
+ * instead (delay only, see beginFrame()), at the same latency.
+ */
+class StftEngine
+{
+private:
+    //--------------------------------------------------------------------------
+    // Configuration
+    //--------------------------------------------------------------------------
+    unsigned int fftSize;
+    unsigned int hopSize;
+    bool synthesisEnabled;
+    std::shared_ptr<const StftWindow> window;
+    const SpectralKernels* kernels;
+
+    //--------------------------------------------------------------------------
+    // FFTW Resources
+    //--------------------------------------------------------------------------
+    fftw_plan forwardPlan;
+    fftw_plan inversePlan;
+    double* timeData;
+    fftw_complex* spectrum;
+
+    //--------------------------------------------------------------------------
+    // Circular Buffers
+    //--------------------------------------------------------------------------
+    std::vector<double> inputRing;      // fftSize samples; inputPos is the oldest
+    std::vector<double> outputRing;     // 2 * fftSize; overlap-add accumulator
+    unsigned int inputPos;
+    unsigned int hopFill;               // samples written since the last frame
+    unsigned int synthesisPos;          // ring index of the next frame's first sample
+    unsigned int outputPos;             // ring index of the next sample to output
+    unsigned int latency;
+    bool hopAligned;                    // every block is a whole number of hops (see prepare())
+    std::size_t silentRun;              // samples since input last came through pushInput()
+    bool delayOnly;                     // frames skipped; input copied into the output ring
+
+    //--------------------------------------------------------------------------
+    // Private Methods
+    //--------------------------------------------------------------------------
+    /**
+     * Advances the input position and hop count past samples just written.
+     * @return true when a hop is complete
+     */
+    bool advanceInput(std::size_t numFrames);
+
+    /**
+     * Adds (sign 1) or removes (sign -1) what unmodified frames from the one
+     * just completed onwards would add to the output for the input ring.
+     */
+    void addIdentityFrames(double sign);
+
+public:
+    //--------------------------------------------------------------------------
+    // Lifecycle
+    //--------------------------------------------------------------------------
+    /**
+     * Plans the FFTs and allocates the buffers for one format.
+     *
+     * @param size FFT size (a multiple of the overlap factor)
+     * @param overlap Overlap between frames
+     * @param synthesis false for analysis only (no inverse FFT or output)
+     */
+    StftEngine(unsigned int size, StftOverlap overlap = StftOverlap::Half, bool synthesis = true);
+
+    /**
+     * Cleans up FFTW resources.
+     */
+    ~StftEngine();
+
+    StftEngine(const StftEngine&) = delete;
+    StftEngine& operator=(const StftEngine&) = delete;
+
+    /**
+     * Checks that the FFTs were planned and the size fits the overlap.
+     */
+    bool isValid() const { return forwardPlan != nullptr; }
+
+    /**
+     * Chooses the latency for the period the host delivers and clears the
+     * buffers if it changes. Engines start with periods that vary.
+     * @param periodFrames Frames in every block, or 0 if blocks vary in size
+     */
+    void prepare(std::size_t periodFrames);
+
+    /**
+     * Clears the buffers; the latency stays as prepared.
+     */
+    void reset();
+
+    //--------------------------------------------------------------------------
+    // Streaming
+    //--------------------------------------------------------------------------
+    /**
+     * Runs a block through analysis, a spectral modification and resynthesis.
+     *
+     * @param input Source samples (numFrames)
+     * @param output Destination, delayed by getLatency() (may alias input)
+     * @param numFrames Number of samples, any size
+     * @param modify Called as modify(spectrum, numBins) once per frame
+     * @param identity true if modify leaves the spectrum unchanged (run delay only)
+     */
+    template <typename SpectrumFunction>
+    void process(const float* input, float* output, std::size_t numFrames, SpectrumFunction&& modify,
+                 bool identity = false)
+    {
+        while (numFrames > 0)
+        {
+            const std::size_t chunk = std::min<std::size_t>(numFrames, getHopRemaining());
+            if (pushInput(input, chunk) && beginFrame(identity))
+            {
+                analyze();
+                modify(spectrum, getNumBins());
+                synthesize();
+            }
+            popOutput(output, chunk);
+            input += chunk;
+            output += chunk;
+            numFrames -= chunk;
+        }
+    }
+
+    /**
+     * Runs a block of silent input (all zeros) through the engine.
+     *
+     * Output is exactly what process() would give for zeros, but zeros are
+     * only written into the input ring until it is clear, frames are only
+     * transformed while they still hold signal, and once the overlap-add
+     * tail has drained the output is a plain fill.
+     * modify must map a zero spectrum to zero (any per-bin gain does).
+     *
+     * @param output Destination, delayed by getLatency()
+     * @param numFrames Number of samples, any size
+     * @param modify Called as modify(spectrum, numBins) for frames that still hold signal
+     * @param identity true if modify leaves the spectrum unchanged (run delay only)
+     * @return true if the whole output block is silent
+     */
+    template <typename SpectrumFunction>
+    bool processSilence(float* output, std::size_t numFrames, SpectrumFunction&& modify, bool identity = false)
+    {
+        const bool drained = isDrained();
+        while (numFrames > 0)
+        {
+            const std::size_t chunk = std::min<std::size_t>(numFrames, getHopRemaining());
+            if (pushSilence(chunk) && beginFrame(identity) && !isFrameSilent())
+            {
+                analyze();
+                modify(spectrum, getNumBins());
+                synthesize();
+            }
+            popOutput(output, chunk);
+            output += chunk;
+            numFrames -= chunk;
+        }
+        return drained;
+    }
+
+    /**
+     * Gets the samples still needed to complete the current hop.
+     */
+    std::size_t getHopRemaining() const { return hopSize - hopFill; }
+
+    /**
+     * Writes input into the ring.
+     * @param input Source samples
+     * @param numFrames Number of samples, at most getHopRemaining()
+     * @return true when a hop is complete and a frame should be analysed
+     */
+    bool pushInput(const float* input, std::size_t numFrames);
+
+    /**
+     * Advances the input by silent samples; writes zeros only until the ring is clear.
+     * @param numFrames Number of samples, at most getHopRemaining()
+     * @return true when a hop is complete
+     */
+    bool pushSilence(std::size_t numFrames);
+
+    /**
+     * Chooses how the hop just completed is resynthesised.
+     *
+     * While the modification is the identity the frame is skipped and
+     * input is copied into the output ring, delayed by getLatency() as
+     * before (delay only). Switching either way adds or removes the share
+     * of the pending output that unmodified frames would have contributed,
+     * so the output crossfades through the synthesis window exactly as if
+     * every frame had run.
+     *
+     * @param identity true if this frame's modification leaves the spectrum unchanged
+     * @return true if the frame should be processed
+     */
+    bool beginFrame(bool identity);
+
+    /**
+     * Checks whether frames are being skipped for the delay-only path.
+     */
+    bool isDelayOnly() const { return delayOnly; }
+
+    /**
+     * Checks whether the newest fftSize input samples are all silence
+     * pushed with pushSilence(), so the frame would transform to zero.
+     */
+    bool isFrameSilent() const { return silentRun >= fftSize; }
+
+    /**
+     * Checks whether every frame holding signal has been output, so
+     * further silent input gives silent output.
+     */
+    bool isDrained() const { return silentRun >= static_cast<std::size_t>(fftSize) + latency; }
+
+    /**
+     * Reads output from the overlap-add accumulator and clears what was read.
+     * Call after pushInput() (and the frame, if one completed) for the same samples.
+     * @param output Destination samples
+     * @param numFrames Number of samples passed to the matching pushInput()
+     */
+    void popOutput(float* output, std::size_t numFrames);
+
+    //--------------------------------------------------------------------------
+    // Frame Steps
+    //--------------------------------------------------------------------------
+    /**
+     * Gathers the newest fftSize samples from the ring into the FFT input,
+     * applying the analysis window in the same pass.
+     */
+    void loadFrame();
+
+    /**
+     * Forward FFT of the loaded frame into getSpectrum().
+     */
+    void forward();
+
+    /**
+     * Inverse FFT of getSpectrum() back into the frame.
+     */
+    void inverse();
+
+    /**
+     * Applies the synthesis window (with normalisation) and adds the frame
+     * into the output accumulator in one pass.
+     */
+    void overlapAdd();
+
+    /**
+     * loadFrame() and forward().
+     */
+    void analyze() { loadFrame(); forward(); }
+
+    /**
+     * inverse() and overlapAdd().
+     */
+    void synthesize() { inverse(); overlapAdd(); }
+
+    //--------------------------------------------------------------------------
+    // Accessors
+    //--------------------------------------------------------------------------
+    fftw_complex* getSpectrum() { return spectrum; }
+    const fftw_complex* getSpectrum() const { return spectrum; }
+    unsigned int getNumBins() const { return fftSize / 2 + 1; }
+    unsigned int getFftSize() const { return fftSize; }
+    unsigned int getHopSize() const { return hopSize; }
+    const SpectralKernels& getKernels() const { return *kernels; }
+
+    /**
+     * Gets the delay from input to output in samples.
+     */
+    unsigned int getLatency() const { return latency; }
+
+    /**
+     * Gets the sum of the squared analysis window. Dividing a windowed
+     * frame's spectral energy by this calibrates it the way dividing by
+     * fftSize does for an unwindowed frame.
+     */
+    double getAnalysisPower() const { return window ? window->analysisPower : 0.0; }
+};
+
+} // namespace audio
+
+#endif // STFT_ENGINE_H
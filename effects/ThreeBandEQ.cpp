@@ -1,8 +1,6 @@
 #include "ThreeBandEQ.h"
+#include "../audio/Profiler.h"
 
-#include <iostream>
-#include <cstring>
-#include <stdexcept>
 #include <algorithm>
 #include <cmath>
 
@@ -16,22 +14,12 @@ namespace audio {
 // Lifecycle
 //--------------------------------------------------------------------------
 
-ThreeBandEQ::ThreeBandEQ(unsigned int rate, unsigned int frameSize)
+ThreeBandEQ::ThreeBandEQ(unsigned int rate, unsigned int frameSize, StftOverlap overlap)
     : AudioEffect(rate),
-      hopSize(frameSize),
-      fftSize(frameSize * 2),
-      timeData(nullptr),
-      frequencyData(nullptr),
-      fftForwardPlan(nullptr),
-      fftInversePlan(nullptr)
+      stft(frameSize * 2, overlap),
+      passThrough(false),
+      binGains(stft.getNumBins(), 1.0)
 {
-    if (hopSize == 0)
-    {
-        // Invalid hop size, disable effect
-        effectActive.store(false);
-        return;
-    }
-
     // Initialize default band cutoffs and gains
     const float DEFAULT_LOW_MID_CUTOFF = 250.0f;
     const float DEFAULT_MID_HIGH_CUTOFF = 4000.0f;
@@ -44,87 +32,22 @@ ThreeBandEQ::ThreeBandEQ(unsigned int rate, unsigned int frameSize)
     for (unsigned int i = 0; i < NUM_EQ_BANDS; ++i)
     {
         setBandGain(i, 1.0f);
+        curveCutoffs[i] = 0.0f;     // no curve yet: built on the first frame
+        curveGains[i] = 0.0f;
     }
 
-    bool setupOk = true;
-
-    // Allocate FFTW resources
-    try
+    if (!stft.isValid())
     {
-        timeData = fftw_alloc_real(fftSize);
-        frequencyData = fftw_alloc_complex(fftSize / 2 + 1);
-
-        if (!timeData || !frequencyData)
-        {
-            setupOk = false;
-        }
-        else
-        {
-            fftForwardPlan = fftw_plan_dft_r2c_1d(fftSize, timeData, frequencyData, FFTW_ESTIMATE);
-            fftInversePlan = fftw_plan_dft_c2r_1d(fftSize, frequencyData, timeData, FFTW_ESTIMATE);
-
-            if (!fftForwardPlan || !fftInversePlan)
-            {
-                setupOk = false;
-            }
-        }
-
-        if (setupOk)
-        {
-            // Initialize buffers
-            window.resize(fftSize);
-            inputBufferInternal.resize(fftSize, 0.0);
-            outputOverlapBuffer.resize(fftSize - hopSize, 0.0);
-            calculateWindow();
-        }
-    }
-    catch (...)
-    {
-        setupOk = false;
-    }
-
-    if (!setupOk)
-    {
-        // Cleanup on failure
+        // FFT setup failed or the frame size is zero: disable effect
         effectActive.store(false);
-        if (fftForwardPlan) fftw_destroy_plan(fftForwardPlan);
-        if (fftInversePlan) fftw_destroy_plan(fftInversePlan);
-        if (timeData) fftw_free(timeData);
-        if (frequencyData) fftw_free(frequencyData);
-    }
-    else
-    {
-        reset();
     }
-}
-
-ThreeBandEQ::~ThreeBandEQ()
-{
-    // Free FFTW resources
-    if (fftForwardPlan) fftw_destroy_plan(fftForwardPlan);
-    if (fftInversePlan) fftw_destroy_plan(fftInversePlan);
-    if (timeData) fftw_free(timeData);
-    if (frequencyData) fftw_free(frequencyData);
+    stft.prepare(frameSize);
 }
 
 //--------------------------------------------------------------------------
 // Private Methods
 //--------------------------------------------------------------------------
 
-void ThreeBandEQ::calculateWindow()
-{
-    if (window.size() != fftSize)
-    {
-        window.resize(fftSize);
-    }
-
-    // Generate Hann window
-    for (std::size_t i = 0; i < fftSize; ++i)
-    {
-        window[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / (fftSize - 1)));
-    }
-}
-
 float ThreeBandEQ::getSmoothGain(float frequency)
 {
     // Define transition regions around band cutoffs
@@ -162,38 +85,54 @@ float ThreeBandEQ::getSmoothGain(float frequency)
     }
 }
 
-void ThreeBandEQ::applyEQGain()
+void ThreeBandEQ::processFrame()
 {
-    if (!frequencyData) return;
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQWindow);
+        stft.loadFrame();
+    }
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQForwardFFT);
+        stft.forward();
+    }
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQGain);
+        applyEQGain();
+    }
+    {
+        MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQInverseFFT);
+        stft.inverse();
+    }
+    MULTIAUDIO_PROFILE_SCOPE(ProfileStage::EQOverlapAdd);
+    stft.overlapAdd();
+}
 
-    // Apply gain to DC bin
-    frequencyData[0][0] *= bandGains[0];
-    frequencyData[0][1] *= bandGains[0];
+void ThreeBandEQ::updateBinGains()
+{
+    if (std::equal(bandGains, bandGains + NUM_EQ_BANDS, curveGains) &&
+        std::equal(bandCutoffs, bandCutoffs + NUM_EQ_BANDS, curveCutoffs))
+    {
+        return;
+    }
+    std::copy(bandGains, bandGains + NUM_EQ_BANDS, curveGains);
+    std::copy(bandCutoffs, bandCutoffs + NUM_EQ_BANDS, curveCutoffs);
 
-    // Apply gain to other bins with phase preservation
+    // DC and Nyquist take the outer band gains; bins between follow the smoothed curve
+    const unsigned int fftSize = stft.getFftSize();
+    binGains[0] = bandGains[0];
     for (unsigned int i = 1; i < fftSize / 2; ++i)
     {
         float frequency = static_cast<float>(i) * sampleRate / fftSize;
-        float gain = getSmoothGain(frequency);
-
-        double real = frequencyData[i][0];
-        double imag = frequencyData[i][1];
-        double magnitude = std::sqrt(real * real + imag * imag);
-        double phase = std::atan2(imag, real);
-
-        magnitude *= gain;
-
-        frequencyData[i][0] = magnitude * std::cos(phase);
-        frequencyData[i][1] = magnitude * std::sin(phase);
+        binGains[i] = getSmoothGain(frequency);
     }
+    binGains[fftSize / 2] = bandGains[2];
+}
 
-    // Apply gain to Nyquist bin
-    unsigned int nyquist_bin = fftSize / 2;
-    if (nyquist_bin < fftSize)
-    {
-        frequencyData[nyquist_bin][0] *= bandGains[2];
-        frequencyData[nyquist_bin][1] *= bandGains[2];
-    }
+void ThreeBandEQ::applyEQGain()
+{
+    // Scaling real and imaginary parts alike scales the magnitude and keeps the phase
+    updateBinGains();
+    stft.getKernels().applyBinGains(stft.getSpectrum(), binGains.data(), stft.getNumBins());
 }
 
 //--------------------------------------------------------------------------
@@ -202,9 +141,17 @@ void ThreeBandEQ::applyEQGain()
 
 void ThreeBandEQ::process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames)
 {
+    process(inputBuffer, outputBuffer, numFrames, BlockEvents());
+}
+
+void ThreeBandEQ::process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames,
+                          const BlockEvents& events)
+{
+    auto apply = [this](const ParameterEvent& event) { applyParameter(event); };
     if (!effectActive.load() || numFrames == 0)
     {
         // Effect bypass or invalid input
+        events.applyBefore(0, static_cast<std::size_t>(-1), apply);
         if (numFrames > 0 && inputBuffer && outputBuffer)
         {
             std::copy(inputBuffer, inputBuffer + numFrames, outputBuffer);
@@ -216,88 +163,103 @@ void ThreeBandEQ::process(const float* inputBuffer, float* outputBuffer, std::si
         return;
     }
 
-    if (numFrames != hopSize)
-    {
-        // Incorrect block size
-        if (outputBuffer) std::fill_n(outputBuffer, numFrames, 0.0f);
-        return;
-    }
-
-    if (!fftForwardPlan || !fftInversePlan || !timeData || !frequencyData ||
-        inputBufferInternal.size() != fftSize || outputOverlapBuffer.size() != (fftSize - hopSize) ||
-        window.size() != fftSize || !inputBuffer || !outputBuffer)
+    if (!stft.isValid() || !inputBuffer || !outputBuffer)
     {
         // Resource validation failed
+        events.applyBefore(0, static_cast<std::size_t>(-1), apply);
         if (outputBuffer) std::fill_n(outputBuffer, numFrames, 0.0f);
         return;
     }
 
-    // Shift previous input for overlap
-    std::memmove(inputBufferInternal.data(), inputBufferInternal.data() + hopSize,
-                 (fftSize - hopSize) * sizeof(double));
-
-    // Copy new input
-    for (std::size_t i = 0; i < hopSize; ++i)
+    // One STFT frame per completed hop, wherever it falls in the block; events
+    // up to a frame's last sample take effect in that frame
+    std::size_t next = 0;
+    for (std::size_t offset = 0; offset < numFrames;)
     {
-        inputBufferInternal[fftSize - hopSize + i] = static_cast<double>(inputBuffer[i]);
-    }
-
-    // Copy to FFT input buffer
-    std::memcpy(timeData, inputBufferInternal.data(), fftSize * sizeof(double));
-
-    // Apply window function
-    for (std::size_t i = 0; i < fftSize; ++i)
-    {
-        timeData[i] *= window[i];
+        const std::size_t chunk = std::min(numFrames - offset, stft.getHopRemaining());
+        if (stft.pushInput(inputBuffer + offset, chunk))
+        {
+            next = events.applyBefore(next, offset + chunk, apply);
+            if (stft.beginFrame(passThrough || isIdentity()))
+            {
+                processFrame();
+            }
+        }
+        stft.popOutput(outputBuffer + offset, chunk);
+        offset += chunk;
     }
+    events.applyBefore(next, static_cast<std::size_t>(-1), apply);
+}
 
-    // Forward FFT
-    fftw_execute(fftForwardPlan);
-
-    // EQ gain application
-    applyEQGain();
-
-    // Inverse FFT
-    fftw_execute(fftInversePlan);
+bool ThreeBandEQ::processSilence(float* outputBuffer, std::size_t numFrames)
+{
+    return processSilence(outputBuffer, numFrames, BlockEvents());
+}
 
-    // Overlap-add output
-    for (std::size_t i = 0; i < fftSize - hopSize; ++i)
+bool ThreeBandEQ::processSilence(float* outputBuffer, std::size_t numFrames, const BlockEvents& events)
+{
+    auto apply = [this](const ParameterEvent& event) { applyParameter(event); };
+    if (!effectActive.load() || !stft.isValid())
     {
-        outputOverlapBuffer[i] += timeData[i] / fftSize;
+        events.applyBefore(0, static_cast<std::size_t>(-1), apply);
+        std::fill_n(outputBuffer, numFrames, 0.0f);
+        if (!effectActive.load())
+        {
+            reset();
+        }
+        return true;
     }
 
-    for (std::size_t i = 0; i < hopSize; ++i)
+    // Frames run only while the overlap buffers still hold signal
+    const bool drained = stft.isDrained();
+    std::size_t next = 0;
+    for (std::size_t offset = 0; offset < numFrames;)
     {
-        outputBuffer[i] = static_cast<float>(outputOverlapBuffer[i]);
+        const std::size_t chunk = std::min(numFrames - offset, stft.getHopRemaining());
+        if (stft.pushSilence(chunk))
+        {
+            next = events.applyBefore(next, offset + chunk, apply);
+            if (stft.beginFrame(passThrough || isIdentity()) && !stft.isFrameSilent())
+            {
+                processFrame();
+            }
+        }
+        stft.popOutput(outputBuffer + offset, chunk);
+        offset += chunk;
     }
+    events.applyBefore(next, static_cast<std::size_t>(-1), apply);
+    return drained;
+}
 
-    // Shift overlap buffer
-    std::memmove(outputOverlapBuffer.data(), outputOverlapBuffer.data() + hopSize,
-                 (fftSize - hopSize - hopSize) * sizeof(double));
-
-    // Fill new overlap portion
-    for (std::size_t i = 0; i < hopSize; ++i)
-    {
-        outputOverlapBuffer[fftSize - hopSize - hopSize + i] = timeData[fftSize - hopSize + i] / fftSize;
-    }
+void ThreeBandEQ::prepare(std::size_t periodFrames)
+{
+    stft.prepare(periodFrames);
 }
 
 void ThreeBandEQ::reset()
 {
-    if (!inputBufferInternal.empty())
-    {
-        std::fill(inputBufferInternal.begin(), inputBufferInternal.end(), 0.0);
-    }
-    if (!outputOverlapBuffer.empty())
-    {
-        std::fill(outputOverlapBuffer.begin(), outputOverlapBuffer.end(), 0.0);
-    }
+    stft.reset();
 }
 
 //--------------------------------------------------------------------------
 // EQ Controls
 //--------------------------------------------------------------------------
 
+bool ThreeBandEQ::applyParameter(const ParameterEvent& event)
+{
+    // Non-finite values are claimed but dropped
+    float value = event.value;
+    const bool valid = clampParameter(event.id, value);
+    switch (event.id)
+    {
+        case ParameterId::EQEnabled: if (valid) setEnabled(value != 0.0f); return true;
+        case ParameterId::EQLowGain: if (valid) setBandGain(0, value); return true;
+        case ParameterId::EQMidGain: if (valid) setBandGain(1, value); return true;
+        case ParameterId::EQHighGain: if (valid) setBandGain(2, value); return true;
+        default: return false;
+    }
+}
+
 void ThreeBandEQ::setBandGain(unsigned int bandIndex, float gain)
 {
     if (bandIndex < NUM_EQ_BANDS)
@@ -325,4 +287,10 @@ float ThreeBandEQ::getBandCutoff(unsigned int bandIndex) const
     return (bandIndex < NUM_EQ_BANDS) ? bandCutoffs[bandIndex] : 0.0f;
 }
 
+bool ThreeBandEQ::isIdentity() const
+{
+    // Unity bands blend to unity in every transition, whatever the cutoffs
+    return std::all_of(bandGains, bandGains + NUM_EQ_BANDS, [](float gain) { return gain == 1.0f; });
+}
+
 } // namespace audio
@@ -2,10 +2,11 @@
 #define THREE_BAND_EQ_H
 
 #include "AudioEffect.h"
+#include "StftEngine.h"
+#include "../audio/ParameterEvent.h"
 #include "../common.h"
 
 #include <vector>
-#include <fftw3.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -18,24 +19,22 @@ namespace audio {
  *
  * Implements spectral processing with separate gain control
  * for low, mid, and high frequency bands using FFT analysis.
- * Uses 50% overlap-add with Hann windowing to minimize artifacts.
+ * Runs on a StftEngine (square-root Hann analysis and synthesis
+ * windows, 50% overlap by default), so any block size is accepted.
+ * The band gains are expanded into a per-bin gain curve, rebuilt only
+ * when a setting changes, so each frame is a single multiply per bin.
+ * With every band at unity the curve is flat and no frames run: the
+ * engine only delays the input, at the same latency, and crossfades
+ * back into spectral frames when a gain changes.
  */
 class ThreeBandEQ : public AudioEffect
 {
 private:
     //--------------------------------------------------------------------------
-    // Configuration
+    // STFT
     //--------------------------------------------------------------------------
-    unsigned int fftSize;
-    unsigned int hopSize;
-
-    //--------------------------------------------------------------------------
-    // FFTW Resources
-    //--------------------------------------------------------------------------
-    fftw_plan fftForwardPlan;
-    fftw_plan fftInversePlan;
-    double* timeData;
-    fftw_complex* frequencyData;
+    StftEngine stft;
+    bool passThrough;                       // frames run delay-only whatever the gains (setPassThrough())
 
     //--------------------------------------------------------------------------
     // EQ Parameters
@@ -44,24 +43,29 @@ private:
     float bandGains[NUM_EQ_BANDS];
 
     //--------------------------------------------------------------------------
-    // OLA Buffers & Window
+    // Gain Curve
     //--------------------------------------------------------------------------
-    std::vector<double> window;
-    std::vector<double> inputBufferInternal;
-    std::vector<double> outputOverlapBuffer;
+    std::vector<double> binGains;           // gain per FFT bin for the settings below
+    float curveCutoffs[NUM_EQ_BANDS];
+    float curveGains[NUM_EQ_BANDS];
 
     //--------------------------------------------------------------------------
     // Private Methods
     //--------------------------------------------------------------------------
     /**
-     * Applies EQ gain to frequency-domain data.
+     * Applies EQ gain to the current frame's spectrum.
      */
     void applyEQGain();
 
     /**
-     * Calculates Hann window function for 50% overlap.
+     * Runs the STFT frame that just completed, timing each step.
      */
-    void calculateWindow();
+    void processFrame();
+
+    /**
+     * Rebuilds the per-bin gain curve if the gains or cutoffs changed since it was built.
+     */
+    void updateBinGains();
 
     /**
      * Gets interpolated gain for smooth transitions between bands.
@@ -76,16 +80,17 @@ public:
     //--------------------------------------------------------------------------
     /**
      * Creates a three-band equalizer with FFT processing.
+     * The FFT is twice frameSize; at 50% overlap the hop is frameSize, so
+     * blocks of frameSize frames are delayed by frameSize. The EQ is
+     * prepared for periods of frameSize (see prepare()).
+     *
      * @param rate Sample rate in Hz (default: SAMPLE_RATE)
      * @param frameSize Processing frame size (default: FRAMES_PER_BUFFER)
+     * @param overlap Overlap between FFT frames (default: 50%)
      */
     ThreeBandEQ(unsigned int rate = SAMPLE_RATE,
-                unsigned int frameSize = FRAMES_PER_BUFFER);
-
-    /**
-     * Cleans up FFTW resources.
-     */
-    ~ThreeBandEQ() override;
+                unsigned int frameSize = FRAMES_PER_BUFFER,
+                StftOverlap overlap = StftOverlap::Half);
 
     //--------------------------------------------------------------------------
     // AudioEffect Interface
@@ -98,6 +103,38 @@ public:
      */
     void process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames) override;
 
+    /**
+     * Advances the equalizer over a block of silent input.
+     * Output matches process() on zeros: the tail of earlier signal is
+     * flushed, and once it has drained no FFTs run at all.
+     * @param outputBuffer Destination for processed audio
+     * @param numFrames Number of frames to process
+     * @return true if the output block is silent
+     */
+    bool processSilence(float* outputBuffer, std::size_t numFrames);
+
+    /**
+     * Processes a block, applying the EQ's parameter events before the
+     * first STFT frame that ends after each one (a frame is the finest
+     * step the gain curve has).
+     * @param events Events inside the block; other effects' events are skipped
+     */
+    void process(const float* inputBuffer, float* outputBuffer, std::size_t numFrames, const BlockEvents& events);
+
+    /**
+     * processSilence() with the EQ's parameter events applied per frame.
+     */
+    bool processSilence(float* outputBuffer, std::size_t numFrames, const BlockEvents& events);
+
+    /**
+     * Chooses the STFT latency for the period the backend delivers:
+     * FFT size minus hop if it is a whole number of hops, FFT size minus
+     * one otherwise. Clears the STFT if the latency changes; call before
+     * the stream starts.
+     * @param periodFrames Frames in every block, or 0 if blocks vary in size
+     */
+    void prepare(std::size_t periodFrames);
+
     /**
      * Resets internal state.
      */
@@ -106,6 +143,13 @@ public:
     //--------------------------------------------------------------------------
     // EQ Controls
     //--------------------------------------------------------------------------
+    /**
+     * Applies a parameter event if it is one of the EQ's, clamped to
+     * parameterRange(); a non-finite value is ignored.
+     * @return false if the event belongs to another effect
+     */
+    bool applyParameter(const ParameterEvent& event);
+
     /**
      * Sets the gain for a frequency band.
      * @param bandIndex Band to adjust (0=low, 1=mid, 2=high)
@@ -133,6 +177,27 @@ public:
      * @return Current cutoff frequency in Hz
      */
     float getBandCutoff(unsigned int bandIndex) const;
+
+    /**
+     * Checks whether every band gain is unity, so the EQ only delays its input.
+     */
+    bool isIdentity() const;
+
+    /**
+     * Runs frames delay-only while set, as if every gain were unity, e.g.
+     * while a voice activity detector finds no speech. The STFT keeps
+     * running, so switching crossfades exactly and the latency is unchanged.
+     * Call between blocks on the audio thread.
+     */
+    void setPassThrough(bool enabled) { passThrough = enabled; }
+
+    bool isPassThrough() const { return passThrough; }
+
+    /**
+     * Gets the delay the STFT adds while enabled.
+     * @return Latency in samples
+     */
+    unsigned int getLatency() const { return stft.getLatency(); }
 };
 
 } // namespace audio
@@ -0,0 +1,156 @@
+#include "VoiceActivity.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+namespace {
+
+// Band the flatness is measured over: voiced harmonics and the first formants
+const double FLATNESS_LOW_HZ = 100.0;
+const double FLATNESS_HIGH_HZ = 4000.0;
+
+// Bin power added before the logarithm, so empty bins stay finite
+const double FLATNESS_POWER_FLOOR = 1e-20;
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+VoiceActivityDetector::VoiceActivityDetector(unsigned int rate, unsigned int fftSize)
+    : sampleRate(rate),
+      stft(fftSize, StftOverlap::Half, false)
+{
+    reset();
+}
+
+void VoiceActivityDetector::reset()
+{
+    stft.reset();
+    flatnessSum = 0.0;
+    frameCount = 0;
+    lastSample = 0.0f;
+    blockPower = 0.0;
+    blockFrames = 0;
+    features = VoiceFeatures();
+    hangoverRemaining = 0;
+    speech = false;
+    floorValid = false;
+}
+
+//--------------------------------------------------------------------------
+// Analysis
+//--------------------------------------------------------------------------
+
+void VoiceActivityDetector::analyzeFrame(const fftw_complex* bins, unsigned int fftSize)
+{
+    const unsigned int lowBin = std::max(1u, static_cast<unsigned int>(std::ceil(FLATNESS_LOW_HZ * fftSize / sampleRate)));
+    const unsigned int highBin = std::min(fftSize / 2, static_cast<unsigned int>(FLATNESS_HIGH_HZ * fftSize / sampleRate));
+    if (highBin <= lowBin)
+    {
+        return;
+    }
+
+    // Geometric over arithmetic mean of the bin powers
+    double logSum = 0.0;
+    double sum = 0.0;
+    for (unsigned int k = lowBin; k <= highBin; ++k)
+    {
+        const double power = bins[k][0] * bins[k][0] + bins[k][1] * bins[k][1] + FLATNESS_POWER_FLOOR;
+        logSum += std::log(power);
+        sum += power;
+    }
+    const double count = highBin - lowBin + 1;
+    flatnessSum += std::exp(logSum / count) / (sum / count);
+    ++frameCount;
+}
+
+void VoiceActivityDetector::measure(const float* input, std::size_t numFrames, bool framesHandedOver)
+{
+    double energy = 0.0;
+    std::size_t crossings = 0;
+    float previous = lastSample;
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        const float sample = input[i];
+        energy += static_cast<double>(sample) * sample;
+        crossings += (sample >= 0.0f) != (previous >= 0.0f);
+        previous = sample;
+    }
+    lastSample = previous;
+    blockPower = numFrames > 0 ? energy / numFrames : 0.0;
+    blockFrames = numFrames;
+    features.zeroCrossingRate = numFrames > 0 ? static_cast<float>(crossings) / numFrames : 0.0f;
+
+    if (framesHandedOver || !stft.isValid())
+    {
+        return;
+    }
+    for (std::size_t pos = 0; pos < numFrames; )
+    {
+        const std::size_t chunk = std::min(numFrames - pos, stft.getHopRemaining());
+        if (stft.pushInput(input + pos, chunk))
+        {
+            stft.analyze();
+            analyzeFrame(stft.getSpectrum(), stft.getFftSize());
+        }
+        pos += chunk;
+    }
+}
+
+bool VoiceActivityDetector::decide()
+{
+    if (frameCount > 0)
+    {
+        features.flatness = static_cast<float>(flatnessSum / frameCount);
+        flatnessSum = 0.0;
+        frameCount = 0;
+    }
+
+    const float energyDB = blockPower > 1e-12 ? static_cast<float>(10.0 * std::log10(blockPower)) : -120.0f;
+    features.energyDB = energyDB;
+
+    // Speech is judged against the floor before this block moves it
+    const bool speechLike = floorValid &&
+                            energyDB > std::max(features.noiseFloorDB + settings.marginDB, settings.minEnergyDB) &&
+                            features.flatness < settings.maxFlatness &&
+                            features.zeroCrossingRate < settings.maxZeroCrossingRate;
+
+    const double seconds = static_cast<double>(blockFrames) / sampleRate;
+    if (!floorValid)
+    {
+        features.noiseFloorDB = energyDB;
+        floorValid = true;
+    }
+    else if (energyDB < features.noiseFloorDB)
+    {
+        const double follow = 1.0 - std::exp(-seconds * 1000.0 / settings.floorFallMs);
+        features.noiseFloorDB += static_cast<float>((energyDB - features.noiseFloorDB) * follow);
+    }
+    else
+    {
+        features.noiseFloorDB = std::min(energyDB, features.noiseFloorDB +
+                                         static_cast<float>(settings.floorRiseDBPerSecond * seconds));
+    }
+
+    if (speechLike)
+    {
+        hangoverRemaining = static_cast<std::size_t>(settings.hangoverMs * sampleRate / 1000.0f);
+        speech = true;
+    }
+    else if (hangoverRemaining > blockFrames)
+    {
+        hangoverRemaining -= blockFrames;
+    }
+    else
+    {
+        hangoverRemaining = 0;
+        speech = false;
+    }
+    return speech;
+}
+
+} // namespace audio
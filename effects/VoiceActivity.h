@@ -0,0 +1,118 @@
+#ifndef VOICE_ACTIVITY_H
+#define VOICE_ACTIVITY_H
+
+#include "StftEngine.h"
+#include "../common.h"
+
+#include <cstddef>
+#include <fftw3.h>
+
+namespace audio {
+
+/**
+ * Thresholds of the voice activity decision.
+ */
+struct VoiceActivitySettings
+{
+    float marginDB = 9.0f;              // energy above the noise floor a speech block needs
+    float minEnergyDB = -55.0f;         // blocks below this are never speech (dBFS)
+    float maxFlatness = 0.4f;           // voiced speech is harmonic: flatness well below noise's ~0.56
+    float maxZeroCrossingRate = 0.3f;   // crossings per sample; above this the energy is mostly hiss
+    float hangoverMs = 250.0f;          // speech holds this long after the last speech-like block
+    float floorRiseDBPerSecond = 3.0f;  // how fast the noise floor follows a louder background
+    float floorFallMs = 50.0f;          // time constant of the floor following a quieter one
+};
+
+/**
+ * Features of the last block the detector decided on.
+ */
+struct VoiceFeatures
+{
+    float energyDB = -120.0f;           // mean square of the block (dBFS)
+    float noiseFloorDB = -120.0f;       // tracked background level (dBFS)
+    float flatness = 1.0f;              // spectral flatness over the speech band, 0 (tonal) .. 1 (white)
+    float zeroCrossingRate = 0.0f;      // sign changes per sample
+};
+
+/**
+ * Lightweight voice activity detector: block energy against a tracked
+ * noise floor, spectral flatness over 100 Hz - 4 kHz, and zero-crossing
+ * rate.
+ *
+ * The spectra come from whichever STFT already analyses the signal: the
+ * noise gate hands over each frame it analyses (analyzeFrame()); on
+ * blocks without such frames the detector runs its own analysis-only
+ * engine. A block is speech-like when it stands marginDB above the noise
+ * floor, is harmonic enough (flatness) and not dominated by hiss
+ * (zero-crossing rate); the decision then holds for hangoverMs, which
+ * bridges fricatives and the gaps between words.
+ *
+ * The noise floor falls quickly to a quieter background and rises at a
+ * fixed rate, so a steady tone or hum is absorbed into the floor within
+ * seconds while a louder talker is not.
+ */
+class VoiceActivityDetector
+{
+private:
+    unsigned int sampleRate;
+    VoiceActivitySettings settings;
+    StftEngine stft;                    // own analysis when no frames are handed over
+
+    double flatnessSum;                 // over the frames of the current block
+    unsigned int frameCount;
+    float lastSample;                   // carries zero crossings across blocks
+    double blockPower;                  // set by measure(), used by decide()
+    std::size_t blockFrames;
+
+    VoiceFeatures features;
+    std::size_t hangoverRemaining;      // samples the decision still holds
+    bool speech;
+    bool floorValid;                    // the floor has seen a block since reset()
+
+public:
+    /**
+     * @param rate Sample rate in Hz (default: SAMPLE_RATE)
+     * @param fftSize Frame size of the detector's own analysis (default: FFT_SIZE)
+     */
+    explicit VoiceActivityDetector(unsigned int rate = SAMPLE_RATE, unsigned int fftSize = FFT_SIZE);
+
+    /**
+     * Adds an analysed frame's spectrum to the current block's flatness.
+     * Called by the stage that owns the STFT, between measure() and decide().
+     * @param bins fftSize/2+1 bins of a real forward FFT
+     * @param fftSize Frame size the bins came from
+     */
+    void analyzeFrame(const fftw_complex* bins, unsigned int fftSize);
+
+    /**
+     * Measures a block's energy and zero crossings. Call before the block
+     * is overwritten (input may alias the chain's output).
+     * @param input Block samples
+     * @param numFrames Number of samples
+     * @param framesHandedOver true when another stage will call analyzeFrame()
+     *        for this block; false runs the detector's own analysis
+     */
+    void measure(const float* input, std::size_t numFrames, bool framesHandedOver);
+
+    /**
+     * Decides on the block measured last, updates the noise floor and the hangover.
+     * A block without a completed frame keeps the previous flatness.
+     * @return true if the block is speech
+     */
+    bool decide();
+
+    /**
+     * Clears the floor, hangover and analysis state.
+     */
+    void reset();
+
+    bool isSpeech() const { return speech; }
+    const VoiceFeatures& getFeatures() const { return features; }
+
+    VoiceActivitySettings& getSettings() { return settings; }
+    const VoiceActivitySettings& getSettings() const { return settings; }
+};
+
+} // namespace audio
+
+#endif // VOICE_ACTIVITY_H
@@ -16,16 +16,36 @@ GUIManager::GUIManager(audio::NoiseGate& ng, audio::ThreeBandEQ& threeBandEq, au
                        int& deEsserStartFreq, int& deEsserEndFreq)
     : window(nullptr),
       running(false),
-      noiseGate(ng),
-      eq(threeBandEq),
-      limiter(lim),
-      deesserEnabledRef(deEsserEnabled),
-      deesserReductionDBRef(deEsserReduction),
-      deesserStartFreqRef(deEsserStartFreq),
-      deesserEndFreqRef(deEsserEndFreq),
+      noiseGate(&ng),
+      eq(&threeBandEq),
+      limiter(&lim),
+      deesserEnabledRef(&deEsserEnabled),
+      deesserReductionDBRef(&deEsserReduction),
+      deesserStartFreqRef(&deEsserStartFreq),
+      deesserEndFreqRef(&deEsserEndFreq),
+      profiler(nullptr),
+      parameterQueue(nullptr),
+      devicesAvailable(false),
+      deviceRequestPending(false),
+      selectedInput(0),
+      selectedOutput(0),
+      selectedRate(0),
+      selectedFrames(0),
       selectedEffect(0) // Default to Noise Gate
 {}
 
+void GUIManager::bindEffects(audio::NoiseGate& ng, audio::ThreeBandEQ& threeBandEq, audio::Limiter& lim,
+                             bool& deEsserEnabled, double& deEsserReduction,
+                             int& deEsserStartFreq, int& deEsserEndFreq) {
+    noiseGate = &ng;
+    eq = &threeBandEq;
+    limiter = &lim;
+    deesserEnabledRef = &deEsserEnabled;
+    deesserReductionDBRef = &deEsserReduction;
+    deesserStartFreqRef = &deEsserStartFreq;
+    deesserEndFreqRef = &deEsserEndFreq;
+}
+
 GUIManager::~GUIManager() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -168,6 +188,16 @@ void GUIManager::renderEffectsPanel() {
     RenderEffectItem("Limiter", 2);
     RenderEffectItem("3-Band EQ", 3);
 
+    if (profiler || devicesAvailable) {
+        ImGui::Separator();
+    }
+    if (profiler) {
+        RenderEffectItem("Profiler", 4);
+    }
+    if (devicesAvailable) {
+        RenderEffectItem("Audio Device", 5);
+    }
+
     ImGui::EndChild();
 }
 
@@ -182,6 +212,8 @@ void GUIManager::renderControlsPanel() {
         case 1: renderDeEsserControls(); break;
         case 2: renderLimiterControls(); break;
         case 3: renderEQControls(); break;
+        case 4: renderProfilerPanel(); break;
+        case 5: renderDevicePanel(); break;
         default: ImGui::Text("Select an effect from the left panel."); break;
     }
 
@@ -197,24 +229,32 @@ void GUIManager::renderNoiseGateControls() {
     ImGui::Text("NOISE GATE CONTROLS");
     ImGui::Separator();
 
-    bool enabled = noiseGate.isEnabled();
+    bool enabled = noiseGate->isEnabled();
     if (ImGui::Checkbox("Enabled##NoiseGate", &enabled)) {
-        noiseGate.setEnabled(enabled);
+        if (!postParameter(audio::ParameterId::GateEnabled, enabled ? 1.0f : 0.0f)) {
+            noiseGate->setEnabled(enabled);
+        }
     }
 
-    float threshold = noiseGate.getThreshold();
+    float threshold = noiseGate->getThreshold();
     if (ImGui::SliderFloat("Threshold##NoiseGate", &threshold, 0.0f, 1.0f, "%.3f")) {
-        noiseGate.setThreshold(threshold);
+        if (!postParameter(audio::ParameterId::GateThreshold, threshold)) {
+            noiseGate->setThreshold(threshold);
+        }
     }
 
-    float attackTime = noiseGate.getAttackTime();
+    float attackTime = noiseGate->getAttackTime();
     if (ImGui::SliderFloat("Attack (ms)##NoiseGate", &attackTime, 0.1f, 50.0f, "%.1f ms")) {
-        noiseGate.setAttackTime(attackTime);
+        if (!postParameter(audio::ParameterId::GateAttack, attackTime)) {
+            noiseGate->setAttackTime(attackTime);
+        }
     }
 
-    float releaseTime = noiseGate.getReleaseTime();
+    float releaseTime = noiseGate->getReleaseTime();
     if (ImGui::SliderFloat("Release (ms)##NoiseGate", &releaseTime, 1.0f, 500.0f, "%.1f ms")) {
-        noiseGate.setReleaseTime(releaseTime);
+        if (!postParameter(audio::ParameterId::GateRelease, releaseTime)) {
+            noiseGate->setReleaseTime(releaseTime);
+        }
     }
 
     ImGui::Separator();
@@ -225,27 +265,35 @@ void GUIManager::renderEQControls() {
     ImGui::Text("3-BAND EQ CONTROLS");
     ImGui::Separator();
 
-    bool enabled = eq.isEnabled();
+    bool enabled = eq->isEnabled();
     if (ImGui::Checkbox("Enabled##EQ", &enabled)) {
-        eq.setEnabled(enabled);
+        if (!postParameter(audio::ParameterId::EQEnabled, enabled ? 1.0f : 0.0f)) {
+            eq->setEnabled(enabled);
+        }
     }
 
-    float lowGain = eq.getBandGain(0);
-    float midGain = eq.getBandGain(1);
-    float highGain = eq.getBandGain(2);
+    float lowGain = eq->getBandGain(0);
+    float midGain = eq->getBandGain(1);
+    float highGain = eq->getBandGain(2);
 
     if (ImGui::SliderFloat("Low Gain##EQ", &lowGain, 0.0f, 6.0f, "%.1f")) {
-        eq.setBandGain(0, lowGain);
+        if (!postParameter(audio::ParameterId::EQLowGain, lowGain)) {
+            eq->setBandGain(0, lowGain);
+        }
     }
     ImGui::SameLine(); ImGui::Text(" (%.1f dB)", 20.0f * log10f(lowGain + 1e-6f));
 
     if (ImGui::SliderFloat("Mid Gain##EQ", &midGain, 0.0f, 6.0f, "%.1f")) {
-        eq.setBandGain(1, midGain);
+        if (!postParameter(audio::ParameterId::EQMidGain, midGain)) {
+            eq->setBandGain(1, midGain);
+        }
     }
     ImGui::SameLine(); ImGui::Text(" (%.1f dB)", 20.0f * log10f(midGain + 1e-6f));
 
     if (ImGui::SliderFloat("High Gain##EQ", &highGain, 0.0f, 6.0f, "%.1f")) {
-        eq.setBandGain(2, highGain);
+        if (!postParameter(audio::ParameterId::EQHighGain, highGain)) {
+            eq->setBandGain(2, highGain);
+        }
     }
     ImGui::SameLine(); ImGui::Text(" (%.1f dB)", 20.0f * log10f(highGain + 1e-6f));
 
@@ -257,25 +305,33 @@ void GUIManager::renderLimiterControls() {
     ImGui::Text("LIMITER CONTROLS");
     ImGui::Separator();
 
-    bool enabled = limiter.isEnabled();
+    bool enabled = limiter->isEnabled();
     if (ImGui::Checkbox("Enabled##Limiter", &enabled)) {
-        limiter.setEnabled(enabled);
+        if (!postParameter(audio::ParameterId::LimiterEnabled, enabled ? 1.0f : 0.0f)) {
+            limiter->setEnabled(enabled);
+        }
     }
 
-    float threshold = limiter.getThreshold();
+    float threshold = limiter->getThreshold();
     if (ImGui::SliderFloat("Threshold##Limiter", &threshold, 0.0f, 1.0f, "%.3f")) {
-        limiter.setThreshold(threshold);
+        if (!postParameter(audio::ParameterId::LimiterThreshold, threshold)) {
+            limiter->setThreshold(threshold);
+        }
     }
     ImGui::SameLine(); ImGui::Text(" (%.1f dBFS)", 20.0f * log10f(threshold + 1e-6f));
 
-    float attackTime = limiter.getAttackTime();
+    float attackTime = limiter->getAttackTime();
     if (ImGui::SliderFloat("Attack (ms)##Limiter", &attackTime, 0.1f, 50.0f, "%.1f ms")) {
-        limiter.setAttackTime(attackTime);
+        if (!postParameter(audio::ParameterId::LimiterAttack, attackTime)) {
+            limiter->setAttackTime(attackTime);
+        }
     }
 
-    float releaseTime = limiter.getReleaseTime();
+    float releaseTime = limiter->getReleaseTime();
     if (ImGui::SliderFloat("Release (ms)##Limiter", &releaseTime, 1.0f, 500.0f, "%.1f ms")) {
-        limiter.setReleaseTime(releaseTime);
+        if (!postParameter(audio::ParameterId::LimiterRelease, releaseTime)) {
+            limiter->setReleaseTime(releaseTime);
+        }
     }
 
     ImGui::Separator();
@@ -286,36 +342,242 @@ void GUIManager::renderDeEsserControls() {
     ImGui::Text("DE-ESSER CONTROLS");
     ImGui::Separator();
 
-    if (ImGui::Checkbox("Enabled##DeEsser", &deesserEnabledRef)) {
-        // Updated directly
+    bool enabled = *deesserEnabledRef;
+    if (ImGui::Checkbox("Enabled##DeEsser", &enabled)) {
+        if (!postParameter(audio::ParameterId::DeEsserEnabled, enabled ? 1.0f : 0.0f)) {
+            *deesserEnabledRef = enabled;
+        }
     }
 
-    float reduction = static_cast<float>(deesserReductionDBRef);
+    float reduction = static_cast<float>(*deesserReductionDBRef);
     if (ImGui::SliderFloat("Reduction (dB)##DeEsser", &reduction, 0.0f, 30.0f, "%.1f dB")) {
-        deesserReductionDBRef = static_cast<double>(reduction);
+        if (!postParameter(audio::ParameterId::DeEsserReduction, reduction)) {
+            *deesserReductionDBRef = static_cast<double>(reduction);
+        }
     }
 
-    int startFreq = deesserStartFreqRef;
-    int endFreq = deesserEndFreqRef;
+    int startFreq = *deesserStartFreqRef;
+    int endFreq = *deesserEndFreqRef;
 
     if (ImGui::SliderInt("Start Freq##DeEsser", &startFreq, 2000, 10000, "%d Hz")) {
-        if (startFreq >= deesserEndFreqRef) {
+        if (startFreq >= *deesserEndFreqRef) {
             endFreq = startFreq + 500;
-            deesserEndFreqRef = endFreq;
+            if (!postParameter(audio::ParameterId::DeEsserEndFreq, static_cast<float>(endFreq))) {
+                *deesserEndFreqRef = endFreq;
+            }
+        }
+        if (!postParameter(audio::ParameterId::DeEsserStartFreq, static_cast<float>(startFreq))) {
+            *deesserStartFreqRef = startFreq;
         }
-        deesserStartFreqRef = startFreq;
     }
 
     if (ImGui::SliderInt("End Freq##DeEsser", &endFreq, 3000, 12000, "%d Hz")) {
-        if (endFreq <= deesserStartFreqRef) {
+        if (endFreq <= *deesserStartFreqRef) {
             startFreq = endFreq - 500;
-            deesserStartFreqRef = startFreq;
+            if (!postParameter(audio::ParameterId::DeEsserStartFreq, static_cast<float>(startFreq))) {
+                *deesserStartFreqRef = startFreq;
+            }
+        }
+        if (!postParameter(audio::ParameterId::DeEsserEndFreq, static_cast<float>(endFreq))) {
+            *deesserEndFreqRef = endFreq;
         }
-        deesserEndFreqRef = endFreq;
     }
 
     ImGui::Separator();
     ImGui::TextWrapped("Reduces sibilance ('s' sounds) by attenuating a specific high-frequency range.");
 }
 
+//------------------------------------------------------------------------------
+// Parameter Automation
+//------------------------------------------------------------------------------
+
+void GUIManager::setParameterQueue(audio::ParameterQueue* queue) {
+    parameterQueue = queue;
+}
+
+bool GUIManager::postParameter(audio::ParameterId id, float value) {
+    return parameterQueue && parameterQueue->post(id, value);
+}
+
+//------------------------------------------------------------------------------
+// Profiler
+//------------------------------------------------------------------------------
+
+void GUIManager::setProfiler(audio::Profiler* prof) {
+    profiler = prof;
+}
+
+void GUIManager::renderProfilerPanel() {
+    ImGui::Text("PROFILER");
+    ImGui::Separator();
+
+    if (!profiler) {
+        ImGui::Text("Profiling is not enabled.");
+        return;
+    }
+
+    static bool paused = false;
+    if (ImGui::Checkbox("Pause##Profiler", &paused)) {
+        profiler->setEnabled(!paused);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##Profiler")) {
+        profiler->reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Trace##Profiler")) {
+        profiler->exportChromeTrace("multiaudio-trace.json");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Flame Graph##Profiler")) {
+        profiler->exportFoldedStacks("multiaudio-profile.folded");
+    }
+
+    for (audio::ThreadProfile* profile : profiler->getProfiles()) {
+        const std::vector<audio::ProfileSummary> summary = profiler->summarize(*profile);
+        const double chainMicros = summary[static_cast<size_t>(audio::ProfileStage::Chain)].totalMicros;
+
+        ImGui::Text("Thread: %s", profile->getName().c_str());
+        if (!ImGui::BeginTable(profile->getName().c_str(), 7,
+                               ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            continue;
+        }
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Mean (us)");
+        ImGui::TableSetupColumn("p50 (us)");
+        ImGui::TableSetupColumn("p99 (us)");
+        ImGui::TableSetupColumn("Max (us)");
+        ImGui::TableSetupColumn("% Chain");
+        ImGui::TableHeadersRow();
+
+        for (size_t s = 0; s < audio::PROFILE_STAGE_COUNT; ++s) {
+            const audio::ProfileSummary& stage = summary[s];
+            if (stage.calls == 0) {
+                continue;
+            }
+            // Indent by nesting depth so the table reads as a call tree
+            int depth = 0;
+            for (audio::ProfileStage p = static_cast<audio::ProfileStage>(s);
+                 p != audio::ProfileStage::Chain; p = audio::profileStageParent(p)) {
+                ++depth;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%*s%s", depth * 2, "",
+                                                  audio::profileStageName(static_cast<audio::ProfileStage>(s)));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(stage.calls));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", stage.meanMicros);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", stage.p50Micros);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", stage.p99Micros);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", stage.maxMicros);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", chainMicros > 0.0 ? 100.0 * stage.totalMicros / chainMicros : 0.0);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    ImGui::TextWrapped("Time spent in each stage of the processing chain. p50/p99 are histogram estimates "
+                       "(within a factor of 1.4). Exports open in chrome://tracing, Perfetto or speedscope, "
+                       "and flamegraph.pl.");
+}
+
+//------------------------------------------------------------------------------
+// Audio Device
+//------------------------------------------------------------------------------
+
+namespace {
+
+const unsigned int SAMPLE_RATE_CHOICES[] = { 44100, 48000, 88200, 96000 };
+const unsigned int BUFFER_FRAME_CHOICES[] = { 128, 256, 512, 1024, 2048, 4096 };
+
+template <size_t N>
+int indexOf(const unsigned int (&choices)[N], unsigned int value) {
+    for (size_t i = 0; i < N; ++i) {
+        if (choices[i] == value) return static_cast<int>(i);
+    }
+    return 0;
+}
+
+} // namespace
+
+void GUIManager::setDevices(const std::vector<audio::DeviceOption>& options, const audio::StreamConfig& current) {
+    devices = options;
+    currentConfig = current;
+    devicesAvailable = !devices.empty();
+    selectedInput = selectedOutput = 0;
+    for (size_t i = 0; i < devices.size(); ++i) {
+        if (devices[i].id == current.inputDevice) selectedInput = static_cast<int>(i);
+        if (devices[i].id == current.outputDevice) selectedOutput = static_cast<int>(i);
+    }
+    selectedRate = indexOf(SAMPLE_RATE_CHOICES, current.sampleRate);
+    selectedFrames = indexOf(BUFFER_FRAME_CHOICES, current.bufferFrames);
+}
+
+bool GUIManager::takeDeviceRequest(audio::StreamConfig& request) {
+    if (!deviceRequestPending) return false;
+    request = deviceRequest;
+    deviceRequestPending = false;
+    return true;
+}
+
+void GUIManager::setDeviceStatus(const std::string& status) {
+    deviceStatus = status;
+}
+
+void GUIManager::renderDevicePanel() {
+    ImGui::Text("AUDIO DEVICE");
+    ImGui::Separator();
+
+    auto deviceCombo = [&](const char* label, int& selected, bool input) {
+        if (ImGui::BeginCombo(label, devices[selected].name.c_str())) {
+            for (size_t i = 0; i < devices.size(); ++i) {
+                const audio::DeviceOption& device = devices[i];
+                if ((input ? device.inputChannels : device.outputChannels) < NUM_CHANNELS) continue;
+                if (ImGui::Selectable(device.name.c_str(), selected == static_cast<int>(i))) {
+                    selected = static_cast<int>(i);
+                }
+            }
+            ImGui::EndCombo();
+        }
+    };
+    deviceCombo("Input##Device", selectedInput, true);
+    deviceCombo("Output##Device", selectedOutput, false);
+
+    const std::string rateLabel = std::to_string(SAMPLE_RATE_CHOICES[selectedRate]) + " Hz";
+    if (ImGui::BeginCombo("Sample Rate##Device", rateLabel.c_str())) {
+        for (int i = 0; i < static_cast<int>(sizeof(SAMPLE_RATE_CHOICES) / sizeof(SAMPLE_RATE_CHOICES[0])); ++i) {
+            if (ImGui::Selectable((std::to_string(SAMPLE_RATE_CHOICES[i]) + " Hz").c_str(), selectedRate == i)) {
+                selectedRate = i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    const std::string framesLabel = std::to_string(BUFFER_FRAME_CHOICES[selectedFrames]) + " frames";
+    if (ImGui::BeginCombo("Buffer Size##Device", framesLabel.c_str())) {
+        for (int i = 0; i < static_cast<int>(sizeof(BUFFER_FRAME_CHOICES) / sizeof(BUFFER_FRAME_CHOICES[0])); ++i) {
+            if (ImGui::Selectable((std::to_string(BUFFER_FRAME_CHOICES[i]) + " frames").c_str(), selectedFrames == i)) {
+                selectedFrames = i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    if (ImGui::Button("Apply##Device")) {
+        deviceRequest.inputDevice = devices[selectedInput].id;
+        deviceRequest.outputDevice = devices[selectedOutput].id;
+        deviceRequest.sampleRate = SAMPLE_RATE_CHOICES[selectedRate];
+        deviceRequest.bufferFrames = BUFFER_FRAME_CHOICES[selectedFrames];
+        deviceRequestPending = true;
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Running: %u Hz, %u frames", currentConfig.sampleRate, currentConfig.bufferFrames);
+    if (!deviceStatus.empty()) {
+        ImGui::TextWrapped("%s", deviceStatus.c_str());
+    }
+    ImGui::TextWrapped("Applying builds a new effect chain for the new format while audio keeps running, "
+                       "then reopens the stream and crossfades to the new chain. Effect settings carry over.");
+}
+
 }
@@ -8,6 +8,12 @@
 #include "../effects/NoiseGate.h"
 #include "../effects/ThreeBandEQ.h"
 #include "../effects/Limiter.h"
+#include "../audio/Profiler.h"
+#include "../audio/ParameterQueue.h"
+#include "../audio/StreamConfig.h"
+
+#include <string>
+#include <vector>
 
 // Forward declaration to avoid including the full GLFW header
 struct GLFWwindow;
@@ -73,6 +79,52 @@ public:
      */
     bool isRunning() const;
 
+    /**
+     * Shows live per-stage timings from a profiler (optional, external ownership).
+     *
+     * @param prof Profiler fed by the effect chain, or nullptr to hide the panel
+     */
+    void setProfiler(audio::Profiler* prof);
+
+    /**
+     * Sends control changes through a parameter queue instead of writing
+     * the effects directly, so the audio thread applies them between
+     * samples (optional, external ownership). Changes fall back to direct
+     * writes while the queue is full.
+     *
+     * @param queue Queue the effect chain takes events from, or nullptr
+     */
+    void setParameterQueue(audio::ParameterQueue* queue);
+
+    /**
+     * Points the controls at another set of effects (e.g. after the chain
+     * was rebuilt for a new stream format). Parameters as for the constructor.
+     */
+    void bindEffects(audio::NoiseGate& ng, audio::ThreeBandEQ& threeBandEq, audio::Limiter& lim,
+                     bool& deEsserEnabled, double& deEsserReduction,
+                     int& deEsserStartFreq, int& deEsserEndFreq);
+
+    /**
+     * Offers devices, sample rates and buffer sizes in the Audio Device panel.
+     *
+     * @param options Devices the stream can be opened on
+     * @param current Configuration the stream is running with
+     */
+    void setDevices(const std::vector<audio::DeviceOption>& options, const audio::StreamConfig& current);
+
+    /**
+     * Takes the configuration applied in the Audio Device panel, once per Apply.
+     *
+     * @param request Receives the requested configuration
+     * @return true if the user applied a configuration since the last call
+     */
+    bool takeDeviceRequest(audio::StreamConfig& request);
+
+    /**
+     * Shows the outcome of the last reconfiguration in the Audio Device panel.
+     */
+    void setDeviceStatus(const std::string& status);
+
 private:
     //--------------------------------------------------------------------------
     // Member Variables
@@ -81,23 +133,45 @@ private:
     GLFWwindow* window;   // OpenGL window handle (owned by ImGui + GLFW)
     bool running;         // Main loop control flag, true if app is active
 
-    // Audio processing effect references (external ownership)
-    audio::NoiseGate& noiseGate; // Noise gate effect instance
-    audio::ThreeBandEQ& eq;      // 3-band equalizer instance
-    audio::Limiter& limiter;     // Limiter effect instance
-
-    // De-esser parameter references - modified directly through GUI
-    bool& deesserEnabledRef;      // De-esser on/off toggle
-    double& deesserReductionDBRef; // De-esser reduction in dB
-    int& deesserStartFreqRef;     // De-esser frequency lower bound
-    int& deesserEndFreqRef;       // De-esser frequency upper bound
-
-    int selectedEffect;   // 0=Noise Gate, 1=EQ, 2=Limiter, 3=De-Esser (panel selector)
+    // Audio processing effects (external ownership, rebound by bindEffects())
+    audio::NoiseGate* noiseGate; // Noise gate effect instance
+    audio::ThreeBandEQ* eq;      // 3-band equalizer instance
+    audio::Limiter* limiter;     // Limiter effect instance
+
+    // De-esser parameters - modified directly through GUI
+    bool* deesserEnabledRef;      // De-esser on/off toggle
+    double* deesserReductionDBRef; // De-esser reduction in dB
+    int* deesserStartFreqRef;     // De-esser frequency lower bound
+    int* deesserEndFreqRef;       // De-esser frequency upper bound
+
+    audio::Profiler* profiler;    // Stage timings, nullptr when not profiling
+    audio::ParameterQueue* parameterQueue; // Control changes to the audio thread, nullptr to write directly
+
+    // Audio device selection (shown once setDevices() was called)
+    std::vector<audio::DeviceOption> devices;
+    audio::StreamConfig currentConfig;  // What the stream runs with
+    audio::StreamConfig deviceRequest;  // Applied, not yet taken
+    bool devicesAvailable;
+    bool deviceRequestPending;
+    int selectedInput;    // Index into devices
+    int selectedOutput;   // Index into devices
+    int selectedRate;     // Index into the sample rate choices
+    int selectedFrames;   // Index into the buffer size choices
+    std::string deviceStatus;
+
+    int selectedEffect;   // 0=Noise Gate, 1=De-Esser, 2=Limiter, 3=EQ, 4=Profiler, 5=Audio Device (panel selector)
 
     //--------------------------------------------------------------------------
     // Private UI Rendering Methods
     //--------------------------------------------------------------------------
 
+    /**
+     * Posts a control change to the parameter queue.
+     *
+     * @return false if there is no queue or it is full (write the effect directly)
+     */
+    bool postParameter(audio::ParameterId id, float value);
+
     /**
      * Renders the left panel containing the list of audio effects.
      */
@@ -132,6 +206,18 @@ private:
      * Includes reduction amount and frequency range settings.
      */
     void renderDeEsserControls();
+
+    /**
+     * Renders the per-stage timing table of each profiled thread.
+     * Includes pause, reset, and trace/flame graph export.
+     */
+    void renderProfilerPanel();
+
+    /**
+     * Renders device, sample rate and buffer size selection.
+     * Apply hands the choice to the application through takeDeviceRequest().
+     */
+    void renderDevicePanel();
 };
 
 } // namespace gui
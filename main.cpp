@@ -1,16 +1,37 @@
 #include "common.h"
 #include "audio/BufferQueue.h"
+#include "audio/EffectChain.h"
+#include "audio/RecordingTap.h"
+#include "audio/Profiler.h"
+#include "audio/LatencyTracker.h"
+#include "audio/EngineMetrics.h"
+#include "audio/MetricsExporter.h"
+#include "audio/Watchdog.h"
+#include "audio/HotSwapChain.h"
+#include "audio/ChainInstance.h"
+#include "audio/StreamConfig.h"
+#include "audio/JackBackend.h"
+#include "audio/RtpBackend.h"
+#include "audio/ControlInput.h"
 #include "effects/NoiseGate.h"
 #include "effects/ThreeBandEQ.h"
 #include "effects/Limiter.h"
 #include "effects/DeEsser.h"
 #include "gui/GUIManager.h"
+#ifdef MULTIAUDIO_WITH_SNDFILE
+#include "offline/EncodedFileSink.h"
+#endif
 #include <iostream> // Needed for std::cout, std::cerr
 #include <rtaudio/RtAudio.h> // Keep this explicit include
 #include <vector>   // Ensure vector is included (likely via common.h)
 #include <algorithm> // For std::copy, std::fill_n, std::transform
 #include <cmath>     // For std::isnan, std::isinf (optional checks)
 #include <limits>    // For numeric_limits (optional checks)
+#include <cstring>   // For std::strcmp
+#include <cstdlib>   // For std::atoi
+#include <cctype>    // For std::isdigit
+#include <memory>    // For std::unique_ptr
+#include <thread>    // For std::this_thread::sleep_for
 
 #ifdef _WIN32
 #include <windows.h>
@@ -34,27 +55,238 @@ void safeResize(vector<float> &buffer, size_t newSize)
 }
 
 // --- Global Variables ---
-audio::BufferQueue inputBuffer;
-audio::BufferQueue outputBuffer;
+audio::BufferQueue inputBuffer(10, audio::TRACE_QUEUE_INPUT);
+audio::BufferQueue outputBuffer(10, audio::TRACE_QUEUE_OUTPUT);
 audio::NoiseGate noiseGate;
 audio::ThreeBandEQ eq;
 audio::Limiter limiter;
 atomic<bool> running(true);
-struct DeEsserSettings {
-    bool enabled = false; double reductionDB = 6.0; int startFreq = 4000; int endFreq = 10000;
-} deesserConfig;
+audio::DeEsserSettings deesserConfig;
+audio::EffectChain effectChain(noiseGate, eq, limiter, deesserConfig);
+audio::HotSwapChain liveChain(effectChain); // What the processing thread runs; swapped on reconfiguration
+std::unique_ptr<audio::ChainInstance> liveInstance;     // Owns the active chain once one was swapped in
+std::unique_ptr<audio::ChainInstance> retiringInstance; // Chain being faded out, freed once retired
+const audio::EffectChain* metricsChain = nullptr;        // Chain the metrics readers point at
+std::unique_ptr<audio::ChainInstance> metricsPinnedInstance; // Retired chain kept alive for those readers
+audio::StreamConfig streamConfig;   // RtAudio stream as currently opened
+std::mutex pipelineMutex;           // Serialises watchdog recovery and reconfiguration of stream and thread
+const unsigned int MAX_STREAM_FRAMES = 8192;  // Largest period the callback accepts
+const unsigned int CROSSFADE_MS = 20;         // Old-to-new chain crossfade on reconfiguration
+#ifdef MULTIAUDIO_WITH_SNDFILE
+audio::EncodedFileSink recordSink; // Live FLAC tap of the processed output (--record)
+#endif
+audio::TapRecorder archiveRecorder; // Raw input / processed output archive (--archive)
+audio::Profiler profiler;           // Per-stage chain timings (--profile, --metrics)
+audio::ThreadProfile* chainProfile = nullptr; // Profile the chain records into, nullptr when off
+audio::ParameterQueue parameterQueue;   // GUI control changes, applied by the chain between samples
+audio::ParameterRecorder automationRecorder; // Applied changes (--automation-record)
+std::string automationPath;         // Recording file, empty when not recording
+audio::ParameterQueue controlQueue(1024); // OSC / MIDI control changes (--osc, --midi)
+const std::size_t CONTROL_QUEUE_SLOT = 1; // Chain queue slot of the control thread (the GUI has 0)
+int oscPort = -1;                   // OSC UDP port, -1 when disabled
+bool midiEnabled = false;           // ALSA sequencer MIDI input (--midi)
+#ifdef __linux__
+std::unique_ptr<audio::ControlInput> controlInput;
+#endif
+std::string profilePrefix;          // Export prefix, empty when not exporting
+audio::LatencyTracker latencyTracker; // Capture-to-playout latency, drops and reorders (RtAudio path)
+std::atomic<uint64_t> rtAudioXruns(0); // Stream status reports from RtAudio
+audio::MetricsRegistry metricsRegistry; // Served by the exporter (--metrics)
+int metricsPort = -1;               // Exporter port, -1 when disabled
+#ifdef __linux__
+std::unique_ptr<audio::MetricsExporter> metricsExporter;
+#endif
+audio::Heartbeat callbackHeartbeat;   // Beaten on every RtAudio callback
+audio::Heartbeat processingHeartbeat; // Beaten for every block the processing thread outputs
+std::atomic<bool> processingActive(false); // Cleared when processingThread() returns
+bool watchdogEnabled = true;        // --no-watchdog disables automatic recovery
+const uint32_t PIPELINE_STALL_MS = 500;  // Processing thread restarted after this long without output
+const uint32_t STREAM_STALL_MS = 2000;   // Stream reopened after this long without a callback
 // --- End Global Variables ---
 
+// Opens <prefix>-input.wav and <prefix>-output.wav on the chain's pre/post taps
+bool startArchive(const std::string& prefix)
+{
+    audio::RecordingTap* pre = archiveRecorder.addTap(prefix + "-input.wav", 1);
+    audio::RecordingTap* post = archiveRecorder.addTap(prefix + "-output.wav", 1);
+    if (!pre || !post || !archiveRecorder.start()) { return false; }
+    liveChain.getActive().setTaps(pre, post);
+    return true;
+}
+
+// Call after the backend has stopped so the final blocks are on disk
+void stopArchive()
+{
+    if (!archiveRecorder.isRunning()) return;
+    liveChain.getActive().setTaps(nullptr, nullptr);
+    archiveRecorder.stop();
+    for (const auto& tap : archiveRecorder.getTaps()) {
+        std::cout << "DEBUG: Archived " << tap->getPath() << " (" << tap->getFramesWritten() << " frames, "
+                  << tap->getOverflows() << " overflows, " << tap->getDroppedFrames() << " dropped frames, "
+                  << tap->getWriteErrors() << " write errors, ring high-water "
+                  << static_cast<int>(tap->getHighWaterRatio() * 100.0) << "%"
+                  << (tap->isDirect() ? ", O_DIRECT" : "") << ")." << std::endl;
+    }
+}
+
+// Times every chain stage on whichever thread the backend runs it on
+void startProfiling(const std::string& prefix)
+{
+    profilePrefix = prefix;
+    if (!chainProfile) {
+        chainProfile = profiler.createProfile("audio");
+        liveChain.getActive().setProfile(chainProfile);
+    }
+}
+
+// Records every parameter change the chain applies, for replay with ParameterPlayer
+void startAutomationRecording(const std::string& path)
+{
+    automationPath = path;
+    liveChain.getActive().setParameterRecorder(&automationRecorder);
+}
+
+// Moves captured changes out of the recorder's ring; call regularly from the GUI loop
+void collectAutomation()
+{
+    if (!automationPath.empty()) automationRecorder.collect();
+}
+
+// Call after the backend has stopped so every applied change is captured
+void stopAutomationRecording()
+{
+    liveChain.getActive().setParameterRecorder(nullptr);
+    if (automationPath.empty()) return;
+    if (automationRecorder.save(automationPath)) {
+        std::cout << "DEBUG: Wrote " << automationRecorder.getEvents().size() << " parameter changes to "
+                  << automationPath << " (" << automationRecorder.getDropped() << " dropped)." << std::endl;
+    }
+}
+
+// Takes OSC (127.0.0.1:<oscPort>) and MIDI control changes into the chain's control queue.
+// Failure only loses the control surface, so it is reported and the session carries on.
+void startControlInput()
+{
+    if (oscPort < 0 && !midiEnabled) return;
+#ifdef __linux__
+    controlInput.reset(new audio::ControlInput(controlQueue));
+    bool opened = false;
+    if (oscPort >= 0 && controlInput->openOsc(static_cast<uint16_t>(oscPort))) {
+        std::cout << "DEBUG: Listening for OSC on udp://127.0.0.1:" << controlInput->getOscPort() << std::endl;
+        opened = true;
+    }
+    if (midiEnabled && controlInput->openMidi()) {
+        std::cout << "DEBUG: MIDI control port open (connect a controller with aconnect)." << std::endl;
+        opened = true;
+    }
+    if (!opened || !controlInput->start()) {
+        std::cerr << "ERROR: Control input unavailable; continuing without it." << std::endl;
+        controlInput.reset();
+        return;
+    }
+    liveChain.getActive().setParameterQueue(&controlQueue, CONTROL_QUEUE_SLOT);
+#else
+    std::cerr << "Warning: --osc and --midi are only supported on Linux." << std::endl;
+#endif
+}
+
+void stopControlInput()
+{
+#ifdef __linux__
+    if (!controlInput) return;
+    controlInput->stop();
+    std::cout << "DEBUG: Control input took " << controlInput->getOscMessages() << " OSC and "
+              << controlInput->getMidiMessages() << " MIDI messages (" << controlInput->getUnmappedMessages()
+              << " unmapped, " << controlInput->getMalformedPackets() << " malformed), posted "
+              << controlInput->getEventsPosted() << " changes." << std::endl;
+    controlInput.reset();
+#endif
+}
+
+// Call after the backend has stopped; writes <prefix>-trace.json and <prefix>.folded
+void stopProfiling()
+{
+    liveChain.getActive().setProfile(nullptr);
+    if (profilePrefix.empty()) return;
+    if (profiler.exportChromeTrace(profilePrefix + "-trace.json") &&
+        profiler.exportFoldedStacks(profilePrefix + ".folded")) {
+        std::cout << "DEBUG: Wrote profile to " << profilePrefix << "-trace.json and "
+                  << profilePrefix << ".folded" << std::endl;
+    }
+}
+
+// Registers a chain's, the backend's and the per-stage metrics. The readers keep a pointer to
+// the chain: re-register (after clearing) before that chain can be freed.
+void registerEngineMetrics(const std::string& backend, audio::MetricsRegistry::ValueReader readXruns,
+                           audio::EffectChain& chain)
+{
+    audio::registerChainMetrics(metricsRegistry, chain);
+    audio::registerXrunMetric(metricsRegistry, backend, std::move(readXruns));
+    audio::registerProfileMetrics(metricsRegistry, *chainProfile);
+    metricsChain = &chain;
+    if (metricsPinnedInstance && &metricsPinnedInstance->getChain() != metricsChain) { metricsPinnedInstance.reset(); }
+}
+
+// Frees the chain that has faded out, unless the metrics still read it (then it waits for re-registration)
+void releaseRetiredChain()
+{
+    if (!liveChain.takeRetired() || !retiringInstance) return;
+    if (&retiringInstance->getChain() == metricsChain) { metricsPinnedInstance = std::move(retiringInstance); return; }
+    retiringInstance.reset();
+}
+
+// Serves chain, backend and (when profiled) per-stage metrics on 127.0.0.1:<metricsPort>
+bool startMetrics(const std::string& backend, audio::MetricsRegistry::ValueReader readXruns)
+{
+    if (metricsPort < 0) return true;
+#ifdef __linux__
+    if (!chainProfile) { startProfiling(""); } // Per-effect CPU time comes from the profiler
+    registerEngineMetrics(backend, std::move(readXruns), liveChain.getActive());
+    metricsExporter.reset(new audio::MetricsExporter(metricsRegistry, static_cast<uint16_t>(metricsPort)));
+    if (!metricsExporter->start()) { return false; }
+    std::cout << "DEBUG: Serving metrics on http://127.0.0.1:" << metricsExporter->getPort() << "/metrics" << std::endl;
+#else
+    (void)backend; (void)readXruns;
+    std::cerr << "Warning: --metrics is only supported on Linux." << std::endl;
+#endif
+    return true;
+}
+
+// Call before the backend objects the readers refer to are destroyed
+void stopMetrics()
+{
+#ifdef __linux__
+    if (metricsExporter) {
+        std::cout << "DEBUG: Metrics exporter served " << metricsExporter->getScrapes() << " scrapes." << std::endl;
+        metricsExporter->stop();
+        metricsExporter.reset();
+    }
+#endif
+    metricsRegistry.clear();
+}
+
 int audioCallback(void *outputBufferCallback, void *inputBufferCallback, unsigned int nFrames,
                   double streamTime, RtAudioStreamStatus status, void *userData)
 {
-    static vector<float> fixedInBuffer(FRAMES_PER_BUFFER * NUM_CHANNELS + 64); // Uses NUM_CHANNELS from common.h
+    static vector<float> fixedInBuffer(MAX_STREAM_FRAMES * NUM_CHANNELS + 64); // Uses NUM_CHANNELS from common.h
+    static uint64_t callbackSequence = 0; // Periods seen by this callback (block headers, tracepoints)
+    const uint64_t sequence = callbackSequence++;
+    audio::BlockHeader captureHeader;
+    captureHeader.sequence = sequence;
+    captureHeader.streamTime = streamTime;
+    captureHeader.stamp(audio::BlockStage::Capture);
+    MULTIAUDIO_TRACE3(callback_entry, audio::TRACE_STREAM_RTAUDIO, sequence, nFrames);
+    callbackHeartbeat.beat();
 
     float *input = static_cast<float *>(inputBufferCallback);
     float *output = static_cast<float *>(outputBufferCallback);
     size_t samplesAvailable = nFrames * NUM_CHANNELS; // Total samples for all channels
 
-    if (status) { std::cerr << "Warning: Audio stream status: " << status << std::endl; }
+    if (status) {
+        MULTIAUDIO_TRACE2(xrun, audio::TRACE_STREAM_RTAUDIO, sequence);
+        rtAudioXruns.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Warning: Audio stream status: " << status << std::endl;
+    }
     if (samplesAvailable > fixedInBuffer.size()) {
         std::cerr << "ERROR: nFrames (" << nFrames << ") * NUM_CHANNELS (" << NUM_CHANNELS
                   << ") exceeds fixedInBuffer size in audioCallback!" << std::endl;
@@ -65,13 +297,17 @@ int audioCallback(void *outputBufferCallback, void *inputBufferCallback, unsigne
     std::copy(input, input + samplesAvailable, fixedInBuffer.begin());
     // Push exact amount to processing thread
     vector<float> currentInput(fixedInBuffer.begin(), fixedInBuffer.begin() + samplesAvailable);
-    ::inputBuffer.push(currentInput);
+    ::inputBuffer.push(currentInput, captureHeader);
 
     // Attempt to get processed data
     vector<float> currentOutput; // Let pop resize this
-    bool pop_success = ::outputBuffer.pop(currentOutput); // <<<--- Check success
+    audio::BlockHeader playoutHeader;
+    bool pop_success = ::outputBuffer.pop(currentOutput, playoutHeader); // <<<--- Check success
 
     if (pop_success) {
+        playoutHeader.stamp(audio::BlockStage::Playout);
+        latencyTracker.record(playoutHeader);
+
         // --- Debug Print (Success Case) ---
         // Uncomment the next line to verify pops are succeeding (can be verbose)
         // std::cout << "DEBUG: audioCallback pop SUCCESS (size: " << currentOutput.size() << ")" << std::endl;
@@ -93,6 +329,7 @@ int audioCallback(void *outputBufferCallback, void *inputBufferCallback, unsigne
         if (running.load()) { /* Log persistent underruns if needed */ }
         std::fill_n(output, samplesAvailable, 0.0f); // Output silence
     }
+    MULTIAUDIO_TRACE4(callback_exit, audio::TRACE_STREAM_RTAUDIO, sequence, nFrames, pop_success ? 0 : 1);
     return 0;
 }
 
@@ -111,25 +348,24 @@ void processingThread()
 #endif
 
     // Adjust buffer sizes based on actual NUM_CHANNELS
-    const size_t MAX_EXPECTED_FRAMES = FRAMES_PER_BUFFER * 2; // Max frames expected
+    const size_t MAX_EXPECTED_FRAMES = streamConfig.bufferFrames * 2; // Max frames expected
     const size_t PADDED_BUFFER_FRAMES = MAX_EXPECTED_FRAMES + 64; // Frame padding
 
     vector<float> inputData; // Pop resizes this
+    audio::BlockHeader header; // Travels with the block from capture to playout
     vector<float> monoChannel(PADDED_BUFFER_FRAMES); // Buffer for mono processing
-    vector<float> gateOutput(PADDED_BUFFER_FRAMES);
-    vector<float> eqOutput(PADDED_BUFFER_FRAMES);
-    vector<float> deessedData(PADDED_BUFFER_FRAMES);
     vector<float> limiterOutput(PADDED_BUFFER_FRAMES); // Final mono processed stage
     vector<float> outputData; // Final stereo (or multi-channel) output
-    vector<double> tempDeEsser(PADDED_BUFFER_FRAMES);
+    liveChain.prepare(PADDED_BUFFER_FRAMES);
 
     std::cout << "[Processing Thread] Entering main loop." << std::endl;
     while (running.load()) {
-        if (!inputBuffer.pop(inputData)) {
+        if (!inputBuffer.pop(inputData, header)) {
             if (running.load()) { std::cerr << "[Processing Thread] Warning: inputBuffer.pop failed while running." << std::endl; }
             else { std::cout << "[Processing Thread] Input buffer done, exiting loop." << std::endl; }
             break;
         }
+        header.stamp(audio::BlockStage::Dequeue);
         size_t samplesReceived = inputData.size();
         if (samplesReceived == 0) { std::cerr << "[Processing Thread] Warning: Received empty input buffer." << std::endl; continue; }
         if (samplesReceived % NUM_CHANNELS != 0) {
@@ -140,11 +376,8 @@ void processingThread()
 
         // Ensure intermediate buffers are large enough for MONO processing
         if (monoChannel.size() < numFrames) monoChannel.resize(numFrames);
-        if (gateOutput.size() < numFrames) gateOutput.resize(numFrames);
-        if (eqOutput.size() < numFrames) eqOutput.resize(numFrames);
-        if (deessedData.size() < numFrames) deessedData.resize(numFrames);
         if (limiterOutput.size() < numFrames) limiterOutput.resize(numFrames);
-        if (tempDeEsser.size() < numFrames) tempDeEsser.resize(numFrames);
+        if (liveChain.getActive().getMaxFrames() < numFrames) liveChain.prepare(numFrames);
 
         // Extract first channel for mono processing
         // Assumes interleaved inputData: [L1, R1, L2, R2, ...]
@@ -153,26 +386,23 @@ void processingThread()
         }
 
         // --- Effects Chain (on mono data) ---
-        noiseGate.process(monoChannel.data(), gateOutput.data(), numFrames);
-        eq.process(gateOutput.data(), eqOutput.data(), numFrames);
-
-        const float* deesserInputPtr = eqOutput.data();
-        if (deesserConfig.enabled) {
-            std::copy(eqOutput.begin(), eqOutput.begin() + numFrames, tempDeEsser.begin());
-            audio::applyDeEsser(tempDeEsser, SAMPLE_RATE, deesserConfig.startFreq, deesserConfig.endFreq, deesserConfig.reductionDB);
-            std::transform(tempDeEsser.begin(), tempDeEsser.begin() + numFrames, deessedData.begin(), [](double x){ return static_cast<float>(x); });
-            deesserInputPtr = deessedData.data();
-        }
-        limiter.process(deesserInputPtr, limiterOutput.data(), numFrames); // limiterOutput is mono
+        liveChain.process(monoChannel.data(), limiterOutput.data(), numFrames); // limiterOutput is mono
+        header.stamp(audio::BlockStage::Processed);
+        if (liveChain.isOutputSilent()) header.flags |= audio::BLOCK_FLAG_SILENT; // Gated: all zeros
+        if (liveChain.isSpeech()) header.flags |= audio::BLOCK_FLAG_SPEECH;
 
         // --- Prepare Output Buffer ---
         size_t outputSamples = numFrames * NUM_CHANNELS; // Total samples for output
         outputData.resize(outputSamples);
 
-        // Duplicate processed mono data to all output channels (dual mono if NUM_CHANNELS=2)
-        for (size_t i = 0; i < numFrames; ++i) {
-            for (unsigned int ch = 0; ch < NUM_CHANNELS; ++ch) {
-                 outputData[i * NUM_CHANNELS + ch] = limiterOutput[i];
+        if (header.isSilent()) {
+            std::fill(outputData.begin(), outputData.end(), 0.0f);
+        } else {
+            // Duplicate processed mono data to all output channels (dual mono if NUM_CHANNELS=2)
+            for (size_t i = 0; i < numFrames; ++i) {
+                for (unsigned int ch = 0; ch < NUM_CHANNELS; ++ch) {
+                     outputData[i * NUM_CHANNELS + ch] = limiterOutput[i];
+                }
             }
         }
 
@@ -201,15 +431,357 @@ void processingThread()
         //           << ", min=" << minVal << ", max=" << maxVal << std::endl;
         // // --- End check ---
 
+#ifdef MULTIAUDIO_WITH_SNDFILE
+        // Non-blocking: encoding and disk I/O happen on the sink's own thread
+        if (recordSink.isOpen()) { recordSink.write(outputData.data(), numFrames); }
+#endif
+
         // Push the final data to the output queue
-        outputBuffer.push(outputData);
+        header.stamp(audio::BlockStage::Enqueue);
+        outputBuffer.push(outputData, header);
+        processingHeartbeat.beat();
     }
     std::cout << "[Processing Thread] Exited main loop." << std::endl;
+    processingActive.store(false);
+}
+
+// Starts processingThread() on freshly emptied queues
+void startPipeline(thread& procThread)
+{
+    inputBuffer.reset(); outputBuffer.reset();
+    processingActive.store(true);
+    procThread = thread(::processingThread);
+}
+
+// Wakes the processing thread out of its queue waits and joins it.
+// Returns false (without joining) if it is stuck elsewhere and did not exit within a second.
+bool stopPipeline(thread& procThread)
+{
+    inputBuffer.setDone(); outputBuffer.setDone();
+    for (int waited = 0; waited < 100 && processingActive.load(); ++waited) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (processingActive.load()) {
+        std::cerr << "ERROR: Processing thread did not exit; cannot restart it yet." << std::endl;
+        return false;
+    }
+    if (procThread.joinable()) procThread.join();
+    return true;
+}
+
+// Opens the duplex stream described by config; bufferFrames is updated to the driver's choice
+bool openAudioStream(RtAudio& audio, audio::StreamConfig& config)
+{
+    RtAudio::StreamParameters inputParams;
+    inputParams.deviceId = config.inputDevice; inputParams.nChannels = NUM_CHANNELS; inputParams.firstChannel = 0;
+    RtAudio::StreamParameters outputParams;
+    outputParams.deviceId = config.outputDevice; outputParams.nChannels = NUM_CHANNELS; outputParams.firstChannel = 0;
+
+    unsigned int bufferFrames = config.bufferFrames;
+    if (audio.openStream(&outputParams, &inputParams, RTAUDIO_FLOAT32, config.sampleRate,
+                         &bufferFrames, &audioCallback, nullptr) != RTAUDIO_NO_ERROR) {
+        std::cerr << "ERROR: Failed to open RtAudio stream: " << audio.getErrorText() << std::endl;
+        return false;
+    }
+    if (bufferFrames > MAX_STREAM_FRAMES) {
+        std::cerr << "ERROR: Driver chose " << bufferFrames << " frames per period (max " << MAX_STREAM_FRAMES << ")." << std::endl;
+        audio.closeStream();
+        return false;
+    }
+    config.bufferFrames = bufferFrames;
+    return true;
+}
+
+void closeAudioStream(RtAudio& audio)
+{
+    if (!audio.isStreamOpen()) return;
+    if (audio.isStreamRunning()) audio.abortStream();
+    audio.closeStream();
+}
+
+// Devices with enough channels for either direction of the duplex stream
+std::vector<audio::DeviceOption> listAudioDevices(RtAudio& audio)
+{
+    std::vector<audio::DeviceOption> devices;
+    for (unsigned int id : audio.getDeviceIds()) {
+        RtAudio::DeviceInfo info = audio.getDeviceInfo(id);
+        if (info.inputChannels < NUM_CHANNELS && info.outputChannels < NUM_CHANNELS) continue;
+        audio::DeviceOption option;
+        option.id = id; option.name = info.name;
+        option.inputChannels = info.inputChannels; option.outputChannels = info.outputChannels;
+        devices.push_back(option);
+    }
+    return devices;
+}
+
+// Moves the RtAudio path to another device, sample rate or buffer size without restarting.
+// The new chain (effects, FFT plans, buffers) is built while the old stream keeps playing;
+// the outage is only the stream close/open, and the first 20 ms of the new stream crossfade
+// from the old chain to the new one. Returns false with the old stream restored on failure.
+bool reconfigureStream(RtAudio& audio, thread& procThread, const audio::StreamConfig& request, std::string& status)
+{
+    // Collect a finished swap first; one swap is in flight at a time
+    releaseRetiredChain();
+    if (liveChain.isSwapping()) { status = "Previous reconfiguration is still crossfading."; return false; }
+
+    const uint64_t buildStart = audio::blockClockNanos();
+    std::unique_ptr<audio::ChainInstance> next(new audio::ChainInstance(request.sampleRate, request.bufferFrames));
+    audio::EffectChain& current = liveChain.getActive();
+    if (liveInstance) {
+        next->copySettings(liveInstance->getNoiseGate(), liveInstance->getEQ(), liveInstance->getLimiter(), liveInstance->getDeEsser());
+    } else {
+        next->copySettings(noiseGate, eq, limiter, deesserConfig);
+    }
+    const double buildMs = (audio::blockClockNanos() - buildStart) / 1e6;
+
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    const uint64_t outageStart = audio::blockClockNanos();
+    if (!stopPipeline(procThread)) { status = "Processing thread did not stop; nothing changed."; return false; }
+    closeAudioStream(audio);
+
+    audio::StreamConfig opened = request;
+    if (!openAudioStream(audio, opened)) {
+        status = "Could not open the requested configuration: " + audio.getErrorText();
+        // Back to the configuration that worked
+        if (openAudioStream(audio, streamConfig)) {
+            startPipeline(procThread);
+            audio.startStream();
+        }
+        return false;
+    }
+    if (opened.bufferFrames != next->getBlockFrames()) {
+        // The driver chose another period than the chain was built for
+        const size_t maxFrames = static_cast<size_t>(std::max(opened.bufferFrames, next->getBlockFrames())) * 2;
+        next->getChain().prepare(maxFrames, opened.bufferFrames);
+    }
+    streamConfig = opened;
+
+    // Nothing is processing: the old chain can be sized for the new periods it will see while fading out
+    next->getChain().inheritFrom(current);
+    liveChain.prepare(static_cast<size_t>(opened.bufferFrames) * 2);
+    liveChain.stage(next->getChain(), static_cast<size_t>(opened.sampleRate) * CROSSFADE_MS / 1000);
+    retiringInstance = std::move(liveInstance);
+    liveInstance = std::move(next);
+
+    startPipeline(procThread);
+    if (audio.startStream() != RTAUDIO_NO_ERROR) {
+        status = "Stream opened but did not start: " + audio.getErrorText();
+        return false;
+    }
+    status = "Running " + std::to_string(opened.sampleRate) + " Hz, " + std::to_string(opened.bufferFrames) +
+             " frames (chain built in " + std::to_string(static_cast<int>(buildMs)) + " ms, stream switched in " +
+             std::to_string(static_cast<int>((audio::blockClockNanos() - outageStart) / 1e6)) + " ms).";
+    return true;
+}
+
+#ifdef MULTIAUDIO_WITH_JACK
+// Runs the chain inside the JACK (or PipeWire-JACK) process callback.
+// No RtAudio stream, BufferQueue or processing thread is involved.
+int runJackBackend()
+{
+    std::cout << "DEBUG: Using native JACK backend." << std::endl;
+    audio::JackBackend jack(effectChain, NUM_CHANNELS);
+    if (!jack.open()) {
+        std::cerr << "ERROR: Failed to start JACK backend" << std::endl;
+        return 1;
+    }
+    if (jack.getSampleRate() != effectChain.getSampleRate()) {
+        // The server picks the rate: run a chain built for it, carrying the settings and attachments over
+        liveInstance.reset(new audio::ChainInstance(jack.getSampleRate(), jack.getBufferSize()));
+        liveInstance->copySettings(noiseGate, eq, limiter, deesserConfig);
+        liveChain.replace(liveInstance->getChain());
+        jack.setChain(liveInstance->getChain());
+        std::cout << "DEBUG: Effect chain rebuilt for the server's " << jack.getSampleRate() << " Hz." << std::endl;
+    }
+    if (!jack.start()) {
+        std::cerr << "ERROR: Failed to start JACK backend" << std::endl;
+        return 1;
+    }
+    std::cout << "DEBUG: JACK client running (" << jack.getSampleRate() << " Hz, "
+              << jack.getBufferSize() << " frames/period)." << std::endl;
+    startControlInput();
+    if (!startMetrics("jack", [&jack] { return static_cast<double>(jack.getXrunCount()); })) {
+        std::cerr << "ERROR: Failed to start metrics exporter" << std::endl;
+        jack.stop();
+        return 1;
+    }
+
+    gui::GUIManager guiManager(noiseGate, eq, limiter, deesserConfig.enabled, deesserConfig.reductionDB, deesserConfig.startFreq, deesserConfig.endFreq);
+    if (liveInstance) {
+        audio::ChainInstance& instance = *liveInstance;
+        guiManager.bindEffects(instance.getNoiseGate(), instance.getEQ(), instance.getLimiter(),
+                               instance.getDeEsser().enabled, instance.getDeEsser().reductionDB,
+                               instance.getDeEsser().startFreq, instance.getDeEsser().endFreq);
+    }
+    guiManager.setProfiler(chainProfile ? &profiler : nullptr);
+    guiManager.setParameterQueue(&parameterQueue);
+    if (!guiManager.initialize()) {
+        cerr << "ERROR: Failed to initialize GUI" << endl;
+        stopMetrics();
+        jack.stop();
+        return 1;
+    }
+
+    while (running.load() && guiManager.isRunning() && jack.isRunning()) {
+        guiManager.update();
+        collectAutomation();
+    }
+    if (!jack.isRunning()) {
+        if (jack.getSampleRate() != jack.getChain().getSampleRate()) {
+            std::cerr << "ERROR: JACK server switched to " << jack.getSampleRate() << " Hz; the effect chain runs at "
+                      << jack.getChain().getSampleRate() << " Hz." << std::endl;
+        } else {
+            std::cerr << "ERROR: JACK server shut down." << std::endl;
+        }
+    }
+
+    running.store(false);
+    std::cout << "DEBUG: Stopping JACK client (xruns: " << jack.getXrunCount() << ")." << std::endl;
+    stopMetrics();
+    jack.stop();
+    stopArchive();
+    stopProfiling();
+    stopControlInput();
+    stopAutomationRecording();
+    return 0;
+}
+#endif
+
+#ifdef __linux__
+// Takes input from an RTP (AES67-style L24) stream and sends the processed
+// result as another RTP stream. No sound card is involved.
+int runRtpBackend(const audio::RtpConfig& config)
+{
+    std::cout << "DEBUG: Using RTP backend (listen " << config.bindAddress << ":" << config.listenPort
+              << ", send " << config.destAddress << ":" << config.destPort << ")." << std::endl;
+    audio::RtpBackend rtp(effectChain, config);
+    if (!rtp.start()) {
+        std::cerr << "ERROR: Failed to start RTP backend" << std::endl;
+        return 1;
+    }
+    startControlInput();
+    if (!startMetrics("rtp", [&rtp] { return static_cast<double>(rtp.getDeadlineMisses()); })) {
+        std::cerr << "ERROR: Failed to start metrics exporter" << std::endl;
+        rtp.stop();
+        return 1;
+    }
+
+    gui::GUIManager guiManager(noiseGate, eq, limiter, deesserConfig.enabled, deesserConfig.reductionDB, deesserConfig.startFreq, deesserConfig.endFreq);
+    guiManager.setProfiler(chainProfile ? &profiler : nullptr);
+    guiManager.setParameterQueue(&parameterQueue);
+    if (!guiManager.initialize()) {
+        cerr << "ERROR: Failed to initialize GUI" << endl;
+        stopMetrics();
+        rtp.stop();
+        return 1;
+    }
+
+    while (running.load() && guiManager.isRunning()) {
+        guiManager.update();
+        collectAutomation();
+    }
+
+    running.store(false);
+    const audio::JitterBuffer& jitter = rtp.getJitterBuffer();
+    std::cout << "DEBUG: Stopping RTP backend (received " << jitter.getPacketsReceived()
+              << ", lost " << jitter.getPacketsLost() << ", late " << jitter.getPacketsLate()
+              << ", underruns " << jitter.getUnderruns() << ", drift " << rtp.getDriftPpm() << " ppm)." << std::endl;
+    stopMetrics();
+    rtp.stop();
+    stopArchive();
+    stopProfiling();
+    stopControlInput();
+    stopAutomationRecording();
+    return 0;
 }
+#endif
 
-int main()
+int main(int argc, char* argv[])
 {
     std::cout << "DEBUG: main() started." << std::endl;
+    liveChain.getActive().setParameterQueue(&parameterQueue);
+    for (int i = 1; i < argc; ++i) {
+        // --archive <prefix>: must come before a backend flag
+        if (std::strcmp(argv[i], "--archive") == 0 && i + 1 < argc) {
+            if (!startArchive(argv[++i])) {
+                std::cerr << "ERROR: Failed to start archive " << argv[i] << std::endl;
+                return 1;
+            }
+            std::cout << "DEBUG: Archiving chain input/output to " << argv[i] << "-{input,output}.wav" << std::endl;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--no-watchdog") == 0) { watchdogEnabled = false; continue; }
+        // --automation-record <file>: must come before a backend flag
+        if (std::strcmp(argv[i], "--automation-record") == 0 && i + 1 < argc) {
+            startAutomationRecording(argv[++i]);
+            std::cout << "DEBUG: Recording parameter changes to " << argv[i] << std::endl;
+            continue;
+        }
+        // --metrics [port]: must come before a backend flag
+        if (std::strcmp(argv[i], "--metrics") == 0) {
+            metricsPort = 9464;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                metricsPort = std::atoi(argv[++i]);
+            }
+            continue;
+        }
+        // --osc [port] and --midi: control surface input, must come before a backend flag
+        if (std::strcmp(argv[i], "--osc") == 0) {
+            oscPort = 9000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                oscPort = std::atoi(argv[++i]);
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--midi") == 0) { midiEnabled = true; continue; }
+        // --sidechain: the gate detects from the decimated side-chain, whose band levels --metrics exports
+        if (std::strcmp(argv[i], "--sidechain") == 0) {
+            liveChain.getActive().setSideChainDetection(true);
+            continue;
+        }
+        // --vad: classify blocks as speech; --vad-skip also skips the EQ, de-esser and post tap between speech
+        if (std::strcmp(argv[i], "--vad") == 0 || std::strcmp(argv[i], "--vad-skip") == 0) {
+            liveChain.getActive().setVoiceActivityDetection(true);
+            liveChain.getActive().setSkipNonSpeech(std::strcmp(argv[i], "--vad-skip") == 0);
+            continue;
+        }
+        // --aec: cancel the echo of what the chain plays (monitoring through speakers) from the mic
+        if (std::strcmp(argv[i], "--aec") == 0) {
+            liveChain.getActive().setEchoCancellation(true);
+            continue;
+        }
+        // --profile <prefix>: must come before a backend flag
+        if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            startProfiling(argv[++i]);
+            std::cout << "DEBUG: Profiling chain stages to " << argv[i] << "-trace.json / .folded" << std::endl;
+            continue;
+        }
+#ifdef MULTIAUDIO_WITH_JACK
+        if (std::strcmp(argv[i], "--jack") == 0) { return runJackBackend(); }
+#endif
+#ifdef __linux__
+        // --rtp [listenPort] [destAddress] [destPort]
+        if (std::strcmp(argv[i], "--rtp") == 0) {
+            audio::RtpConfig config;
+            if (i + 1 < argc) config.listenPort = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+            if (i + 2 < argc) config.destAddress = argv[i + 2];
+            if (i + 3 < argc) config.destPort = static_cast<uint16_t>(std::atoi(argv[i + 3]));
+            return runRtpBackend(config);
+        }
+#endif
+#ifdef MULTIAUDIO_WITH_SNDFILE
+        // --record <file.flac>
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            audio::SinkConfig sinkConfig;
+            sinkConfig.blockFrames = FRAMES_PER_BUFFER;
+            if (!recordSink.open(argv[++i], NUM_CHANNELS, SAMPLE_RATE, sinkConfig)) {
+                std::cerr << "ERROR: Failed to open recording file " << argv[i] << std::endl;
+                return 1;
+            }
+            std::cout << "DEBUG: Recording processed output to " << argv[i] << std::endl;
+        }
+#endif
+    }
     try {
         std::cout << "DEBUG: Creating RtAudio object..." << std::endl;
 #ifdef _WIN32
@@ -223,28 +795,65 @@ int main()
         if (audio.getDeviceCount() < 1) { cerr << "ERROR: No audio devices detected" << endl; return 1; }
         std::cout << "DEBUG: Audio device count checked (" << audio.getDeviceCount() << ")." << std::endl;
 
-        RtAudio::StreamParameters inputParams;
-        inputParams.deviceId = audio.getDefaultInputDevice(); inputParams.nChannels = NUM_CHANNELS; inputParams.firstChannel = 0;
-        std::cout << "DEBUG: Input parameters set (Device: " << inputParams.deviceId << ", Channels: " << inputParams.nChannels << ")." << std::endl;
-
-        RtAudio::StreamParameters outputParams;
-        outputParams.deviceId = audio.getDefaultOutputDevice(); outputParams.nChannels = NUM_CHANNELS; outputParams.firstChannel = 0;
-        std::cout << "DEBUG: Output parameters set (Device: " << outputParams.deviceId << ", Channels: " << outputParams.nChannels << ")." << std::endl;
-
-        unsigned int bufferFrames = FRAMES_PER_BUFFER;
-        std::cout << "DEBUG: Buffer frames variable set to " << bufferFrames << "." << std::endl;
+        streamConfig.inputDevice = audio.getDefaultInputDevice();
+        streamConfig.outputDevice = audio.getDefaultOutputDevice();
+        std::cout << "DEBUG: Stream parameters set (Input device: " << streamConfig.inputDevice << ", Output device: "
+                  << streamConfig.outputDevice << ", Channels: " << NUM_CHANNELS << ", Buffer frames: "
+                  << streamConfig.bufferFrames << ")." << std::endl;
 
         std::cout << "DEBUG: Opening audio stream..." << std::endl;
-        RtAudioErrorType openResult = audio.openStream(
-            &outputParams, &inputParams, RTAUDIO_FLOAT32, SAMPLE_RATE, &bufferFrames, &audioCallback, nullptr);
-        if (openResult != RTAUDIO_NO_ERROR) {
-             std::cerr << "ERROR: Failed to open RtAudio stream: " << audio.getErrorText() << std::endl;
-             return 1;
+        if (!openAudioStream(audio, streamConfig)) { return 1; }
+        std::cout << "DEBUG: Audio stream opened (bufferFrames possibly adjusted to: " << streamConfig.bufferFrames << ")." << std::endl;
+
+        effectChain.setStreamId(audio::TRACE_STREAM_RTAUDIO);
+        effectChain.prepare(static_cast<size_t>(streamConfig.bufferFrames) * 2, streamConfig.bufferFrames);
+
+        // Supervision: a wedged processing thread is restarted first; a silent or failed
+        // device gets the stream reopened. The pipeline only counts as stalled while callbacks
+        // keep delivering input, so a dead device is not blamed on it. Effect settings live in
+        // the effect objects and survive both.
+        thread procThread;
+        audio::Watchdog watchdog;
+        watchdog.addComponent("pipeline", processingHeartbeat, PIPELINE_STALL_MS, [&procThread] {
+            std::lock_guard<std::mutex> lock(pipelineMutex);
+            if (!stopPipeline(procThread)) return false;
+            startPipeline(procThread);
+            return true;
+        }, &callbackHeartbeat);
+        const size_t streamComponent = watchdog.addComponent("stream", callbackHeartbeat, STREAM_STALL_MS, [&] {
+            std::lock_guard<std::mutex> lock(pipelineMutex);
+            if (!stopPipeline(procThread)) return false;
+            closeAudioStream(audio);
+            if (!openAudioStream(audio, streamConfig)) {
+                // The configured devices may be gone (e.g. an unplugged interface): fall back to the defaults
+                streamConfig.inputDevice = audio.getDefaultInputDevice();
+                streamConfig.outputDevice = audio.getDefaultOutputDevice();
+                if (!openAudioStream(audio, streamConfig)) return false;
+            }
+            startPipeline(procThread);
+            return audio.startStream() == RTAUDIO_NO_ERROR;
+        });
+        audio.setErrorCallback([&watchdog, streamComponent](RtAudioErrorType type, const std::string& errorText) {
+            std::cerr << (type == RTAUDIO_WARNING ? "Warning: " : "ERROR: ") << "RtAudio: " << errorText << std::endl;
+            if (type != RTAUDIO_WARNING) watchdog.reportFault(streamComponent, "device error");
+        });
+
+        auto readXruns = [] { return static_cast<double>(rtAudioXruns.load(std::memory_order_relaxed)); };
+        auto registerPipelineMetrics = [&watchdog] {
+            audio::registerQueueMetrics(metricsRegistry, inputBuffer, "input");
+            audio::registerQueueMetrics(metricsRegistry, outputBuffer, "output");
+            audio::registerLatencyMetrics(metricsRegistry, latencyTracker);
+            audio::registerWatchdogMetrics(metricsRegistry, watchdog);
+        };
+        registerPipelineMetrics();
+        startControlInput();
+        if (!startMetrics("rtaudio", readXruns)) {
+            std::cerr << "ERROR: Failed to start metrics exporter" << std::endl;
+            audio.closeStream();
+            return 1;
         }
-        std::cout << "DEBUG: Audio stream opened (bufferFrames possibly adjusted to: " << bufferFrames << ")." << std::endl;
-
         std::cout << "DEBUG: Starting processing thread..." << std::endl;
-        thread procThread(::processingThread);
+        startPipeline(procThread);
         std::cout << "DEBUG: Processing thread object created." << std::endl;
 
         std::cout << "DEBUG: Starting audio stream..." << std::endl;
@@ -259,6 +868,9 @@ int main()
 
         std::cout << "DEBUG: Initializing GUIManager..." << std::endl;
         gui::GUIManager guiManager(noiseGate, eq, limiter, deesserConfig.enabled, deesserConfig.reductionDB, deesserConfig.startFreq, deesserConfig.endFreq);
+        guiManager.setProfiler(chainProfile ? &profiler : nullptr);
+        guiManager.setParameterQueue(&parameterQueue);
+        guiManager.setDevices(listAudioDevices(audio), streamConfig);
         std::cout << "DEBUG: GUIManager object created." << std::endl;
 
         std::cout << "DEBUG: Calling guiManager.initialize()..." << std::endl;
@@ -270,14 +882,51 @@ int main()
         }
         std::cout << "DEBUG: guiManager.initialize() successful." << std::endl;
 
+        if (watchdogEnabled) { watchdog.start(); std::cout << "DEBUG: Watchdog started." << std::endl; }
+
         std::cout << "DEBUG: Entering main GUI loop..." << std::endl;
         while (running.load() && guiManager.isRunning()) {
             guiManager.update();
+            collectAutomation();
             // std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            audio::StreamConfig request;
+            if (guiManager.takeDeviceRequest(request)) {
+                std::string status;
+                const audio::ChainInstance* previousInstance = liveInstance.get();
+                reconfigureStream(audio, procThread, request, status);
+                if (liveInstance && liveInstance.get() != previousInstance) {
+                    // Controls and scrapes follow the new chain (even if its stream then failed to start).
+                    // It is only staged: getActive() would still be the chain now retiring, which is freed
+                    // once faded out, so register the staged chain before that can happen.
+                    audio::ChainInstance& instance = *liveInstance;
+                    guiManager.bindEffects(instance.getNoiseGate(), instance.getEQ(), instance.getLimiter(),
+                                           instance.getDeEsser().enabled, instance.getDeEsser().reductionDB,
+                                           instance.getDeEsser().startFreq, instance.getDeEsser().endFreq);
+                    if (metricsPort >= 0 && chainProfile) {
+                        metricsRegistry.clear();
+                        registerPipelineMetrics();
+                        registerEngineMetrics("rtaudio", readXruns, instance.getChain());
+                    }
+                }
+                std::cout << "DEBUG: Reconfiguration: " << status << std::endl;
+                // The watchdog may reopen the stream meanwhile, and RtAudio is not thread-safe
+                audio::StreamConfig current;
+                std::vector<audio::DeviceOption> devices;
+                {
+                    std::lock_guard<std::mutex> lock(pipelineMutex);
+                    current = streamConfig;
+                    devices = listAudioDevices(audio);
+                }
+                guiManager.setDevices(devices, current);
+                guiManager.setDeviceStatus(status);
+            }
+            releaseRetiredChain(); // Old chain has faded out
         }
         std::cout << "DEBUG: Exited main GUI loop." << std::endl;
 
         std::cout << "DEBUG: Initiating shutdown..." << std::endl;
+        watchdog.stop(); // No recovery may touch the stream or thread from here on
         running.store(false);
 
         std::cout << "DEBUG: Stopping/closing audio stream..." << std::endl;
@@ -292,6 +941,29 @@ int main()
         std::cout << "DEBUG: Joining processing thread..." << std::endl;
         if (procThread.joinable()) { procThread.join(); std::cout << "DEBUG: Processing thread joined." << std::endl;
         } else { std::cout << "DEBUG: Processing thread was not joinable." << std::endl; }
+        stopMetrics();
+        stopArchive();
+        stopProfiling();
+        stopControlInput();
+        stopAutomationRecording();
+        std::cout << "DEBUG: Played " << latencyTracker.getBlocks() << " blocks (latency mean "
+                  << latencyTracker.getMeanLatencyMs() << " ms, min " << latencyTracker.getMinLatencyMs()
+                  << " ms, max " << latencyTracker.getMaxLatencyMs() << " ms; " << latencyTracker.getDropped()
+                  << " dropped, " << latencyTracker.getReordered() << " reordered)." << std::endl;
+        for (const audio::RecoveryEvent& event : watchdog.getEvents()) {
+            std::cout << "DEBUG: Recovery of " << event.component << " (" << event.reason << ", attempt "
+                      << event.attempt << ", stalled " << event.stalledMs << " ms): "
+                      << (event.recovered ? "recovered" : "failed") << std::endl;
+        }
+
+#ifdef MULTIAUDIO_WITH_SNDFILE
+        if (recordSink.isOpen()) {
+            uint64_t overflows = recordSink.getOverflows();
+            recordSink.close();
+            std::cout << "DEBUG: Recording closed (" << recordSink.getFramesWritten() << " frames, "
+                      << overflows << " overflows)." << std::endl;
+        }
+#endif
 
         std::cout << "DEBUG: GUI cleanup (implicit via destructor)..." << std::endl;
         std::cout << "DEBUG: Shutdown sequence complete." << std::endl;
@@ -0,0 +1,271 @@
+#include "EncodedFileSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace audio {
+
+namespace {
+
+int toSndfileFormat(SinkFormat format)
+{
+    switch (format)
+    {
+        case SinkFormat::WavFloat: return SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+        case SinkFormat::Wav24:    return SF_FORMAT_WAV | SF_FORMAT_PCM_24;
+        case SinkFormat::Flac:     return SF_FORMAT_FLAC | SF_FORMAT_PCM_24;
+        case SinkFormat::Opus:     return SF_FORMAT_OGG | SF_FORMAT_OPUS;
+    }
+    return SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+}
+
+// Maps a libsndfile WAV format onto the streaming writer's encodings
+bool toWavEncoding(int sndfileFormat, WavEncoding& encoding)
+{
+    if ((sndfileFormat & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV)
+    {
+        return false;
+    }
+    switch (sndfileFormat & SF_FORMAT_SUBMASK)
+    {
+        case SF_FORMAT_PCM_16: encoding = WavEncoding::Pcm16;   return true;
+        case SF_FORMAT_PCM_24: encoding = WavEncoding::Pcm24;   return true;
+        case SF_FORMAT_PCM_32: encoding = WavEncoding::Pcm32;   return true;
+        case SF_FORMAT_FLOAT:  encoding = WavEncoding::Float32; return true;
+        default:               return false;
+    }
+}
+
+void backoff(unsigned int& spins)
+{
+    if (++spins < 64)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+EncodedFileSink::EncodedFileSink(const SinkConfig& config)
+    : file(nullptr),
+      numChannels(0),
+      blockFrames(std::max<std::size_t>(1, config.blockFrames)),
+      ring(config.queueBlocks),
+      partial(nullptr),
+      closing(false),
+      writeFailed(false),
+      framesWritten(0),
+      overflows(0),
+      encodeSeconds(0.0)
+{
+}
+
+EncodedFileSink::~EncodedFileSink()
+{
+    close();
+}
+
+bool EncodedFileSink::open(const std::string& path, unsigned int channels, unsigned int sampleRate,
+                           const SinkConfig& config)
+{
+    if (!open(path, toSndfileFormat(config.format), channels, sampleRate))
+    {
+        return false;
+    }
+
+    // Must be set before the first frame is written
+    double level = std::max(0.0, std::min(1.0, config.compressionLevel));
+    if (file && (config.format == SinkFormat::Flac || config.format == SinkFormat::Opus))
+    {
+        sf_command(file, SFC_SET_COMPRESSION_LEVEL, &level, sizeof(level));
+    }
+    return true;
+}
+
+bool EncodedFileSink::open(const std::string& path, int sndfileFormat, unsigned int channels, unsigned int sampleRate)
+{
+    close();
+
+    numChannels = std::max(1u, channels);
+
+    WavEncoding wavEncoding;
+    if (toWavEncoding(sndfileFormat, wavEncoding))
+    {
+        // Plain WAV needs no codec: stream it with async aligned writes
+        if (!wavWriter.open(path, numChannels, sampleRate, wavEncoding))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        SF_INFO info = SF_INFO();
+        info.channels = static_cast<int>(numChannels);
+        info.samplerate = static_cast<int>(sampleRate);
+        info.format = sndfileFormat;
+
+        file = sf_open(path.c_str(), SFM_WRITE, &info);
+        if (!file)
+        {
+            std::cerr << "[Sink] ERROR: Cannot open " << path << ": " << sf_strerror(nullptr) << std::endl;
+            return false;
+        }
+    }
+
+    // Size every slot now so write() never allocates
+    PendingBlock prototype;
+    prototype.samples.assign(blockFrames * numChannels, 0.0f);
+    ring.fill(prototype);
+    partial = nullptr;
+
+    closing.store(false);
+    writeFailed.store(false);
+    framesWritten.store(0);
+    overflows.store(0);
+    encodeSeconds.store(0.0);
+    encoderThread = std::thread(&EncodedFileSink::encodeLoop, this);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// Producer Interface
+//--------------------------------------------------------------------------
+
+bool EncodedFileSink::write(const float* interleaved, std::size_t numFrames, bool waitIfFull)
+{
+    if (!isOpen())
+    {
+        return false;
+    }
+
+    std::size_t offset = 0;
+    while (offset < numFrames)
+    {
+        if (!partial)
+        {
+            partial = ring.beginWrite();
+            unsigned int spins = 0;
+            while (!partial && waitIfFull)
+            {
+                backoff(spins);
+                partial = ring.beginWrite();
+            }
+            if (!partial)
+            {
+                // Encoder or disk fell behind: drop the rest of this write
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            partial->frames = 0;
+        }
+
+        std::size_t n = std::min(blockFrames - partial->frames, numFrames - offset);
+        std::copy(interleaved + offset * numChannels, interleaved + (offset + n) * numChannels,
+                  partial->samples.begin() + partial->frames * numChannels);
+        partial->frames += n;
+        offset += n;
+
+        if (partial->frames == blockFrames)
+        {
+            ring.commitWrite();
+            partial = nullptr;
+        }
+    }
+    return true;
+}
+
+void EncodedFileSink::flushPartial()
+{
+    if (partial && partial->frames > 0)
+    {
+        ring.commitWrite();
+    }
+    partial = nullptr;
+}
+
+//--------------------------------------------------------------------------
+// Encoder Thread
+//--------------------------------------------------------------------------
+
+void EncodedFileSink::encodeLoop()
+{
+    double busy = 0.0;
+    unsigned int spins = 0;
+
+    while (true)
+    {
+        PendingBlock* block = ring.front();
+        if (!block)
+        {
+            if (closing.load())
+            {
+                // Re-check: the final partial block is published before closing is set
+                if (!ring.front())
+                {
+                    break;
+                }
+                continue;
+            }
+            backoff(spins);
+            continue;
+        }
+        spins = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        sf_count_t written = static_cast<sf_count_t>(block->frames);
+        if (file)
+        {
+            written = sf_writef_float(file, block->samples.data(), static_cast<sf_count_t>(block->frames));
+        }
+        else if (!wavWriter.write(block->samples.data(), block->frames))
+        {
+            written = 0;
+        }
+        busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (written != static_cast<sf_count_t>(block->frames))
+        {
+            writeFailed.store(true);
+        }
+        framesWritten.fetch_add(static_cast<uint64_t>(std::max<sf_count_t>(0, written)), std::memory_order_relaxed);
+        encodeSeconds.store(busy, std::memory_order_relaxed);
+        ring.pop();
+    }
+}
+
+bool EncodedFileSink::close()
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+
+    flushPartial();
+    closing.store(true);
+    if (encoderThread.joinable())
+    {
+        encoderThread.join();
+    }
+
+    if (file)
+    {
+        sf_close(file);
+        file = nullptr;
+    }
+    else if (!wavWriter.close())
+    {
+        writeFailed.store(true);
+    }
+    return !writeFailed.load();
+}
+
+} // namespace audio
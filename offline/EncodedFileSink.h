@@ -0,0 +1,141 @@
+#ifndef ENCODED_FILE_SINK_H
+#define ENCODED_FILE_SINK_H
+
+#include "../audio/SpscRingBuffer.h"
+#include "../audio/WavStream.h"
+
+#include <sndfile.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Output encodings supported by EncodedFileSink.
+ */
+enum class SinkFormat
+{
+    WavFloat,
+    Wav24,
+    Flac,       // 24-bit FLAC
+    Opus        // Ogg/Opus; libsndfile requires 8/12/16/24/48 kHz
+};
+
+/**
+ * Encoder settings for EncodedFileSink.
+ */
+struct SinkConfig
+{
+    SinkFormat format = SinkFormat::Flac;
+    double compressionLevel = 0.5;  // 0.0 (fastest/largest) .. 1.0 (slowest/smallest)
+    std::size_t blockFrames = 2048; // frames per queued block
+    std::size_t queueBlocks = 64;   // blocks buffered ahead of the encoder
+};
+
+/**
+ * Audio file writer that encodes on a background thread.
+ *
+ * Producers copy interleaved frames into a bounded lock-free ring of
+ * preallocated blocks; the encoder thread drains it through libsndfile.
+ * PCM and float WAV bypass libsndfile and go through WavStreamWriter, which
+ * keeps several aligned writes in flight (io_uring where available).
+ * write() never touches the encoder or the disk, so it is safe to call
+ * from processingThread as a live recording tap (use the non-waiting
+ * mode there and watch getOverflows()).
+ */
+class EncodedFileSink
+{
+private:
+    struct PendingBlock
+    {
+        std::vector<float> samples;
+        std::size_t frames = 0;
+    };
+
+    SNDFILE* file;
+    WavStreamWriter wavWriter;      // used instead of file for PCM/float WAV
+    unsigned int numChannels;
+    std::size_t blockFrames;
+    SpscRingBuffer<PendingBlock> ring;
+    PendingBlock* partial;          // producer's partly filled slot
+
+    std::thread encoderThread;
+    std::atomic<bool> closing;
+    std::atomic<bool> writeFailed;
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> overflows;
+    std::atomic<double> encodeSeconds;
+
+    /**
+     * Encoder loop run on encoderThread.
+     */
+    void encodeLoop();
+
+    /**
+     * Publishes the partly filled block, if any.
+     */
+    void flushPartial();
+
+public:
+    /**
+     * Creates a closed sink.
+     * @param config Block size, queue depth and encoder settings used by open()
+     */
+    explicit EncodedFileSink(const SinkConfig& config = SinkConfig());
+
+    ~EncodedFileSink();
+
+    /**
+     * Opens a file with a format from SinkConfig and starts the encoder.
+     *
+     * @param path Output file
+     * @param channels Interleaved channel count
+     * @param sampleRate Sample rate in Hz
+     * @param config Encoding and compression level
+     * @return false if libsndfile rejects the format or path
+     */
+    bool open(const std::string& path, unsigned int channels, unsigned int sampleRate, const SinkConfig& config);
+
+    /**
+     * Opens a file with a raw libsndfile format (e.g. matching an input file).
+     *
+     * @param path Output file
+     * @param sndfileFormat SF_FORMAT_* major|minor
+     * @param channels Interleaved channel count
+     * @param sampleRate Sample rate in Hz
+     * @return false if libsndfile rejects the format or path
+     */
+    bool open(const std::string& path, int sndfileFormat, unsigned int channels, unsigned int sampleRate);
+
+    /**
+     * Queues interleaved frames for encoding.
+     *
+     * @param interleaved Samples (numFrames * channels)
+     * @param numFrames Frames to queue
+     * @param waitIfFull true to wait for the encoder (offline), false to drop (live)
+     * @return false if any frames were dropped because the queue was full
+     */
+    bool write(const float* interleaved, std::size_t numFrames, bool waitIfFull = false);
+
+    /**
+     * Drains the queue, finalises the file and stops the encoder.
+     * @return false if the encoder reported a write error
+     */
+    bool close();
+
+    bool isOpen() const { return file != nullptr || wavWriter.isOpen(); }
+    uint64_t getFramesWritten() const { return framesWritten.load(); }
+    uint64_t getOverflows() const { return overflows.load(); }
+    double getEncodeSeconds() const { return encodeSeconds.load(); }
+
+    EncodedFileSink(const EncodedFileSink&) = delete;
+    EncodedFileSink& operator=(const EncodedFileSink&) = delete;
+};
+
+} // namespace audio
+
+#endif // ENCODED_FILE_SINK_H
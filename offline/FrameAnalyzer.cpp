@@ -0,0 +1,249 @@
+#include "FrameAnalyzer.h"
+#include "MetricsFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace audio {
+
+namespace {
+
+// Gain (linear) to reduction in dB, reported as a positive number
+float reductionDB(float gain)
+{
+    return gain >= 1.0f ? 0.0f : -20.0f * std::log10(std::max(gain, 1e-6f));
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// Lifecycle
+//--------------------------------------------------------------------------
+
+FrameAnalyzer::FrameAnalyzer(unsigned int channels, unsigned int rate, std::size_t frameSize,
+                             const AnalysisSettings& analysisSettings)
+    : settings(analysisSettings),
+      sampleRate(rate),
+      channelStates(channels),
+      channelBuffer(frameSize)
+{
+    for (ChannelState& state : channelStates)
+    {
+        if (settings.sideChainDetectors && (settings.measureGate || settings.measureDeEsser))
+        {
+            state.sideChain.reset(new SideChain(rate, frameSize));
+        }
+        if (settings.measureGate)
+        {
+            state.gate.reset(new NoiseGate(rate, static_cast<unsigned int>(frameSize), settings.gateThreshold,
+                                           settings.gateAttackMs, settings.gateReleaseMs));
+            state.gate->setEnabled(true);
+            state.gate->setSideChain(state.sideChain.get());
+        }
+        if (settings.measureLimiter)
+        {
+            state.limiter.reset(new Limiter(rate, settings.limiterThreshold, settings.limiterAttackMs,
+                                            settings.limiterReleaseMs));
+            state.limiter->setEnabled(true);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// Analysis
+//--------------------------------------------------------------------------
+
+void FrameAnalyzer::analyze(const RenderBlock& block)
+{
+    const unsigned int channels = static_cast<unsigned int>(channelStates.size());
+    const std::size_t numFrames = block.validFrames;
+    if (channels == 0 || numFrames == 0)
+    {
+        return;
+    }
+    if (channelBuffer.size() < numFrames)
+    {
+        channelBuffer.resize(numFrames);
+    }
+
+    FrameFeatures features;
+    features.frame = block.index * block.numFrames;
+
+    double sumSquares = 0.0;
+    float peak = 0.0f;
+    const std::size_t numSamples = numFrames * channels;
+    for (std::size_t i = 0; i < numSamples; ++i)
+    {
+        float sample = block.input[i];
+        sumSquares += static_cast<double>(sample) * sample;
+        peak = std::max(peak, std::fabs(sample));
+    }
+    features.rms = static_cast<float>(std::sqrt(sumSquares / numSamples));
+    features.peak = peak;
+
+    float minLimiterGain = 1.0f;
+    for (unsigned int ch = 0; ch < channels; ++ch)
+    {
+        const float* samples = block.input;
+        if (channels > 1)
+        {
+            for (std::size_t i = 0; i < numFrames; ++i)
+            {
+                channelBuffer[i] = block.input[i * channels + ch];
+            }
+            samples = channelBuffer.data();
+        }
+
+        ChannelState& state = channelStates[ch];
+        if (state.sideChain)
+        {
+            state.sideChain->analyze(samples, numFrames);
+        }
+        if (state.gate)
+        {
+            features.gateGain += state.gate->analyze(samples, numFrames) / channels;
+            features.gateOpen = features.gateOpen || state.gate->isOpen();
+            for (unsigned int band = 0; band < NUM_BANDS; ++band)
+            {
+                features.bandEnergy[band] += static_cast<float>(state.gate->getBandEnergy(band) / channels);
+            }
+        }
+        if (state.limiter)
+        {
+            minLimiterGain = std::min(minLimiterGain, state.limiter->analyze(samples, numFrames));
+        }
+        if (settings.measureDeEsser && state.sideChain)
+        {
+            float reduction = static_cast<float>(DeEsserMeter::estimate(*state.sideChain, settings.deEsserStartFreq,
+                                                                        settings.deEsserEndFreq,
+                                                                        settings.deEsserReductionDB));
+            features.deEsserReductionDB = std::max(features.deEsserReductionDB, reduction);
+        }
+        else if (settings.measureDeEsser)
+        {
+            float reduction = static_cast<float>(deEsserMeter.measure(samples, numFrames, static_cast<int>(sampleRate),
+                                                                      settings.deEsserStartFreq, settings.deEsserEndFreq,
+                                                                      settings.deEsserReductionDB));
+            features.deEsserReductionDB = std::max(features.deEsserReductionDB, reduction);
+        }
+    }
+    features.limiterReductionDB = reductionDB(minLimiterGain);
+
+    frames.push_back(features);
+}
+
+bool FrameAnalyzer::analyzeFile(const std::string& path, const AnalysisSettings& analysisSettings,
+                                std::size_t frameSize, std::vector<FrameFeatures>& out, RenderStats* stats)
+{
+    std::unique_ptr<FrameAnalyzer> analyzer;
+    BlockProcessor processor = [&](const RenderBlock& block) {
+        if (!analyzer)
+        {
+            analyzer.reset(new FrameAnalyzer(block.channels, block.sampleRate, frameSize, analysisSettings));
+        }
+        analyzer->analyze(block);
+    };
+
+    // No output path: the renderer decodes and calls the processor but encodes nothing
+    OfflineRenderer renderer(frameSize);
+    bool ok = renderer.render({ path, std::string() }, processor, stats);
+
+    out.clear();
+    if (analyzer)
+    {
+        out.swap(analyzer->frames);
+    }
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// Output
+//--------------------------------------------------------------------------
+
+bool FrameAnalyzer::writeCSV(const std::string& path, const std::vector<FrameFeatures>& features)
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cerr << "[Analysis] ERROR: Cannot create " << path << std::endl;
+        return false;
+    }
+
+    // One large stdio buffer; rows are formatted with snprintf, not iostream
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    std::fputs("Frame,RMS,Peak,Gate Gain,Gate Open", file);
+    for (unsigned int band = 0; band < NUM_BANDS; ++band)
+    {
+        std::fprintf(file, ",Band %u Energy", band);
+    }
+    std::fputs(",Limiter Reduction dB,De-Esser Reduction dB\n", file);
+
+    char row[256];
+    for (const FrameFeatures& f : features)
+    {
+        int length = std::snprintf(row, sizeof(row), "%llu,%.6g,%.6g,%.4f,%d",
+                                   static_cast<unsigned long long>(f.frame), f.rms, f.peak, f.gateGain,
+                                   f.gateOpen ? 1 : 0);
+        for (unsigned int band = 0; band < NUM_BANDS; ++band)
+        {
+            length += std::snprintf(row + length, sizeof(row) - length, ",%.6g", f.bandEnergy[band]);
+        }
+        length += std::snprintf(row + length, sizeof(row) - length, ",%.3f,%.3f\n",
+                                f.limiterReductionDB, f.deEsserReductionDB);
+        std::fwrite(row, 1, static_cast<std::size_t>(length), file);
+    }
+
+    bool ok = std::ferror(file) == 0;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        std::cerr << "[Analysis] ERROR: Failed writing " << path << std::endl;
+    }
+    return ok;
+}
+
+bool FrameAnalyzer::writeMetrics(const std::string& path, const std::vector<FrameFeatures>& features)
+{
+    std::vector<MetricColumn> columns = {
+        { "frame", MetricType::UInt64 },
+        { "rms", MetricType::Float32 },
+        { "peak", MetricType::Float32 },
+        { "gate_gain", MetricType::Float32 },
+        { "gate_open", MetricType::UInt8 },
+    };
+    for (unsigned int band = 0; band < NUM_BANDS; ++band)
+    {
+        columns.push_back({ "band" + std::to_string(band), MetricType::Float32 });
+    }
+    columns.push_back({ "limiter_gr_db", MetricType::Float32 });
+    columns.push_back({ "deesser_db", MetricType::Float32 });
+
+    MetricsWriter writer;
+    if (!writer.open(path, columns))
+    {
+        return false;
+    }
+    for (const FrameFeatures& f : features)
+    {
+        std::size_t column = 0;
+        writer.set<uint64_t>(column++, f.frame);
+        writer.set<float>(column++, f.rms);
+        writer.set<float>(column++, f.peak);
+        writer.set<float>(column++, f.gateGain);
+        writer.set<uint8_t>(column++, f.gateOpen ? 1 : 0);
+        for (unsigned int band = 0; band < NUM_BANDS; ++band)
+        {
+            writer.set<float>(column++, f.bandEnergy[band]);
+        }
+        writer.set<float>(column++, f.limiterReductionDB);
+        writer.set<float>(column++, f.deEsserReductionDB);
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+} // namespace audio
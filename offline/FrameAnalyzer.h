@@ -0,0 +1,142 @@
+#ifndef FRAME_ANALYZER_H
+#define FRAME_ANALYZER_H
+
+#include "OfflineRenderer.h"
+#include "../common.h"
+#include "../effects/DeEsser.h"
+#include "../effects/Limiter.h"
+#include "../effects/NoiseGate.h"
+#include "../effects/SideChain.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Features of one analysis frame (one render block), combined over channels.
+ */
+struct FrameFeatures
+{
+    uint64_t frame = 0;                 // first sample frame of the block
+    float rms = 0.0f;                   // over all channels
+    float peak = 0.0f;                  // largest absolute sample
+    float gateGain = 0.0f;              // smoothed gate gain at block end, mean of channels
+    bool gateOpen = false;              // any channel above the gate threshold
+    float bandEnergy[NUM_BANDS] = {};   // gate's spectral bands, mean of channels
+    float limiterReductionDB = 0.0f;    // deepest limiter gain reduction in the block
+    float deEsserReductionDB = 0.0f;    // energy the de-esser would remove
+};
+
+/**
+ * Effect parameters and feature selection for an analysis pass.
+ */
+struct AnalysisSettings
+{
+    bool measureGate = true;            // gate state and band energies (one forward FFT)
+    float gateThreshold = 0.1f;
+    float gateAttackMs = 20.0f;
+    float gateReleaseMs = 200.0f;
+
+    bool measureLimiter = true;
+    float limiterThreshold = 0.6f;
+    float limiterAttackMs = 10.0f;
+    float limiterReleaseMs = 100.0f;
+
+    bool measureDeEsser = true;         // forward FFT per DEESSER_FRAME_SIZE samples
+    int deEsserStartFreq = 4000;
+    int deEsserEndFreq = 10000;
+    double deEsserReductionDB = 6.0;
+
+    bool sideChainDetectors = false;    // gate and de-esser read one decimated side-chain per channel, no FFTs
+};
+
+//--------------------------------------------------------------------------
+// FrameAnalyzer
+//--------------------------------------------------------------------------
+
+/**
+ * Computes per-frame features of a file without rendering audio.
+ *
+ * Each block of the stream is run through the analysis entry points of the
+ * effects (NoiseGate::analyze, Limiter::analyze, DeEsserMeter), which keep
+ * the same state as processing would but skip inverse FFTs and never
+ * write output samples. With sideChainDetectors the gate and de-esser
+ * both read one SideChain per channel instead (band energies are then
+ * not measured). Files are decoded through OfflineRenderer with no
+ * output path, so nothing is encoded or written either.
+ */
+class FrameAnalyzer
+{
+private:
+    struct ChannelState
+    {
+        std::unique_ptr<NoiseGate> gate;
+        std::unique_ptr<Limiter> limiter;
+        std::unique_ptr<SideChain> sideChain;
+    };
+
+    AnalysisSettings settings;
+    unsigned int sampleRate;
+    std::vector<ChannelState> channelStates;
+    DeEsserMeter deEsserMeter;
+    std::vector<float> channelBuffer;
+    std::vector<FrameFeatures> frames;
+
+public:
+    /**
+     * Creates an analyzer with per-channel effect state.
+     *
+     * @param channels Interleaved channels per frame
+     * @param rate Sample rate in Hz
+     * @param frameSize Frames per block (sizes the gate FFT)
+     * @param analysisSettings Effect parameters and features to compute
+     */
+    FrameAnalyzer(unsigned int channels, unsigned int rate, std::size_t frameSize,
+                  const AnalysisSettings& analysisSettings = AnalysisSettings());
+
+    /**
+     * Analyzes one block and appends its features.
+     * @param block Block from the renderer; only input and validFrames are read
+     */
+    void analyze(const RenderBlock& block);
+
+    /**
+     * Analyzes a whole file.
+     *
+     * @param path Input file (any format StreamingDecoder reads)
+     * @param analysisSettings Effect parameters and features to compute
+     * @param frameSize Frames per analysis frame
+     * @param out Receives one entry per frame
+     * @param stats Optional timing
+     * @return false if the file could not be decoded
+     */
+    static bool analyzeFile(const std::string& path, const AnalysisSettings& analysisSettings,
+                            std::size_t frameSize, std::vector<FrameFeatures>& out,
+                            RenderStats* stats = nullptr);
+
+    /**
+     * Writes features as CSV (one row per frame) through a large buffer.
+     * @return false if the file cannot be written
+     */
+    static bool writeCSV(const std::string& path, const std::vector<FrameFeatures>& features);
+
+    /**
+     * Writes features as a columnar binary metrics file (see MetricsFile.h).
+     * Columns: frame, rms, peak, gate_gain, gate_open, band0..bandN,
+     * limiter_gr_db, deesser_db.
+     * @return false if the file cannot be written
+     */
+    static bool writeMetrics(const std::string& path, const std::vector<FrameFeatures>& features);
+
+    const std::vector<FrameFeatures>& getFrames() const { return frames; }
+
+    FrameAnalyzer(const FrameAnalyzer&) = delete;
+    FrameAnalyzer& operator=(const FrameAnalyzer&) = delete;
+};
+
+} // namespace audio
+
+#endif // FRAME_ANALYZER_H
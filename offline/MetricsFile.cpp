@@ -0,0 +1,395 @@
+#include "MetricsFile.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace audio {
+
+namespace {
+
+const char HEADER_MAGIC[8] = { 'M', 'A', 'M', 'E', 'T', 'R', 'I', 'C' };
+const char TRAILER_MAGIC[8] = { 'M', 'A', 'M', 'E', 'T', 'E', 'N', 'D' };
+const uint32_t FORMAT_VERSION = 1;
+const std::size_t HEADER_BYTES = 16;
+const std::size_t TRAILER_BYTES = 16;
+const std::size_t NAME_BYTES = 32;
+const std::size_t COLUMN_ENTRY_BYTES = NAME_BYTES + 8;
+const std::size_t CHUNK_ALIGNMENT = 64;
+
+template <typename T>
+T load(const unsigned char* at)
+{
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+std::size_t metricTypeSize(MetricType type)
+{
+    switch (type)
+    {
+        case MetricType::Float32: return 4;
+        case MetricType::Float64: return 8;
+        case MetricType::UInt64: return 8;
+        case MetricType::UInt8: return 1;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// MetricsWriter
+//--------------------------------------------------------------------------
+
+MetricsWriter::MetricsWriter(std::size_t groupRows)
+    : file(nullptr),
+      rowsPerGroup(std::max<std::size_t>(1, groupRows)),
+      rowsInGroup(0),
+      totalRows(0),
+      fileOffset(0),
+      failed(false)
+{
+}
+
+MetricsWriter::~MetricsWriter()
+{
+    close();
+}
+
+bool MetricsWriter::open(const std::string& path, const std::vector<MetricColumn>& columnList)
+{
+    close();
+
+    for (const MetricColumn& column : columnList)
+    {
+        if (column.name.empty() || column.name.size() >= NAME_BYTES)
+        {
+            std::cerr << "[Metrics] ERROR: Column name '" << column.name << "' must be 1-31 characters" << std::endl;
+            return false;
+        }
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "[Metrics] ERROR: Cannot create " << path << std::endl;
+        return false;
+    }
+    ioBuffer.resize(1 << 20);
+    std::setvbuf(file, ioBuffer.data(), _IOFBF, ioBuffer.size());
+
+    columns = columnList;
+    columnData.assign(columns.size(), std::vector<unsigned char>());
+    for (std::size_t c = 0; c < columns.size(); ++c)
+    {
+        columnData[c].resize(rowsPerGroup * metricTypeSize(columns[c].type));
+    }
+    groupRows.clear();
+    groupOffsets.clear();
+    rowsInGroup = 0;
+    totalRows = 0;
+    fileOffset = 0;
+    failed = false;
+
+    uint32_t header[2] = { FORMAT_VERSION, 0 };
+    writeBytes(HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    writeBytes(header, sizeof(header));
+    return !failed;
+}
+
+bool MetricsWriter::writeBytes(const void* data, std::size_t bytes)
+{
+    if (bytes > 0 && std::fwrite(data, 1, bytes, file) != bytes)
+    {
+        failed = true;
+    }
+    fileOffset += bytes;
+    return !failed;
+}
+
+bool MetricsWriter::padTo(std::size_t alignment)
+{
+    static const unsigned char zeros[CHUNK_ALIGNMENT] = {};
+    std::size_t remainder = static_cast<std::size_t>(fileOffset % alignment);
+    return remainder == 0 || writeBytes(zeros, alignment - remainder);
+}
+
+bool MetricsWriter::flushGroup()
+{
+    if (rowsInGroup == 0)
+    {
+        return !failed;
+    }
+
+    groupRows.push_back(rowsInGroup);
+    for (std::size_t c = 0; c < columns.size(); ++c)
+    {
+        padTo(CHUNK_ALIGNMENT);
+        groupOffsets.push_back(fileOffset);
+        writeBytes(columnData[c].data(), rowsInGroup * metricTypeSize(columns[c].type));
+    }
+    rowsInGroup = 0;
+    return !failed;
+}
+
+bool MetricsWriter::endRow()
+{
+    if (!file)
+    {
+        return false;
+    }
+    ++totalRows;
+    if (++rowsInGroup == rowsPerGroup)
+    {
+        flushGroup();
+    }
+    return !failed;
+}
+
+bool MetricsWriter::close()
+{
+    if (!file)
+    {
+        return false;
+    }
+
+    flushGroup();
+
+    padTo(8);
+    uint64_t footerOffset = fileOffset;
+    uint32_t counts[2] = { static_cast<uint32_t>(columns.size()), static_cast<uint32_t>(groupRows.size()) };
+    writeBytes(counts, sizeof(counts));
+    writeBytes(&totalRows, sizeof(totalRows));
+    for (const MetricColumn& column : columns)
+    {
+        unsigned char entry[COLUMN_ENTRY_BYTES] = {};
+        std::memcpy(entry, column.name.data(), column.name.size());
+        entry[NAME_BYTES] = static_cast<unsigned char>(column.type);
+        writeBytes(entry, sizeof(entry));
+    }
+    for (std::size_t g = 0; g < groupRows.size(); ++g)
+    {
+        writeBytes(&groupRows[g], sizeof(uint64_t));
+        writeBytes(&groupOffsets[g * columns.size()], columns.size() * sizeof(uint64_t));
+    }
+    writeBytes(&footerOffset, sizeof(footerOffset));
+    writeBytes(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+
+    bool ok = !failed && std::fclose(file) == 0;
+    file = nullptr;
+    if (!ok)
+    {
+        std::cerr << "[Metrics] ERROR: Failed writing metrics file" << std::endl;
+    }
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// MetricsReader
+//--------------------------------------------------------------------------
+
+MetricsReader::MetricsReader()
+    : mapped(nullptr),
+      mappedBytes(0),
+#ifdef _WIN32
+      fileHandle(nullptr),
+      mappingHandle(nullptr),
+#endif
+      totalRows(0)
+{
+}
+
+MetricsReader::~MetricsReader()
+{
+    close();
+}
+
+bool MetricsReader::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "[Metrics] ERROR: Cannot open " << path << std::endl;
+        return false;
+    }
+    fileHandle = handle;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+    {
+        mappingHandle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle)
+        {
+            mapped = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            mappedBytes = mapped ? static_cast<std::size_t>(size.QuadPart) : 0;
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "[Metrics] ERROR: Cannot open " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* address = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            mapped = static_cast<const unsigned char*>(address);
+            mappedBytes = static_cast<std::size_t>(st.st_size);
+        }
+    }
+    ::close(fd);    // the mapping stays valid
+#endif
+
+    if (!mapped || !parse(path))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MetricsReader::parse(const std::string& path)
+{
+    auto fail = [&path](const char* reason) {
+        std::cerr << "[Metrics] ERROR: " << path << ": " << reason << std::endl;
+        return false;
+    };
+
+    if (mappedBytes < HEADER_BYTES + TRAILER_BYTES ||
+        std::memcmp(mapped, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0 ||
+        std::memcmp(mapped + mappedBytes - sizeof(TRAILER_MAGIC), TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0)
+    {
+        return fail("not a metrics file (or truncated)");
+    }
+    if (load<uint32_t>(mapped + 8) != FORMAT_VERSION)
+    {
+        return fail("unsupported version");
+    }
+
+    const std::size_t footerEnd = mappedBytes - TRAILER_BYTES;
+    uint64_t footerOffset = load<uint64_t>(mapped + footerEnd);
+    if (footerOffset < HEADER_BYTES || footerOffset + 16 > footerEnd)
+    {
+        return fail("bad footer offset");
+    }
+
+    const unsigned char* at = mapped + footerOffset;
+    uint32_t numColumns = load<uint32_t>(at);
+    uint32_t numGroups = load<uint32_t>(at + 4);
+    totalRows = load<uint64_t>(at + 8);
+    at += 16;
+
+    // Checked by division so hostile counts cannot overflow
+    uint64_t remaining = footerEnd - footerOffset - 16;
+    const uint64_t groupEntryBytes = 8 + 8 * static_cast<uint64_t>(numColumns);
+    if (numColumns > remaining / COLUMN_ENTRY_BYTES ||
+        numGroups != (remaining - numColumns * COLUMN_ENTRY_BYTES) / groupEntryBytes ||
+        (remaining - numColumns * COLUMN_ENTRY_BYTES) % groupEntryBytes != 0)
+    {
+        return fail("footer size mismatch");
+    }
+
+    columns.resize(numColumns);
+    for (MetricColumn& column : columns)
+    {
+        const char* name = reinterpret_cast<const char*>(at);
+        column.name.assign(name, std::find(name, name + NAME_BYTES - 1, '\0'));
+        column.type = static_cast<MetricType>(at[NAME_BYTES]);
+        if (metricTypeSize(column.type) == 0)
+        {
+            return fail("unknown column type");
+        }
+        at += COLUMN_ENTRY_BYTES;
+    }
+
+    uint64_t rowsSeen = 0;
+    groupRows.resize(numGroups);
+    groupOffsets.resize(static_cast<std::size_t>(numGroups) * numColumns);
+    for (uint32_t g = 0; g < numGroups; ++g)
+    {
+        groupRows[g] = load<uint64_t>(at);
+        at += 8;
+        rowsSeen += groupRows[g];
+        for (uint32_t c = 0; c < numColumns; ++c)
+        {
+            uint64_t offset = load<uint64_t>(at);
+            at += 8;
+            uint64_t bytes = groupRows[g] * metricTypeSize(columns[c].type);
+            if (offset % CHUNK_ALIGNMENT != 0 || offset < HEADER_BYTES || offset + bytes > footerOffset)
+            {
+                return fail("column chunk out of bounds");
+            }
+            groupOffsets[static_cast<std::size_t>(g) * numColumns + c] = offset;
+        }
+    }
+    if (rowsSeen != totalRows)
+    {
+        return fail("row count mismatch");
+    }
+    return true;
+}
+
+void MetricsReader::close()
+{
+#ifdef _WIN32
+    if (mapped)
+    {
+        UnmapViewOfFile(mapped);
+    }
+    if (mappingHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    if (fileHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (mapped)
+    {
+        munmap(const_cast<unsigned char*>(mapped), mappedBytes);
+    }
+#endif
+    mapped = nullptr;
+    mappedBytes = 0;
+    columns.clear();
+    groupRows.clear();
+    groupOffsets.clear();
+    totalRows = 0;
+}
+
+int MetricsReader::findColumn(const std::string& name) const
+{
+    for (std::size_t c = 0; c < columns.size(); ++c)
+    {
+        if (columns[c].name == name)
+        {
+            return static_cast<int>(c);
+        }
+    }
+    return -1;
+}
+
+} // namespace audio
@@ -0,0 +1,245 @@
+#ifndef METRICS_FILE_H
+#define METRICS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * Stored type of a metrics column.
+ */
+enum class MetricType : uint8_t
+{
+    Float32 = 0,
+    Float64 = 1,
+    UInt64 = 2,
+    UInt8 = 3
+};
+
+/**
+ * Gets the stored size of one value.
+ */
+std::size_t metricTypeSize(MetricType type);
+
+/**
+ * Maps a C++ value type to its MetricType.
+ */
+template <typename T> struct MetricTypeOf;
+template <> struct MetricTypeOf<float> { static constexpr MetricType value = MetricType::Float32; };
+template <> struct MetricTypeOf<double> { static constexpr MetricType value = MetricType::Float64; };
+template <> struct MetricTypeOf<uint64_t> { static constexpr MetricType value = MetricType::UInt64; };
+template <> struct MetricTypeOf<uint8_t> { static constexpr MetricType value = MetricType::UInt8; };
+
+/**
+ * Name and type of one column.
+ */
+struct MetricColumn
+{
+    std::string name;           // up to 31 characters
+    MetricType type = MetricType::Float32;
+};
+
+//--------------------------------------------------------------------------
+// File Layout
+//--------------------------------------------------------------------------
+//
+// Little-endian, column-oriented, in row groups (like Parquet):
+//
+//   "MAMETRIC" u32 version u32 reserved            header, 16 bytes
+//   row group 0: column 0 values, column 1 values, ...
+//   row group 1: ...
+//   footer: u32 columns, u32 groups, u64 rows,
+//           per column: char name[32], u8 type, 7 bytes padding,
+//           per group: u64 rows, u64 offset of each column's values
+//   u64 footer offset, "MAMETEND"                  trailer, 16 bytes
+//
+// Every column chunk starts on a 64-byte boundary so a memory-mapped file
+// can be read through typed pointers directly.
+
+//--------------------------------------------------------------------------
+// MetricsWriter
+//--------------------------------------------------------------------------
+
+/**
+ * Writes typed per-frame metrics as a columnar binary file.
+ *
+ * Values are stored raw into per-column buffers; when a row group fills,
+ * each column is written as one contiguous block through a large stdio
+ * buffer. Nothing is formatted as text.
+ */
+class MetricsWriter
+{
+private:
+    FILE* file;
+    std::vector<char> ioBuffer;
+    std::vector<MetricColumn> columns;
+    std::vector<std::vector<unsigned char>> columnData;    // one row group per column
+    std::vector<uint64_t> groupRows;
+    std::vector<uint64_t> groupOffsets;                    // groups * columns
+    std::size_t rowsPerGroup;
+    std::size_t rowsInGroup;
+    uint64_t totalRows;
+    uint64_t fileOffset;
+    bool failed;
+
+    bool writeBytes(const void* data, std::size_t bytes);
+    bool padTo(std::size_t alignment);
+    bool flushGroup();
+
+public:
+    /**
+     * Creates a writer.
+     * @param groupRows Rows buffered per row group (default: 65536)
+     */
+    explicit MetricsWriter(std::size_t groupRows = 1 << 16);
+
+    ~MetricsWriter();
+
+    /**
+     * Creates the file and declares its columns.
+     *
+     * @param path Output file
+     * @param columnList Column names and types, in order
+     * @return false if the file cannot be created or a name is too long
+     */
+    bool open(const std::string& path, const std::vector<MetricColumn>& columnList);
+
+    /**
+     * Sets one value of the current row; the type must match the column.
+     * @param column Column index
+     * @param value Value to store
+     */
+    template <typename T>
+    void set(std::size_t column, T value)
+    {
+        std::memcpy(columnData[column].data() + rowsInGroup * sizeof(T), &value, sizeof(T));
+    }
+
+    /**
+     * Completes the current row; flushes the row group when it is full.
+     * @return false once a write has failed
+     */
+    bool endRow();
+
+    /**
+     * Writes the last row group and the footer and closes the file.
+     * @return false if any write failed
+     */
+    bool close();
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t getRows() const { return totalRows; }
+
+    MetricsWriter(const MetricsWriter&) = delete;
+    MetricsWriter& operator=(const MetricsWriter&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// MetricsReader
+//--------------------------------------------------------------------------
+
+/**
+ * Memory-maps a metrics file and exposes its columns in place.
+ *
+ * Opening only validates the footer; values are paged in by the OS as
+ * they are touched, so even very large files open instantly.
+ */
+class MetricsReader
+{
+private:
+    const unsigned char* mapped;
+    std::size_t mappedBytes;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+    std::vector<MetricColumn> columns;
+    std::vector<uint64_t> groupRows;
+    std::vector<uint64_t> groupOffsets;                    // groups * columns
+    uint64_t totalRows;
+
+    bool parse(const std::string& path);
+
+public:
+    MetricsReader();
+    ~MetricsReader();
+
+    /**
+     * Maps a metrics file.
+     * @param path Input file
+     * @return false if the file is missing, truncated or not a metrics file
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps the file; pointers from groupData() become invalid.
+     */
+    void close();
+
+    /**
+     * Finds a column by name.
+     * @return Column index, or -1 if absent
+     */
+    int findColumn(const std::string& name) const;
+
+    /**
+     * Gets one row group of a column without copying.
+     *
+     * @param column Column index
+     * @param group Row group index
+     * @param rows Receives the rows in the group
+     * @return Values inside the mapping, or nullptr if T does not match the column type
+     */
+    template <typename T>
+    const T* groupData(std::size_t column, std::size_t group, std::size_t& rows) const
+    {
+        rows = 0;
+        if (column >= columns.size() || group >= groupRows.size() ||
+            columns[column].type != MetricTypeOf<T>::value)
+        {
+            return nullptr;
+        }
+        rows = static_cast<std::size_t>(groupRows[group]);
+        return reinterpret_cast<const T*>(mapped + groupOffsets[group * columns.size() + column]);
+    }
+
+    /**
+     * Copies a whole column into a vector (across row groups).
+     * @return false if T does not match the column type
+     */
+    template <typename T>
+    bool readColumn(std::size_t column, std::vector<T>& out) const
+    {
+        out.clear();
+        out.reserve(static_cast<std::size_t>(totalRows));
+        for (std::size_t group = 0; group < groupRows.size(); ++group)
+        {
+            std::size_t rows = 0;
+            const T* values = groupData<T>(column, group, rows);
+            if (!values)
+            {
+                return false;
+            }
+            out.insert(out.end(), values, values + rows);
+        }
+        return true;
+    }
+
+    bool isOpen() const { return mapped != nullptr; }
+    uint64_t getRows() const { return totalRows; }
+    std::size_t getGroupCount() const { return groupRows.size(); }
+    std::size_t getGroupRows(std::size_t group) const { return static_cast<std::size_t>(groupRows[group]); }
+    const std::vector<MetricColumn>& getColumns() const { return columns; }
+
+    MetricsReader(const MetricsReader&) = delete;
+    MetricsReader& operator=(const MetricsReader&) = delete;
+};
+
+} // namespace audio
+
+#endif // METRICS_FILE_H
@@ -0,0 +1,541 @@
+#include "OfflineRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace audio {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Spin briefly, then yield the core: waits here are block-sized, not sample-sized
+void backoff(unsigned int& spins)
+{
+    if (++spins < 64)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------
+// StreamingDecoder
+//--------------------------------------------------------------------------
+
+StreamingDecoder::StreamingDecoder(std::size_t frames, std::size_t queueBlocks)
+    : file(nullptr),
+      info(),
+      blockFrames(std::max<std::size_t>(1, frames)),
+      framesRemaining(0),
+      ring(queueBlocks),
+      stopRequested(false),
+      failed(false),
+      decodeSeconds(0.0),
+      finished(false)
+{
+}
+
+StreamingDecoder::~StreamingDecoder()
+{
+    close();
+}
+
+bool StreamingDecoder::open(const std::string& path, uint64_t startFrame, uint64_t frameCount)
+{
+    close();
+
+    info = SF_INFO();
+    if (wavReader.open(path, WavStreamConfig(), startFrame))
+    {
+        // Describe the stream the way libsndfile would so callers need not care
+        static const int subtypes[] = { SF_FORMAT_PCM_16, SF_FORMAT_PCM_24, SF_FORMAT_PCM_32, SF_FORMAT_FLOAT };
+        const WavInfo& wav = wavReader.getInfo();
+        info.frames = static_cast<sf_count_t>(wav.frames);
+        info.samplerate = static_cast<int>(wav.sampleRate);
+        info.channels = static_cast<int>(wav.channels);
+        info.format = SF_FORMAT_WAV | subtypes[static_cast<int>(wav.encoding)];
+        info.sections = 1;
+        info.seekable = 1;
+    }
+    else
+    {
+        file = sf_open(path.c_str(), SFM_READ, &info);
+    }
+    if (!isOpen())
+    {
+        std::cerr << "[Offline] ERROR: Cannot open " << path << ": " << sf_strerror(nullptr) << std::endl;
+        return false;
+    }
+    if (file && startFrame > 0 && sf_seek(file, static_cast<sf_count_t>(startFrame), SEEK_SET) < 0)
+    {
+        std::cerr << "[Offline] ERROR: Cannot seek " << path << " to frame " << startFrame << std::endl;
+        close();
+        return false;
+    }
+
+    framesRemaining = frameCount > 0 ? frameCount : UINT64_MAX;
+    finished = false;
+    failed.store(false);
+    decodeSeconds.store(0.0);
+    return true;
+}
+
+void StreamingDecoder::start()
+{
+    if (!isOpen() || decodeThread.joinable())
+    {
+        return;
+    }
+    stopRequested.store(false);
+    decodeThread = std::thread(&StreamingDecoder::decodeLoop, this);
+}
+
+void StreamingDecoder::decodeLoop()
+{
+    const std::size_t blockSamples = blockFrames * static_cast<std::size_t>(info.channels);
+    double busy = 0.0;
+    bool last = false;
+
+    while (!last && !stopRequested.load())
+    {
+        DecodedBlock* block = ring.beginWrite();
+        unsigned int spins = 0;
+        while (!block && !stopRequested.load())
+        {
+            backoff(spins);
+            block = ring.beginWrite();
+        }
+        if (!block)
+        {
+            break;
+        }
+
+        // Slots grow to size on first use and are reused afterwards
+        block->samples.resize(blockSamples);
+
+        const std::size_t wanted = static_cast<std::size_t>(std::min<uint64_t>(blockFrames, framesRemaining));
+        Clock::time_point start = Clock::now();
+        sf_count_t read = file
+            ? sf_readf_float(file, block->samples.data(), static_cast<sf_count_t>(wanted))
+            : static_cast<sf_count_t>(wavReader.read(block->samples.data(), wanted));
+        if (!file && wavReader.hasFailed())
+        {
+            read = -1;
+        }
+        busy += secondsSince(start);
+
+        if (read < 0)
+        {
+            failed.store(true);
+            read = 0;
+        }
+
+        std::size_t valid = static_cast<std::size_t>(read);
+        std::fill(block->samples.begin() + valid * info.channels, block->samples.end(), 0.0f);
+        block->validFrames = valid;
+        framesRemaining -= valid;
+        last = (valid < blockFrames || framesRemaining == 0);
+        block->last = last;
+        ring.commitWrite();
+        decodeSeconds.store(busy, std::memory_order_relaxed);
+    }
+}
+
+const StreamingDecoder::DecodedBlock* StreamingDecoder::acquire(bool* stalled)
+{
+    if (stalled)
+    {
+        *stalled = false;
+    }
+    if (finished || !isOpen())
+    {
+        return nullptr;
+    }
+
+    DecodedBlock* block = ring.front();
+    unsigned int spins = 0;
+    while (!block)
+    {
+        if (stalled)
+        {
+            *stalled = true;
+        }
+        backoff(spins);
+        block = ring.front();
+    }
+    return block;
+}
+
+void StreamingDecoder::release()
+{
+    DecodedBlock* block = ring.front();
+    if (block)
+    {
+        finished = block->last;
+        ring.pop();
+    }
+}
+
+void StreamingDecoder::close()
+{
+    stopRequested.store(true);
+    if (decodeThread.joinable())
+    {
+        decodeThread.join();
+    }
+    while (ring.front())
+    {
+        ring.pop();
+    }
+    if (file)
+    {
+        sf_close(file);
+        file = nullptr;
+    }
+    wavReader.close();
+    finished = true;
+}
+
+//--------------------------------------------------------------------------
+// OfflineRenderer
+//--------------------------------------------------------------------------
+
+OfflineRenderer::OfflineRenderer(std::size_t frames, std::size_t queue)
+    : blockFrames(std::max<std::size_t>(1, frames)),
+      queueBlocks(std::max<std::size_t>(2, queue)),
+      outputFormat(0),
+      useSinkConfig(false)
+{
+}
+
+void OfflineRenderer::setOutputFormat(int format)
+{
+    outputFormat = format;
+    useSinkConfig = false;
+}
+
+void OfflineRenderer::setOutputEncoding(const SinkConfig& config)
+{
+    sinkConfig = config;
+    useSinkConfig = true;
+}
+
+bool OfflineRenderer::openSink(EncodedFileSink& sink, const std::string& path, const SF_INFO& inInfo)
+{
+    const unsigned int channels = static_cast<unsigned int>(inInfo.channels);
+    const unsigned int rate = static_cast<unsigned int>(inInfo.samplerate);
+    return useSinkConfig ? sink.open(path, channels, rate, sinkConfig)
+                         : sink.open(path, outputFormat != 0 ? outputFormat : inInfo.format, channels, rate);
+}
+
+bool OfflineRenderer::processStream(StreamingDecoder& decoder, const BlockProcessor& processor, uint64_t firstBlock,
+                                    uint64_t prerollFrames, const std::function<void(const float*, std::size_t)>& emit,
+                                    RenderStats& local)
+{
+    const SF_INFO& inInfo = decoder.getInfo();
+    const unsigned int channels = static_cast<unsigned int>(inInfo.channels);
+    std::vector<float> output(blockFrames * channels);
+
+    decoder.start();
+
+    RenderBlock block;
+    block.output = output.data();
+    block.numFrames = blockFrames;
+    block.channels = channels;
+    block.sampleRate = static_cast<unsigned int>(inInfo.samplerate);
+    block.index = firstBlock;
+
+    uint64_t framesSeen = 0;
+    bool stalled = false;
+    while (const StreamingDecoder::DecodedBlock* decoded = decoder.acquire(&stalled))
+    {
+        local.processorStalls += stalled ? 1 : 0;
+
+        if (decoded->validFrames > 0)
+        {
+            block.input = decoded->samples.data();
+            block.validFrames = decoded->validFrames;
+            // Pre-roll is a whole number of blocks, so a block is either all warm-up or all kept
+            block.preroll = framesSeen < prerollFrames;
+
+            Clock::time_point start = Clock::now();
+            processor(block);
+            local.processSeconds += secondsSince(start);
+
+            if (block.preroll)
+            {
+                local.prerollFrames += block.validFrames;
+            }
+            else
+            {
+                emit(output.data(), block.validFrames);
+                local.frames += block.validFrames;
+            }
+
+            framesSeen += block.validFrames;
+            local.blocks++;
+            block.index++;
+        }
+        decoder.release();
+    }
+
+    local.decodeSeconds += decoder.getDecodeSeconds();
+    return !decoder.hasFailed();
+}
+
+bool OfflineRenderer::render(const RenderJob& job, const BlockProcessor& processor, RenderStats* stats)
+{
+    Clock::time_point wallStart = Clock::now();
+
+    StreamingDecoder decoder(blockFrames, queueBlocks);
+    if (!decoder.open(job.inputPath))
+    {
+        return false;
+    }
+
+    // Encoding runs on the sink's own thread, fed in whole blocks
+    SinkConfig config = sinkConfig;
+    config.blockFrames = blockFrames;
+    EncodedFileSink sink(config);
+    if (!job.outputPath.empty() && !openSink(sink, job.outputPath, decoder.getInfo()))
+    {
+        return false;
+    }
+
+    RenderStats local;
+    bool ok = processStream(decoder, processor, 0, 0, [&sink](const float* samples, std::size_t frames) {
+        // Waits only if the encoder is a full queue behind (it is the bottleneck)
+        sink.write(samples, frames, true);
+    }, local);
+
+    decoder.close();
+    ok = sink.close() && ok;
+    local.encodeSeconds = sink.getEncodeSeconds();
+
+    local.wallSeconds = secondsSince(wallStart);
+    if (stats)
+    {
+        *stats = local;
+    }
+    return ok;
+}
+
+bool OfflineRenderer::renderChunked(const RenderJob& job, const BlockProcessorFactory& factory, const ChunkPlan& plan,
+                                    RenderStats* stats)
+{
+    Clock::time_point wallStart = Clock::now();
+
+    SF_INFO inInfo;
+    {
+        StreamingDecoder probe(blockFrames, 2);
+        if (!probe.open(job.inputPath))
+        {
+            return false;
+        }
+        inInfo = probe.getInfo();
+    }
+    const unsigned int channels = static_cast<unsigned int>(inInfo.channels);
+    const unsigned int rate = static_cast<unsigned int>(inInfo.samplerate);
+
+    // Whole blocks keep every chunk on the serial render's block grid
+    auto toBlocks = [this](std::size_t frames) {
+        return std::max<uint64_t>(1, (frames + blockFrames - 1) / blockFrames) * blockFrames;
+    };
+    const uint64_t chunkFrames = toBlocks(plan.chunkFrames);
+    const uint64_t prerollFrames = plan.prerollFrames > 0 ? toBlocks(plan.prerollFrames) : 0;
+    const uint64_t totalFrames = inInfo.frames > 0 ? static_cast<uint64_t>(inInfo.frames) : 0;
+    const std::size_t numChunks = static_cast<std::size_t>((totalFrames + chunkFrames - 1) / chunkFrames);
+
+    if (numChunks < 2)
+    {
+        return render(job, factory(channels, rate), stats);
+    }
+
+    unsigned int threads = plan.threads != 0 ? plan.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned int>(threads, static_cast<unsigned int>(numChunks));
+
+    const bool writeOutput = !job.outputPath.empty();
+    std::vector<std::string> partPaths(numChunks);
+    std::vector<RenderStats> partStats(numChunks);
+    std::vector<char> partOk(numChunks, 0);
+    for (std::size_t i = 0; i < numChunks && writeOutput; ++i)
+    {
+        partPaths[i] = job.outputPath + ".part" + std::to_string(i) + ".wav";
+    }
+
+    std::atomic<std::size_t> nextChunk(0);
+    auto worker = [&]() {
+        for (std::size_t i = nextChunk.fetch_add(1); i < numChunks; i = nextChunk.fetch_add(1))
+        {
+            const uint64_t start = i * chunkFrames;
+            const uint64_t warmup = std::min(prerollFrames, start);
+            const uint64_t length = std::min(chunkFrames, totalFrames - start);
+
+            StreamingDecoder decoder(blockFrames, queueBlocks);
+            if (!decoder.open(job.inputPath, start - warmup, warmup + length))
+            {
+                continue;
+            }
+
+            // Float parts are lossless, so stitching adds no error of its own
+            WavStreamWriter part;
+            if (writeOutput && !part.open(partPaths[i], channels, rate, WavEncoding::Float32))
+            {
+                continue;
+            }
+
+            BlockProcessor processor = factory(channels, rate);
+            bool ok = processStream(decoder, processor, (start - warmup) / blockFrames, warmup,
+                                    [&part, writeOutput](const float* samples, std::size_t frames) {
+                                        if (writeOutput)
+                                        {
+                                            part.write(samples, frames);
+                                        }
+                                    }, partStats[i]);
+            decoder.close();
+            ok = (!writeOutput || part.close()) && ok;
+            partOk[i] = (ok && partStats[i].frames == length) ? 1 : 0;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+
+    RenderStats local;
+    bool ok = true;
+    for (std::size_t i = 0; i < numChunks; ++i)
+    {
+        ok = ok && partOk[i];
+        local.frames += partStats[i].frames;
+        local.blocks += partStats[i].blocks;
+        local.decodeSeconds += partStats[i].decodeSeconds;
+        local.processSeconds += partStats[i].processSeconds;
+        local.processorStalls += partStats[i].processorStalls;
+        local.prerollFrames += partStats[i].prerollFrames;
+    }
+    local.chunks = numChunks;
+
+    // Stitch the parts in order into the requested format
+    if (writeOutput && ok)
+    {
+        SinkConfig config = sinkConfig;
+        config.blockFrames = blockFrames;
+        EncodedFileSink sink(config);
+        ok = openSink(sink, job.outputPath, inInfo);
+
+        std::vector<float> buffer(blockFrames * channels);
+        for (std::size_t i = 0; ok && i < numChunks; ++i)
+        {
+            WavStreamReader part;
+            ok = part.open(partPaths[i]);
+            while (ok)
+            {
+                std::size_t frames = part.read(buffer.data(), blockFrames);
+                if (frames == 0)
+                {
+                    break;
+                }
+                sink.write(buffer.data(), frames, true);
+            }
+            ok = ok && !part.hasFailed();
+        }
+        ok = sink.close() && ok;
+        local.encodeSeconds = sink.getEncodeSeconds();
+    }
+
+    for (const std::string& path : partPaths)
+    {
+        if (!path.empty())
+        {
+            std::remove(path.c_str());
+        }
+    }
+
+    local.wallSeconds = secondsSince(wallStart);
+    if (stats)
+    {
+        *stats = local;
+    }
+    return ok;
+}
+
+std::size_t OfflineRenderer::prerollForTimeConstant(double timeConstantMs, unsigned int sampleRate)
+{
+    return static_cast<std::size_t>(std::ceil(7.0 * timeConstantMs * 0.001 * sampleRate));
+}
+
+std::size_t OfflineRenderer::renderAll(const std::vector<RenderJob>& jobs, const BlockProcessorFactory& factory,
+                                       unsigned int threads, std::vector<RenderStats>* stats)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned int>(threads, static_cast<unsigned int>(jobs.size()));
+    if (stats)
+    {
+        stats->assign(jobs.size(), RenderStats());
+    }
+
+    std::atomic<std::size_t> nextJob(0);
+    std::atomic<std::size_t> succeeded(0);
+
+    auto worker = [&]() {
+        for (std::size_t i = nextJob.fetch_add(1); i < jobs.size(); i = nextJob.fetch_add(1))
+        {
+            // Peek at the format so the factory can size per-channel state
+            SF_INFO probe = SF_INFO();
+            SNDFILE* probeFile = sf_open(jobs[i].inputPath.c_str(), SFM_READ, &probe);
+            if (!probeFile)
+            {
+                std::cerr << "[Offline] ERROR: Cannot open " << jobs[i].inputPath << std::endl;
+                continue;
+            }
+            sf_close(probeFile);
+
+            BlockProcessor processor = factory(static_cast<unsigned int>(probe.channels),
+                                               static_cast<unsigned int>(probe.samplerate));
+            if (render(jobs[i], processor, stats ? &(*stats)[i] : nullptr))
+            {
+                succeeded.fetch_add(1);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+
+    return succeeded.load();
+}
+
+} // namespace audio
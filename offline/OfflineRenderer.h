@@ -0,0 +1,290 @@
+#ifndef OFFLINE_RENDERER_H
+#define OFFLINE_RENDERER_H
+
+#include "../audio/SpscRingBuffer.h"
+#include "EncodedFileSink.h"
+
+#include <sndfile.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audio {
+
+//--------------------------------------------------------------------------
+// Streaming Block Interface
+//--------------------------------------------------------------------------
+
+/**
+ * One block handed to a BlockProcessor.
+ *
+ * Blocks always span numFrames frames; the final block of a file is
+ * zero-padded and validFrames says how much of it is real audio.
+ */
+struct RenderBlock
+{
+    const float* input = nullptr;   // interleaved, numFrames * channels
+    float* output = nullptr;        // interleaved, numFrames * channels
+    std::size_t numFrames = 0;
+    std::size_t validFrames = 0;
+    unsigned int channels = 0;
+    unsigned int sampleRate = 0;
+    uint64_t index = 0;             // block number within the file
+    bool preroll = false;           // warm-up block of a chunk; output is discarded
+};
+
+/**
+ * Processes one block; called sequentially on the render thread.
+ */
+using BlockProcessor = std::function<void(const RenderBlock&)>;
+
+/**
+ * Creates a fresh processor (with its own effect state) for one file.
+ * Receives the input's channel count and sample rate.
+ */
+using BlockProcessorFactory = std::function<BlockProcessor(unsigned int channels, unsigned int sampleRate)>;
+
+/**
+ * Timing for one render, used to check that decode and DSP overlap.
+ */
+struct RenderStats
+{
+    uint64_t frames = 0;
+    uint64_t blocks = 0;
+    double decodeSeconds = 0.0;    // time spent inside the decoder
+    double processSeconds = 0.0;   // time spent inside the processor
+    double encodeSeconds = 0.0;    // time spent in the encoder thread
+    double wallSeconds = 0.0;
+    uint64_t processorStalls = 0;  // times the processor waited on the decoder
+    uint64_t prerollFrames = 0;    // warm-up frames processed and discarded (chunked renders)
+    uint64_t chunks = 0;           // chunks rendered in parallel (chunked renders)
+};
+
+/**
+ * How renderChunked() splits one long file.
+ *
+ * Both lengths are rounded up to whole blocks so every chunk sees the same
+ * block grid as a serial render. The pre-roll must cover the slowest state
+ * in the chain: envelopes (Limiter gain, NoiseGate envelope) decay with
+ * their release time constant, while the EQ and De-Esser STFT buffers
+ * only need the previous FFT frame. See prerollForTimeConstant().
+ */
+struct ChunkPlan
+{
+    std::size_t chunkFrames = 48000 * 300;  // audio each task produces (5 min at 48 kHz)
+    std::size_t prerollFrames = 48000 * 2;  // audio processed before it and discarded
+    unsigned int threads = 0;               // 0: hardware concurrency
+};
+
+//--------------------------------------------------------------------------
+// StreamingDecoder
+//--------------------------------------------------------------------------
+
+/**
+ * Decodes a file on a dedicated thread into a lock-free ring of blocks.
+ *
+ * Any format libsndfile reads (WAV, FLAC, Ogg/Opus, ...) is supported;
+ * PCM and float WAV bypass libsndfile and stream through WavStreamReader,
+ * which keeps several aligned reads in flight (io_uring where available).
+ * The decoder runs ahead by up to queueBlocks blocks so that decoding
+ * and processing overlap.
+ */
+class StreamingDecoder
+{
+public:
+    struct DecodedBlock
+    {
+        std::vector<float> samples;
+        std::size_t validFrames = 0;
+        bool last = false;
+    };
+
+private:
+    SNDFILE* file;
+    WavStreamReader wavReader;      // used instead of file for PCM/float WAV
+    SF_INFO info;
+    std::size_t blockFrames;
+    uint64_t framesRemaining;       // frames left in the requested range
+    SpscRingBuffer<DecodedBlock> ring;
+    std::thread decodeThread;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> failed;
+    std::atomic<double> decodeSeconds;
+    bool finished;
+
+    /**
+     * Decode loop run on decodeThread.
+     */
+    void decodeLoop();
+
+    bool isOpen() const { return file != nullptr || wavReader.isOpen(); }
+
+public:
+    /**
+     * Creates a decoder.
+     * @param frames Frames per block
+     * @param queueBlocks Blocks the decoder may run ahead (default: 16)
+     */
+    explicit StreamingDecoder(std::size_t frames, std::size_t queueBlocks = 16);
+
+    ~StreamingDecoder();
+
+    /**
+     * Opens a file (or a range of it) for decoding.
+     * @param path Input file
+     * @param startFrame First frame to decode (default: 0)
+     * @param frameCount Frames to decode, or 0 for the rest of the file
+     * @return false if the file cannot be opened or seeked
+     */
+    bool open(const std::string& path, uint64_t startFrame = 0, uint64_t frameCount = 0);
+
+    /**
+     * Starts the decode thread.
+     */
+    void start();
+
+    /**
+     * Waits for the next decoded block.
+     * @param stalled Set to true if the call had to wait
+     * @return Block to read, or nullptr once the file is exhausted
+     */
+    const DecodedBlock* acquire(bool* stalled = nullptr);
+
+    /**
+     * Returns the block from acquire() to the decoder.
+     */
+    void release();
+
+    /**
+     * Stops the decode thread and closes the file.
+     */
+    void close();
+
+    const SF_INFO& getInfo() const { return info; }
+    double getDecodeSeconds() const { return decodeSeconds.load(); }
+    bool hasFailed() const { return failed.load(); }
+
+    StreamingDecoder(const StreamingDecoder&) = delete;
+    StreamingDecoder& operator=(const StreamingDecoder&) = delete;
+};
+
+//--------------------------------------------------------------------------
+// OfflineRenderer
+//--------------------------------------------------------------------------
+
+/**
+ * File-to-file renderer that overlaps decoding, processing and encoding.
+ *
+ * Each file gets its own decode thread and encoder thread around the
+ * render thread; multi-file jobs run on a pool of render threads, so
+ * throughput is bound by the slowest stage rather than their sum.
+ */
+class OfflineRenderer
+{
+public:
+    struct RenderJob
+    {
+        std::string inputPath;
+        std::string outputPath;     // empty: process without writing
+    };
+
+private:
+    std::size_t blockFrames;
+    std::size_t queueBlocks;
+    int outputFormat;               // 0: same container/encoding as the input
+    SinkConfig sinkConfig;
+    bool useSinkConfig;             // encode with sinkConfig instead of outputFormat
+
+    /**
+     * Opens the output sink for a job in the configured format.
+     */
+    bool openSink(EncodedFileSink& sink, const std::string& path, const SF_INFO& inInfo);
+
+    /**
+     * Runs every decoded block through the processor, discarding the first
+     * prerollFrames of output and passing the rest to emit.
+     */
+    bool processStream(StreamingDecoder& decoder, const BlockProcessor& processor, uint64_t firstBlock,
+                       uint64_t prerollFrames, const std::function<void(const float*, std::size_t)>& emit,
+                       RenderStats& local);
+
+public:
+    /**
+     * Creates a renderer.
+     * @param frames Frames per block (default: 2048)
+     * @param queue Decoded blocks buffered ahead of the processor (default: 16)
+     */
+    explicit OfflineRenderer(std::size_t frames = 2048, std::size_t queue = 16);
+
+    /**
+     * Sets the libsndfile format for output files.
+     * @param format SF_FORMAT_* major|minor, or 0 to match the input
+     */
+    void setOutputFormat(int format);
+
+    /**
+     * Encodes output files with the given sink settings (e.g. FLAC at maximum compression).
+     * @param config Encoding, compression level and queue depth
+     */
+    void setOutputEncoding(const SinkConfig& config);
+
+    /**
+     * Renders one file.
+     *
+     * @param job Input and output paths
+     * @param processor Block processor, called in order on this thread
+     * @param stats Optional timing
+     * @return true if the whole file was decoded and written
+     */
+    bool render(const RenderJob& job, const BlockProcessor& processor, RenderStats* stats = nullptr);
+
+    /**
+     * Renders several files in parallel.
+     *
+     * @param jobs Files to render
+     * @param factory Creates an independent processor per file
+     * @param threads Render threads (0: hardware concurrency)
+     * @param stats Optional per-job timing, resized to jobs.size()
+     * @return Number of jobs that succeeded
+     */
+    std::size_t renderAll(const std::vector<RenderJob>& jobs, const BlockProcessorFactory& factory,
+                          unsigned int threads = 0, std::vector<RenderStats>* stats = nullptr);
+
+    /**
+     * Renders one long file as chunks processed in parallel.
+     *
+     * Each chunk gets its own processor from the factory and is pre-rolled
+     * with the audio before it so effect state has converged by the time its
+     * output is kept. Chunks are rendered to temporary float WAV files next
+     * to the output and stitched in order into the final file, which then
+     * matches a serial render to within the pre-roll's convergence error.
+     * Falls back to render() when the file is shorter than two chunks or its
+     * length is unknown.
+     *
+     * @param job Input and output paths
+     * @param factory Creates an independent processor per chunk
+     * @param plan Chunk length, pre-roll and thread count
+     * @param stats Optional timing summed over chunks
+     * @return true if every chunk was rendered and stitched
+     */
+    bool renderChunked(const RenderJob& job, const BlockProcessorFactory& factory, const ChunkPlan& plan,
+                       RenderStats* stats = nullptr);
+
+    /**
+     * Gets a pre-roll long enough for a one-pole envelope to settle.
+     * @param timeConstantMs Longest attack/release time in the chain
+     * @param sampleRate Sample rate in Hz
+     * @return Frames for the envelope to decay to about -60 dB (7 time constants)
+     */
+    static std::size_t prerollForTimeConstant(double timeConstantMs, unsigned int sampleRate);
+
+    std::size_t getBlockFrames() const { return blockFrames; }
+};
+
+} // namespace audio
+
+#endif // OFFLINE_RENDERER_H
@@ -1,12 +1,13 @@
 // AudioTestRunner.cpp
-// A driver program to apply audio processors and log raw vs. processed RMS values to CSV
-// Command to compile: g++ -std=c++17 -Ieffects tests/AudioTestRunner.cpp effects/DeEsser.cpp effects/Limiter.cpp effects/NoiseGate.cpp effects/ThreeBandEQ.cpp -lsndfile -lfftw3 -o audiotest
+// A driver program to apply audio processors and log raw vs. processed RMS values (columnar metrics or CSV)
+// Command to compile: g++ -std=c++17 -Ieffects tests/AudioTestRunner.cpp offline/OfflineRenderer.cpp offline/EncodedFileSink.cpp offline/FrameAnalyzer.cpp offline/MetricsFile.cpp audio/WavStream.cpp audio/AsyncFileIO.cpp effects/DeEsser.cpp effects/Limiter.cpp effects/NoiseGate.cpp effects/ThreeBandEQ.cpp effects/StftEngine.cpp effects/SpectralKernels.cpp effects/SideChain.cpp effects/VoiceActivity.cpp -lsndfile -lfftw3 -pthread -o audiotest
 // Command to run: ./audiotest
 
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <cmath>
+#include <memory>
 #include <sndfile.h>
 
 // Include your processor headers here
@@ -14,6 +15,9 @@
 #include "../effects/Limiter.h"
 #include "../effects/NoiseGate.h"
 #include "../effects/ThreeBandEQ.h"
+#include "../offline/OfflineRenderer.h"
+#include "../offline/FrameAnalyzer.h"
+#include "../offline/MetricsFile.h"
 
 float calculateRMS(const std::vector<float>& buffer) {
     double sumSquares = 0.0;
@@ -32,71 +36,122 @@ void writeCSV(const std::string& path, const std::vector<float>& rawRMS, const s
     file.close();
 }
 
+// Typed columns, no per-value formatting; read back with tools/MetricsDump.cpp or audio::MetricsReader
+bool writeMetrics(const std::string& path, const std::vector<float>& rawRMS, const std::vector<float>& processedRMS) {
+    audio::MetricsWriter writer;
+    if (!writer.open(path, { { "frame", audio::MetricType::UInt64 },
+                             { "raw_rms", audio::MetricType::Float32 },
+                             { "processed_rms", audio::MetricType::Float32 } })) {
+        return false;
+    }
+    for (size_t i = 0; i < rawRMS.size(); ++i) {
+        writer.set<uint64_t>(0, i);
+        writer.set<float>(1, rawRMS[i]);
+        writer.set<float>(2, processedRMS[i]);
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+// Per-channel effect instances so state carries across blocks of the stream
+struct ChannelEffects {
+    std::unique_ptr<audio::Limiter> limiter;
+    std::unique_ptr<audio::NoiseGate> gate;
+    std::unique_ptr<audio::ThreeBandEQ> eq;
+};
+
 int main() {
     // === HARDCODED INPUT ===
+    // Any format libsndfile decodes works here (WAV, FLAC, Ogg/Opus, ...)
     std::string inputPath = "tests/eq-input.wav";
     std::string outputPath = "tests/eq-output.wav";
     std::string effectType = "eq";  // Options: "deesser", "limiter", "noisegate", "eq"
+    bool analysisOnly = false;      // true: per-frame features of the input, no audio rendered
+    bool textCSV = false;           // true: analysis.csv instead of the columnar analysis.metrics
 
-    SF_INFO sfInfo;
-    SNDFILE* inFile = sf_open(inputPath.c_str(), SFM_READ, &sfInfo);
-    if (!inFile) {
-        std::cerr << "Error reading input WAV file: " << inputPath << std::endl;
-        return 1;
-    }
+    const size_t frameSize = 2048;
 
-    std::vector<float> inputBuffer(sfInfo.frames * sfInfo.channels);
-    sf_readf_float(inFile, inputBuffer.data(), sfInfo.frames);
-    sf_close(inFile);
+    if (analysisOnly) {
+        // Gate/limiter defaults match the effect settings used below
+        audio::AnalysisSettings settings;
+        std::vector<audio::FrameFeatures> features;
+        audio::RenderStats stats;
+        std::string analysisPath = textCSV ? "analysis.csv" : "analysis.metrics";
+        bool written = audio::FrameAnalyzer::analyzeFile(inputPath, settings, frameSize, features, &stats) &&
+                       (textCSV ? audio::FrameAnalyzer::writeCSV(analysisPath, features)
+                                : audio::FrameAnalyzer::writeMetrics(analysisPath, features));
+        if (!written) {
+            std::cerr << "Error analyzing " << inputPath << std::endl;
+            return 1;
+        }
+        std::cout << "Analyzed " << features.size() << " frames in " << stats.wallSeconds
+                  << " s; features saved to " << analysisPath << "\n";
+        return 0;
+    }
 
-    std::vector<float> outputBuffer(inputBuffer.size(), 0.0f);
     std::vector<float> rawRMS, processedRMS;
+    std::vector<ChannelEffects> channelEffects;
+    std::vector<float> channelIn(frameSize), channelOut(frameSize);
+
+    // Decoding runs on the renderer's decode thread; this runs on the render thread
+    audio::BlockProcessor processor = [&](const audio::RenderBlock& block) {
+        const unsigned int channels = block.channels;
+        if (channelEffects.empty()) {
+            channelEffects.resize(channels);
+            for (ChannelEffects& fx : channelEffects) {
+                fx.limiter.reset(new audio::Limiter(block.sampleRate, 0.6f, 10.0f, 100.0f));
+                fx.limiter->setEnabled(true);
+                fx.gate.reset(new audio::NoiseGate(block.sampleRate, frameSize, 0.1f, 20.0f, 200.0f));
+                fx.gate->setEnabled(true);
+                fx.eq.reset(new audio::ThreeBandEQ(block.sampleRate, frameSize));
+                fx.eq->setEnabled(true);
+                fx.eq->setBandGain(0, 1.5f); // bass
+                fx.eq->setBandGain(1, 0.8f); // mid
+                fx.eq->setBandGain(2, 1.2f); // treble
+            }
+        }
 
-    const size_t frameSize = 2048;
-
-    for (size_t i = 0; i < inputBuffer.size(); i += frameSize) {
-        size_t end = std::min(i + frameSize, inputBuffer.size());
-        std::vector<float> raw(inputBuffer.begin() + i, inputBuffer.begin() + end);
-        std::vector<float> processed = raw;
-
-        if (effectType == "deesser") {
-            std::vector<double> samples(raw.begin(), raw.end());
-            audio::applyDeEsser(samples, sfInfo.samplerate, 4000, 10000, 6.0);
-            for (size_t j = 0; j < samples.size(); ++j) processed[j] = (float)samples[j];
-        } else if (effectType == "limiter") {
-            audio::Limiter lim(sfInfo.samplerate, 0.6f, 10.0f, 100.0f);
-            lim.setEnabled(true);
-            lim.process(raw.data(), processed.data(), raw.size());
-        } else if (effectType == "noisegate") {
-            audio::NoiseGate gate(sfInfo.samplerate, frameSize, 0.1f, 20.0f, 200.0f);
-            gate.setEnabled(true);
-            gate.process(raw.data(), processed.data(), raw.size());
-        } else if (effectType == "eq") {
-            audio::ThreeBandEQ eq(sfInfo.samplerate, frameSize);
-            eq.setEnabled(true);
-            eq.setBandGain(0, 1.5f); // bass
-            eq.setBandGain(1, 0.8f); // mid
-            eq.setBandGain(2, 1.2f); // treble
-            eq.process(raw.data(), processed.data(), raw.size());
+        for (unsigned int ch = 0; ch < channels; ++ch) {
+            for (size_t i = 0; i < block.numFrames; ++i) channelIn[i] = block.input[i * channels + ch];
+
+            if (effectType == "deesser") {
+                std::vector<double> samples(channelIn.begin(), channelIn.begin() + block.numFrames);
+                audio::applyDeEsser(samples, block.sampleRate, 4000, 10000, 6.0);
+                for (size_t j = 0; j < samples.size(); ++j) channelOut[j] = (float)samples[j];
+            } else if (effectType == "limiter") {
+                channelEffects[ch].limiter->process(channelIn.data(), channelOut.data(), block.numFrames);
+            } else if (effectType == "noisegate") {
+                channelEffects[ch].gate->process(channelIn.data(), channelOut.data(), block.numFrames);
+            } else if (effectType == "eq") {
+                channelEffects[ch].eq->process(channelIn.data(), channelOut.data(), block.numFrames);
+            } else {
+                std::copy(channelIn.begin(), channelIn.begin() + block.numFrames, channelOut.begin());
+            }
+
+            for (size_t i = 0; i < block.numFrames; ++i) block.output[i * channels + ch] = channelOut[i];
         }
 
-        rawRMS.push_back(calculateRMS(raw));
-        processedRMS.push_back(calculateRMS(processed));
+        size_t validSamples = block.validFrames * channels;
+        rawRMS.push_back(calculateRMS(std::vector<float>(block.input, block.input + validSamples)));
+        processedRMS.push_back(calculateRMS(std::vector<float>(block.output, block.output + validSamples)));
+    };
 
-        std::copy(processed.begin(), processed.end(), outputBuffer.begin() + i);
+    audio::OfflineRenderer renderer(frameSize);
+    audio::RenderStats stats;
+    if (!renderer.render({ inputPath, outputPath }, processor, &stats)) {
+        std::cerr << "Error rendering " << inputPath << " to " << outputPath << std::endl;
+        return 1;
     }
 
-    SF_INFO outInfo = sfInfo;
-    SNDFILE* outFile = sf_open(outputPath.c_str(), SFM_WRITE, &outInfo);
-    if (!outFile) {
-        std::cerr << "Error writing output WAV file: " << outputPath << std::endl;
+    std::string analysisPath = textCSV ? "analysis.csv" : "analysis.metrics";
+    if (textCSV) {
+        writeCSV(analysisPath, rawRMS, processedRMS);
+    } else if (!writeMetrics(analysisPath, rawRMS, processedRMS)) {
+        std::cerr << "Error writing " << analysisPath << std::endl;
         return 1;
     }
-
-    sf_writef_float(outFile, outputBuffer.data(), sfInfo.frames);
-    sf_close(outFile);
-
-    writeCSV("analysis.csv", rawRMS, processedRMS);
-    std::cout << "Done. Output saved to " << outputPath << " and analysis to analysis.csv\n";
+    std::cout << "Done. Output saved to " << outputPath << " and analysis to " << analysisPath << "\n";
+    std::cout << "Rendered " << stats.frames << " frames in " << stats.wallSeconds << " s (decode "
+              << stats.decodeSeconds << " s, process " << stats.processSeconds << " s, overlapped)\n";
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+// BlockLatencyTest.cpp
+// Sends numbered, timestamped blocks through the input and output BufferQueues with a
+// processing thread in between that drops one block and swaps two, and checks that the
+// output side measures the latency and reports the drop and the reorder.
+// Command to compile: g++ -std=c++17 -I. tests/BlockLatencyTest.cpp audio/BufferQueue.cpp audio/LatencyTracker.cpp -pthread -o latencytest
+// Command to run: ./latencytest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "../audio/BufferQueue.h"
+#include "../audio/LatencyTracker.h"
+#include "TestUtils.h"
+
+const uint64_t BLOCKS = 100;
+const uint64_t DROPPED_BLOCK = 20;
+const uint64_t SWAPPED_BLOCK = 40;       // played after SWAPPED_BLOCK + 1
+const auto PROCESSING_TIME = std::chrono::milliseconds(1);
+
+int main() {
+    bool ok = true;
+
+    // Headerless pushes are numbered in order and buffers survive the swap-out pop
+    {
+        audio::BufferQueue queue(4);
+        queue.push(std::vector<float>(8, 1.0f));
+        queue.push(std::vector<float>(8, 2.0f));
+        std::vector<float> buffer(3, 0.0f);
+        audio::BlockHeader first, second;
+        ok &= check(queue.pop(buffer, first) && buffer.size() == 8 && buffer[0] == 1.0f &&
+                    queue.pop(buffer, second) && buffer[7] == 2.0f &&
+                    first.sequence == 0 && second.sequence == 1, "headerless blocks numbered in push order");
+    }
+
+    audio::BufferQueue inputQueue(4, audio::TRACE_QUEUE_INPUT);
+    audio::BufferQueue outputQueue(4, audio::TRACE_QUEUE_OUTPUT);
+    audio::LatencyTracker tracker;
+
+    std::thread processing([&] {
+        std::vector<float> block;
+        audio::BlockHeader header, held;
+        bool holding = false;
+        while (inputQueue.pop(block, header)) {
+            header.stamp(audio::BlockStage::Dequeue);
+            if (header.sequence == DROPPED_BLOCK) {
+                continue;
+            }
+            std::this_thread::sleep_for(PROCESSING_TIME);
+            header.stamp(audio::BlockStage::Processed);
+            if (header.sequence == SWAPPED_BLOCK) {
+                held = header;
+                holding = true;
+                continue;
+            }
+            header.stamp(audio::BlockStage::Enqueue);
+            outputQueue.push(block, header);
+            if (holding) {
+                held.stamp(audio::BlockStage::Enqueue);
+                outputQueue.push(block, held);
+                holding = false;
+            }
+        }
+        outputQueue.setDone();
+    });
+
+    std::thread output([&] {
+        std::vector<float> block;
+        audio::BlockHeader header;
+        while (outputQueue.pop(block, header)) {
+            header.stamp(audio::BlockStage::Playout);
+            tracker.record(header);
+        }
+    });
+
+    for (uint64_t i = 0; i < BLOCKS; ++i) {
+        audio::BlockHeader header;
+        header.sequence = i;
+        header.streamTime = i * 0.01;
+        header.stamp(audio::BlockStage::Capture);
+        inputQueue.push(std::vector<float>(256, 0.0f), header);
+    }
+    inputQueue.setDone();
+    processing.join();
+    output.join();
+
+    ok &= check(tracker.getBlocks() == BLOCKS - 1, "every block but the dropped one played");
+    ok &= check(tracker.getDropped() == 1, "gap reported as one dropped block");
+    ok &= check(tracker.getReordered() == 1, "late block reported as reordered");
+
+    const double processingMs = std::chrono::duration<double, std::milli>(PROCESSING_TIME).count();
+    ok &= check(tracker.getMinLatencyMs() >= processingMs && tracker.getMaxLatencyMs() >= tracker.getMeanLatencyMs() &&
+                tracker.getMeanLatencyMs() >= tracker.getMinLatencyMs(), "latency covers the processing time");
+    ok &= check(tracker.getMeanStageMs(audio::BlockStage::Processed) >= processingMs &&
+                tracker.getMeanStageMs(audio::BlockStage::Capture) == 0.0, "per-stage time attributed to processing");
+
+    uint64_t histogramTotal = 0;
+    for (size_t b = 0; b < audio::LATENCY_HISTOGRAM_BUCKETS; ++b) {
+        histogramTotal += tracker.getHistogramCount(b);
+    }
+    ok &= check(histogramTotal == BLOCKS - 1, "latency histogram counts every timed block");
+
+    std::cout << "Latency mean " << tracker.getMeanLatencyMs() << " ms, min " << tracker.getMinLatencyMs()
+              << " ms, max " << tracker.getMaxLatencyMs() << " ms" << std::endl;
+
+    tracker.reset();
+    ok &= check(tracker.getBlocks() == 0 && tracker.getMinLatencyMs() == 0.0, "reset clears statistics");
+
+    std::cout << (ok ? "All block latency tests passed." : "Block latency tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+// ChunkedRenderTest.cpp
+// Renders one long file serially and as parallel pre-rolled chunks through a per-channel
+// NoiseGate + Limiter chain, and checks that the stitched output matches the serial render.
+// Command to compile: g++ -std=c++17 -I. tests/ChunkedRenderTest.cpp offline/OfflineRenderer.cpp offline/EncodedFileSink.cpp audio/WavStream.cpp audio/AsyncFileIO.cpp effects/NoiseGate.cpp effects/Limiter.cpp effects/StftEngine.cpp effects/SpectralKernels.cpp effects/SideChain.cpp effects/VoiceActivity.cpp -lsndfile -lfftw3 -pthread -o chunktest
+// Command to run: ./chunktest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "../offline/OfflineRenderer.h"
+#include "../effects/NoiseGate.h"
+#include "../effects/Limiter.h"
+#include "TestUtils.h"
+
+const unsigned int CHANNELS = 2;
+const unsigned int SAMPLE_RATE_HZ = 48000;
+const size_t FRAMES = SAMPLE_RATE_HZ * 60 + 12345;  // not a whole number of blocks
+const float RELEASE_MS = 200.0f;
+
+// Tone whose level steps every 1.5 s, so gate and limiter envelopes move across chunk edges
+void writeSource(const std::string& path) {
+    std::vector<float> samples(FRAMES * CHANNELS);
+    for (size_t i = 0; i < FRAMES; ++i) {
+        float level = ((i / (SAMPLE_RATE_HZ * 3 / 2)) % 3 == 0) ? 0.01f : 0.6f;
+        for (unsigned int c = 0; c < CHANNELS; ++c) {
+            samples[i * CHANNELS + c] = level * static_cast<float>(std::sin(0.031 * i * (c + 1)));
+        }
+    }
+    audio::WavStreamWriter writer;
+    writer.open(path, CHANNELS, SAMPLE_RATE_HZ, audio::WavEncoding::Float32);
+    writer.write(samples.data(), FRAMES);
+    writer.close();
+}
+
+// Deinterleaves each block through an independent gate and limiter per channel
+audio::BlockProcessor makeChain(unsigned int channels, unsigned int rate) {
+    struct State {
+        std::vector<std::unique_ptr<audio::NoiseGate>> gates;
+        std::vector<std::unique_ptr<audio::Limiter>> limiters;
+        std::vector<float> in, out;
+    };
+    auto state = std::make_shared<State>();
+    for (unsigned int c = 0; c < channels; ++c) {
+        state->gates.emplace_back(new audio::NoiseGate(rate, FFT_SIZE, 0.05f, 5.0f, RELEASE_MS));
+        state->limiters.emplace_back(new audio::Limiter(rate, 0.3f, 5.0f, RELEASE_MS));
+        state->gates.back()->setEnabled(true);
+        state->limiters.back()->setEnabled(true);
+    }
+    return [state](const audio::RenderBlock& block) {
+        state->in.resize(block.numFrames);
+        state->out.resize(block.numFrames);
+        for (unsigned int c = 0; c < block.channels; ++c) {
+            for (size_t i = 0; i < block.numFrames; ++i) state->in[i] = block.input[i * block.channels + c];
+            state->gates[c]->process(state->in.data(), state->out.data(), block.numFrames);
+            state->limiters[c]->process(state->out.data(), state->in.data(), block.numFrames);
+            for (size_t i = 0; i < block.numFrames; ++i) block.output[i * block.channels + c] = state->in[i];
+        }
+    };
+}
+
+std::vector<float> readAll(const std::string& path, uint64_t& frames) {
+    audio::WavStreamReader reader;
+    frames = 0;
+    if (!reader.open(path)) return {};
+    frames = reader.getInfo().frames;
+    std::vector<float> samples(frames * reader.getInfo().channels);
+    frames = reader.read(samples.data(), frames);
+    return samples;
+}
+
+int main() {
+    bool ok = true;
+    const std::string source = "chunktest-in.wav";
+    const std::string serialPath = "chunktest-serial.wav";
+    const std::string chunkedPath = "chunktest-chunked.wav";
+    writeSource(source);
+
+    audio::OfflineRenderer renderer(1024);
+    audio::SinkConfig sink;
+    sink.format = audio::SinkFormat::WavFloat;
+    renderer.setOutputEncoding(sink);
+
+    audio::RenderStats serialStats;
+    ok &= check(renderer.render({ source, serialPath }, makeChain(CHANNELS, SAMPLE_RATE_HZ), &serialStats),
+                "serial render completes");
+
+    audio::ChunkPlan plan;
+    plan.chunkFrames = SAMPLE_RATE_HZ * 10;
+    plan.prerollFrames = audio::OfflineRenderer::prerollForTimeConstant(RELEASE_MS, SAMPLE_RATE_HZ);
+    plan.threads = 4;
+    audio::RenderStats chunkedStats;
+    ok &= check(renderer.renderChunked({ source, chunkedPath }, makeChain, plan, &chunkedStats),
+                "chunked render completes");
+    ok &= check(chunkedStats.chunks == 7 && chunkedStats.frames == FRAMES && chunkedStats.prerollFrames > 0,
+                "chunks cover the file exactly once (" + std::to_string(chunkedStats.chunks) + " chunks, " +
+                std::to_string(chunkedStats.prerollFrames) + " pre-roll frames)");
+
+    uint64_t serialFrames = 0, chunkedFrames = 0;
+    std::vector<float> serial = readAll(serialPath, serialFrames);
+    std::vector<float> chunked = readAll(chunkedPath, chunkedFrames);
+    ok &= check(serialFrames == FRAMES && chunkedFrames == FRAMES, "outputs have the input's length");
+
+    uint64_t sourceFrames = 0;
+    std::vector<float> input = readAll(source, sourceFrames);
+    double change = 0.0;
+    for (size_t i = 0; i < serial.size() && i < input.size(); ++i) {
+        change = std::max(change, std::fabs(static_cast<double>(serial[i]) - input[i]));
+    }
+    ok &= check(change > 0.1, "chain changes the signal");
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < serial.size() && i < chunked.size(); ++i) {
+        maxError = std::max(maxError, std::fabs(static_cast<double>(serial[i]) - chunked[i]));
+    }
+    std::cout << "Max difference from serial render: " << maxError << std::endl;
+    ok &= check(!serial.empty() && maxError < 1e-3, "stitched output matches the serial render");
+
+    bool partsRemoved = true;
+    for (uint64_t i = 0; i < chunkedStats.chunks; ++i) {
+        partsRemoved &= !std::ifstream(chunkedPath + ".part" + std::to_string(i) + ".wav").good();
+    }
+    ok &= check(partsRemoved, "temporary chunk files are removed");
+
+    std::remove(source.c_str());
+    std::remove(serialPath.c_str());
+    std::remove(chunkedPath.c_str());
+    std::cout << (ok ? "All chunked render tests passed." : "Chunked render tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+// ControlInputTest.cpp
+// Checks the control surface input: OSC messages and bundles parse in place (malformed packets are
+// rejected, as are non-finite arguments), every parameter answers at its OSC address, MIDI
+// controllers scale onto their ranges, and a burst of OSC over loopback UDP reaches a chain
+// processing on another thread, ending on the last value sent with hostile values dropped or clamped.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/ControlInputTest.cpp audio/ControlInput.cpp $CHAIN_SOURCES -lfftw3 -pthread -o controltest
+// Command to run: ./controltest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+#include "../audio/ControlInput.h"
+#include "../audio/EffectChain.h"
+#include "../audio/ParameterQueue.h"
+#include "TestUtils.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+const unsigned int RATE = 48000;
+
+void appendBigEndian(std::vector<uint8_t>& bytes, uint32_t value) {
+    bytes.push_back(static_cast<uint8_t>(value >> 24));
+    bytes.push_back(static_cast<uint8_t>(value >> 16));
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void appendString(std::vector<uint8_t>& bytes, const char* text) {
+    const size_t length = std::strlen(text) + 1;
+    bytes.insert(bytes.end(), text, text + length);
+    while (bytes.size() % 4 != 0) bytes.push_back(0);
+}
+
+// A message with a type tag string and raw argument words
+std::vector<uint8_t> makeMessage(const char* address, const char* types, const std::vector<uint32_t>& words) {
+    std::vector<uint8_t> bytes;
+    appendString(bytes, address);
+    appendString(bytes, types);
+    for (uint32_t word : words) appendBigEndian(bytes, word);
+    return bytes;
+}
+
+std::vector<uint8_t> makeBundle(const std::vector<std::vector<uint8_t>>& elements) {
+    std::vector<uint8_t> bytes;
+    appendString(bytes, "#bundle");
+    appendBigEndian(bytes, 0);
+    appendBigEndian(bytes, 1);          // time tag "immediately"
+    for (const std::vector<uint8_t>& element : elements) {
+        appendBigEndian(bytes, static_cast<uint32_t>(element.size()));
+        bytes.insert(bytes.end(), element.begin(), element.end());
+    }
+    return bytes;
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+int main() {
+    bool ok = true;
+
+    // Message parsing: argument types, round trip through the builder, malformed input
+    {
+        audio::OscMessage message;
+        uint8_t packet[audio::OSC_MAX_PACKET_SIZE];
+        const size_t size = audio::buildOscMessage(packet, sizeof(packet), "/limiter/threshold", 0.625f);
+        ok &= check(size == 28 && audio::parseOscMessage(packet, size, message) &&
+                    std::strcmp(message.address, "/limiter/threshold") == 0 && message.type == 'f' &&
+                    message.value == 0.625f, "built float message parses back");
+        ok &= check(audio::buildOscMessage(packet, 16, "/limiter/threshold", 0.625f) == 0,
+                    "builder refuses a buffer that is too small");
+
+        std::vector<uint8_t> integer = makeMessage("/eq/low_gain", ",i", { 3 });
+        ok &= check(audio::parseOscMessage(integer.data(), integer.size(), message) && message.value == 3.0f,
+                    "integer argument converts to float");
+        std::vector<uint8_t> on = makeMessage("/gate/enabled", ",T", {});
+        std::vector<uint8_t> off = makeMessage("/gate/enabled", ",F", {});
+        ok &= check(audio::parseOscMessage(on.data(), on.size(), message) && message.value == 1.0f &&
+                    audio::parseOscMessage(off.data(), off.size(), message) && message.value == 0.0f,
+                    "T and F arguments parse as 1 and 0");
+
+        std::vector<uint8_t> truncated = makeMessage("/eq/low_gain", ",f", { floatBits(1.0f) });
+        truncated.resize(truncated.size() - 4);
+        std::vector<uint8_t> noTypes = { '/', 'a', 0, 0, 'x', 0, 0, 0 };
+        std::vector<uint8_t> text = makeMessage("/eq/low_gain", ",s", {});
+        appendString(text, "loud");
+        std::vector<uint8_t> unterminated(12, 'a');
+        unterminated[0] = '/';
+        ok &= check(!audio::parseOscMessage(truncated.data(), truncated.size(), message) &&
+                    !audio::parseOscMessage(noTypes.data(), noTypes.size(), message) &&
+                    !audio::parseOscMessage(text.data(), text.size(), message) &&
+                    !audio::parseOscMessage(unterminated.data(), unterminated.size(), message),
+                    "truncated, untyped, non-numeric and unterminated messages are rejected");
+
+        std::vector<uint8_t> notANumber = makeMessage("/eq/low_gain", ",f", { floatBits(std::nanf("")) });
+        std::vector<uint8_t> infinite = makeMessage("/eq/low_gain", ",f", { floatBits(INFINITY) });
+        std::vector<uint8_t> hugeDouble = makeMessage("/eq/low_gain", ",d", { 0x7fefffff, 0xffffffff });
+        ok &= check(!audio::parseOscMessage(notANumber.data(), notANumber.size(), message) &&
+                    !audio::parseOscMessage(infinite.data(), infinite.size(), message) &&
+                    !audio::parseOscMessage(hugeDouble.data(), hugeDouble.size(), message),
+                    "NaN, infinite and beyond-float arguments are rejected");
+    }
+
+    // Bundles: nested elements are visited in order, bad lengths and deep nesting are counted
+    {
+        std::vector<uint8_t> inner = makeBundle({ makeMessage("/gate/threshold", ",f", { floatBits(0.1f) }),
+                                                  makeMessage("/gate/release_ms", ",i", { 120 }) });
+        std::vector<uint8_t> outer = makeBundle({ makeMessage("/eq/enabled", ",T", {}), inner,
+                                                  makeMessage("/nowhere", ",f", { floatBits(2.0f) }) });
+        std::vector<std::string> addresses;
+        std::vector<float> values;
+        const size_t malformed = audio::forEachOscMessage(outer.data(), outer.size(), [&](const audio::OscMessage& m) {
+            addresses.push_back(m.address);
+            values.push_back(m.value);
+        });
+        ok &= check(malformed == 0 && addresses.size() == 4 && addresses[1] == "/gate/threshold" &&
+                    addresses[2] == "/gate/release_ms" && values[2] == 120.0f && addresses[3] == "/nowhere",
+                    "nested bundle yields its 4 messages in order");
+
+        std::vector<uint8_t> badLength = outer;
+        badLength[19] = 0xff;           // first element claims more bytes than the packet holds
+        size_t visited = 0;
+        ok &= check(audio::forEachOscMessage(badLength.data(), badLength.size(), [&](const audio::OscMessage&) { ++visited; }) == 1 &&
+                    visited == 0, "bundle element running past the packet is rejected");
+
+        std::vector<uint8_t> deep = makeMessage("/eq/enabled", ",T", {});
+        for (int i = 0; i <= audio::OSC_MAX_BUNDLE_DEPTH; ++i) deep = makeBundle({ deep });
+        visited = 0;
+        ok &= check(audio::forEachOscMessage(deep.data(), deep.size(), [&](const audio::OscMessage&) { ++visited; }) == 1 &&
+                    visited == 0, "bundles nested past the depth limit are rejected");
+    }
+
+    // Control map: every parameter answers at its address, MIDI scales onto ranges
+    {
+        audio::ControlMap map;
+        bool allFound = true;
+        for (size_t i = 0; i < audio::PARAMETER_ID_COUNT; ++i) {
+            const audio::ParameterId expected = static_cast<audio::ParameterId>(i);
+            std::string address = std::string("/") + audio::parameterName(expected);
+            for (char& c : address) if (c == '.') c = '/';
+            audio::ParameterId id;
+            allFound &= map.lookupOsc(address.c_str(), id) && id == expected;
+        }
+        audio::ParameterId id;
+        ok &= check(allFound, "every parameter resolves from its OSC address");
+        ok &= check(!map.lookupOsc("/limiter/threshol", id) && !map.lookupOsc("/limiter/thresholds", id) &&
+                    !map.lookupOsc("/", id), "unknown addresses are not mapped");
+
+        float value = 0.0f;
+        const uint8_t thresholdCC = audio::MIDI_DEFAULT_FIRST_CC + static_cast<uint8_t>(audio::ParameterId::LimiterThreshold);
+        const uint8_t enableCC = audio::MIDI_DEFAULT_FIRST_CC + static_cast<uint8_t>(audio::ParameterId::EQEnabled);
+        ok &= check(map.lookupMidi(thresholdCC, 127, id, value) && id == audio::ParameterId::LimiterThreshold &&
+                    value == 1.0f && map.lookupMidi(thresholdCC, 0, id, value) && value == 0.0f,
+                    "default MIDI map scales CC " + std::to_string(thresholdCC) + " onto the limiter threshold");
+        float low = -1.0f, high = -1.0f;
+        ok &= check(map.lookupMidi(enableCC, 63, id, low) && map.lookupMidi(enableCC, 64, id, high) &&
+                    id == audio::ParameterId::EQEnabled && low == 0.0f && high == 1.0f,
+                    "enable toggles switch at 64");
+        map.mapMidiController(7, audio::ParameterId::DeEsserReduction, 0.0f, 12.7f);
+        map.mapMidiController(thresholdCC, audio::ParameterId::Count, 0.0f, 1.0f);
+        ok &= check(map.lookupMidi(7, 10, id, value) && id == audio::ParameterId::DeEsserReduction &&
+                    std::fabs(value - 1.0f) < 1e-5f && !map.lookupMidi(thresholdCC, 64, id, value) &&
+                    !map.lookupMidi(1, 64, id, value), "controllers can be remapped and unmapped");
+    }
+
+#ifdef __linux__
+    // Loopback: an OSC burst reaches a chain processing blocks on another thread
+    {
+        audio::NoiseGate gate;
+        audio::ThreeBandEQ eq;
+        audio::Limiter limiter;
+        audio::DeEsserSettings deesser;
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        audio::ParameterQueue controlQueue(1024);
+        chain.setParameterQueue(&controlQueue, 1);
+
+        audio::ControlInput input(controlQueue);
+        const bool listening = input.openOsc(0) && input.getOscPort() != 0 && input.start();
+        ok &= check(listening, "control input listens on udp://127.0.0.1:" + std::to_string(input.getOscPort()));
+
+        std::atomic<bool> processing(true);
+        std::thread audioThread([&]() {
+            std::vector<float> in(480, 0.1f), out(480);
+            do {
+                chain.process(in.data(), out.data(), in.size());
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            } while (processing.load());
+            chain.process(in.data(), out.data(), in.size());    // take whatever arrived last
+        });
+
+        const int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in target;
+        std::memset(&target, 0, sizeof(target));
+        target.sin_family = AF_INET;
+        target.sin_port = htons(input.getOscPort());
+        ::inet_pton(AF_INET, "127.0.0.1", &target.sin_addr);
+
+        const int MESSAGES = 5000;
+        const int UNMAPPED = 50;
+        uint8_t packet[audio::OSC_MAX_PACKET_SIZE];
+        const auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < MESSAGES + UNMAPPED; ++i) {
+            const bool mapped = i % 101 != 100;
+            const size_t size = audio::buildOscMessage(packet, sizeof(packet), mapped ? "/limiter/threshold" : "/limiter/colour",
+                                                       0.1f + 0.0001f * i);
+            ::sendto(sender, packet, size, 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+            // Paced in bursts so the default socket buffer limit cannot drop any
+            if (i % 200 == 199) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::vector<uint8_t> bundle = makeBundle({ makeMessage("/limiter/enabled", ",T", {}),
+                                                   makeMessage("/limiter/threshold", ",f", { floatBits(0.75f) }) });
+        ::sendto(sender, bundle.data(), bundle.size(), 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+        const uint8_t garbage[8] = { 'n', 'o', 't', ' ', 'o', 's', 'c', 0 };
+        ::sendto(sender, garbage, sizeof(garbage), 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+        // Hostile values: NaN is dropped as malformed, out-of-range values clamp to the controls' ranges
+        const std::vector<std::vector<uint8_t>> hostile = {
+            makeMessage("/limiter/threshold", ",f", { floatBits(std::nanf("")) }),
+            makeMessage("/deesser/reduction_db", ",f", { floatBits(-40.0f) }),
+            makeMessage("/deesser/start_hz", ",i", { 2000000000 })
+        };
+        for (const std::vector<uint8_t>& message : hostile) {
+            ::sendto(sender, message.data(), message.size(), 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+        }
+        ::close(sender);
+
+        const uint64_t expected = MESSAGES + UNMAPPED + 4;
+        for (int wait = 0; wait < 500 && input.getOscMessages() + input.getMalformedPackets() < expected + 2; ++wait) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        input.stop();
+        processing.store(false);
+        audioThread.join();
+
+        ok &= check(input.getOscMessages() == expected && input.getMalformedPackets() == 2,
+                    "all " + std::to_string(expected) + " messages received, 2 malformed packets counted");
+        ok &= check(input.getUnmappedMessages() == static_cast<uint64_t>(UNMAPPED), "unmapped addresses counted");
+        ok &= check(input.getEventsPosted() < expected && controlQueue.getDropped() == 0,
+                    "bursts coalesce to " + std::to_string(input.getEventsPosted()) + " queued changes, none dropped");
+        ok &= check(controlQueue.pending() == 0 && limiter.isEnabled() && limiter.getThreshold() == 0.75f,
+                    "last value sent is in effect");
+        ok &= check(deesser.reductionDB == 0.0f && deesser.startFreq == 10000,
+                    "out-of-range values clamp to the control ranges");
+        std::cout << "        " << static_cast<int>(expected / seconds) << " messages/s through the control thread" << std::endl;
+    }
+#endif
+
+    std::cout << (ok ? "All control input tests passed." : "Some control input tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
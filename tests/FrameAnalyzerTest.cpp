@@ -0,0 +1,119 @@
+// FrameAnalyzerTest.cpp
+// Checks the analysis-only pass: per-frame RMS, peak, gate state, band energies, limiter gain
+// reduction and de-esser activity on a file with quiet, loud and sibilant sections, and that
+// the effects' analyze() paths track the same state as process().
+// Command to compile: g++ -std=c++17 -I. tests/FrameAnalyzerTest.cpp offline/FrameAnalyzer.cpp offline/MetricsFile.cpp offline/OfflineRenderer.cpp offline/EncodedFileSink.cpp audio/WavStream.cpp audio/AsyncFileIO.cpp effects/NoiseGate.cpp effects/Limiter.cpp effects/DeEsser.cpp effects/StftEngine.cpp effects/SpectralKernels.cpp effects/SideChain.cpp effects/VoiceActivity.cpp -lsndfile -lfftw3 -pthread -o analysistest
+// Command to run: ./analysistest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+
+#include "../offline/FrameAnalyzer.h"
+#include "../offline/MetricsFile.h"
+#include "TestUtils.h"
+
+const unsigned int SAMPLE_RATE_HZ = 48000;
+const size_t FRAME_SIZE = 2048;
+const size_t SECTION_FRAMES = SAMPLE_RATE_HZ;   // quiet, loud, sibilant; one second each
+
+std::vector<float> makeSignal() {
+    std::vector<float> samples(SECTION_FRAMES * 3);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        double t = static_cast<double>(i) / SAMPLE_RATE_HZ;
+        if (i < SECTION_FRAMES) {
+            samples[i] = 0.001f * static_cast<float>(std::sin(2.0 * M_PI * 300.0 * t));
+        } else if (i < 2 * SECTION_FRAMES) {
+            samples[i] = 0.9f * static_cast<float>(std::sin(2.0 * M_PI * 200.0 * t));
+        } else {
+            samples[i] = 0.4f * static_cast<float>(std::sin(2.0 * M_PI * 7000.0 * t));
+        }
+    }
+    return samples;
+}
+
+// Frames well inside a section, clear of envelope transitions
+bool inSection(const audio::FrameFeatures& f, size_t section) {
+    return f.frame >= section * SECTION_FRAMES + SAMPLE_RATE_HZ / 2 &&
+           f.frame + FRAME_SIZE <= (section + 1) * SECTION_FRAMES;
+}
+
+bool testAnalyzeMatchesProcess(const std::vector<float>& signal) {
+    audio::NoiseGate processedGate(SAMPLE_RATE_HZ, FRAME_SIZE), analysedGate(SAMPLE_RATE_HZ, FRAME_SIZE);
+    audio::Limiter processedLimiter(SAMPLE_RATE_HZ, 0.5f), analysedLimiter(SAMPLE_RATE_HZ, 0.5f);
+    processedGate.setEnabled(true);
+    processedLimiter.setEnabled(true);
+
+    std::vector<float> out(FRAME_SIZE);
+    bool same = true;
+    for (size_t offset = 0; offset + FRAME_SIZE <= signal.size(); offset += FRAME_SIZE) {
+        processedGate.process(signal.data() + offset, out.data(), FRAME_SIZE);
+        analysedGate.analyze(signal.data() + offset, FRAME_SIZE);
+        processedLimiter.process(signal.data() + offset, out.data(), FRAME_SIZE);
+        analysedLimiter.analyze(signal.data() + offset, FRAME_SIZE);
+        same = same && processedGate.getCurrentGain() == analysedGate.getCurrentGain() &&
+               processedGate.isOpen() == analysedGate.isOpen() &&
+               processedLimiter.getCurrentGain() == analysedLimiter.getCurrentGain();
+    }
+    return check(same, "analyze() tracks the same gate and limiter state as process()");
+}
+
+int main() {
+    bool ok = true;
+    const std::string path = "analysistest.wav";
+    std::vector<float> signal = makeSignal();
+    {
+        audio::WavStreamWriter writer;
+        writer.open(path, 1, SAMPLE_RATE_HZ, audio::WavEncoding::Float32);
+        writer.write(signal.data(), signal.size());
+        writer.close();
+    }
+
+    ok &= testAnalyzeMatchesProcess(signal);
+
+    audio::AnalysisSettings settings;
+    settings.gateThreshold = 0.05f;
+    settings.limiterThreshold = 0.5f;
+    std::vector<audio::FrameFeatures> frames;
+    audio::RenderStats stats;
+    ok &= check(audio::FrameAnalyzer::analyzeFile(path, settings, FRAME_SIZE, frames, &stats),
+                "file analyzes");
+    ok &= check(frames.size() == (signal.size() + FRAME_SIZE - 1) / FRAME_SIZE && stats.frames == signal.size(),
+                "one feature row per frame (" + std::to_string(frames.size()) + ")");
+
+    bool quiet = true, loud = true, sibilant = true;
+    for (const audio::FrameFeatures& f : frames) {
+        if (inSection(f, 0)) {
+            quiet &= !f.gateOpen && f.gateGain < 0.01f && f.peak < 0.002f && f.limiterReductionDB == 0.0f;
+        } else if (inSection(f, 1)) {
+            loud &= f.gateOpen && f.gateGain > 0.99f && std::fabs(f.rms - 0.9f / std::sqrt(2.0f)) < 0.01f &&
+                    f.peak > 0.89f && f.limiterReductionDB > 1.0f && f.deEsserReductionDB < 0.1f &&
+                    f.bandEnergy[0] > f.bandEnergy[NUM_BANDS - 2];
+        } else if (inSection(f, 2)) {
+            sibilant &= f.gateOpen && f.deEsserReductionDB > 5.0f &&
+                        f.bandEnergy[NUM_BANDS - 2] > f.bandEnergy[0];
+        }
+    }
+    ok &= check(quiet, "quiet section: gate closed, no limiting");
+    ok &= check(loud, "loud section: gate open, RMS/peak correct, limiter reducing, de-esser idle");
+    ok &= check(sibilant, "sibilant section: de-esser active, energy in the upper bands");
+
+    const std::string csvPath = "analysistest.csv";
+    ok &= check(audio::FrameAnalyzer::writeCSV(csvPath, frames), "features write as CSV");
+
+    const std::string metricsPath = "analysistest.metrics";
+    audio::MetricsReader reader;
+    std::vector<float> rms;
+    ok &= check(audio::FrameAnalyzer::writeMetrics(metricsPath, frames) && reader.open(metricsPath) &&
+                reader.getRows() == frames.size() && reader.readColumn(reader.findColumn("rms"), rms) &&
+                rms.back() == frames.back().rms, "features write as columnar metrics");
+    reader.close();
+
+    std::remove(path.c_str());
+    std::remove(csvPath.c_str());
+    std::remove(metricsPath.c_str());
+    std::cout << (ok ? "All analysis tests passed." : "Analysis tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
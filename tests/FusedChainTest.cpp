@@ -0,0 +1,143 @@
+// FusedChainTest.cpp
+// Checks that the gate and limiter fused into one pass produce exactly what running them one after
+// the other does, at any block size and in place, that state carries across blocks, and that the
+// effect chain takes the fused path while the EQ and de-esser are bypassed.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/FusedChainTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o fusedtest
+// Command to run: ./fusedtest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+#include "../audio/EffectChain.h"
+#include "../effects/FusedChain.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+const size_t SIGNAL_FRAMES = 48000;
+
+// Quiet and loud stretches, so the gate opens and closes and the limiter works
+std::vector<float> makeSignal() {
+    std::vector<float> samples(SIGNAL_FRAMES);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const float level = ((i / 6000) % 2 == 0) ? 0.002f : 0.9f;
+        samples[i] = level * static_cast<float>(std::sin(2.0 * M_PI * 330.0 * i / RATE));
+    }
+    return samples;
+}
+
+void configure(audio::NoiseGate& gate, audio::Limiter& limiter) {
+    gate.setEnabled(true);
+    gate.setThreshold(0.05f);
+    limiter.setEnabled(true);
+    limiter.setThreshold(0.3f);
+}
+
+// Gate then limiter, each a full pass through its own buffer
+std::vector<float> runSeparate(const std::vector<float>& input, size_t blockFrames,
+                               audio::NoiseGate& gate, audio::Limiter& limiter) {
+    std::vector<float> output(input.size()), gated(blockFrames);
+    for (size_t offset = 0; offset < input.size(); offset += blockFrames) {
+        const size_t frames = std::min(blockFrames, input.size() - offset);
+        gate.process(input.data() + offset, gated.data(), frames);
+        limiter.process(gated.data(), output.data() + offset, frames);
+    }
+    return output;
+}
+
+// Both ramps in one FusedChain pass, in place
+std::vector<float> runFused(const std::vector<float>& input, size_t blockFrames,
+                            audio::NoiseGate& gate, audio::Limiter& limiter) {
+    std::vector<float> buffer = input;
+    for (size_t offset = 0; offset < buffer.size(); offset += blockFrames) {
+        const size_t frames = std::min(blockFrames, buffer.size() - offset);
+        audio::GateRamp gateRamp = gate.beginRamp(buffer.data() + offset, frames);
+        audio::LimiterRamp limiterRamp = limiter.beginRamp();
+        audio::FusedChain<audio::GateRamp, audio::LimiterRamp>::run(buffer.data() + offset, buffer.data() + offset,
+                                                                    frames, gateRamp, limiterRamp);
+        gate.endRamp(gateRamp);
+        limiter.endRamp(limiterRamp);
+    }
+    return buffer;
+}
+
+int main() {
+    bool ok = true;
+    const std::vector<float> input = makeSignal();
+
+    for (size_t blockFrames : { 1024u, 97u, 4096u }) {
+        audio::NoiseGate gateA, gateB;
+        audio::Limiter limiterA, limiterB;
+        configure(gateA, limiterA);
+        configure(gateB, limiterB);
+        const std::vector<float> separate = runSeparate(input, blockFrames, gateA, limiterA);
+        const std::vector<float> fused = runFused(input, blockFrames, gateB, limiterB);
+        ok &= check(separate == fused && gateA.getCurrentGain() == gateB.getCurrentGain()
+                        && gateA.isOpen() == gateB.isOpen() && limiterA.getCurrentGain() == limiterB.getCurrentGain(),
+                    "fused gate + limiter identical to separate passes, " + std::to_string(blockFrames) + "-frame blocks");
+    }
+
+    std::vector<float> passed = input;
+    audio::PassThrough pass;
+    audio::FusedChain<audio::PassThrough>::run(passed.data(), passed.data(), passed.size(), pass);
+    ok &= check(passed == input, "pass-through stage leaves the signal unchanged");
+
+    // The chain fuses while the spectral stages are bypassed
+    audio::NoiseGate gate, refGate;
+    audio::ThreeBandEQ eq;
+    audio::Limiter limiter, refLimiter;
+    audio::DeEsserSettings deesser;
+    configure(gate, limiter);
+    configure(refGate, refLimiter);
+    audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+
+    std::vector<float> chainOutput(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += 1024) {
+        const size_t frames = std::min<size_t>(1024, input.size() - offset);
+        chain.process(input.data() + offset, chainOutput.data() + offset, frames);
+    }
+    const std::vector<float> reference = runSeparate(input, 1024, refGate, refLimiter);
+    ok &= check(chainOutput == reference, "effect chain with EQ and de-esser bypassed matches gate then limiter");
+    ok &= check(chain.getGateOpenBlocks() > 0 && chain.getGateOpenBlocks() < chain.getBlockSequence(),
+                "gate statistics kept on the fused path");
+
+    // Enabling the EQ switches back to the staged path; the EQ's delay shows up in the output
+    eq.setEnabled(true);
+    std::vector<float> staged(1024);
+    chain.process(input.data(), staged.data(), staged.size());
+    ok &= check(std::all_of(staged.begin(), staged.end(), [](float s) { return std::fabs(s) < 1e-6f; }),
+                "enabled EQ runs staged (first block is its latency)");
+
+    // A de-esser bypassed mid-signal comes back without its old tail once the chain has fused
+    eq.setEnabled(false);
+    deesser.enabled = true;
+    chain.process(input.data() + 6000, staged.data(), staged.size());
+    deesser.enabled = false;
+    chain.process(input.data(), staged.data(), staged.size());
+    deesser.enabled = true;
+    const std::vector<float> silence(1024, 0.0f);
+    chain.process(silence.data(), staged.data(), staged.size());
+    ok &= check(std::all_of(staged.begin(), staged.end(), [](float s) { return s == 0.0f; }),
+                "de-esser re-enabled after the fused path starts clean");
+
+    // Informational: one fused pass against two passes through a buffer
+    const int repeats = 200;
+    audio::NoiseGate timeGateA, timeGateB;
+    audio::Limiter timeLimiterA, timeLimiterB;
+    configure(timeGateA, timeLimiterA);
+    configure(timeGateB, timeLimiterB);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) runSeparate(input, 1024, timeGateA, timeLimiterA);
+    const double separateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) runFused(input, 1024, timeGateB, timeLimiterB);
+    const double fusedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  separate " << separateMs / repeats << " ms, fused " << fusedMs / repeats
+              << " ms per second of audio (includes gate analysis)" << std::endl;
+
+    std::cout << (ok ? "All fused chain tests passed." : "Fused chain tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
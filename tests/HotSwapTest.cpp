@@ -0,0 +1,132 @@
+// HotSwapTest.cpp
+// Swaps a running effect chain for one built at another sample rate and block size and checks
+// the crossfade has no step, the old chain is handed back once, taps and counters carry over,
+// settings (including an EQ cutoff at Nyquist) are copied to the new format, and that replace()
+// hands over to a rebuilt chain at once.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/HotSwapTest.cpp audio/HotSwapChain.cpp audio/ChainInstance.cpp $CHAIN_SOURCES -lfftw3 -pthread -o hotswaptest
+// Command to run: ./hotswaptest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "../audio/HotSwapChain.h"
+#include "../audio/ChainInstance.h"
+#include "../audio/RecordingTap.h"
+#include "TestUtils.h"
+
+const unsigned int OLD_RATE = 48000;
+const unsigned int OLD_FRAMES = 512;
+const unsigned int NEW_RATE = 96000;
+const unsigned int NEW_FRAMES = 1024;   // whole hops of the old chain's STFTs, so it fades out cleanly
+const size_t FADE_FRAMES = NEW_RATE * 20 / 1000;
+
+// Runs blocks of a sine through the swapper and returns the largest sample-to-sample step
+float runBlocks(audio::HotSwapChain& swapper, size_t blocks, size_t frames, unsigned int rate,
+                double& phase, float& previous) {
+    std::vector<float> input(frames), output(frames);
+    float largestStep = 0.0f;
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t i = 0; i < frames; ++i) {
+            input[i] = 0.5f * static_cast<float>(std::sin(phase));
+            phase += 2.0 * 3.14159265358979 * 220.0 / rate;  // continuous across the rate change
+        }
+        swapper.process(input.data(), output.data(), frames);
+        for (float sample : output) {
+            largestStep = std::max(largestStep, std::fabs(sample - previous));
+            previous = sample;
+        }
+    }
+    return largestStep;
+}
+
+int main() {
+    bool ok = true;
+
+    // Running chain: everything bypassed, so it passes the sine through
+    audio::ChainInstance running(OLD_RATE, OLD_FRAMES);
+    running.getEQ().setBandGain(0, 0.5f);
+    running.getLimiter().setThreshold(0.8f);
+    running.getNoiseGate().setThreshold(0.9f);
+    running.getDeEsser().enabled = true;
+    running.getDeEsser().startFreq = 5000;
+
+    // Never started, so no files are written; only where the taps end up is checked
+    audio::TapConfig tapConfig;
+    audio::RecordingTap preTap("hotswap-pre.wav", 1, OLD_RATE, tapConfig);
+    audio::RecordingTap postTap("hotswap-post.wav", 1, OLD_RATE, tapConfig);
+    running.getChain().setTaps(&preTap, &postTap);
+    running.getChain().setStreamId(3);
+
+    audio::HotSwapChain swapper(running.getChain(), OLD_FRAMES * 2);
+    double phase = 0.0;
+    float previous = 0.0f;
+    const float steadyStep = runBlocks(swapper, 20, OLD_FRAMES, OLD_RATE, phase, previous);
+    const uint64_t blocksBefore = running.getChain().getBlockSequence();
+    const uint64_t framesBefore = running.getChain().getFramesProcessed();
+
+    // Replacement at another format; its gate starts closed, so alone it would cut to silence
+    audio::ChainInstance replacement(NEW_RATE, NEW_FRAMES);
+    replacement.copySettings(running.getNoiseGate(), running.getEQ(), running.getLimiter(), running.getDeEsser());
+    replacement.getNoiseGate().setEnabled(true);
+
+    ok &= check(replacement.getEQ().getBandGain(0) == 0.5f, "EQ gain copied");
+    ok &= check(replacement.getLimiter().getThreshold() == 0.8f, "limiter threshold copied");
+    ok &= check(replacement.getNoiseGate().getThreshold() == 0.9f, "gate threshold copied");
+    ok &= check(replacement.getDeEsser().enabled && replacement.getDeEsser().startFreq == 5000,
+                "de-esser settings copied");
+    ok &= check(running.getEQ().getBandCutoff(NUM_EQ_BANDS - 1) >= OLD_RATE / 2.0f
+                    && replacement.getEQ().getBandCutoff(NUM_EQ_BANDS - 1) == NEW_RATE / 2.0f,
+                "top cutoff at Nyquist follows the new Nyquist");
+
+    replacement.getChain().inheritFrom(running.getChain());
+    swapper.prepare(NEW_FRAMES * 2);
+    ok &= check(swapper.stage(replacement.getChain(), FADE_FRAMES), "stage accepted while idle");
+    ok &= check(!swapper.stage(replacement.getChain(), FADE_FRAMES), "second stage refused while swapping");
+    ok &= check(swapper.takeRetired() == nullptr, "nothing retired before the processing thread picks it up");
+
+    // One block starts the swap but does not finish the fade
+    const float firstStep = runBlocks(swapper, 1, NEW_FRAMES, NEW_RATE, phase, previous);
+    ok &= check(&swapper.getActive() == &replacement.getChain(), "replacement active once the swap begins");
+    ok &= check(replacement.getChain().getPreTap() == &preTap && replacement.getChain().getPostTap() == &postTap,
+                "taps moved to the replacement");
+    ok &= check(running.getChain().getPreTap() == nullptr && running.getChain().getPostTap() == nullptr,
+                "taps removed from the old chain");
+    ok &= check(swapper.takeRetired() == nullptr && swapper.isSwapping(), "old chain kept while fading");
+
+    // Finish the fade: steps stay on the order of the sine's own slope, never a jump to silence
+    const size_t fadeBlocks = FADE_FRAMES / NEW_FRAMES + 1;
+    const float fadeStep = std::max(firstStep, runBlocks(swapper, fadeBlocks, NEW_FRAMES, NEW_RATE, phase, previous));
+    std::cout << "  steady step " << steadyStep << ", crossfade step " << fadeStep << std::endl;
+    ok &= check(fadeStep < 0.05f, "crossfade has no discontinuity");
+
+    audio::EffectChain* retired = swapper.takeRetired();
+    ok &= check(retired == &running.getChain(), "old chain handed back after the fade");
+    ok &= check(swapper.takeRetired() == nullptr && !swapper.isSwapping(), "handed back once, swap finished");
+
+    const uint64_t blocksAfter = replacement.getChain().getBlockSequence();
+    ok &= check(blocksAfter == blocksBefore + 1 + fadeBlocks, "block sequence continues across the swap");
+    ok &= check(replacement.getChain().getFramesProcessed() == framesBefore + (1 + fadeBlocks) * NEW_FRAMES,
+                "frame count continues across the swap");
+
+    // A swap with no fade takes effect at the block boundary
+    audio::ChainInstance back(OLD_RATE, OLD_FRAMES);
+    back.getChain().inheritFrom(replacement.getChain());
+    ok &= check(swapper.stage(back.getChain(), 0), "stage accepted after the previous swap was taken back");
+    runBlocks(swapper, 1, NEW_FRAMES, NEW_RATE, phase, previous);
+    ok &= check(swapper.takeRetired() == &replacement.getChain(), "zero-length fade retires after one block");
+
+    // A chain rebuilt before processing starts (e.g. for a JACK server's rate) takes over at once
+    audio::ChainInstance rebuilt(NEW_RATE, NEW_FRAMES);
+    ok &= check(swapper.replace(rebuilt.getChain()) && &swapper.getActive() == &rebuilt.getChain()
+                    && rebuilt.getChain().getPreTap() == &preTap && back.getChain().getPreTap() == nullptr
+                    && rebuilt.getChain().getBlockSequence() == back.getChain().getBlockSequence(),
+                "replace() hands taps and counters over without a swap");
+    ok &= check(swapper.stage(back.getChain(), FADE_FRAMES) && !swapper.replace(replacement.getChain()),
+                "replace() refused while a swap is in flight");
+
+    std::cout << (ok ? "All hot swap tests passed" : "Hot swap tests FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// MetricsExporterTest.cpp
+// Registers a counter, a gauge, a histogram and the effect chain's metrics, serves them on an
+// ephemeral loopback port and scrapes /metrics over a plain socket, checking the exposition
+// format, the values after processing a few blocks, and the 404/405 answers.
+// Command to compile: g++ -std=c++17 -I. tests/MetricsExporterTest.cpp audio/MetricsRegistry.cpp audio/MetricsExporter.cpp audio/EngineMetrics.cpp audio/BufferQueue.cpp audio/LatencyTracker.cpp $CHAIN_SOURCES -lfftw3 -pthread -o exportertest
+// Command to run: ./exportertest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../audio/MetricsRegistry.h"
+#include "../audio/MetricsExporter.h"
+#include "../audio/EngineMetrics.h"
+#include "TestUtils.h"
+
+const int BLOCKS = 5;
+
+bool contains(const std::string& text, const std::string& needle) {
+    return text.find(needle) != std::string::npos;
+}
+
+// Sends one raw request to 127.0.0.1:port and returns the whole response
+std::string request(uint16_t port, const std::string& raw) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in server;
+    std::memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &server.sin_addr);
+    std::string response;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&server), sizeof(server)) == 0) {
+        send(fd, raw.data(), raw.size(), 0);
+        char chunk[4096];
+        ssize_t received;
+        while ((received = recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+            response.append(chunk, static_cast<size_t>(received));
+        }
+    }
+    close(fd);
+    return response;
+}
+
+int main() {
+    bool ok = true;
+
+    // Rendering alone: grouping, label merging and cumulative buckets
+    {
+        audio::MetricsRegistry registry;
+        registry.addCounter("test_total", "A counter.", "side=\"a\"", [] { return 3.0; });
+        registry.addGauge("test_level", "A gauge.", "", [] { return -1.5; });
+        registry.addCounter("test_total", "A counter.", "side=\"b\"", [] { return 4.0; });
+        registry.addHistogram("test_seconds", "A histogram.", "",
+                              [](std::vector<audio::HistogramBucket>& buckets, double& sum, uint64_t& count) {
+                                  buckets = { {0.1, 2}, {1.0, 3} };
+                                  sum = 2.5;
+                                  count = 6;   // one observation above the last bound
+                              });
+        const std::string text = registry.renderPrometheus();
+        ok &= check(text.find("# TYPE test_total counter") == text.rfind("# TYPE test_total counter"),
+                    "one HELP/TYPE header per metric name");
+        ok &= check(contains(text, "test_total{side=\"a\"} 3\n") && contains(text, "test_total{side=\"b\"} 4\n"),
+                    "labelled samples rendered under one name");
+        ok &= check(contains(text, "# TYPE test_level gauge\ntest_level -1.5\n"), "gauge rendered without labels");
+        ok &= check(contains(text, "test_seconds_bucket{le=\"0.10000000000000001\"} 2\n") &&
+                    contains(text, "test_seconds_bucket{le=\"1\"} 5\n") &&
+                    contains(text, "test_seconds_bucket{le=\"+Inf\"} 6\n") &&
+                    contains(text, "test_seconds_sum 2.5\n") && contains(text, "test_seconds_count 6\n"),
+                    "histogram buckets are cumulative with +Inf, sum and count");
+        registry.clear();
+        ok &= check(registry.renderPrometheus().empty(), "clear() removes every metric");
+    }
+
+    // Engine metrics served over HTTP
+    audio::NoiseGate noiseGate;
+    audio::ThreeBandEQ eq;
+    audio::Limiter limiter;
+    audio::DeEsserSettings deesser;
+    noiseGate.setEnabled(true);
+    eq.setEnabled(true);
+    limiter.setEnabled(true);
+    audio::EffectChain chain(noiseGate, eq, limiter, deesser);
+    audio::Profiler profiler;
+    chain.setProfile(profiler.createProfile("audio"));
+    std::vector<float> input(FRAMES_PER_BUFFER, 0.25f), output(FRAMES_PER_BUFFER);
+    for (int i = 0; i < BLOCKS; ++i) {
+        chain.process(input.data(), output.data(), input.size());
+    }
+
+    audio::MetricsRegistry registry;
+    audio::registerChainMetrics(registry, chain);
+    audio::registerXrunMetric(registry, "test", [] { return 7.0; });
+    audio::registerProfileMetrics(registry, *profiler.getProfiles()[0]);
+
+    audio::MetricsExporter exporter(registry, 0);
+    ok &= check(exporter.start() && exporter.getPort() != 0, "exporter listens on an ephemeral port");
+
+    const std::string metrics = request(exporter.getPort(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    ok &= check(contains(metrics, "HTTP/1.1 200 OK") && contains(metrics, "text/plain; version=0.0.4"),
+                "GET /metrics answers 200 with the text exposition content type");
+    ok &= check(contains(metrics, "# HELP multiaudio_blocks_total ") &&
+                contains(metrics, "# TYPE multiaudio_blocks_total counter") &&
+                contains(metrics, "multiaudio_blocks_total " + std::to_string(BLOCKS) + "\n"),
+                "blocks processed reported");
+    ok &= check(contains(metrics, "multiaudio_xruns_total{backend=\"test\"} 7\n"), "xruns reported per backend");
+    ok &= check(contains(metrics, "# TYPE multiaudio_realtime_factor gauge") &&
+                contains(metrics, "multiaudio_gate_open_ratio ") &&
+                contains(metrics, "multiaudio_limiter_gain_reduction_db "), "effect state gauges reported");
+    ok &= check(contains(metrics, "multiaudio_stage_cpu_seconds_total{thread=\"audio\",stage=\"EQ\"} ") &&
+                contains(metrics, "multiaudio_stage_duration_seconds_bucket{thread=\"audio\",stage=\"Chain\",le=\"+Inf\"} " +
+                         std::to_string(BLOCKS) + "\n"),
+                "per-stage CPU time and duration histogram reported");
+
+    ok &= check(contains(request(exporter.getPort(), "GET /other HTTP/1.1\r\n\r\n"), "HTTP/1.1 404"),
+                "unknown path answers 404");
+    ok &= check(contains(request(exporter.getPort(), "POST /metrics HTTP/1.1\r\n\r\n"), "HTTP/1.1 405"),
+                "non-GET answers 405");
+    ok &= check(exporter.getScrapes() == 1, "only successful scrapes counted");
+
+    exporter.stop();
+    ok &= check(request(exporter.getPort(), "GET /metrics HTTP/1.1\r\n\r\n").empty(), "stop() closes the listener");
+
+    std::cout << (ok ? "All tests passed." : "Some tests failed.") << std::endl;
+    return ok ? 0 : 1;
+}
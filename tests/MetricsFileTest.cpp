@@ -0,0 +1,102 @@
+// MetricsFileTest.cpp
+// Writes a columnar metrics file spanning several row groups, maps it back and checks every
+// value, the column types and alignment, and that truncated or foreign files are rejected.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/MetricsFileTest.cpp offline/MetricsFile.cpp -o metricstest
+// Command to run: ./metricstest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "../offline/MetricsFile.h"
+#include "TestUtils.h"
+
+const size_t ROWS = 1000003;            // not a multiple of the group size
+const size_t GROUP_ROWS = 1 << 16;
+
+bool writeFile(const std::string& path, size_t rows) {
+    audio::MetricsWriter writer(GROUP_ROWS);
+    if (!writer.open(path, { { "frame", audio::MetricType::UInt64 },
+                             { "rms", audio::MetricType::Float32 },
+                             { "gain", audio::MetricType::Float64 },
+                             { "open", audio::MetricType::UInt8 } })) {
+        return false;
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        writer.set<uint64_t>(0, i * 1024);
+        writer.set<float>(1, static_cast<float>(i) * 0.5f);
+        writer.set<double>(2, 1.0 / (i + 1));
+        writer.set<uint8_t>(3, static_cast<uint8_t>(i % 2));
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+int main() {
+    bool ok = true;
+    const std::string path = "metricstest.metrics";
+
+    auto start = std::chrono::steady_clock::now();
+    ok &= check(writeFile(path, ROWS), "writer completes");
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Wrote " << ROWS << " rows in " << writeSeconds << " s" << std::endl;
+
+    audio::MetricsReader reader;
+    ok &= check(reader.open(path), "reader maps the file");
+    ok &= check(reader.getRows() == ROWS && reader.getGroupCount() == (ROWS + GROUP_ROWS - 1) / GROUP_ROWS &&
+                reader.getColumns().size() == 4 && reader.getColumns()[2].name == "gain" &&
+                reader.getColumns()[2].type == audio::MetricType::Float64, "schema and row groups round-trip");
+
+    int frameColumn = reader.findColumn("frame");
+    int rmsColumn = reader.findColumn("rms");
+    int gainColumn = reader.findColumn("gain");
+    int openColumn = reader.findColumn("open");
+    ok &= check(frameColumn == 0 && openColumn == 3 && reader.findColumn("missing") == -1, "columns found by name");
+
+    // Zero-copy access through the mapping
+    bool match = true, aligned = true;
+    size_t row = 0;
+    for (size_t g = 0; g < reader.getGroupCount(); ++g) {
+        size_t rows = 0;
+        const uint64_t* frames = reader.groupData<uint64_t>(frameColumn, g, rows);
+        const float* rms = reader.groupData<float>(rmsColumn, g, rows);
+        const double* gain = reader.groupData<double>(gainColumn, g, rows);
+        const uint8_t* open = reader.groupData<uint8_t>(openColumn, g, rows);
+        aligned &= reinterpret_cast<uintptr_t>(frames) % 64 == 0 && reinterpret_cast<uintptr_t>(gain) % 64 == 0;
+        for (size_t r = 0; r < rows && match; ++r, ++row) {
+            match = frames[r] == row * 1024 && rms[r] == static_cast<float>(row) * 0.5f &&
+                    gain[r] == 1.0 / (row + 1) && open[r] == row % 2;
+        }
+    }
+    ok &= check(match && row == ROWS, "every value reads back in place");
+    ok &= check(aligned, "column chunks are 64-byte aligned");
+
+    size_t rows = 0;
+    ok &= check(reader.groupData<float>(frameColumn, 0, rows) == nullptr &&
+                reader.groupData<uint64_t>(gainColumn, 0, rows) == nullptr, "mismatched types are refused");
+
+    std::vector<float> rmsValues;
+    ok &= check(reader.readColumn(rmsColumn, rmsValues) && rmsValues.size() == ROWS &&
+                rmsValues.back() == static_cast<float>(ROWS - 1) * 0.5f, "readColumn concatenates row groups");
+    reader.close();
+
+    // Truncate the file: the trailer is gone, so it must be refused
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 5));
+    }
+    ok &= check(!reader.open(path), "truncated file is rejected");
+
+    ok &= check(writeFile(path, 0) && reader.open(path) && reader.getRows() == 0 && reader.getGroupCount() == 0,
+                "empty file round-trips");
+    reader.close();
+
+    std::remove(path.c_str());
+    std::cout << (ok ? "All metrics file tests passed." : "Metrics file tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+// ParameterEventTest.cpp
+// Checks the parameter event queue: gate and limiter changes land on the exact sample they are
+// stamped with, the EQ applies its changes from the first STFT frame after them whatever the block
+// size, enable toggles take effect at the start of their block, events are clamped to the control
+// ranges (NaN dropped), a control thread can post while the audio thread consumes, and a recorded
+// automation file replays into a bit-identical render.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/ParameterEventTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o automationtest
+// Command to run: ./automationtest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+
+#include "../audio/EffectChain.h"
+#include "../audio/ParameterQueue.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+const size_t SIGNAL_FRAMES = 48000;
+
+// Quiet and loud stretches, so the gate opens and closes and the limiter works
+std::vector<float> makeSignal() {
+    std::vector<float> samples(SIGNAL_FRAMES);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const float level = ((i / 5000) % 2 == 0) ? 0.01f : 0.9f;
+        samples[i] = level * static_cast<float>(std::sin(2.0 * M_PI * 440.0 * i / RATE));
+    }
+    return samples;
+}
+
+// Takes a block's events from a queue, the way the chain does
+audio::BlockEvents takeBlock(audio::ParameterQueue& queue, std::vector<audio::ParameterEvent>& storage,
+                             uint64_t blockStart, size_t frames) {
+    audio::BlockEvents events;
+    events.blockStart = blockStart;
+    events.events = storage.data();
+    events.count = queue.take(blockStart + frames, storage.data(), storage.size());
+    return events;
+}
+
+// A per-sample effect fed events in 1024-frame blocks against the same effect stopped at each event by hand
+template <typename Effect, typename Set>
+bool checkSampleAccurate(const std::string& name, audio::ParameterId id, Effect& queued, Effect& manual, Set&& set) {
+    const std::vector<float> input = makeSignal();
+    const uint64_t changes[] = { 1500, 7001, 7002, 20480 };
+    const float values[] = { 0.2f, 0.05f, 0.4f, 0.1f };
+
+    audio::ParameterQueue queue;
+    for (size_t i = 0; i < 4; ++i) queue.post(id, values[i], changes[i]);
+    std::vector<audio::ParameterEvent> storage(audio::MAX_BLOCK_EVENTS);
+    std::vector<float> a(input.size()), b(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += 1024) {
+        const size_t frames = std::min<size_t>(1024, input.size() - offset);
+        queued.process(input.data() + offset, a.data() + offset, frames, takeBlock(queue, storage, offset, frames));
+    }
+
+    size_t from = 0;
+    for (size_t i = 0; i <= 4; ++i) {
+        const size_t to = (i < 4) ? changes[i] : input.size();
+        manual.process(input.data() + from, b.data() + from, to - from);
+        if (i < 4) set(manual, values[i]);
+        from = to;
+    }
+    return check(a == b, name + " changes land on their sample, mid-block");
+}
+
+void configure(audio::NoiseGate& gate, audio::Limiter& limiter) {
+    gate.setEnabled(true);
+    gate.setThreshold(0.05f);
+    limiter.setEnabled(true);
+    limiter.setThreshold(0.3f);
+}
+
+int main() {
+    bool ok = true;
+    const std::vector<float> input = makeSignal();
+
+    // Per-sample stages: split exactly at the event
+    {
+        audio::Limiter queued, manual;
+        queued.setEnabled(true);
+        manual.setEnabled(true);
+        ok &= checkSampleAccurate("limiter", audio::ParameterId::LimiterThreshold, queued, manual,
+                                  [](audio::Limiter& limiter, float value) { limiter.setThreshold(value); });
+    }
+    {
+        audio::NoiseGate queued, manual;
+        queued.setEnabled(true);
+        manual.setEnabled(true);
+        ok &= checkSampleAccurate("gate", audio::ParameterId::GateThreshold, queued, manual,
+                                  [](audio::NoiseGate& gate, float value) { gate.setThreshold(value); });
+    }
+
+    // The chain's fused gate + limiter pass splits at events too
+    {
+        audio::NoiseGate gate, refGate;
+        audio::ThreeBandEQ eq;
+        audio::Limiter limiter, refLimiter;
+        audio::DeEsserSettings deesser;
+        configure(gate, limiter);
+        configure(refGate, refLimiter);
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        audio::ParameterQueue queue;
+        chain.setParameterQueue(&queue);
+        queue.post(audio::ParameterId::LimiterThreshold, 0.15f, 3333);
+        queue.post(audio::ParameterId::GateRelease, 5.0f, 9000);
+
+        std::vector<float> a(input.size()), b(input.size()), gated(input.size());
+        for (size_t offset = 0; offset < input.size(); offset += 1024) {
+            const size_t frames = std::min<size_t>(1024, input.size() - offset);
+            chain.process(input.data() + offset, a.data() + offset, frames);
+        }
+        const size_t cuts[] = { 0, 3333, 9000, input.size() };
+        for (size_t i = 0; i < 3; ++i) {
+            if (i == 1) refLimiter.setThreshold(0.15f);
+            if (i == 2) refGate.setReleaseTime(5.0f);
+            refGate.process(input.data() + cuts[i], gated.data() + cuts[i], cuts[i + 1] - cuts[i]);
+            refLimiter.process(gated.data() + cuts[i], b.data() + cuts[i], cuts[i + 1] - cuts[i]);
+        }
+        ok &= check(a == b, "fused chain pass splits at events");
+    }
+
+    // EQ: a change applies from the first frame ending after it, whatever the block size
+    {
+        audio::ThreeBandEQ queued, manual;
+        queued.setEnabled(true);
+        manual.setEnabled(true);
+        audio::ParameterQueue queue;
+        queue.post(audio::ParameterId::EQMidGain, 0.25f, 1500);     // inside the hop ending at 2047
+        queue.post(audio::ParameterId::EQHighGain, 2.0f, 6200);     // inside the hop ending at 7167
+        std::vector<audio::ParameterEvent> storage(audio::MAX_BLOCK_EVENTS);
+        std::vector<float> a(input.size()), b(input.size());
+        for (size_t offset = 0; offset + 4096 <= input.size(); offset += 4096) {
+            queued.process(input.data() + offset, a.data() + offset, 4096, takeBlock(queue, storage, offset, 4096));
+        }
+        for (size_t offset = 0; offset + 1024 <= input.size(); offset += 1024) {
+            if (offset == 1024) manual.setBandGain(1, 0.25f);
+            if (offset == 6144) manual.setBandGain(2, 2.0f);
+            manual.process(input.data() + offset, b.data() + offset, 1024);
+        }
+        const size_t rendered = input.size() / 4096 * 4096;
+        ok &= check(std::equal(a.begin(), a.begin() + rendered, b.begin()),
+                    "EQ changes take effect at the next frame boundary (4096-frame blocks match 1024-frame hops)");
+    }
+
+    // Enable toggles take effect at the start of their block
+    {
+        audio::NoiseGate gate, refGate;
+        audio::ThreeBandEQ eq, refEQ;
+        audio::Limiter limiter, refLimiter;
+        audio::DeEsserSettings deesser, refDeEsser;
+        limiter.setThreshold(0.3f);
+        refLimiter.setThreshold(0.3f);
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        audio::EffectChain reference(refGate, refEQ, refLimiter, refDeEsser, RATE);
+        audio::ParameterQueue queue;
+        chain.setParameterQueue(&queue);
+        queue.post(audio::ParameterId::LimiterEnabled, 1.0f, 5800);
+
+        std::vector<float> a(input.size()), b(input.size());
+        for (size_t offset = 0; offset + 1024 <= input.size(); offset += 1024) {
+            if (offset == 5120) refLimiter.setEnabled(true);
+            chain.process(input.data() + offset, a.data() + offset, 1024);
+            reference.process(input.data() + offset, b.data() + offset, 1024);
+        }
+        ok &= check(limiter.isEnabled() && a == b, "enable toggle applies at the start of its block");
+    }
+
+    // Replayed events skip the control input: each effect clamps them itself and drops NaN
+    {
+        audio::NoiseGate gate;
+        audio::ThreeBandEQ eq;
+        audio::Limiter limiter;
+        audio::DeEsserSettings deesser;
+        const float nan = std::nanf("");
+        gate.applyParameter({ 0, audio::ParameterId::GateAttack, 1e9f });
+        eq.applyParameter({ 0, audio::ParameterId::EQLowGain, -3.0f });
+        limiter.applyParameter({ 0, audio::ParameterId::LimiterThreshold, 0.4f });
+        limiter.applyParameter({ 0, audio::ParameterId::LimiterThreshold, nan });
+        limiter.applyParameter({ 0, audio::ParameterId::LimiterEnabled, nan });
+        audio::applyParameter(deesser, { 0, audio::ParameterId::DeEsserReduction, -12.0f });
+        audio::applyParameter(deesser, { 0, audio::ParameterId::DeEsserEndFreq, 1e20f });
+        audio::applyParameter(deesser, { 0, audio::ParameterId::DeEsserStartFreq, nan });
+        ok &= check(gate.getAttackTime() == 50.0f && eq.getBandGain(0) == 0.0f && limiter.getThreshold() == 0.4f &&
+                    !limiter.isEnabled() && deesser.reductionDB == 0.0 && deesser.endFreq == 12000 &&
+                    deesser.startFreq == 4000,
+                    "out-of-range events clamp to the control ranges, NaN events are ignored");
+    }
+
+    // A control thread posting while the audio thread consumes
+    {
+        audio::NoiseGate gate;
+        audio::ThreeBandEQ eq;
+        audio::Limiter limiter;
+        audio::DeEsserSettings deesser;
+        limiter.setEnabled(true);
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        audio::ParameterQueue queue(64);
+        audio::ParameterRecorder recorder(8192);
+        chain.setParameterQueue(&queue);
+        chain.setParameterRecorder(&recorder);
+
+        const size_t EVENTS = 5000;
+        std::atomic<bool> posted(false);
+        std::thread producer([&] {
+            for (size_t i = 0; i < EVENTS; ++i) {
+                while (queue.pending() >= queue.capacity()) std::this_thread::yield();
+                queue.post(audio::ParameterId::LimiterThreshold, 0.1f + 0.0001f * i, i * 50);
+            }
+            posted.store(true);
+        });
+        std::vector<float> block(256);
+        size_t offset = 0;
+        while (!posted.load() || queue.pending() > 0) {
+            chain.process(input.data() + offset, block.data(), block.size());
+            offset = (offset + block.size()) % (input.size() - block.size());
+        }
+        producer.join();
+        recorder.collect();
+
+        const std::vector<audio::ParameterEvent>& recorded = recorder.getEvents();
+        bool ordered = true;
+        for (size_t i = 0; i < recorded.size(); ++i) {
+            ordered &= recorded[i].frame >= i * 50 && (i == 0 || recorded[i].frame >= recorded[i - 1].frame);
+        }
+        ok &= check(recorded.size() == EVENTS && queue.getDropped() == 0 && recorder.getDropped() == 0 && ordered,
+                    "concurrent producer: " + std::to_string(recorded.size()) + " events applied in order, none dropped");
+        ok &= check(limiter.getThreshold() == 0.1f + 0.0001f * (EVENTS - 1), "last posted value is in effect");
+    }
+
+    // Record a live session, replay it offline: bit-identical render
+    {
+        const std::string path = "automation-test.txt";
+        std::vector<float> live(input.size()), replayed(input.size());
+        {
+            audio::NoiseGate gate;
+            audio::ThreeBandEQ eq;
+            audio::Limiter limiter;
+            audio::DeEsserSettings deesser;
+            audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+            audio::ParameterQueue queue;
+            audio::ParameterRecorder recorder;
+            chain.setParameterQueue(&queue);
+            chain.setParameterRecorder(&recorder);
+            for (size_t offset = 0, block = 0; offset + 480 <= input.size(); offset += 480, ++block) {
+                // GUI-style posts: no timestamp, applied at whichever block takes them
+                if (block == 3) { queue.post(audio::ParameterId::GateEnabled, 1.0f); queue.post(audio::ParameterId::GateThreshold, 0.03f); }
+                if (block == 10) queue.post(audio::ParameterId::EQEnabled, 1.0f);
+                if (block == 17) queue.post(audio::ParameterId::EQLowGain, 1.7f / 3.0f);
+                if (block == 30) { queue.post(audio::ParameterId::DeEsserEnabled, 1.0f); queue.post(audio::ParameterId::DeEsserReduction, 9.5f); }
+                if (block == 44) { queue.post(audio::ParameterId::LimiterEnabled, 1.0f); queue.post(audio::ParameterId::LimiterThreshold, 0.123456789f); }
+                if (block == 61) queue.post(audio::ParameterId::EQEnabled, 0.0f);
+                if (block == 80) queue.post(audio::ParameterId::LimiterRelease, 12.5f);
+                chain.process(input.data() + offset, live.data() + offset, 480);
+                if (block % 7 == 0) recorder.collect();
+            }
+            ok &= check(recorder.save(path) && recorder.getEvents().size() == 10, "recording saved (" +
+                        std::to_string(recorder.getEvents().size()) + " events)");
+        }
+        {
+            audio::NoiseGate gate;
+            audio::ThreeBandEQ eq;
+            audio::Limiter limiter;
+            audio::DeEsserSettings deesser;
+            audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+            audio::ParameterQueue queue;
+            audio::ParameterPlayer player;
+            chain.setParameterQueue(&queue);
+            ok &= check(player.load(path), "recording loads");
+            for (size_t offset = 0; offset + 480 <= input.size(); offset += 480) {
+                player.feed(queue, offset + 480);
+                chain.process(input.data() + offset, replayed.data() + offset, 480);
+            }
+            ok &= check(player.isFinished() && live == replayed, "replayed automation renders bit-identically");
+        }
+        std::remove(path.c_str());
+    }
+
+    std::cout << (ok ? "All parameter event tests passed." : "Parameter event tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// ProfilerTest.cpp
+// Runs the effect chain with a profile attached and checks per-stage call counts, nesting,
+// pausing, the trace and folded-stack exports, and the cost of an unattached timer.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/ProfilerTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o profilertest
+// Command to run: ./profilertest
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+
+#include "../audio/EffectChain.h"
+#include "../audio/Profiler.h"
+#include "TestUtils.h"
+
+const size_t BLOCKS = 200;
+const size_t EVENT_CAPACITY = 64;
+
+size_t countOccurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+uint64_t calls(const audio::ThreadProfile& profile, audio::ProfileStage stage) {
+    return profile.getStage(stage).calls.load();
+}
+
+int main() {
+    bool ok = true;
+
+    audio::NoiseGate noiseGate;
+    audio::ThreeBandEQ eq;
+    audio::Limiter limiter;
+    audio::DeEsserSettings deesser;
+    noiseGate.setEnabled(true);
+    eq.setEnabled(true);
+    eq.setBandGain(2, 0.8f);    // unity gains would skip the EQ's frames
+    limiter.setEnabled(true);
+    deesser.enabled = true;
+    audio::EffectChain chain(noiseGate, eq, limiter, deesser);
+
+    std::vector<float> input(FRAMES_PER_BUFFER), output(FRAMES_PER_BUFFER);
+    size_t phase = 0;
+    auto runBlocks = [&](size_t blocks) {
+        for (size_t b = 0; b < blocks; ++b) {
+            for (size_t i = 0; i < input.size(); ++i, ++phase) {
+                input[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * phase / SAMPLE_RATE);
+            }
+            chain.process(input.data(), output.data(), input.size());
+        }
+    };
+
+    audio::Profiler profiler;
+    audio::ThreadProfile* profile = profiler.createProfile("audio", EVENT_CAPACITY);
+
+    // No profile set: nothing is recorded
+    runBlocks(10);
+    ok &= check(calls(*profile, audio::ProfileStage::Chain) == 0, "unattached chain records nothing");
+
+    // Profile on a worker thread while this thread reads summaries concurrently
+    chain.setProfile(profile);
+    std::atomic<bool> done(false);
+    std::thread worker([&] { runBlocks(BLOCKS); done = true; });
+    while (!done) {
+        profiler.summarize(*profile);
+    }
+    worker.join();
+
+    bool countsMatch = true;
+    for (size_t s = 0; s < audio::PROFILE_STAGE_COUNT; ++s) {
+        // The side-chain, voice activity and echo canceller stages only run when turned on (checked below)
+        const audio::ProfileStage stage = static_cast<audio::ProfileStage>(s);
+        const bool optional = stage == audio::ProfileStage::SideChain || stage == audio::ProfileStage::VoiceActivity ||
+                              stage == audio::ProfileStage::EchoCanceller;
+        countsMatch &= calls(*profile, stage) == (optional ? 0 : BLOCKS);
+    }
+    ok &= check(countsMatch, "every stage timed once per block");
+
+    std::vector<audio::ProfileSummary> summary = profiler.summarize(*profile);
+    auto at = [&](audio::ProfileStage stage) { return summary[static_cast<size_t>(stage)]; };
+    double eqChildren = 0.0, chainChildren = 0.0;
+    bool selfValid = true;
+    for (size_t s = 1; s < audio::PROFILE_STAGE_COUNT; ++s) {
+        audio::ProfileStage parent = audio::profileStageParent(static_cast<audio::ProfileStage>(s));
+        if (parent == audio::ProfileStage::EQ) eqChildren += summary[s].totalMicros;
+        if (parent == audio::ProfileStage::Chain) chainChildren += summary[s].totalMicros;
+        selfValid &= summary[s].selfMicros >= 0.0 && summary[s].selfMicros <= summary[s].totalMicros;
+    }
+    ok &= check(at(audio::ProfileStage::EQ).totalMicros >= eqChildren &&
+                at(audio::ProfileStage::Chain).totalMicros >= chainChildren && selfValid,
+                "nested stages fit inside their parents");
+
+    const audio::ProfileSummary eqSummary = at(audio::ProfileStage::EQ);
+    ok &= check(eqSummary.meanMicros > 0.0 && eqSummary.p50Micros <= eqSummary.p99Micros &&
+                eqSummary.maxMicros * 1.5 >= eqSummary.p99Micros, "histogram percentiles are ordered");
+
+    std::cout << "Per block (us):";
+    for (size_t s = 0; s < audio::PROFILE_STAGE_COUNT; ++s) {
+        std::printf(" %s %.2f", audio::profileStageName(static_cast<audio::ProfileStage>(s)), summary[s].meanMicros);
+    }
+    std::cout << std::endl;
+
+    // Chrome trace keeps only the newest EVENT_CAPACITY events
+    const std::string tracePath = "profilertest-trace.json";
+    ok &= check(profiler.exportChromeTrace(tracePath), "chrome trace written");
+    std::string trace = readFile(tracePath);
+    ok &= check(trace.find("\"traceEvents\"") != std::string::npos &&
+                countOccurrences(trace, "\"ph\":\"X\"") == EVENT_CAPACITY &&
+                trace.find("\"name\":\"audio\"") != std::string::npos, "trace holds the event ring and thread name");
+
+    const std::string foldedPath = "profilertest.folded";
+    ok &= check(profiler.exportFoldedStacks(foldedPath), "folded stacks written");
+    std::string folded = readFile(foldedPath);
+    ok &= check(folded.find("audio;Chain;EQ;EQGain ") != std::string::npos &&
+                folded.find("audio;Chain;NoiseGate;GateFFT ") != std::string::npos, "folded stacks carry full paths");
+
+    // Paused profiles record nothing; reset clears
+    profiler.setEnabled(false);
+    runBlocks(10);
+    ok &= check(calls(*profile, audio::ProfileStage::Chain) == BLOCKS, "paused profile records nothing");
+    profiler.setEnabled(true);
+    profiler.reset();
+    ok &= check(calls(*profile, audio::ProfileStage::Chain) == 0 && profile->getEventHead() == 0, "reset clears counters");
+
+    // Side-chain detection: the shared analysis runs instead of the gate's FFT
+    chain.setSideChainDetection(true);
+    runBlocks(10);
+    ok &= check(calls(*profile, audio::ProfileStage::SideChain) == 10 && calls(*profile, audio::ProfileStage::GateFFT) == 0,
+                "side-chain detection replaces the gate FFT");
+    chain.setSideChainDetection(false);
+
+    // Voice activity detection: timed once per block
+    profiler.reset();
+    chain.setVoiceActivityDetection(true);
+    runBlocks(10);
+    ok &= check(calls(*profile, audio::ProfileStage::VoiceActivity) == 10, "voice activity detection timed once per block");
+    chain.setVoiceActivityDetection(false);
+
+    // Echo cancellation: timed once per block
+    profiler.reset();
+    chain.setEchoCancellation(true);
+    runBlocks(10);
+    ok &= check(calls(*profile, audio::ProfileStage::EchoCanceller) == 10, "echo cancellation timed once per block");
+    chain.setEchoCancellation(false);
+
+    // Cost of a timer on a thread with no profile attached
+    audio::Profiler::attach(nullptr);
+    const size_t scopes = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scopes; ++i) {
+        MULTIAUDIO_PROFILE_SCOPE(audio::ProfileStage::Chain);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / scopes;
+    std::cout << "Unattached timer: " << nanos << " ns" << std::endl;
+    ok &= check(nanos < 20.0, "unattached timer is nearly free");
+
+    std::remove(tracePath.c_str());
+    std::remove(foldedPath.c_str());
+    std::cout << (ok ? "All profiler tests passed." : "Profiler tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// RecordingTapTest.cpp
+// Checks that a recording tap archives blocks to a valid float WAV file, with and without
+// O_DIRECT, and that a full ring drops blocks and counts them instead of blocking.
+// Command to compile: g++ -std=c++17 -I. tests/RecordingTapTest.cpp audio/RecordingTap.cpp audio/WavStream.cpp audio/AsyncFileIO.cpp -pthread -o taptest
+// Command to run: ./taptest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+#include "../audio/RecordingTap.h"
+#include "TestUtils.h"
+
+const unsigned int CHANNELS = 2;
+const unsigned int BLOCK_FRAMES = 480;
+
+uint32_t readU32(const std::vector<char>& bytes, size_t at) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) value = (value << 8) | static_cast<unsigned char>(bytes[at + i]);
+    return value;
+}
+
+// Finds a chunk in a RIFF/WAVE file; returns its payload offset or 0
+size_t findChunk(const std::vector<char>& bytes, const char* id, uint32_t& size) {
+    size_t at = 12;
+    while (at + 8 <= bytes.size()) {
+        size = readU32(bytes, at + 4);
+        if (std::memcmp(&bytes[at], id, 4) == 0) return at + 8;
+        at += 8 + size + (size & 1);
+    }
+    return 0;
+}
+
+bool testArchive(bool directIO) {
+    bool ok = true;
+    const std::string path = directIO ? "taptest-direct.wav" : "taptest-buffered.wav";
+    const unsigned int blocks = 300; // not a multiple of the write size, so the tail is partial
+
+    audio::TapConfig config;
+    config.directIO = directIO;
+    config.writeBytes = 64 * 1024;
+    {
+        audio::TapRecorder recorder(config);
+        audio::RecordingTap* tap = recorder.addTap(path, CHANNELS, 48000);
+        ok &= check(tap && recorder.start(), "recorder starts (" + path + ")");
+        if (!ok) return false;
+
+        std::vector<float> block(BLOCK_FRAMES * CHANNELS);
+        size_t n = 0;
+        for (unsigned int b = 0; b < blocks; ++b) {
+            for (float& sample : block) sample = static_cast<float>(n++);
+            tap->write(block.data(), BLOCK_FRAMES);
+        }
+        recorder.stop();
+        ok &= check(tap->getOverflows() == 0, "no overflows with a large ring");
+        ok &= check(tap->getFramesWritten() == uint64_t(blocks) * BLOCK_FRAMES, "every frame reached the file");
+        std::cout << "       " << (tap->isDirect() ? "O_DIRECT" : "buffered I/O") << " used" << std::endl;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ok &= check(bytes.size() > 12 && std::memcmp(bytes.data(), "RIFF", 4) == 0 && std::memcmp(&bytes[8], "WAVE", 4) == 0,
+                "file has a RIFF/WAVE header");
+
+    uint32_t fmtSize = 0, dataSize = 0;
+    size_t fmt = findChunk(bytes, "fmt ", fmtSize);
+    size_t data = findChunk(bytes, "data", dataSize);
+    ok &= check(fmt && (static_cast<unsigned char>(bytes[fmt]) == 3) && (static_cast<unsigned char>(bytes[fmt + 2]) == CHANNELS),
+                "fmt chunk is float with the right channel count");
+    ok &= check(data % 4096 == 0, "audio data starts on an aligned boundary");
+    ok &= check(dataSize == uint64_t(blocks) * BLOCK_FRAMES * CHANNELS * sizeof(float) && data + dataSize == bytes.size(),
+                "data chunk size matches the file length");
+
+    bool samplesMatch = data != 0;
+    for (size_t i = 0; samplesMatch && i < dataSize / sizeof(float); ++i) {
+        float value;
+        std::memcpy(&value, &bytes[data + i * sizeof(float)], sizeof(float));
+        samplesMatch = (value == static_cast<float>(i));
+    }
+    ok &= check(samplesMatch, "samples round-trip in order");
+
+    std::remove(path.c_str());
+    return ok;
+}
+
+bool testOverflow() {
+    bool ok = true;
+    audio::TapConfig config;
+    config.ringSeconds = 0.1;
+    audio::RecordingTap tap("taptest-overflow.wav", CHANNELS, 48000, config);
+
+    // No writer is draining, so the ring must fill and then drop whole blocks
+    std::vector<float> block(BLOCK_FRAMES * CHANNELS, 0.5f);
+    unsigned int accepted = 0;
+    for (unsigned int b = 0; b < 100; ++b) {
+        if (tap.write(block.data(), BLOCK_FRAMES)) accepted++;
+    }
+    ok &= check(accepted > 0 && accepted < 100, "full ring rejects blocks");
+    ok &= check(tap.getOverflows() == 100 - accepted && tap.getDroppedFrames() == (100 - accepted) * BLOCK_FRAMES,
+                "overflows and dropped frames are counted");
+    ok &= check(tap.getHighWaterRatio() > 0.9, "high-water mark shows the ring was nearly full");
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok &= testArchive(true);
+    ok &= testArchive(false);
+    ok &= testOverflow();
+    std::cout << (ok ? "All recording tap tests passed." : "Recording tap tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
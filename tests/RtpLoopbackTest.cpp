@@ -0,0 +1,182 @@
+// RtpLoopbackTest.cpp
+// End-to-end test of the RTP backend over 127.0.0.1: a packet generator streams a sine
+// into the engine, and a collector receives the processed stream back.
+// Command to compile: g++ -std=c++17 -I. tests/RtpLoopbackTest.cpp audio/RtpBackend.cpp audio/JitterBuffer.cpp audio/DriftCompensator.cpp $CHAIN_SOURCES -lfftw3 -pthread -o rtptest
+// Command to run: ./rtptest
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../audio/RtpBackend.h"
+#include "TestUtils.h"
+
+const uint16_t ENGINE_PORT = 15004;
+const uint16_t COLLECTOR_PORT = 15006;
+const unsigned int CHANNELS = 2;
+const unsigned int PACKET_FRAMES = 48;
+const float AMPLITUDE = 0.25f;
+
+bool testPayloadRoundTrip() {
+    bool ok = true;
+    std::vector<float> samples = { 0.0f, 0.5f, -0.5f, 0.999f, -1.0f, 0.123456f };
+    std::vector<uint8_t> packet(audio::RTP_MAX_PACKET_SIZE);
+    std::vector<float> decoded(samples.size());
+
+    for (audio::RtpEncoding encoding : { audio::RtpEncoding::L16, audio::RtpEncoding::L24 }) {
+        audio::RtpPacketInfo info;
+        info.sequence = 65535; info.timestamp = 0xDEADBEEF; info.ssrc = 42; info.payloadType = 96;
+        size_t size = audio::buildRtpPacket(packet.data(), info, encoding, samples.data(), samples.size());
+
+        audio::RtpPacketInfo parsed;
+        ok &= check(audio::parseRtpPacket(packet.data(), size, parsed), "parse built packet");
+        ok &= check(parsed.sequence == 65535 && parsed.timestamp == 0xDEADBEEF && parsed.ssrc == 42,
+                    "header fields survive round trip");
+        audio::decodeRtpPayload(parsed.payload, samples.size(), encoding, decoded.data());
+
+        float tolerance = (encoding == audio::RtpEncoding::L24) ? 1e-6f : 1e-4f;
+        float maxError = 0.0f;
+        for (size_t i = 0; i < samples.size(); ++i) maxError = std::max(maxError, std::fabs(samples[i] - decoded[i]));
+        ok &= check(maxError < tolerance, encoding == audio::RtpEncoding::L24 ? "L24 payload round trip" : "L16 payload round trip");
+    }
+    return ok;
+}
+
+bool testJitterBufferReorderAndLoss() {
+    audio::JitterBuffer buffer(1, 4, 16, 2);
+    std::vector<float> packet(4);
+    auto writePacket = [&](uint64_t seq) {
+        std::fill(packet.begin(), packet.end(), static_cast<float>(seq + 1));
+        buffer.write(100 + seq, static_cast<uint32_t>(seq * 4), packet.data(), 4);
+    };
+
+    // Prime with two packets and start playout
+    std::vector<float> out(36);
+    writePacket(0); writePacket(1);
+    size_t received = buffer.read(out.data(), 4);
+
+    // Sequence 3 and 4 arrive swapped, 6 never arrives
+    for (uint64_t seq : { 2, 4, 3, 5, 7, 8 }) writePacket(seq);
+    received += buffer.read(out.data() + 4, 32);
+
+    bool ordered = true;
+    for (size_t seq = 0; seq < 9; ++seq) {
+        float expected = (seq == 6) ? 0.0f : static_cast<float>(seq + 1);
+        for (size_t i = 0; i < 4; ++i) ordered &= (out[seq * 4 + i] == expected);
+    }
+
+    bool ok = true;
+    ok &= check(ordered, "jitter buffer restores order and conceals the gap");
+    ok &= check(received == 32, "jitter buffer reports concealed frames");
+    ok &= check(buffer.getPacketsLost() == 1, "jitter buffer counts one lost packet");
+    ok &= check(!buffer.write(101, 0, packet.data(), 4) && buffer.getPacketsLate() == 1, "late packet rejected");
+    return ok;
+}
+
+// Streams a sine at a slightly fast clock to exercise drift compensation
+void packetGenerator(std::atomic<bool>& running, double clockOffsetPpm) {
+    audio::RtpSender sender(audio::RtpEncoding::L24, 96, CHANNELS, PACKET_FRAMES, PACKET_FRAMES * 8);
+    if (!sender.open("127.0.0.1", ENGINE_PORT)) return;
+
+    std::vector<float> block(PACKET_FRAMES * CHANNELS);
+    double phase = 0.0;
+    const double step = 2.0 * M_PI * 1000.0 / SAMPLE_RATE;
+    const auto period = std::chrono::duration<double>(PACKET_FRAMES / (SAMPLE_RATE * (1.0 + clockOffsetPpm * 1e-6)));
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (running.load()) {
+        for (unsigned int i = 0; i < PACKET_FRAMES; ++i) {
+            float s = AMPLITUDE * static_cast<float>(std::sin(phase));
+            phase += step;
+            for (unsigned int ch = 0; ch < CHANNELS; ++ch) block[i * CHANNELS + ch] = s;
+        }
+        sender.send(block.data(), PACKET_FRAMES);
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+bool testLoopback() {
+    audio::NoiseGate gate;
+    audio::ThreeBandEQ eq;
+    audio::Limiter limiter;
+    audio::DeEsserSettings deesser;
+    audio::EffectChain chain(gate, eq, limiter, deesser); // All effects bypassed
+
+    audio::RtpConfig config;
+    config.bindAddress = "127.0.0.1";
+    config.listenPort = ENGINE_PORT;
+    config.destPort = COLLECTOR_PORT;
+    config.channels = CHANNELS;
+    config.framesPerPacket = PACKET_FRAMES;
+
+    int collector = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local; std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET; local.sin_port = htons(COLLECTOR_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &local.sin_addr);
+    timeval timeout = { 0, 100000 };
+    setsockopt(collector, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (bind(collector, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        return check(false, "bind collector socket");
+    }
+
+    audio::RtpBackend backend(chain, config);
+    if (!check(backend.start(), "backend starts")) { close(collector); return false; }
+
+    std::atomic<bool> generating(true);
+    std::thread generator(packetGenerator, std::ref(generating), 200.0);
+
+    // Collect two seconds of processed output
+    std::vector<float> collected;
+    std::vector<uint8_t> datagram(audio::RTP_MAX_PACKET_SIZE);
+    std::vector<float> decoded(audio::RTP_MAX_PACKET_SIZE / 3);
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < end) {
+        ssize_t size = recv(collector, datagram.data(), datagram.size(), 0);
+        audio::RtpPacketInfo info;
+        if (size <= 0 || !audio::parseRtpPacket(datagram.data(), static_cast<size_t>(size), info)) continue;
+        size_t samples = info.payloadSize / 3;
+        audio::decodeRtpPayload(info.payload, samples, audio::RtpEncoding::L24, decoded.data());
+        for (size_t i = 0; i < samples; i += CHANNELS) collected.push_back(decoded[i]);
+    }
+
+    generating.store(false);
+    generator.join();
+    const audio::JitterBuffer& jitter = backend.getJitterBuffer();
+    std::cout << "  received=" << jitter.getPacketsReceived() << " lost=" << jitter.getPacketsLost()
+              << " late=" << jitter.getPacketsLate() << " underruns=" << jitter.getUnderruns()
+              << " drift=" << backend.getDriftPpm() << "ppm" << std::endl;
+    backend.stop();
+    close(collector);
+
+    bool ok = true;
+    ok &= check(collected.size() > SAMPLE_RATE, "collector received over one second of audio");
+
+    // Steady-state level of the second half should match the generated sine
+    double sumSquares = 0.0;
+    size_t half = collected.size() / 2;
+    for (size_t i = half; i < collected.size(); ++i) sumSquares += collected[i] * collected[i];
+    double rms = (collected.size() > half) ? std::sqrt(sumSquares / (collected.size() - half)) : 0.0;
+    double expected = AMPLITUDE / std::sqrt(2.0);
+    ok &= check(std::fabs(rms - expected) < expected * 0.1, "output level matches input sine");
+    ok &= check(jitter.getPacketsLost() == 0, "no packets lost on loopback");
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok &= testPayloadRoundTrip();
+    ok &= testJitterBufferReorderAndLoss();
+    ok &= testLoopback();
+    std::cout << (ok ? "All RTP tests passed." : "RTP tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// SideChainTest.cpp
+// Checks the decimated side-chain: the half-band cascade gives the same samples whatever the block
+// split, its band powers add up to the signal power and put tones in their octave, the gate decides
+// like its spectral detector when reading it, the de-esser estimate matches the FFT meter, and the
+// chain publishes band levels. Prints the side-chain's cost against the gate's FFT analysis.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/SideChainTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o sidechaintest
+// Command to run: ./sidechaintest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "../audio/EffectChain.h"
+#include "../effects/SideChain.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+
+std::vector<float> makeTone(size_t frames, double frequency, float amplitude) {
+    std::vector<float> samples(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        samples[i] = amplitude * static_cast<float>(std::sin(2.0 * M_PI * frequency * i / RATE));
+    }
+    return samples;
+}
+
+std::vector<float> makeNoise(size_t frames, float amplitude) {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> distribution(-amplitude, amplitude);
+    std::vector<float> samples(frames);
+    for (float& sample : samples) sample = distribution(generator);
+    return samples;
+}
+
+// Quiet and loud stretches, so the gate opens and closes
+std::vector<float> makeBursts(size_t frames) {
+    std::vector<float> samples(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        const float level = ((i / 9000) % 2 == 0) ? 0.01f : 0.9f;
+        samples[i] = level * static_cast<float>(std::sin(2.0 * M_PI * 440.0 * i / RATE));
+    }
+    return samples;
+}
+
+int main() {
+    bool ok = true;
+
+    // The decimator carries its phase across blocks: any split gives the same samples
+    {
+        const std::vector<float> input = makeNoise(4001, 0.5f);
+        audio::HalfBandDecimator whole, split;
+        std::vector<float> lowWhole(input.size() / 2 + 1), lowSplit(input.size() / 2 + 1);
+        double energyWhole = 0.0, energySplit = 0.0, energy = 0.0;
+        const size_t producedWhole = whole.process(input.data(), input.size(), lowWhole.data(), energyWhole);
+        size_t producedSplit = 0;
+        for (size_t offset = 0; offset < input.size(); offset += 7) {
+            const size_t count = std::min<size_t>(7, input.size() - offset);
+            producedSplit += split.process(input.data() + offset, count, lowSplit.data() + producedSplit, energy);
+            energySplit += energy;
+        }
+        lowWhole.resize(producedWhole);
+        lowSplit.resize(producedSplit);
+        ok &= check(producedWhole == 2000 && lowWhole == lowSplit && std::fabs(energyWhole - energySplit) < 1e-6 * energyWhole,
+                    "half-band decimator output is independent of the block split");
+
+        std::vector<float> dc(256, 0.25f), low(129);
+        audio::HalfBandDecimator decimator;
+        const size_t produced = decimator.process(dc.data(), dc.size(), low.data(), energy);
+        ok &= check(std::fabs(low[produced - 1] - 0.25f) < 1e-6f, "unity gain at DC");
+    }
+
+    // Band powers: they sum to the signal power, and tones land in their octave
+    {
+        const std::vector<float> noise = makeNoise(RATE, 0.5f);
+        audio::SideChain sideChain(RATE, noise.size());
+        sideChain.analyze(noise.data(), noise.size());
+        // Uniform in [-0.5, 0.5]; the crossovers count at half power, about 0.6 dB in all
+        const double expected = 0.25 / 3.0;
+        const double ratioDB = 10.0 * std::log10(sideChain.getPower() / expected);
+        ok &= check(ratioDB > -1.0 && ratioDB < 0.1,
+                    "band powers of white noise sum to its power (" + std::to_string(ratioDB) + " dB)");
+        ok &= check(sideChain.getBandLowHz(0) == 0.0 && sideChain.getBandHighHz(0) == 750.0 &&
+                    sideChain.getBandLowHz(audio::SIDECHAIN_BANDS - 1) == 12000.0 &&
+                    sideChain.getBandHighHz(audio::SIDECHAIN_BANDS - 1) == 24000.0, "octave band edges at 48 kHz");
+
+        bool inBand = true;
+        std::string shares;
+        for (unsigned int band = 0; band < audio::SIDECHAIN_BANDS; ++band) {
+            const double frequency = band == 0 ? 300.0 : std::sqrt(sideChain.getBandLowHz(band) * sideChain.getBandHighHz(band));
+            const std::vector<float> tone = makeTone(RATE / 4, frequency, 0.5f);
+            audio::SideChain toneChain(RATE, tone.size());
+            toneChain.analyze(tone.data(), tone.size());
+            const double share = toneChain.getBandPower(band) / toneChain.getPower();
+            shares += " " + std::to_string(static_cast<int>(share * 100)) + "%";
+            inBand = inBand && share > 0.85 && std::fabs(toneChain.getPower() / 0.125 - 1.0) < 0.1;
+        }
+        ok &= check(inBand, "a tone in each octave lands in its band:" + shares);
+    }
+
+    // Gate: detecting from the side-chain decides like the spectral detector
+    {
+        const std::vector<float> input = makeBursts(RATE * 2);
+        audio::NoiseGate spectral(RATE), decimated(RATE);
+        spectral.setEnabled(true);
+        decimated.setEnabled(true);
+        audio::SideChain sideChain(RATE);
+        decimated.setSideChain(&sideChain);
+        size_t blocks = 0, agree = 0, opened = 0;
+        std::vector<float> out(1024);
+        for (size_t offset = 0; offset + 1024 <= input.size(); offset += 1024, ++blocks) {
+            spectral.process(input.data() + offset, out.data(), 1024);
+            sideChain.analyze(input.data() + offset, 1024);
+            decimated.process(input.data() + offset, out.data(), 1024);
+            agree += spectral.isOpen() == decimated.isOpen();
+            opened += decimated.isOpen();
+        }
+        ok &= check(agree >= blocks * 9 / 10 && opened > blocks / 4 && opened < blocks * 3 / 4,
+                    "side-chain gate agrees with the spectral gate on " + std::to_string(agree) + "/" +
+                    std::to_string(blocks) + " blocks");
+    }
+
+    // De-esser metering from the side-chain against the FFT meter
+    {
+        const std::vector<float> noise = makeNoise(RATE, 0.5f);
+        std::vector<float> mixed = makeTone(RATE, 500.0, 0.5f);
+        for (size_t i = 0; i < mixed.size(); ++i) mixed[i] += noise[i];
+        audio::DeEsserMeter meter;
+        bool close = true;
+        std::string values;
+        for (const std::vector<float>* signal : { &noise, static_cast<const std::vector<float>*>(&mixed) }) {
+            audio::SideChain sideChain(RATE, signal->size());
+            sideChain.analyze(signal->data(), signal->size());
+            const double measured = meter.measure(signal->data(), signal->size(), RATE, 4000, 10000, 6.0);
+            const double estimated = audio::DeEsserMeter::estimate(sideChain, 4000, 10000, 6.0);
+            values += " " + std::to_string(measured) + "/" + std::to_string(estimated);
+            close = close && std::fabs(measured - estimated) < 0.5;
+        }
+        ok &= check(close, "de-esser estimate matches the FFT meter within 0.5 dB (measured/estimated:" + values + ")");
+    }
+
+    // Chain: side-chain detection publishes band levels
+    {
+        audio::NoiseGate gate;
+        audio::ThreeBandEQ eq;
+        audio::Limiter limiter;
+        audio::DeEsserSettings deesser;
+        gate.setEnabled(true);
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        chain.setSideChainDetection(true);
+        const std::vector<float> tone = makeTone(RATE / 2, 1000.0, 0.5f);
+        std::vector<float> out(tone.size());
+        for (size_t offset = 0; offset + 480 <= tone.size(); offset += 480) {
+            chain.process(tone.data() + offset, out.data() + offset, 480);
+        }
+        ok &= check(gate.getSideChain() == &chain.getSideChain() && std::fabs(chain.getBandLevelDB(1) + 9.03) < 1.0 &&
+                    chain.getBandLevelDB(5) < -60.0 && chain.getGateOpenBlocks() > 0,
+                    "chain publishes band levels (1 kHz tone at " + std::to_string(chain.getBandLevelDB(1)) + " dB)");
+        chain.setSideChainDetection(false);
+        ok &= check(gate.getSideChain() == nullptr, "turning detection off restores the gate's own FFT");
+    }
+
+    // Cost: the shared side-chain against one gate's FFT analysis
+    {
+        const std::vector<float> input = makeBursts(RATE * 10);
+        audio::NoiseGate gate(RATE);
+        gate.setEnabled(true);
+        audio::SideChain sideChain(RATE);
+        auto started = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset + 1024 <= input.size(); offset += 1024) gate.analyze(input.data() + offset, 1024);
+        const double fftSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        started = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset + 1024 <= input.size(); offset += 1024) sideChain.analyze(input.data() + offset, 1024);
+        const double sideChainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << "        10 s of audio: gate FFT analysis " << fftSeconds * 1e3 << " ms, side-chain "
+                  << sideChainSeconds * 1e3 << " ms" << std::endl;
+    }
+
+    std::cout << (ok ? "All side-chain tests passed." : "Some side-chain tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
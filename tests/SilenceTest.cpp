@@ -0,0 +1,155 @@
+// SilenceTest.cpp
+// Checks silence propagation: a fully closed gate flags its blocks silent, and the STFT effects
+// and limiter then advance on the flag alone while producing exactly what full processing of
+// zeros would, flushing their tails first; the chain clears the flag when signal returns.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/SilenceTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o silencetest
+// Command to run: ./silencetest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+#include "../audio/EffectChain.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+
+std::vector<float> makeTone(size_t frames, double frequency, float amplitude) {
+    std::vector<float> samples(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        samples[i] = amplitude * static_cast<float>(std::sin(2.0 * M_PI * frequency * i / RATE));
+    }
+    return samples;
+}
+
+// Signal, then silence: two identical effects, A processing zeros and B on the silent path;
+// outputs must match exactly and B's flag must turn on (with zeros out) once the tail drains
+template <typename ProcessA, typename ProcessB, typename SilenceB>
+bool compareSilence(const std::string& name, size_t blockFrames, ProcessA&& processA, ProcessB&& processB,
+                    SilenceB&& silenceB) {
+    const std::vector<float> tone = makeTone(8 * 1024, 5000.0, 0.5f);
+    const std::vector<float> zeros(blockFrames, 0.0f);
+    std::vector<float> a(blockFrames), b(blockFrames);
+
+    for (size_t offset = 0; offset + blockFrames <= tone.size(); offset += blockFrames) {
+        processA(tone.data() + offset, a.data(), blockFrames);
+        processB(tone.data() + offset, b.data(), blockFrames);
+    }
+    bool identical = true;
+    bool flagged = false;
+    bool zerosWhenFlagged = true;
+    for (size_t block = 0; block < 40; ++block) {
+        processA(zeros.data(), a.data(), blockFrames);
+        const bool silentOut = silenceB(b.data(), blockFrames);
+        identical &= (a == b);
+        if (silentOut) {
+            flagged = true;
+            zerosWhenFlagged &= std::all_of(b.begin(), b.end(), [](float s) { return s == 0.0f; });
+        }
+    }
+    return check(identical && flagged && zerosWhenFlagged,
+                 name + ": silent path matches processing zeros, " + std::to_string(blockFrames) + "-frame blocks");
+}
+
+int main() {
+    bool ok = true;
+
+    for (size_t blockFrames : { 1024u, 300u }) {
+        audio::ThreeBandEQ eqA(RATE), eqB(RATE);
+        for (audio::ThreeBandEQ* eq : { &eqA, &eqB }) {
+            eq->setEnabled(true);
+            eq->setBandGain(2, 0.3f);
+        }
+        ok &= compareSilence("EQ", blockFrames,
+                             [&](const float* in, float* out, size_t n) { eqA.process(in, out, n); },
+                             [&](const float* in, float* out, size_t n) { eqB.process(in, out, n); },
+                             [&](float* out, size_t n) { return eqB.processSilence(out, n); });
+
+        audio::DeEsser deesserA(RATE), deesserB(RATE);
+        audio::DeEsserSettings settings;
+        settings.enabled = true;
+        settings.reductionDB = 9.0;
+        ok &= compareSilence("de-esser", blockFrames,
+                             [&](const float* in, float* out, size_t n) { deesserA.process(in, out, n, settings); },
+                             [&](const float* in, float* out, size_t n) { deesserB.process(in, out, n, settings); },
+                             [&](float* out, size_t n) { return deesserB.processSilence(out, n, settings); });
+    }
+
+    // Limiter: closed-form recovery tracks the per-sample envelope
+    audio::Limiter limiterA, limiterB;
+    limiterA.setEnabled(true);
+    limiterB.setEnabled(true);
+    const std::vector<float> loud = makeTone(4096, 440.0, 1.0f);
+    std::vector<float> scratch(4096);
+    limiterA.process(loud.data(), scratch.data(), loud.size());
+    limiterB.process(loud.data(), scratch.data(), loud.size());
+    const std::vector<float> zeros(1024, 0.0f);
+    for (int block = 0; block < 3; ++block) {
+        limiterA.process(zeros.data(), scratch.data(), zeros.size());
+        limiterB.processSilence(scratch.data(), zeros.size());
+    }
+    ok &= check(limiterB.getCurrentGain() < 1.0f && std::fabs(limiterA.getCurrentGain() - limiterB.getCurrentGain()) < 1e-5f,
+                "limiter recovers through silence as it would per sample");
+
+    // Gate: closes, snaps to zero and flags its blocks
+    audio::NoiseGate gate(RATE);
+    gate.setEnabled(true);
+    const std::vector<float> speech = makeTone(1024, 300.0, 0.5f);
+    const std::vector<float> hiss = makeTone(1024, 300.0, 0.0005f);
+    std::vector<float> gated(1024);
+    for (int block = 0; block < 10; ++block) gate.process(speech.data(), gated.data(), 1024);
+    bool flagged = false;
+    for (int block = 0; block < 100 && !flagged; ++block) {
+        gate.process(hiss.data(), gated.data(), 1024);
+        flagged = gate.isOutputSilent();
+    }
+    ok &= check(flagged && gate.getCurrentGain() == 0.0f &&
+                std::all_of(gated.begin(), gated.end(), [](float s) { return s == 0.0f; }),
+                "closed gate snaps to zero and flags its blocks silent");
+    gate.process(speech.data(), gated.data(), 1024);
+    ok &= check(!gate.isOutputSilent(), "gate clears the flag when it opens");
+
+    // Whole chain: flag set once every stage has drained, cleared when signal returns
+    audio::NoiseGate chainGate(RATE);
+    audio::ThreeBandEQ chainEQ(RATE);
+    audio::Limiter chainLimiter(RATE);
+    audio::DeEsserSettings chainDeEsser;
+    chainGate.setEnabled(true);
+    chainEQ.setEnabled(true);
+    chainLimiter.setEnabled(true);
+    chainDeEsser.enabled = true;
+    audio::EffectChain chain(chainGate, chainEQ, chainLimiter, chainDeEsser, RATE);
+
+    std::vector<float> out(1024);
+    for (int block = 0; block < 10; ++block) chain.process(speech.data(), out.data(), 1024);
+    size_t silentBlocks = 0;
+    bool zerosWhenFlagged = true;
+    for (int block = 0; block < 200; ++block) {
+        chain.process(hiss.data(), out.data(), 1024);
+        if (chain.isOutputSilent()) {
+            ++silentBlocks;
+            zerosWhenFlagged &= std::all_of(out.begin(), out.end(), [](float s) { return s == 0.0f; });
+        }
+    }
+    ok &= check(silentBlocks > 100 && zerosWhenFlagged, "chain flags gated blocks silent (" +
+                std::to_string(silentBlocks) + " of 200) and outputs zeros");
+    chain.process(speech.data(), out.data(), 1024);
+    ok &= check(!chain.isOutputSilent(), "chain clears the flag when the gate opens");
+
+    // Informational: cost of a gated block against an open one
+    const int repeats = 500;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) chain.process(speech.data(), out.data(), 1024);
+    const double openMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    for (int r = 0; r < 100; ++r) chain.process(hiss.data(), out.data(), 1024);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) chain.process(hiss.data(), out.data(), 1024);
+    const double gatedMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  open block " << openMicros / repeats << " us, gated block " << gatedMicros / repeats << " us" << std::endl;
+
+    std::cout << (ok ? "All silence tests passed." : "Silence tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,353 @@
+// StftEngineTest.cpp
+// Checks the STFT engine reconstructs its input at every overlap and block size with the stated
+// latency, shares window tables, that the fixed-size kernels match the generic ones, and that the
+// EQ, noise gate and de-esser built on it behave the same whatever the host block size, and that
+// identity settings switch to a delay-only path that matches running every frame.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/StftEngineTest.cpp effects/StftEngine.cpp effects/SpectralKernels.cpp effects/SideChain.cpp effects/VoiceActivity.cpp effects/ThreeBandEQ.cpp effects/NoiseGate.cpp effects/DeEsser.cpp -lfftw3 -o stfttest
+// Command to run: ./stfttest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+#include "../effects/StftEngine.h"
+#include "../effects/SpectralKernels.h"
+#include "../effects/ThreeBandEQ.h"
+#include "../effects/NoiseGate.h"
+#include "../effects/DeEsser.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+const size_t SIGNAL_FRAMES = 48 * 1024;
+
+std::vector<float> makeTone(double frequency, float amplitude) {
+    std::vector<float> samples(SIGNAL_FRAMES);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = amplitude * static_cast<float>(std::sin(2.0 * M_PI * frequency * i / RATE));
+    }
+    return samples;
+}
+
+// Runs a signal through in blocks of blockFrames (the last block may be short)
+template <typename Process>
+std::vector<float> runBlocks(const std::vector<float>& input, size_t blockFrames, Process&& process) {
+    std::vector<float> output(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += blockFrames) {
+        const size_t frames = std::min(blockFrames, input.size() - offset);
+        process(input.data() + offset, output.data() + offset, frames);
+    }
+    return output;
+}
+
+// Largest difference between output and input delayed by latency, past the first frames
+float delayedError(const std::vector<float>& input, const std::vector<float>& output, size_t latency, size_t skip) {
+    float error = 0.0f;
+    for (size_t i = skip + latency; i < output.size(); ++i) {
+        error = std::max(error, std::fabs(output[i] - input[i - latency]));
+    }
+    return error;
+}
+
+double rms(const std::vector<float>& samples, size_t from) {
+    double sum = 0.0;
+    for (size_t i = from; i < samples.size(); ++i) sum += samples[i] * samples[i];
+    return std::sqrt(sum / (samples.size() - from));
+}
+
+bool testReconstruction() {
+    bool ok = true;
+    const std::vector<float> input = makeTone(440.0, 0.5f);
+    const unsigned int fftSize = 1024;
+    const audio::StftOverlap overlaps[] = { audio::StftOverlap::Half, audio::StftOverlap::ThreeQuarters,
+                                            audio::StftOverlap::SevenEighths };
+    for (audio::StftOverlap overlap : overlaps) {
+        const unsigned int factor = static_cast<unsigned int>(overlap);
+        const unsigned int hop = fftSize / factor;
+        const std::string name = "overlap 1/" + std::to_string(factor);
+
+        // Periods of two hops: hop-aligned latency
+        audio::StftEngine aligned(fftSize, overlap);
+        aligned.prepare(hop * 2);
+        std::vector<float> output = runBlocks(input, hop * 2, [&](const float* in, float* out, size_t n) {
+            aligned.process(in, out, n, [](fftw_complex*, unsigned int) {});
+        });
+        ok &= check(aligned.getLatency() == fftSize - hop &&
+                    delayedError(input, output, aligned.getLatency(), fftSize) < 1e-4f,
+                    name + ": aligned blocks reconstruct with latency fftSize - hop");
+
+        // Periods that vary: whole hops, then a block ending mid-hop, then whole hops again
+        audio::StftEngine mixed(fftSize, overlap);
+        mixed.prepare(0);
+        output.assign(input.size(), 0.0f);
+        const size_t sizes[] = { hop, hop, hop * 2, 100, hop, 357, hop * 2 };
+        for (size_t offset = 0, block = 0; offset < input.size(); ++block) {
+            const size_t frames = std::min(sizes[block % 7], input.size() - offset);
+            mixed.process(input.data() + offset, output.data() + offset, frames, [](fftw_complex*, unsigned int) {});
+            offset += frames;
+        }
+        ok &= check(mixed.getLatency() == fftSize - 1 && delayedError(input, output, fftSize - 1, fftSize) < 1e-4f,
+                    name + ": mixed block sizes reconstruct without a latency jump");
+
+        // Odd periods, processed in place
+        audio::StftEngine odd(fftSize, overlap);
+        odd.prepare(100);
+        std::vector<float> inPlace = input;
+        for (size_t offset = 0; offset < inPlace.size(); offset += 100) {
+            const size_t frames = std::min<size_t>(100, inPlace.size() - offset);
+            odd.process(inPlace.data() + offset, inPlace.data() + offset, frames, [](fftw_complex*, unsigned int) {});
+        }
+        ok &= check(odd.getLatency() == fftSize - 1 && delayedError(input, inPlace, odd.getLatency(), fftSize) < 1e-4f,
+                    name + ": 100-frame blocks in place reconstruct with latency fftSize - 1");
+    }
+
+    // A size without specialised kernels takes the generic path
+    audio::StftEngine generic(1536, audio::StftOverlap::Half);
+    std::vector<float> output = runBlocks(input, 768, [&](const float* in, float* out, size_t n) {
+        generic.process(in, out, n, [](fftw_complex*, unsigned int) {});
+    });
+    ok &= check(!generic.getKernels().isSpecialized() && delayedError(input, output, generic.getLatency(), 1536) < 1e-4f,
+                "generic kernels reconstruct at size 1536");
+
+    // A block ending mid-hop despite whole-hop periods switches to the any-block latency for good
+    audio::StftEngine broken(1024, audio::StftOverlap::Half);
+    broken.prepare(512);
+    output = runBlocks(input, 300, [&](const float* in, float* out, size_t n) {
+        broken.process(in, out, n, [](fftw_complex*, unsigned int) {});
+    });
+    ok &= check(broken.getLatency() == 1023 && delayedError(input, output, 1023, 1024) < 1e-4f,
+                "undeclared mid-hop block falls back to latency fftSize - 1");
+
+    audio::StftEngine invalid(1001, audio::StftOverlap::ThreeQuarters);
+    ok &= check(!invalid.isValid(), "size that does not divide into hops is rejected");
+    return ok;
+}
+
+bool testSharedWindows() {
+    std::shared_ptr<const audio::StftWindow> a = audio::getStftWindow(2048, audio::StftOverlap::Half);
+    std::shared_ptr<const audio::StftWindow> b = audio::getStftWindow(2048, audio::StftOverlap::Half);
+    std::shared_ptr<const audio::StftWindow> c = audio::getStftWindow(2048, audio::StftOverlap::ThreeQuarters);
+    return check(a == b && a != c && std::fabs(a->analysisPower - 1024.0) < 1e-6,
+                 "window tables shared per size and overlap");
+}
+
+// Tables are built by the compiler
+static_assert(audio::FixedStftWindow<64, 2>::analysis[0] == 0.0, "window starts at zero");
+static_assert(audio::FixedGateBands<1024>::edges[0] == 1 && audio::FixedGateBands<1024>::edges[NUM_BANDS] == 512,
+              "gate bands cover bins 1 .. 511");
+
+bool testKernelDispatch() {
+    bool ok = true;
+    bool allSpecialized = true;
+    for (unsigned int size = 64; size <= 2048; size *= 2) {
+        for (unsigned int factor : { 2u, 4u, 8u }) {
+            const audio::SpectralKernels& kernels = audio::getSpectralKernels(size, factor);
+            allSpecialized &= kernels.isSpecialized() && kernels.fftSize == size && kernels.overlapFactor == factor;
+        }
+    }
+    ok &= check(allSpecialized, "sizes 64 .. 2048 at every overlap dispatch to specialised kernels");
+    ok &= check(!audio::getSpectralKernels(1536, 2).isSpecialized() && !audio::getSpectralKernels(4096, 2).isSpecialized()
+                    && !audio::getSpectralKernels(32, 2).isSpecialized() && !audio::getSpectralKernels(1024, 3).isSpecialized(),
+                "other sizes fall back to the generic kernels");
+
+    double windowError = 0.0;
+    for (unsigned int i = 0; i < 2048; ++i) {
+        windowError = std::max(windowError, std::fabs(audio::FixedStftWindow<2048, 4>::analysis[i] - std::sin(M_PI * i / 2048)));
+    }
+    ok &= check(windowError < 1e-15, "compile-time Hann window matches the runtime one");
+
+    // Same inputs through the fixed and generic kernels: results are bit-identical
+    const unsigned int size = 1024;
+    const audio::SpectralKernels& fixed = audio::getSpectralKernels(size, 4);
+    const audio::SpectralKernels& generic = audio::getGenericSpectralKernels();
+    std::shared_ptr<const audio::StftWindow> window = audio::getStftWindow(size, audio::StftOverlap::ThreeQuarters);
+
+    std::vector<double> ring(size), gains(size / 2 + 1);
+    for (unsigned int i = 0; i < size; ++i) ring[i] = std::sin(0.37 * i) + 0.1 * std::cos(3.1 * i);
+    for (unsigned int i = 0; i < gains.size(); ++i) gains[i] = 0.5 + 0.001 * i;
+
+    std::vector<double> frameA(size), frameB(size);
+    fixed.loadFrame(frameA.data(), ring.data(), 300, window->analysis.data(), size);
+    generic.loadFrame(frameB.data(), ring.data(), 300, window->analysis.data(), size);
+    ok &= check(frameA == frameB, "loadFrame kernels agree");
+
+    bool addsAgree = true;
+    for (unsigned int position : { 0u, 1024u, 1500u }) {
+        std::vector<double> outA(size * 2, 0.25), outB(size * 2, 0.25);
+        fixed.overlapAdd(outA.data(), frameA.data(), position, window->synthesis.data(), size);
+        generic.overlapAdd(outB.data(), frameA.data(), position, window->synthesis.data(), size);
+        addsAgree &= outA == outB;
+    }
+    ok &= check(addsAgree, "overlapAdd kernels agree, wrapped or not");
+
+    std::vector<double> spectrumData((size / 2 + 1) * 2);
+    for (unsigned int i = 0; i < spectrumData.size(); ++i) spectrumData[i] = std::cos(0.11 * i);
+    std::vector<double> spectrumCopy = spectrumData;
+    fftw_complex* binsA = reinterpret_cast<fftw_complex*>(spectrumData.data());
+    fftw_complex* binsB = reinterpret_cast<fftw_complex*>(spectrumCopy.data());
+
+    double energyA[NUM_BANDS] = {}, energyB[NUM_BANDS] = {};
+    fixed.accumulateGateBands(binsA, energyA, size);
+    generic.accumulateGateBands(binsB, energyB, size);
+    ok &= check(std::equal(energyA, energyA + NUM_BANDS, energyB), "gate band kernels agree");
+
+    fixed.applyBinGains(binsA, gains.data(), size / 2 + 1);
+    generic.applyBinGains(binsB, gains.data(), size / 2 + 1);
+    ok &= check(spectrumData == spectrumCopy, "bin gain kernels agree");
+    return ok;
+}
+
+bool testEQ() {
+    bool ok = true;
+    const std::vector<float> low = makeTone(100.0, 0.5f);
+
+    // Unity gains pass the signal through, delayed, with 256-frame blocks into a 1024-frame EQ
+    audio::ThreeBandEQ flat(RATE, 1024);
+    flat.prepare(256);
+    flat.setEnabled(true);
+    std::vector<float> output = runBlocks(low, 256, [&](const float* in, float* out, size_t n) { flat.process(in, out, n); });
+    ok &= check(flat.getLatency() == 2047 && delayedError(low, output, flat.getLatency(), 2048) < 1e-3f,
+                "EQ at unity passes any block size (latency " + std::to_string(flat.getLatency()) + ")");
+
+    audio::ThreeBandEQ cut(RATE, 1024);
+    cut.setEnabled(true);
+    cut.setBandGain(0, 0.0f);
+    output = runBlocks(low, 1024, [&](const float* in, float* out, size_t n) { cut.process(in, out, n); });
+    ok &= check(cut.getLatency() == 1024 && rms(output, 4096) < 0.01 * rms(low, 0),
+                "EQ with the low band at 0 removes a 100 Hz tone (periods of one hop, latency 1024)");
+    return ok;
+}
+
+bool testNoiseGate() {
+    // Quiet, then loud: the gate's decisions fall on hop boundaries, not block edges
+    std::vector<float> input = makeTone(300.0, 0.001f);
+    const std::vector<float> loud = makeTone(300.0, 0.8f);
+    std::copy(loud.begin() + input.size() / 2, loud.end(), input.begin() + input.size() / 2);
+
+    audio::NoiseGate byFrame(RATE, 1024), byOdd(RATE, 1024);
+    byFrame.setEnabled(true);
+    byOdd.setEnabled(true);
+    const std::vector<float> a = runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { byFrame.process(in, out, n); });
+    const std::vector<float> b = runBlocks(input, 97, [&](const float* in, float* out, size_t n) { byOdd.process(in, out, n); });
+
+    bool ok = check(std::equal(a.begin(), a.end(), b.begin()), "noise gate output identical for 1024- and 97-frame blocks");
+    ok &= check(rms(std::vector<float>(a.begin(), a.begin() + a.size() / 2), 0) < 1e-4 &&
+                byFrame.isOpen() && byFrame.getCurrentGain() > 0.99f, "gate closed on quiet input, open on loud");
+    return ok;
+}
+
+bool testDeEsser() {
+    bool ok = true;
+    audio::DeEsserSettings settings;
+    settings.enabled = true;
+    settings.reductionDB = 12.0;
+
+    const std::vector<float> sibilant = makeTone(7000.0, 0.5f);
+    audio::DeEsser deesser(RATE);
+    std::vector<float> output = runBlocks(sibilant, 1024, [&](const float* in, float* out, size_t n) {
+        deesser.process(in, out, n, settings);
+    });
+    const double reductionDB = 20.0 * std::log10(rms(sibilant, 0) / rms(output, 4096));
+    ok &= check(std::fabs(reductionDB - 12.0) < 0.5, "de-esser reduces a 7 kHz tone by the set amount ("
+                + std::to_string(reductionDB) + " dB)");
+
+    // applyDeEsser removes the latency: an out-of-band tone comes back sample-aligned
+    const std::vector<float> voiced = makeTone(1000.0, 0.5f);
+    std::vector<double> samples(voiced.begin(), voiced.end());
+    audio::applyDeEsser(samples, RATE, 4000, 10000, 12.0);
+    float error = 0.0f;
+    for (size_t i = 2048; i < samples.size() - 2048; ++i) {
+        error = std::max(error, std::fabs(static_cast<float>(samples[i]) - voiced[i]));
+    }
+    ok &= check(error < 1e-3f, "applyDeEsser output lines up with its input");
+    return ok;
+}
+
+bool testIdentityPath() {
+    bool ok = true;
+    const std::vector<float> input = makeTone(440.0, 0.5f);
+
+    // Identity on and off every few blocks: skipping those frames matches running them
+    const audio::StftOverlap overlaps[] = { audio::StftOverlap::Half, audio::StftOverlap::SevenEighths };
+    for (audio::StftOverlap overlap : overlaps) {
+        for (size_t blockFrames : { 512u, 300u }) {
+            audio::StftEngine every(1024, overlap), skipping(1024, overlap);
+            bool identity = false;
+            auto modify = [&](fftw_complex* bins, unsigned int numBins) {
+                if (identity) return;
+                for (unsigned int i = 0; i < numBins; ++i) {
+                    bins[i][0] *= 0.5;
+                    bins[i][1] *= 0.5;
+                }
+            };
+            std::vector<float> a(input.size()), b(input.size());
+            size_t delayOnlyBlocks = 0;
+            for (size_t offset = 0, block = 0; offset < input.size(); offset += blockFrames, ++block) {
+                const size_t frames = std::min(blockFrames, input.size() - offset);
+                identity = (block / 5) % 2 == 1;
+                every.process(input.data() + offset, a.data() + offset, frames, modify);
+                skipping.process(input.data() + offset, b.data() + offset, frames, modify, identity);
+                delayOnlyBlocks += skipping.isDelayOnly() ? 1 : 0;
+            }
+            float error = 0.0f;
+            for (size_t i = 0; i < a.size(); ++i) error = std::max(error, std::fabs(a[i] - b[i]));
+            ok &= check(delayOnlyBlocks > 0 && error < 1e-6f,
+                        "overlap 1/" + std::to_string(static_cast<unsigned int>(overlap)) + ", "
+                        + std::to_string(blockFrames) + "-frame blocks: delay-only path switches seamlessly");
+        }
+    }
+
+    // Unity EQ is an exact delay; a gain change crossfades into frames and back
+    audio::ThreeBandEQ eq(RATE, 1024);
+    eq.setEnabled(true);
+    std::vector<float> output = runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { eq.process(in, out, n); });
+    ok &= check(eq.isIdentity() && delayedError(input, output, eq.getLatency(), 2048) == 0.0f,
+                "EQ at unity only delays its input");
+    eq.setBandGain(1, 0.0f);
+    output = runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { eq.process(in, out, n); });
+    ok &= check(!eq.isIdentity() && rms(output, 4096) < 0.01 * rms(input, 0), "EQ leaves the delay-only path when a gain changes");
+    eq.setBandGain(1, 1.0f);
+    output = runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { eq.process(in, out, n); });
+    ok &= check(delayedError(input, output, eq.getLatency(), 4096) == 0.0f, "EQ returns to the delay-only path at unity");
+
+    // De-esser at 0 dB, and with an empty band
+    audio::DeEsser deesser(RATE);
+    audio::DeEsserSettings settings;
+    settings.enabled = true;
+    settings.reductionDB = 0.0;
+    output = runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { deesser.process(in, out, n, settings); });
+    settings.reductionDB = 6.0;
+    settings.startFreq = 9000;
+    settings.endFreq = 8000;
+    ok &= check(deesser.isIdentity(settings) && delayedError(input, output, deesser.getLatency(), 4096) == 0.0f,
+                "de-esser at 0 dB or with an empty band only delays its input");
+
+    // Informational: unity against shaped EQ
+    audio::ThreeBandEQ shaped(RATE), flat(RATE);
+    shaped.setEnabled(true);
+    shaped.setBandGain(2, 0.5f);
+    flat.setEnabled(true);
+    auto start = std::chrono::steady_clock::now();
+    runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { shaped.process(in, out, n); });
+    const double shapedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    runBlocks(input, 1024, [&](const float* in, float* out, size_t n) { flat.process(in, out, n); });
+    const double flatMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  shaped EQ " << shapedMs << " ms, unity EQ " << flatMs << " ms per second of audio" << std::endl;
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    ok &= testReconstruction();
+    ok &= testSharedWindows();
+    ok &= testKernelDispatch();
+    ok &= testEQ();
+    ok &= testNoiseGate();
+    ok &= testDeEsser();
+    ok &= testIdentityPath();
+    std::cout << (ok ? "All STFT tests passed." : "STFT tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
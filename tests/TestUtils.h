@@ -0,0 +1,17 @@
+// TestUtils.h
+// Helpers shared by the test programs in tests/. Each is a plain main() that ANDs its checks into
+// the exit code. Tests that run the effect chain link $CHAIN_SOURCES (see Tests in README.md).
+
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <iostream>
+#include <string>
+
+// Prints a [PASS] or [FAIL] line and returns the condition, for ok &= check(...)
+inline bool check(bool condition, const std::string& message) {
+    std::cout << (condition ? "[PASS] " : "[FAIL] ") << message << std::endl;
+    return condition;
+}
+
+#endif // TEST_UTILS_H
@@ -0,0 +1,230 @@
+// VoiceActivityTest.cpp
+// Checks voice activity detection on synthetic speech (a gliding harmonic voice with syllable
+// modulation, pausing over a noise floor): utterances are found within a block and pauses after the
+// hangover, noise and a steady tone are never speech, the gate's handed-over frames decide like the
+// detector's own STFT, and skipping runs the EQ and de-esser delay-only and keeps non-speech out of
+// the post tap.
+// Command to compile: g++ -std=c++17 -O2 -I. tests/VoiceActivityTest.cpp $CHAIN_SOURCES -lfftw3 -pthread -o vadtest
+// Command to run: ./vadtest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+
+#include "../audio/EffectChain.h"
+#include "TestUtils.h"
+
+const unsigned int RATE = 48000;
+const size_t BLOCK = 1024;
+
+// Each cycle: a pause, then an utterance
+const double PAUSE_SECONDS = 1.5;
+const double UTTERANCE_SECONDS = 1.5;
+const double CYCLE_SECONDS = PAUSE_SECONDS + UTTERANCE_SECONDS;
+
+std::vector<float> makeNoise(size_t frames, float amplitude, unsigned int seed = 7) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-amplitude, amplitude);
+    std::vector<float> samples(frames);
+    for (float& sample : samples) sample = distribution(generator);
+    return samples;
+}
+
+// Seconds into the current utterance, or -1 during a pause
+double utteranceTime(double seconds) {
+    const double inCycle = std::fmod(seconds, CYCLE_SECONDS);
+    return inCycle >= PAUSE_SECONDS ? inCycle - PAUSE_SECONDS : -1.0;
+}
+
+// A voice gliding around 140 Hz with twelve harmonics, four syllables a second, over white noise
+std::vector<float> makeSpeech(size_t frames) {
+    std::vector<float> samples = makeNoise(frames, 0.01f);
+    double phase = 0.0;
+    for (size_t i = 0; i < frames; ++i) {
+        const double seconds = static_cast<double>(i) / RATE;
+        const double fundamental = 140.0 + 25.0 * std::sin(2.0 * M_PI * 0.7 * seconds);
+        phase += 2.0 * M_PI * fundamental / RATE;
+        const double inUtterance = utteranceTime(seconds);
+        if (inUtterance < 0.0) continue;
+        const double syllable = 0.55 + 0.45 * std::sin(2.0 * M_PI * 4.0 * inUtterance);
+        double voice = 0.0;
+        for (int k = 1; k <= 12; ++k) voice += std::sin(k * phase) / k;
+        samples[i] += static_cast<float>(0.3 * syllable * voice);
+    }
+    return samples;
+}
+
+// Per-block speech decisions of a standalone detector
+std::vector<bool> detect(const std::vector<float>& input) {
+    audio::VoiceActivityDetector detector(RATE);
+    std::vector<bool> decisions;
+    for (size_t offset = 0; offset + BLOCK <= input.size(); offset += BLOCK) {
+        detector.measure(input.data() + offset, BLOCK, false);
+        decisions.push_back(detector.decide());
+    }
+    return decisions;
+}
+
+// Scores decisions against the utterances: blocks inside one (after the first 100 ms) should be
+// speech, blocks in a pause (after 400 ms for the hangover) should not
+void score(const std::vector<bool>& decisions, size_t& speechHit, size_t& speechTotal,
+           size_t& pauseHit, size_t& pauseTotal) {
+    speechHit = speechTotal = pauseHit = pauseTotal = 0;
+    for (size_t block = 0; block < decisions.size(); ++block) {
+        const double start = static_cast<double>(block * BLOCK) / RATE;
+        const double end = static_cast<double>((block + 1) * BLOCK) / RATE;
+        const double startIn = utteranceTime(start), endIn = utteranceTime(end);
+        if (startIn >= 0.1 && endIn > startIn) {
+            ++speechTotal;
+            speechHit += decisions[block];
+        }
+        const double inCycle = std::fmod(start, CYCLE_SECONDS);
+        if (start > 1.0 && inCycle >= 0.4 && std::fmod(end, CYCLE_SECONDS) < PAUSE_SECONDS && endIn < 0.0) {
+            ++pauseTotal;
+            pauseHit += !decisions[block];
+        }
+    }
+}
+
+float maxDelayedError(const std::vector<float>& input, const std::vector<float>& output, size_t latency,
+                      size_t from, size_t to) {
+    float error = 0.0f;
+    for (size_t i = std::max(from, latency); i < to; ++i) {
+        error = std::max(error, std::fabs(output[i] - input[i - latency]));
+    }
+    return error;
+}
+
+int main() {
+    bool ok = true;
+    const std::vector<float> speech = makeSpeech(static_cast<size_t>(RATE * CYCLE_SECONDS * 4));
+
+    // Detector on its own STFT: utterances and pauses
+    const std::vector<bool> own = detect(speech);
+    {
+        size_t speechHit, speechTotal, pauseHit, pauseTotal;
+        score(own, speechHit, speechTotal, pauseHit, pauseTotal);
+        ok &= check(speechTotal > 0 && speechHit >= speechTotal * 95 / 100,
+                    "speech found in " + std::to_string(speechHit) + "/" + std::to_string(speechTotal) + " utterance blocks");
+        ok &= check(pauseTotal > 0 && pauseHit >= pauseTotal * 95 / 100,
+                    "no speech in " + std::to_string(pauseHit) + "/" + std::to_string(pauseTotal) + " pause blocks");
+
+        audio::VoiceActivityDetector detector(RATE);
+        for (size_t offset = 0; offset + BLOCK <= speech.size(); offset += BLOCK) {
+            detector.measure(speech.data() + offset, BLOCK, false);
+            detector.decide();
+            if (detector.isSpeech()) {
+                const audio::VoiceFeatures& features = detector.getFeatures();
+                ok &= check(features.flatness < 0.2f && features.energyDB - features.noiseFloorDB > 20.0f,
+                            "speech features: flatness " + std::to_string(features.flatness) + ", " +
+                            std::to_string(features.energyDB - features.noiseFloorDB) + " dB above the floor");
+                break;
+            }
+        }
+    }
+
+    // Noise and a steady tone are never speech
+    {
+        const std::vector<bool> noise = detect(makeNoise(RATE * 5, 0.3f, 11));
+        std::vector<float> tone(RATE * 5);
+        for (size_t i = 0; i < tone.size(); ++i) tone[i] = 0.3f * static_cast<float>(std::sin(2.0 * M_PI * 1000.0 * i / RATE));
+        const std::vector<bool> steady = detect(tone);
+        ok &= check(std::count(noise.begin(), noise.end(), true) == 0, "loud white noise is not speech");
+        ok &= check(std::count(steady.begin(), steady.end(), true) == 0, "a steady tone stays in the noise floor");
+
+        // Quiet noise under a loud talker: the floor falls back once the background drops
+        std::vector<float> loudThenQuiet = makeNoise(RATE * 4, 0.2f, 5);
+        const std::vector<float> quiet = makeNoise(RATE * 2, 0.002f, 6);
+        std::copy(quiet.begin(), quiet.end(), loudThenQuiet.begin() + RATE * 2);
+        const std::vector<bool> drop = detect(loudThenQuiet);
+        ok &= check(std::count(drop.begin(), drop.end(), true) == 0, "a drop in background noise is not speech");
+    }
+
+    // Chain: with the gate analysing, its frames decide like the detector's own STFT
+    {
+        audio::NoiseGate gate(RATE);
+        audio::ThreeBandEQ eq(RATE);
+        audio::Limiter limiter(RATE);
+        audio::DeEsserSettings deesser;
+        gate.setEnabled(true);
+        gate.setThreshold(0.0001f);
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        chain.setVoiceActivityDetection(true);
+        std::vector<float> out(BLOCK);
+        size_t agree = 0, blocks = 0, speechBlocks = 0;
+        bool publishes = true;
+        for (size_t offset = 0; offset + BLOCK <= speech.size(); offset += BLOCK, ++blocks) {
+            chain.process(speech.data() + offset, out.data(), BLOCK);
+            agree += chain.isSpeech() == own[blocks];
+            speechBlocks += chain.isSpeech();
+            publishes &= chain.isSpeechActive() == chain.isSpeech();
+        }
+        ok &= check(gate.getVoiceActivity() == &chain.getVoiceActivity() && agree >= blocks * 95 / 100,
+                    "gate frames agree with the detector's own on " + std::to_string(agree) + "/" +
+                    std::to_string(blocks) + " blocks");
+        ok &= check(publishes && chain.getSpeechBlocks() == speechBlocks, "chain publishes speech blocks and state");
+        chain.setVoiceActivityDetection(false);
+        ok &= check(gate.getVoiceActivity() == nullptr && !chain.isSpeech(), "turning detection off detaches the gate");
+    }
+
+    // Skipping: the EQ and de-esser only delay non-speech, and the post tap keeps speech only
+    {
+        audio::NoiseGate gate(RATE);
+        audio::ThreeBandEQ eq(RATE);
+        audio::Limiter limiter(RATE);
+        audio::DeEsserSettings deesser;
+        eq.setEnabled(true);
+        eq.setBandGain(0, 2.0f);
+        limiter.setEnabled(false);
+        deesser.enabled = true;
+        deesser.startFreq = 1000;
+        deesser.endFreq = 8000;
+        deesser.reductionDB = 12.0;
+        const size_t latency = eq.getLatency() + audio::DeEsser(RATE).getLatency();
+
+        audio::TapConfig tapConfig;
+        tapConfig.directIO = false;
+        audio::RecordingTap postTap("vadtest-post.wav", 1, RATE, tapConfig);
+        const bool opened = postTap.openFile();
+
+        audio::EffectChain chain(gate, eq, limiter, deesser, RATE);
+        chain.setTaps(nullptr, &postTap);
+        chain.setVoiceActivityDetection(true);
+        chain.setSkipNonSpeech(true);
+        std::vector<float> output(speech.size(), 0.0f);
+        std::vector<bool> decisions;
+        for (size_t offset = 0; offset + BLOCK <= speech.size(); offset += BLOCK) {
+            chain.process(speech.data() + offset, output.data() + offset, BLOCK);
+            decisions.push_back(chain.isSpeech());
+            postTap.drain();
+        }
+        postTap.closeFile();
+        std::remove("vadtest-post.wav");
+
+        // Second pause: delay-only once the hangover and the STFT latency have passed
+        const size_t pauseFrom = static_cast<size_t>(RATE * (CYCLE_SECONDS + 0.5)) + latency;
+        const size_t pauseTo = static_cast<size_t>(RATE * (CYCLE_SECONDS + PAUSE_SECONDS));
+        const size_t utteranceFrom = static_cast<size_t>(RATE * (CYCLE_SECONDS + PAUSE_SECONDS + 0.2)) + latency;
+        const size_t utteranceTo = static_cast<size_t>(RATE * 2 * CYCLE_SECONDS);
+        const float pauseError = maxDelayedError(speech, output, latency, pauseFrom, pauseTo);
+        const float utteranceError = maxDelayedError(speech, output, latency, utteranceFrom, utteranceTo);
+        ok &= check(pauseError < 1e-6f && utteranceError > 0.01f,
+                    "non-speech runs delay-only (error " + std::to_string(pauseError) + "), speech is processed (" +
+                    std::to_string(utteranceError) + ")");
+
+        const uint64_t speechFrames = std::count(decisions.begin(), decisions.end(), true) * BLOCK;
+        ok &= check(opened && postTap.getFramesWritten() == speechFrames && speechFrames < speech.size() * 3 / 4,
+                    "post tap wrote " + std::to_string(postTap.getFramesWritten()) + " speech frames of " +
+                    std::to_string(speech.size()));
+
+        chain.setSkipNonSpeech(false);
+        ok &= check(!eq.isPassThrough(), "turning skipping off restores the EQ");
+    }
+
+    std::cout << (ok ? "All voice activity tests passed." : "Some voice activity tests FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+// WatchdogTest.cpp
+// Supervises a worker thread that consumes a BufferQueue the way the processing thread does.
+// The worker is wedged (its producer stops) and must be restarted on fresh queues; a reported
+// fault must trigger recovery without a stall; a consumer whose input died must not be blamed for
+// it; and a recovery that keeps failing must back off.
+// Command to compile: g++ -std=c++17 -I. tests/WatchdogTest.cpp audio/Watchdog.cpp audio/BufferQueue.cpp -pthread -o watchdogtest
+// Command to run: ./watchdogtest
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+
+#include "../audio/Watchdog.h"
+#include "../audio/BufferQueue.h"
+#include "TestUtils.h"
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Consumer that beats once per block, like processingThread()
+struct Worker {
+    audio::BufferQueue queue{4};
+    audio::Heartbeat heartbeat;
+    std::atomic<bool> active{false};
+    std::thread thread;
+
+    void start() {
+        queue.reset();
+        active.store(true);
+        thread = std::thread([this] {
+            std::vector<float> block;
+            while (queue.pop(block)) { heartbeat.beat(); }
+            active.store(false);
+        });
+    }
+    bool stop() {
+        queue.setDone();
+        for (int i = 0; i < 100 && active.load(); ++i) sleepMs(1);
+        if (active.load()) return false;
+        if (thread.joinable()) thread.join();
+        return true;
+    }
+};
+
+int main() {
+    bool ok = true;
+
+    audio::WatchdogConfig config;
+    config.pollMs = 5;
+    config.initialBackoffMs = 20;
+    config.maxBackoffMs = 80;
+
+    // BufferQueue::reset() empties the queue and undoes setDone()
+    {
+        audio::BufferQueue queue(4);
+        queue.push(std::vector<float>(8, 1.0f));
+        queue.setDone();
+        queue.reset();
+        queue.push(std::vector<float>(8, 2.0f));
+        std::vector<float> buffer;
+        ok &= check(queue.getDepth() == 1 && queue.pop(buffer) && buffer[0] == 2.0f,
+                    "reset queue drops old blocks and accepts new ones");
+    }
+
+    // Stall, restart, fault
+    {
+        Worker worker;
+        worker.start();
+        std::atomic<bool> producing{true};
+        std::thread producer([&] {
+            while (producing.load()) {
+                worker.queue.push(std::vector<float>(8, 0.5f));
+                sleepMs(2);
+            }
+        });
+
+        audio::Watchdog watchdog(config);
+        const size_t component = watchdog.addComponent("worker", worker.heartbeat, 50, [&worker] {
+            if (!worker.stop()) return false;
+            worker.start();
+            return true;
+        });
+        watchdog.start();
+
+        sleepMs(150);
+        ok &= check(watchdog.getEvents().empty(), "healthy heartbeat triggers no recovery");
+
+        // Wedge: the worker blocks in pop() with no producer
+        producing.store(false);
+        producer.join();
+        sleepMs(120);
+        std::vector<audio::RecoveryEvent> events = watchdog.getEvents();
+        ok &= check(!events.empty() && events[0].component == "worker" && events[0].reason == "heartbeat stalled" &&
+                    events[0].recovered && events[0].stalledMs >= 50.0, "stalled worker restarted");
+        ok &= check(worker.active.load(), "worker running again after restart");
+
+        // Feed the restarted worker for a while: it is healthy again
+        producing.store(true);
+        producer = std::thread([&] {
+            while (producing.load()) {
+                worker.queue.push(std::vector<float>(8, 0.5f));
+                sleepMs(2);
+            }
+        });
+        const uint64_t beatsBefore = worker.heartbeat.getBeats();
+        const size_t eventsBefore = watchdog.getEvents().size();
+        sleepMs(150);
+        ok &= check(worker.heartbeat.getBeats() > beatsBefore && watchdog.getEvents().size() == eventsBefore,
+                    "restarted worker keeps beating without further recovery");
+
+        watchdog.reportFault(component, "device error");
+        sleepMs(60);
+        events = watchdog.getEvents();
+        ok &= check(events.size() == eventsBefore + 1 && events.back().reason == "device error" &&
+                    events.back().attempt == 1 && events.back().recovered, "reported fault recovered without a stall");
+
+        watchdog.stop();
+        producing.store(false);
+        producer.join();
+        worker.stop();
+        ok &= check(watchdog.getRecoveries(component) == events.size() && watchdog.getFailures(component) == 0,
+                    "recoveries counted per component");
+    }
+
+    // A consumer whose input dies is waiting, not stalled; fed but silent, it is restarted
+    {
+        audio::Heartbeat input, output;
+        std::atomic<bool> feeding{true}, consuming{true}, running{true};
+        std::thread device([&] {
+            while (running.load()) {
+                if (feeding.load()) input.beat();
+                if (feeding.load() && consuming.load()) output.beat();
+                sleepMs(2);
+            }
+        });
+        std::atomic<int> restarts{0};
+        audio::Watchdog watchdog(config);
+        watchdog.addComponent("pipeline", output, 50, [&restarts] {
+            ++restarts;
+            return true;
+        }, &input);
+        watchdog.start();
+
+        // The device stops: output stops with it, for well past the stall timeout
+        sleepMs(50);
+        feeding.store(false);
+        sleepMs(200);
+        ok &= check(restarts.load() == 0 && watchdog.getEvents().empty(),
+                    "consumer not restarted while its input is dead");
+
+        // Input arrives again but the consumer produces nothing: that is a stall
+        consuming.store(false);
+        feeding.store(true);
+        sleepMs(120);
+        const std::vector<audio::RecoveryEvent> events = watchdog.getEvents();
+        ok &= check(restarts.load() >= 1 && !events.empty() && events[0].reason == "heartbeat stalled",
+                    "consumer restarted when input arrives and it produces nothing");
+
+        watchdog.stop();
+        running.store(false);
+        device.join();
+    }
+
+    // A recovery that keeps failing backs off exponentially up to the cap
+    {
+        audio::Heartbeat silent;
+        std::atomic<int> attempts{0};
+        audio::Watchdog watchdog(config);
+        const size_t component = watchdog.addComponent("device", silent, 10, [&attempts] {
+            ++attempts;
+            return false;
+        });
+        watchdog.start();
+        sleepMs(500);
+        watchdog.stop();
+
+        const std::vector<audio::RecoveryEvent> events = watchdog.getEvents();
+        bool spaced = events.size() >= 4;
+        for (size_t i = 1; i < events.size() && spaced; ++i) {
+            const double gapMs = (events[i].timeNanos - events[i - 1].timeNanos) / 1e6;
+            const double backoffMs = std::min(20.0 * (1 << (i - 1)), 80.0);
+            spaced = gapMs >= backoffMs && events[i].attempt == i + 1 && !events[i].recovered;
+        }
+        ok &= check(spaced, "failed recoveries retried after 20, 40, 80, 80... ms");
+        ok &= check(events.size() <= 9 && watchdog.getFailures(component) == static_cast<uint64_t>(attempts.load()),
+                    "backoff bounds the retry rate");
+    }
+
+    std::cout << (ok ? "All watchdog tests passed." : "Some tests failed.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// MetricsDump.cpp
+// Prints the schema and per-column summary of a columnar metrics file, or dumps it as CSV.
+// Command to compile: g++ -std=c++17 -O2 -I. tools/MetricsDump.cpp offline/MetricsFile.cpp -o metricsdump
+// Command to run: ./metricsdump analysis.metrics [--csv]
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+
+#include "../offline/MetricsFile.h"
+
+const char* typeName(audio::MetricType type) {
+    switch (type) {
+        case audio::MetricType::Float32: return "float32";
+        case audio::MetricType::Float64: return "float64";
+        case audio::MetricType::UInt64: return "uint64";
+        case audio::MetricType::UInt8: return "uint8";
+    }
+    return "?";
+}
+
+// Reads one value of any column type as double, straight from the mapping
+double valueAt(const audio::MetricsReader& reader, size_t column, size_t group, size_t row) {
+    size_t rows = 0;
+    switch (reader.getColumns()[column].type) {
+        case audio::MetricType::Float32: return reader.groupData<float>(column, group, rows)[row];
+        case audio::MetricType::Float64: return reader.groupData<double>(column, group, rows)[row];
+        case audio::MetricType::UInt64: return static_cast<double>(reader.groupData<uint64_t>(column, group, rows)[row]);
+        case audio::MetricType::UInt8: return reader.groupData<uint8_t>(column, group, rows)[row];
+    }
+    return 0.0;
+}
+
+void printSummary(const audio::MetricsReader& reader) {
+    const auto& columns = reader.getColumns();
+    std::cout << reader.getRows() << " rows in " << reader.getGroupCount() << " row groups, "
+              << columns.size() << " columns\n";
+    for (size_t c = 0; c < columns.size(); ++c) {
+        double minValue = std::numeric_limits<double>::infinity();
+        double maxValue = -minValue;
+        double sum = 0.0;
+        for (size_t g = 0; g < reader.getGroupCount(); ++g) {
+            for (size_t r = 0; r < reader.getGroupRows(g); ++r) {
+                double v = valueAt(reader, c, g, r);
+                minValue = std::min(minValue, v);
+                maxValue = std::max(maxValue, v);
+                sum += v;
+            }
+        }
+        std::printf("  %-16s %-8s min %-12g max %-12g mean %g\n", columns[c].name.c_str(), typeName(columns[c].type),
+                    minValue, maxValue, reader.getRows() ? sum / reader.getRows() : 0.0);
+    }
+}
+
+void printCSV(const audio::MetricsReader& reader) {
+    const auto& columns = reader.getColumns();
+    for (size_t c = 0; c < columns.size(); ++c) {
+        std::printf("%s%s", c ? "," : "", columns[c].name.c_str());
+    }
+    std::printf("\n");
+    for (size_t g = 0; g < reader.getGroupCount(); ++g) {
+        for (size_t r = 0; r < reader.getGroupRows(g); ++r) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                std::printf("%s%.9g", c ? "," : "", valueAt(reader, c, g, r));
+            }
+            std::printf("\n");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.metrics> [--csv]" << std::endl;
+        return 1;
+    }
+    audio::MetricsReader reader;
+    if (!reader.open(argv[1])) {
+        return 1;
+    }
+    if (argc > 2 && std::strcmp(argv[2], "--csv") == 0) {
+        printCSV(reader);
+    } else {
+        printSummary(reader);
+    }
+    return 0;
+}